@@ -0,0 +1,154 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "fl.h"
+#include "hs.h"
+
+#define DEFAULT_NKEYS 1000000
+
+static double _now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint64_t _rand64(void)
+{
+    return ((uint64_t)rand() << 42) ^ ((uint64_t)rand() << 21) ^ (uint64_t)rand();
+}
+
+/* keys[0, n) are added, keys[n, 2n) never are */
+static void _filters(const uint64_t *keys, size_t n, double fpr)
+{
+    fl_Bloom *bf = fl_bloom_init(n, fpr);
+    fl_Cuckoo *cf = fl_cuckoo_init(n, fpr);
+    size_t i, fp_bloom = 0, fp_cuckoo = 0, failed = 0;
+    double t0, t_badd, t_bget, t_cadd, t_cget;
+
+    t0 = _now();
+    for (i = 0; i < n; ++i)
+        fl_bloom_add(bf, keys[i]);
+    t_badd = _now() - t0;
+    t0 = _now();
+    for (i = n; i < 2 * n; ++i)
+        fp_bloom += fl_bloom_contains(bf, keys[i]);
+    t_bget = _now() - t0;
+
+    t0 = _now();
+    for (i = 0; i < n; ++i)
+        failed += fl_cuckoo_add(cf, keys[i]) != SUCCESS;
+    t_cadd = _now() - t0;
+    t0 = _now();
+    for (i = n; i < 2 * n; ++i)
+        fp_cuckoo += fl_cuckoo_contains(cf, keys[i]);
+    t_cget = _now() - t0;
+
+    printf("fpr %-7g bloom  %5.2f bits/key  fpr %.5f  add %6.1f ns  miss %6.1f ns\n",
+           fpr, fl_bloom_getbytes(bf) * 8.0 / n, (double)fp_bloom / n,
+           t_badd * 1e9 / n, t_bget * 1e9 / n);
+    printf("%12s cuckoo %5.2f bits/key  fpr %.5f  add %6.1f ns  miss %6.1f ns  (%zu failed)\n",
+           "", fl_cuckoo_getbytes(cf) * 8.0 / n, (double)fp_cuckoo / n,
+           t_cadd * 1e9 / n, t_cget * 1e9 / n, failed);
+
+    fl_cuckoo_destroy(cf);
+    fl_bloom_destroy(bf);
+}
+
+/* lookups of which about one in ten hits, against each kind of filter */
+static void _set_lookups(const uint64_t *keys, size_t n)
+{
+    static const char *names[] = {"none", "bloom", "cuckoo"};
+    hs_HashSet *hs = hs_init_int();
+    int kind;
+    size_t i;
+
+    hs_add_many_int(hs, keys, n);
+    for (kind = hs_FILTER_NONE; kind <= hs_FILTER_CUCKOO; ++kind) {
+        size_t hits = 0;
+        double t0;
+
+        hs_set_filter(hs, (hs_FilterKind)kind, 0.01);
+        t0 = _now();
+        for (i = 0; i < n; ++i)
+            hits += hs_contains_int(hs, keys[(i % 10 == 0) ? i : n + i]);
+        printf("%9zu keys  hs_contains_int filter %-6s %6.1f ns/lookup (%zu hits)\n",
+               n, names[kind], (_now() - t0) * 1e9 / n, hits);
+    }
+    hs_destroy(hs, NULL);
+}
+
+/* keys are stored in the element pointers, hashed into 4 values */
+static size_t _colliding_hash(const void *elem)
+{
+    return (uintptr_t)elem % 4;
+}
+
+static int _key_compare(const void *a, const void *b)
+{
+    uintptr_t x = (uintptr_t)a, y = (uintptr_t)b;
+    return (x > y) - (x < y);
+}
+
+static void _noop(void *elem)
+{
+    (void)elem;
+}
+
+/* far more equal hashes than a cuckoo filter holds: the filter set before
+ * the adds is dropped on the way, the one set after fails outright */
+static void _colliding(size_t n)
+{
+    hs_HashSet *hs = hs_init(_colliding_hash, _key_compare);
+    size_t i, hits = 0;
+    int before, after;
+    double t0, t_add, t_get;
+
+    before = hs_set_filter(hs, hs_FILTER_CUCKOO, 0.01);
+    t0 = _now();
+    for (i = 1; i <= n; ++i)
+        hs_add(hs, (void*)i);
+    t_add = _now() - t0;
+    after = hs_set_filter(hs, hs_FILTER_CUCKOO, 0.01);
+    t0 = _now();
+    for (i = 1; i <= 2 * n; ++i)
+        hits += hs_contains(hs, (void*)i);
+    t_get = _now() - t0;
+
+    printf("%9zu keys  4 hashes, cuckoo set before %s, after %s  "
+           "add %8.1f ns  lookup %8.1f ns (%zu hits)\n", n,
+           before == SUCCESS ? "ok" : "ERROR", after == SUCCESS ? "ok" : "ERROR",
+           t_add * 1e9 / n, t_get * 1e9 / (2 * n), hits);
+    hs_destroy(hs, _noop);
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = (argc > 1) ? strtoul(argv[1], NULL, 10) : DEFAULT_NKEYS;
+    uint64_t *keys = (uint64_t*)malloc(2 * n * sizeof *keys);
+    static const double fprs[] = {0.1, 0.01, 0.001, fl_CUCKOO_MIN_FPR};
+    size_t i, m;
+
+    srand(42);
+    for (i = 0; i < 2 * n; ++i)
+        keys[i] = _rand64();
+
+    for (i = 0; i < sizeof fprs / sizeof *fprs; ++i)
+        _filters(keys, n, fprs[i]);
+    for (m = n / 100; m <= 10 * n; m *= 10) {
+        uint64_t *more = (m > n) ? (uint64_t*)malloc(2 * m * sizeof *more) : keys;
+        if (m > n) {
+            for (i = 0; i < 2 * m; ++i)
+                more[i] = _rand64();
+        }
+        _set_lookups(more, m);
+        if (more != keys)
+            free(more);
+    }
+    _colliding(2000);
+
+    free(keys);
+    return 0;
+}
@@ -0,0 +1,121 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "hm.h"
+
+#define DEFAULT_MAXNELEMS 10000000
+
+static double _now(void)
+{
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+static size_t _hash(const void *key)
+{
+    return (size_t)(uintptr_t)key;
+}
+
+static int _compare(const void *a, const void *b)
+{
+    return a != b;
+}
+
+static void _nodtor(void *elem)
+{
+    (void)elem;
+}
+
+static void _run(size_t n, double max_load)
+{
+    std::mt19937_64 rng(42);
+    std::vector<uint64_t> keys(n), misses(n);
+    std::vector<size_t> order(n);
+    double t0, hm_put_t, hm_hit_t, hm_miss_t, hm_remove_t;
+    double um_put_t, um_hit_t, um_miss_t, um_remove_t;
+    size_t i, hm_found = 0, um_found = 0;
+
+    /* odd keys are stored, even ones miss */
+    for (i = 0; i < n; ++i) {
+        keys[i] = rng() | 1;
+        misses[i] = rng() & ~(uint64_t)1;
+        order[i] = i;
+    }
+    /* look up in another order than insertion, or unordered_map nodes
+     * come out of the allocator in lookup order */
+    std::shuffle(order.begin(), order.end(), rng);
+
+    hm_HashMap *hm = hm_init(_hash, _compare);
+    hm_set_max_load(hm, max_load);
+    t0 = _now();
+    for (i = 0; i < n; ++i)
+        hm_put(hm, (void*)(uintptr_t)keys[i], (void*)(uintptr_t)i, _nodtor);
+    hm_put_t = _now() - t0;
+    t0 = _now();
+    for (i = 0; i < n; ++i)
+        hm_found += (uintptr_t)hm_get(hm, (void*)(uintptr_t)keys[order[i]]) == order[i];
+    hm_hit_t = _now() - t0;
+    t0 = _now();
+    for (i = 0; i < n; ++i)
+        hm_found += hm_contains(hm, (void*)(uintptr_t)misses[i]);
+    hm_miss_t = _now() - t0;
+    t0 = _now();
+    for (i = 0; i < n; i += 2)
+        hm_remove(hm, (void*)(uintptr_t)keys[order[i]], _nodtor, _nodtor);
+    hm_remove_t = _now() - t0;
+    hm_destroy(hm, _nodtor, _nodtor);
+
+    {
+        std::unordered_map<uint64_t, uint64_t> um;
+        um.max_load_factor((float)max_load);
+        t0 = _now();
+        for (i = 0; i < n; ++i)
+            um[keys[i]] = i;
+        um_put_t = _now() - t0;
+        t0 = _now();
+        for (i = 0; i < n; ++i) {
+            auto it = um.find(keys[order[i]]);
+            um_found += it != um.end() && it->second == order[i];
+        }
+        um_hit_t = _now() - t0;
+        t0 = _now();
+        for (i = 0; i < n; ++i)
+            um_found += um.count(misses[i]);
+        um_miss_t = _now() - t0;
+        t0 = _now();
+        for (i = 0; i < n; i += 2)
+            um.erase(keys[order[i]]);
+        um_remove_t = _now() - t0;
+    }
+
+    if (hm_found != um_found) {
+        fprintf(stderr, "n=%zu: hm and unordered_map disagree\n", n);
+        exit(EXIT_FAILURE);
+    }
+
+    printf("%9zu load %.3f  ns/op  put %6.1f / %6.1f  hit %6.1f / %6.1f"
+           "  miss %6.1f / %6.1f  remove %6.1f / %6.1f  (hm / unordered_map)\n",
+           n, max_load,
+           hm_put_t * 1e9 / n, um_put_t * 1e9 / n,
+           hm_hit_t * 1e9 / n, um_hit_t * 1e9 / n,
+           hm_miss_t * 1e9 / n, um_miss_t * 1e9 / n,
+           hm_remove_t * 2e9 / n, um_remove_t * 2e9 / n);
+}
+
+int main(int argc, char **argv)
+{
+    size_t maxn = (argc > 1) ? strtoul(argv[1], NULL, 10) : DEFAULT_MAXNELEMS;
+    size_t n;
+
+    for (n = 100000; n <= maxn; n *= 10) {
+        _run(n, 0.5);
+        _run(n, hm_DEFAULT_MAX_LOAD);
+    }
+    return 0;
+}
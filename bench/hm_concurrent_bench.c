@@ -0,0 +1,146 @@
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "hm.h"
+
+#define DEFAULT_MAXTHREADS 16
+#define NKEYS              1000000
+#define RUN_SECONDS        0.5
+
+#define KEY(x) ((void*)(uintptr_t)(x))
+
+typedef struct {
+    hm_HashMap *hm;
+    pthread_mutex_t *lock;      /* one lock around the map, NULL in concurrent mode */
+    uint64_t seed;
+    volatile int *stop;
+    unsigned long ops;
+} Worker;
+
+static double _now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static size_t _hash(const void *key)
+{
+    return (size_t)(uintptr_t)key;
+}
+
+static int _compare(const void *a, const void *b)
+{
+    return a != b;
+}
+
+static void _nodtor(void *elem)
+{
+    (void)elem;
+}
+
+static uint64_t _xorshift(uint64_t *s)
+{
+    *s ^= *s << 13;
+    *s ^= *s >> 7;
+    *s ^= *s << 17;
+    return *s;
+}
+
+static void *_work(void *arg)
+{
+    Worker *w = (Worker*)arg;
+    unsigned long ops = 0;
+
+    while (!*w->stop) {
+        int i;
+        for (i = 0; i < 256; ++i) {
+            uint64_t r = _xorshift(&w->seed);
+            void *key = KEY(1 + (r >> 8) % (2 * NKEYS));
+            unsigned op = r % 20;
+
+            if (w->lock)
+                pthread_mutex_lock(w->lock);
+            /* 90% reads, the writes half puts and half removes */
+            if (op < 18)
+                hm_get(w->hm, key);
+            else if (op == 18)
+                hm_put(w->hm, key, key, _nodtor);
+            else
+                hm_remove(w->hm, key, _nodtor, _nodtor);
+            if (w->lock)
+                pthread_mutex_unlock(w->lock);
+        }
+        ops += 256;
+    }
+    w->ops = ops;
+    return NULL;
+}
+
+static double _run(hm_HashMap *hm, pthread_mutex_t *lock, int nthreads)
+{
+    pthread_t *threads = (pthread_t*)malloc(nthreads * sizeof *threads);
+    Worker *workers = (Worker*)malloc(nthreads * sizeof *workers);
+    volatile int stop = 0;
+    unsigned long ops = 0;
+    double t0, elapsed;
+    int i;
+
+    t0 = _now();
+    for (i = 0; i < nthreads; ++i) {
+        workers[i].hm = hm;
+        workers[i].lock = lock;
+        workers[i].seed = 0x9e3779b97f4a7c15ULL * (i + 1);
+        workers[i].stop = &stop;
+        workers[i].ops = 0;
+        pthread_create(&threads[i], NULL, _work, &workers[i]);
+    }
+    while (_now() - t0 < RUN_SECONDS) {
+        struct timespec ts = {0, 10000000};
+        nanosleep(&ts, NULL);
+    }
+    stop = 1;
+    for (i = 0; i < nthreads; ++i) {
+        pthread_join(threads[i], NULL);
+        ops += workers[i].ops;
+    }
+    elapsed = _now() - t0;
+
+    free(workers);
+    free(threads);
+    return ops / elapsed / 1e6;
+}
+
+static void _fill(hm_HashMap *hm)
+{
+    size_t i;
+
+    /* half the key range, so reads hit about half the time */
+    for (i = 1; i <= 2 * NKEYS; i += 2)
+        hm_put(hm, KEY(i), KEY(i), _nodtor);
+}
+
+int main(int argc, char **argv)
+{
+    int maxthreads = (argc > 1) ? atoi(argv[1]) : DEFAULT_MAXTHREADS;
+    hm_HashMap *locked = hm_init_with_capacity(_hash, _compare, NKEYS);
+    hm_HashMap *concurrent = hm_init_concurrent(_hash, _compare, 0);
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    int n;
+
+    hm_reserve(concurrent, NKEYS);
+    _fill(locked);
+    _fill(concurrent);
+
+    printf("%d keys, 90%% get / 5%% put / 5%% remove, Mops/s\n", NKEYS);
+    printf("threads   one mutex   concurrent\n");
+    for (n = 1; n <= maxthreads; n *= 2)
+        printf("%7d  %10.2f  %11.2f\n", n, _run(locked, &lock, n), _run(concurrent, NULL, n));
+
+    hm_destroy(concurrent, _nodtor, _nodtor);
+    hm_destroy(locked, _nodtor, _nodtor);
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "hm.h"
+
+/* 10^8 needs several GB for the tables, pass it as the first argument */
+#define DEFAULT_NELEMS 10000000
+
+#define KEY(x) ((void*)(uintptr_t)(x))
+
+static uint64_t _now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static size_t _hash(const void *key)
+{
+    return (size_t)(uintptr_t)key;
+}
+
+static int _compare(const void *a, const void *b)
+{
+    return a != b;
+}
+
+static void _nodtor(void *elem)
+{
+    (void)elem;
+}
+
+static int _latency_compare(const void *a, const void *b)
+{
+    float x = *(const float*)a;
+    float y = *(const float*)b;
+    return (x > y) - (x < y);
+}
+
+static void _run(const char *name, bool incremental, size_t n, float *lat)
+{
+    hm_HashMap *hm = hm_init(_hash, _compare);
+    uint64_t start, t0, t1;
+    float max = 0;
+    size_t i, next = 100000;
+
+    hm_set_incremental(hm, incremental);
+    printf("%s\n", name);
+
+    start = _now_ns();
+    for (i = 0; i < n; ++i) {
+        /* every put looks up a key too, as a read-mostly workload would */
+        t0 = _now_ns();
+        hm_put(hm, KEY(i + 1), KEY(i + 1), _nodtor);
+        hm_get(hm, KEY(i / 2 + 1));
+        t1 = _now_ns();
+        lat[i] = (float)(t1 - t0);
+        if (lat[i] > max)
+            max = lat[i];
+        if (i + 1 == next || i + 1 == n) {
+            printf("  %10zu entries  max so far %12.0f ns\n", i + 1, max);
+            next *= 10;
+        }
+    }
+    t1 = _now_ns();
+
+    qsort(lat, n, sizeof *lat, _latency_compare);
+    printf("  total %8.3f s  p50 %6.0f ns  p99 %6.0f ns  p99.9 %8.0f ns  max %12.0f ns\n",
+           (t1 - start) / 1e9, lat[n / 2], lat[n / 100 * 99], lat[n / 1000 * 999], lat[n - 1]);
+
+    hm_destroy(hm, _nodtor, _nodtor);
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = (argc > 1) ? strtoul(argv[1], NULL, 10) : DEFAULT_NELEMS;
+    float *lat = (float*)malloc(n * sizeof *lat);
+
+    if (n < 1000 || !lat) {
+        fprintf(stderr, "need at least 1000 entries\n");
+        return EXIT_FAILURE;
+    }
+
+    /* the same growing workload, timed per put + get */
+    _run("stop-the-world resize", false, n, lat);
+    _run("incremental resize", true, n, lat);
+
+    free(lat);
+    return 0;
+}
@@ -0,0 +1,156 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "hs.h"
+#include "vt.h"
+
+#define DEFAULT_MAXNELEMS 10000000
+
+static double _now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint64_t _rand64(void)
+{
+    return ((uint64_t)rand() << 42) ^ ((uint64_t)rand() << 21) ^ (uint64_t)rand();
+}
+
+static int _vt_compare(const vt_Vector_Element a, const vt_Vector_Element b)
+{
+    uintptr_t x = (uintptr_t)a;
+    uintptr_t y = (uintptr_t)b;
+    return (x > y) - (x < y);
+}
+
+static uint64_t _vt_key(const vt_Vector_Element e)
+{
+    return (uintptr_t)e;
+}
+
+static void _nodtor(vt_Vector_Element elem)
+{
+    (void)elem;
+}
+
+/* ids as vt elements, sorted one way or the other, then counted once each */
+static size_t _vt_dedupe(const uint64_t *ids, size_t n, bool radix)
+{
+    vt_Vector *vt = vt_init_with_capacity(n);
+    size_t i, unique = 0;
+    uintptr_t prev = 0;
+
+    for (i = 0; i < n; ++i)
+        vt_add(vt, (vt_Vector_Element)(uintptr_t)ids[i]);
+    if (radix)
+        vt_sort_by_key(vt, _vt_key);
+    else
+        vt_sort(vt, _vt_compare);
+    for (i = 0; i < n; ++i) {
+        uintptr_t id = (uintptr_t)vt_get_at(vt, i);
+        unique += (i == 0 || id != prev);
+        prev = id;
+    }
+    vt_destroy(vt, _nodtor);
+    return unique;
+}
+
+static size_t _hs_dedupe(const uint64_t *ids, size_t n, bool bulk)
+{
+    hs_HashSet *hs = hs_init_int();
+    size_t i, unique = 0;
+
+    if (bulk) {
+        unique = hs_add_many_int(hs, ids, n);
+    } else {
+        for (i = 0; i < n; ++i)
+            unique += hs_add_int(hs, ids[i]);
+    }
+    hs_destroy(hs, NULL);
+    return unique;
+}
+
+static void _run(const uint64_t *ids, size_t n, const char *dist)
+{
+    size_t u_sort, u_radix, u_add, u_many;
+    double t0, t_sort, t_radix, t_add, t_many;
+
+    t0 = _now();
+    u_sort = _vt_dedupe(ids, n, false);
+    t_sort = _now() - t0;
+    t0 = _now();
+    u_radix = _vt_dedupe(ids, n, true);
+    t_radix = _now() - t0;
+    t0 = _now();
+    u_add = _hs_dedupe(ids, n, false);
+    t_add = _now() - t0;
+    t0 = _now();
+    u_many = _hs_dedupe(ids, n, true);
+    t_many = _now() - t0;
+
+    if (u_sort != u_radix || u_sort != u_add || u_sort != u_many) {
+        fprintf(stderr, "unique counts differ: %zu %zu %zu %zu\n", u_sort, u_radix, u_add, u_many);
+        exit(EXIT_FAILURE);
+    }
+    printf("%9zu ids %-8s %9zu unique  vt_sort %7.3f s  vt_sort_by_key %7.3f s"
+           "  hs_add_int %7.3f s  hs_add_many_int %7.3f s\n",
+           n, dist, u_sort, t_sort, t_radix, t_add, t_many);
+}
+
+static void _set_algebra(size_t n)
+{
+    hs_HashSet *a = hs_init_int();
+    hs_HashSet *b = hs_init_int();
+    hs_HashSet *res = NULL;
+    double t0;
+    size_t i;
+
+    /* a large and b a hundredth of it, half of b in a */
+    for (i = 0; i < n; ++i)
+        hs_add_int(a, 2 * i);
+    for (i = 0; i < n / 100; ++i)
+        hs_add_int(b, i);
+
+    t0 = _now();
+    res = hs_intersect(a, b);
+    printf("%9zu x %zu  intersect %7.4f s (%zu)", n, n / 100, _now() - t0, hs_getsize(res));
+    hs_destroy(res, NULL);
+    t0 = _now();
+    res = hs_difference(b, a);
+    printf("  difference %7.4f s (%zu)", _now() - t0, hs_getsize(res));
+    hs_destroy(res, NULL);
+    t0 = _now();
+    res = hs_union(a, b);
+    printf("  union %7.4f s (%zu)\n", _now() - t0, hs_getsize(res));
+    hs_destroy(res, NULL);
+
+    hs_destroy(b, NULL);
+    hs_destroy(a, NULL);
+}
+
+int main(int argc, char **argv)
+{
+    size_t maxn = (argc > 1) ? strtoul(argv[1], NULL, 10) : DEFAULT_MAXNELEMS;
+    uint64_t *ids = (uint64_t*)malloc(maxn * sizeof *ids);
+    size_t n, i;
+
+    srand(42);
+    for (n = 100000; n <= maxn; n *= 10) {
+        /* about 40% distinct */
+        for (i = 0; i < n; ++i)
+            ids[i] = _rand64() % (n / 2);
+        _run(ids, n, "dup");
+        for (i = 0; i < n; ++i)
+            ids[i] = _rand64();
+        _run(ids, n, "distinct");
+    }
+    for (n = 100000; n <= maxn; n *= 10)
+        _set_algebra(n);
+
+    free(ids);
+    return 0;
+}
@@ -0,0 +1,98 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "ll.h"
+
+#define DEFAULT_NELEMS 1000000
+#define CHURN_ROUNDS   8
+#define MOVE_ROUNDS    1000
+
+static double _now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void _nodtor(void *elem)
+{
+    (void)elem;
+}
+
+static void _run(const char *name, ll_ListType type, unsigned int flags,
+                 size_t n, int *elems)
+{
+    size_t i, r;
+    double t0, t_insert, t_delete, t_churn, t_bulk, t_move;
+    void **batch = (void**)malloc(n * sizeof *batch);
+    ll_LinkedList *ll = NULL;
+
+    /* the elements appended in one call, first so that no earlier frees
+     * are left for the allocator to consolidate */
+    for (i = 0; i < n; ++i)
+        batch[i] = &elems[i];
+    ll = ll_init_withflags(type, flags);
+    t0 = _now();
+    ll_insert_bulk(ll, batch, n);
+    t_bulk = _now() - t0;
+    free(batch);
+
+    /* whole list out and back at the known ends, nodes change lists */
+    t0 = _now();
+    for (r = 0; r < MOVE_ROUNDS; ++r) {
+        ll_LinkedList *rest = ll_split(ll, 0);
+        ll_splice(ll, 0, rest);
+        ll_destroy(rest, _nodtor);
+    }
+    t_move = _now() - t0;
+    ll_destroy(ll, _nodtor);
+
+    ll = ll_init_withflags(type, flags);
+    t0 = _now();
+    for (i = 0; i < n; ++i)
+        ll_insert(ll, &elems[i]);
+    t_insert = _now() - t0;
+
+    t0 = _now();
+    for (i = 0; i < n; ++i)
+        ll_delete_elementatpos(ll, 0, _nodtor);
+    t_delete = _now() - t0;
+
+    /* interleaved insert/delete, exercises node reuse */
+    t0 = _now();
+    for (r = 0; r < CHURN_ROUNDS; ++r) {
+        for (i = 0; i < n / CHURN_ROUNDS; ++i)
+            ll_insert(ll, &elems[i]);
+        for (i = 0; i < n / CHURN_ROUNDS; ++i)
+            ll_delete_elementatpos(ll, 0, _nodtor);
+    }
+    t_churn = _now() - t0;
+
+    ll_destroy(ll, _nodtor);
+
+    printf("%-16s insert %8.2f Mops/s  delete %8.2f Mops/s  churn %8.2f Mops/s  bulk %8.2f Mops/s"
+           "  split+splice %8.2f us\n",
+           name, n / t_insert / 1e6, n / t_delete / 1e6,
+           2.0 * (n / CHURN_ROUNDS) * CHURN_ROUNDS / t_churn / 1e6, n / t_bulk / 1e6,
+           t_move * 1e6 / MOVE_ROUNDS);
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = (argc > 1) ? strtoul(argv[1], NULL, 10) : DEFAULT_NELEMS;
+    int *elems = (int*)malloc(n * sizeof *elems);
+    size_t i;
+
+    for (i = 0; i < n; ++i)
+        elems[i] = (int)i;
+
+    printf("ll node allocation, %zu elements\n", n);
+    _run("singly/calloc", ll_SINGLY, ll_FLAG_NONE, n, elems);
+    _run("singly/pool", ll_SINGLY, ll_FLAG_POOL, n, elems);
+    _run("doubly/calloc", ll_DOUBLY, ll_FLAG_NONE, n, elems);
+    _run("doubly/pool", ll_DOUBLY, ll_FLAG_POOL, n, elems);
+
+    free(elems);
+    return 0;
+}
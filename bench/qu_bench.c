@@ -0,0 +1,178 @@
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "ll.h"
+#include "qu.h"
+
+#define DEFAULT_NITEMS 4000000
+#define CAPACITY       4096
+#define BATCH          32
+
+typedef struct {
+    qu_Queue *qu;
+    ll_LinkedList *ll;          /* the list and its lock when qu is NULL */
+    pthread_mutex_t *lock;
+    size_t batch;               /* 1 for the single element calls */
+    size_t first, count;        /* items a producer adds */
+    size_t *consumed;           /* shared by the consumers */
+    size_t total;
+    uint64_t sum;               /* of the items a consumer took */
+} Worker;
+
+static double _now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void _nodtor(void *elem)
+{
+    (void)elem;
+}
+
+static void *_produce(void *arg)
+{
+    Worker *w = (Worker*)arg;
+    void *items[BATCH];
+    size_t next = w->first, end = w->first + w->count;
+
+    while (next < end) {
+        size_t i, n = (end - next < w->batch) ? end - next : w->batch;
+
+        if (!w->qu) {
+            /* bounded like the ring, ll_insert_atend walks the whole list */
+            bool full;
+            pthread_mutex_lock(w->lock);
+            full = ll_getlinkedlistsize(w->ll) >= CAPACITY;
+            if (!full)
+                ll_insert_atend(w->ll, (void*)(uintptr_t)next);
+            pthread_mutex_unlock(w->lock);
+            if (full)
+                sched_yield();
+            else
+                next++;
+        } else if (n == 1) {
+            if (qu_enqueue(w->qu, (void*)(uintptr_t)next) == SUCCESS)
+                next++;
+            else
+                sched_yield();
+        } else {
+            for (i = 0; i < n; ++i)
+                items[i] = (void*)(uintptr_t)(next + i);
+            i = qu_enqueue_many(w->qu, items, n);
+            next += i;
+            if (i == 0)
+                sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void *_consume(void *arg)
+{
+    Worker *w = (Worker*)arg;
+    void *items[BATCH];
+
+    while (__atomic_load_n(w->consumed, __ATOMIC_RELAXED) < w->total) {
+        size_t i, n = 0;
+
+        if (!w->qu) {
+            pthread_mutex_lock(w->lock);
+            if (!ll_islinkedlistempty(w->ll)) {
+                items[0] = ll_get(w->ll);
+                ll_delete_elementatpos(w->ll, 0, _nodtor);
+                n = 1;
+            }
+            pthread_mutex_unlock(w->lock);
+        } else if (w->batch == 1) {
+            n = (qu_dequeue(w->qu, &items[0]) == SUCCESS);
+        } else {
+            n = qu_dequeue_many(w->qu, items, w->batch);
+        }
+
+        if (n == 0) {
+            sched_yield();
+            continue;
+        }
+        for (i = 0; i < n; ++i)
+            w->sum += (uintptr_t)items[i];
+        __atomic_fetch_add(w->consumed, n, __ATOMIC_RELAXED);
+    }
+    return NULL;
+}
+
+static double _run(const char *name, int producers, int consumers, qu_QueueMode mode,
+                   size_t batch, size_t total)
+{
+    pthread_t threads[64];
+    Worker workers[64];
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    qu_Queue *qu = (batch > 0) ? qu_init(CAPACITY, mode) : NULL;
+    ll_LinkedList *ll = qu ? NULL : ll_init(ll_DOUBLY);
+    size_t consumed = 0, per = total / producers;
+    uint64_t sum = 0;
+    double t0, secs;
+    int i;
+
+    total = per * producers;
+    for (i = 0; i < producers + consumers; ++i) {
+        Worker *w = &workers[i];
+        w->qu = qu;
+        w->ll = ll;
+        w->lock = &lock;
+        w->batch = batch;
+        w->first = 1 + i * per;
+        w->count = per;
+        w->consumed = &consumed;
+        w->total = total;
+        w->sum = 0;
+    }
+
+    t0 = _now();
+    for (i = 0; i < producers + consumers; ++i)
+        pthread_create(&threads[i], NULL, (i < producers) ? _produce : _consume, &workers[i]);
+    for (i = 0; i < producers + consumers; ++i)
+        pthread_join(threads[i], NULL);
+    secs = _now() - t0;
+
+    for (i = producers; i < producers + consumers; ++i)
+        sum += workers[i].sum;
+    if (sum != (uint64_t)total * (total + 1) / 2) {
+        fprintf(stderr, "%s: items lost or duplicated\n", name);
+        exit(EXIT_FAILURE);
+    }
+    printf("%-24s %2dP/%2dC  %8.2f Mitems/s\n", name, producers, consumers, total / secs / 1e6);
+
+    if (qu)
+        qu_destroy(qu, _nodtor);
+    else
+        ll_destroy(ll, _nodtor);
+    pthread_mutex_destroy(&lock);
+    return total / secs;
+}
+
+int main(int argc, char **argv)
+{
+    size_t total = (argc > 1) ? strtoul(argv[1], NULL, 10) : DEFAULT_NITEMS;
+    double base, rate;
+
+    base = _run("mutex + ll_LinkedList", 8, 8, qu_MPMC, 0, total);
+    rate = _run("qu MPMC", 8, 8, qu_MPMC, 1, total);
+    printf("%-24s %8.1fx\n", "", rate / base);
+    rate = _run("qu MPMC many", 8, 8, qu_MPMC, BATCH, total);
+    printf("%-24s %8.1fx\n", "", rate / base);
+
+    _run("mutex + ll_LinkedList", 8, 1, qu_MPSC, 0, total);
+    _run("qu MPSC", 8, 1, qu_MPSC, 1, total);
+    _run("qu MPSC many", 8, 1, qu_MPSC, BATCH, total);
+    _run("mutex + ll_LinkedList", 1, 1, qu_SPSC, 0, total);
+    _run("qu SPSC", 1, 1, qu_SPSC, 1, total);
+    _run("qu SPSC many", 1, 1, qu_SPSC, BATCH, total);
+    return 0;
+}
@@ -0,0 +1,196 @@
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "qu.h"
+
+#define DEFAULT_NMSGS 20000
+#define CAPACITY      1024
+#define MAX_CONSUMERS 8
+/* latency histogram buckets, powers of two from 128 ns */
+#define NBUCKETS      16
+#define MIN_BUCKET    7
+
+/* the mutex + condition variable queue qu_pop_wait replaces */
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t not_empty;
+    void *ring[CAPACITY];
+    size_t head, tail;
+} CondQueue;
+
+typedef struct {
+    qu_Queue *qu;               /* NULL for the condvar queue */
+    CondQueue *cq;
+    uint64_t *lat;              /* handoff latencies of this consumer */
+    size_t n;
+} Consumer;
+
+static uint64_t _now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void _cq_push(CondQueue *cq, void *elem)
+{
+    pthread_mutex_lock(&cq->mutex);
+    while (cq->tail - cq->head == CAPACITY) {
+        pthread_mutex_unlock(&cq->mutex);
+        sched_yield();
+        pthread_mutex_lock(&cq->mutex);
+    }
+    cq->ring[cq->tail++ % CAPACITY] = elem;
+    pthread_cond_signal(&cq->not_empty);
+    pthread_mutex_unlock(&cq->mutex);
+}
+
+static void *_cq_pop(CondQueue *cq)
+{
+    void *elem = NULL;
+
+    pthread_mutex_lock(&cq->mutex);
+    while (cq->head == cq->tail)
+        pthread_cond_wait(&cq->not_empty, &cq->mutex);
+    elem = cq->ring[cq->head++ % CAPACITY];
+    pthread_mutex_unlock(&cq->mutex);
+    return elem;
+}
+
+/* every message is its send time, 0 tells a consumer to stop */
+static void *_consume(void *arg)
+{
+    Consumer *c = (Consumer*)arg;
+
+    for (;;) {
+        void *elem = NULL;
+        uint64_t sent;
+
+        if (c->qu)
+            qu_pop_wait(c->qu, &elem, qu_WAIT_FOREVER);
+        else
+            elem = _cq_pop(c->cq);
+        sent = (uintptr_t)elem;
+        if (sent == 0)
+            break;
+        c->lat[c->n++] = _now_ns() - sent;
+    }
+    return NULL;
+}
+
+static int _u64_compare(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+static void _report(const char *name, uint64_t *lat, size_t n)
+{
+    size_t hist[NBUCKETS] = {0};
+    size_t i;
+    int b;
+
+    qsort(lat, n, sizeof *lat, _u64_compare);
+    for (i = 0; i < n; ++i) {
+        b = 0;
+        while (b < NBUCKETS - 1 && lat[i] >= (1ull << (MIN_BUCKET + b)))
+            ++b;
+        hist[b]++;
+    }
+    printf("%s\n  p50 %7llu ns  p99 %8llu ns  p99.9 %8llu ns  max %9llu ns\n", name,
+           (unsigned long long)lat[n / 2], (unsigned long long)lat[n / 100 * 99],
+           (unsigned long long)lat[n / 1000 * 999], (unsigned long long)lat[n - 1]);
+    for (b = 0; b < NBUCKETS; ++b) {
+        if (!hist[b])
+            continue;
+        if (b < NBUCKETS - 1)
+            printf("  < %8llu ns %7zu %5.1f%%\n", 1ull << (MIN_BUCKET + b), hist[b],
+                   100.0 * hist[b] / n);
+        else
+            printf("  >=%8llu ns %7zu %5.1f%%\n", 1ull << (MIN_BUCKET + b - 1), hist[b],
+                   100.0 * hist[b] / n);
+    }
+}
+
+/* messages in bursts of burst, with a pause that lets the consumers fall asleep between */
+static void _run(const char *name, bool futex, int consumers, size_t n, size_t burst)
+{
+    pthread_t threads[MAX_CONSUMERS];
+    Consumer cons[MAX_CONSUMERS];
+    CondQueue cq;
+    qu_Queue *qu = futex ? qu_init(CAPACITY, qu_MPMC) : NULL;
+    struct timespec pause = {0, 50000};
+    uint64_t *lat = (uint64_t*)malloc(n * sizeof *lat);
+    size_t i, got = 0;
+    int c;
+
+    pthread_mutex_init(&cq.mutex, NULL);
+    pthread_cond_init(&cq.not_empty, NULL);
+    cq.head = cq.tail = 0;
+    for (c = 0; c < consumers; ++c) {
+        cons[c].qu = qu;
+        cons[c].cq = &cq;
+        cons[c].lat = (uint64_t*)malloc(n * sizeof *lat);
+        cons[c].n = 0;
+        pthread_create(&threads[c], NULL, _consume, &cons[c]);
+    }
+
+    for (i = 0; i < n; ++i) {
+        void *elem;
+        if (i % burst == 0)
+            nanosleep(&pause, NULL);
+        elem = (void*)(uintptr_t)_now_ns();
+        if (qu) {
+            while (qu_push_wait(qu, elem, qu_WAIT_FOREVER) != SUCCESS)
+                ;
+        } else {
+            _cq_push(&cq, elem);
+        }
+    }
+    for (c = 0; c < consumers; ++c) {
+        if (qu)
+            qu_push_wait(qu, NULL, qu_WAIT_FOREVER);
+        else
+            _cq_push(&cq, NULL);
+    }
+
+    for (c = 0; c < consumers; ++c) {
+        pthread_join(threads[c], NULL);
+        for (i = 0; i < cons[c].n; ++i)
+            lat[got++] = cons[c].lat[i];
+        free(cons[c].lat);
+    }
+    _report(name, lat, got);
+
+    if (qu)
+        qu_destroy(qu, NULL);
+    pthread_cond_destroy(&cq.not_empty);
+    pthread_mutex_destroy(&cq.mutex);
+    free(lat);
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = (argc > 1) ? strtoul(argv[1], NULL, 10) : DEFAULT_NMSGS;
+
+    if (n < 1000) {
+        fprintf(stderr, "need at least 1000 messages\n");
+        return EXIT_FAILURE;
+    }
+
+    /* one message at a time, the consumer is asleep for most */
+    _run("mutex + condvar, 1 consumer, single messages", false, 1, n, 1);
+    _run("qu_pop_wait,     1 consumer, single messages", true, 1, n, 1);
+    _run("mutex + condvar, 4 consumers, single messages", false, 4, n, 1);
+    _run("qu_pop_wait,     4 consumers, single messages", true, 4, n, 1);
+    /* bursts, the consumers are awake while one lasts */
+    _run("mutex + condvar, 4 consumers, bursts of 64", false, 4, n, 64);
+    _run("qu_pop_wait,     4 consumers, bursts of 64", true, 4, n, 64);
+    return 0;
+}
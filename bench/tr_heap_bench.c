@@ -0,0 +1,197 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "tr.h"
+
+#define DEFAULT_NELEMS 10000000
+
+/* a graph node of the Dijkstra-like run, compared through the pointer */
+typedef struct {
+    uint64_t dist;
+    tr_Handle handle;
+    int queued;
+} Node;
+
+static double _now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint64_t _rand64(void)
+{
+    return ((uint64_t)rand() << 42) ^ ((uint64_t)rand() << 21) ^ (uint64_t)rand();
+}
+
+/* keys are stored in the element pointers themselves */
+static int _key_compare(const void *a, const void *b)
+{
+    uintptr_t x = (uintptr_t)a, y = (uintptr_t)b;
+    return (x > y) - (x < y);
+}
+
+static int _node_compare(const void *a, const void *b)
+{
+    uint64_t x = ((const Node*)a)->dist, y = ((const Node*)b)->dist;
+    return (x > y) - (x < y);
+}
+
+static void _noop(void *elem)
+{
+    (void)elem;
+}
+
+static tr_Heap *_heap(int arity, tr_ElemCompare comp)
+{
+    tr_Heap *heap = tr_heap_init(arity ? tr_DARY_HEAP : tr_PAIRING_HEAP, comp);
+    if (arity)
+        tr_heap_set_arity(heap, arity);
+    return heap;
+}
+
+static const char *_name(int arity)
+{
+    static char name[16];
+    if (!arity)
+        return "pairing";
+    snprintf(name, sizeof name, "%d-ary", arity);
+    return name;
+}
+
+/* n pushes, then n pops, checking the order */
+static void _push_pop(const uintptr_t *keys, size_t n, int arity)
+{
+    tr_Heap *heap = _heap(arity, _key_compare);
+    uintptr_t last = 0;
+    size_t i, unordered = 0;
+    double t0, t_push, t_pop;
+
+    t0 = _now();
+    for (i = 0; i < n; ++i)
+        tr_heap_push(heap, (void*)keys[i]);
+    t_push = _now() - t0;
+    t0 = _now();
+    for (i = 0; i < n; ++i) {
+        uintptr_t key = (uintptr_t)tr_heap_pop(heap);
+        unordered += key < last;
+        last = key;
+    }
+    t_pop = _now() - t0;
+
+    printf("%-8s push %6.1f ns  pop %7.1f ns%s\n", _name(arity),
+           t_push * 1e9 / n, t_pop * 1e9 / n, unordered ? "  OUT OF ORDER" : "");
+    tr_heap_destroy(heap, _noop);
+}
+
+/* n elements at once against n pushes */
+static void _heapify(const uintptr_t *keys, size_t n, int arity)
+{
+    tr_Heap *heap = _heap(arity, _key_compare);
+    double t0, t_heapify, t_first;
+
+    t0 = _now();
+    tr_heap_heapify(heap, (void *const*)keys, n, NULL);
+    t_heapify = _now() - t0;
+    /* a pairing heap orders its elements on the first pop */
+    t0 = _now();
+    tr_heap_pop(heap);
+    t_first = _now() - t0;
+
+    printf("%-8s heapify %6.1f ns per element, first pop %8.2f ms\n", _name(arity),
+           t_heapify * 1e9 / n, t_first * 1e3);
+    tr_heap_destroy(heap, _noop);
+}
+
+/* timer queue: pop the next deadline, push a new one a random delay later */
+static void _hold(const uintptr_t *keys, size_t n, int arity)
+{
+    tr_Heap *heap = _heap(arity, _key_compare);
+    size_t i;
+    double t0, t_hold;
+
+    tr_heap_heapify(heap, (void *const*)keys, n, NULL);
+    tr_heap_pop(heap);
+    tr_heap_push(heap, (void*)keys[0]);
+    t0 = _now();
+    for (i = 0; i < n; ++i) {
+        uintptr_t now = (uintptr_t)tr_heap_pop(heap);
+        tr_heap_push(heap, (void*)(now + (keys[i] >> 40)));
+    }
+    t_hold = _now() - t0;
+
+    printf("%-8s pop + push %7.1f ns\n", _name(arity), t_hold * 1e9 / n);
+    tr_heap_destroy(heap, _noop);
+}
+
+/* shortest paths shape: every pop relaxes a few random nodes, lowering
+ * the distance of those still queued */
+static void _relax(Node *nodes, size_t n, int arity)
+{
+    tr_Heap *heap = _heap(arity, _node_compare);
+    size_t i, pops = 0, decreases = 0;
+    double t0, t_run;
+    int k;
+
+    srand(7);
+    for (i = 0; i < n; ++i) {
+        nodes[i].dist = _rand64() >> 16;
+        nodes[i].queued = 1;
+    }
+    t0 = _now();
+    for (i = 0; i < n; ++i)
+        nodes[i].handle = tr_heap_push(heap, &nodes[i]);
+    while (!tr_heap_isempty(heap)) {
+        Node *u = (Node*)tr_heap_pop(heap);
+        u->queued = 0;
+        ++pops;
+        for (k = 0; k < 4; ++k) {
+            Node *v = &nodes[_rand64() % n];
+            uint64_t dist = u->dist + (_rand64() >> 40);
+            if (v->queued && dist < v->dist) {
+                v->dist = dist;
+                tr_heap_decrease_key(heap, v->handle, v);
+                ++decreases;
+            }
+        }
+    }
+    t_run = _now() - t0;
+
+    printf("%-8s %zu pops, %zu decrease-keys, %7.1f ns per pop\n", _name(arity),
+           pops, decreases, t_run * 1e9 / pops);
+    tr_heap_destroy(heap, _noop);
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = (argc > 1) ? strtoul(argv[1], NULL, 10) : DEFAULT_NELEMS;
+    static const int arities[] = {2, 4, 8, 16, 0};
+    size_t nruns = sizeof arities / sizeof *arities;
+    uintptr_t *keys = (uintptr_t*)malloc(n * sizeof *keys);
+    Node *nodes = (Node*)malloc(n * sizeof *nodes);
+    size_t i;
+
+    if (n == 0) {
+        fprintf(stderr, "need at least 1 element\n");
+        return EXIT_FAILURE;
+    }
+    srand(42);
+    for (i = 0; i < n; ++i)
+        keys[i] = (uintptr_t)(_rand64() | 1);
+
+    printf("%zu random keys\n", n);
+    for (i = 0; i < nruns; ++i)
+        _push_pop(keys, n, arities[i]);
+    for (i = 0; i < nruns; ++i)
+        _heapify(keys, n, arities[i]);
+    for (i = 0; i < nruns; ++i)
+        _hold(keys, n, arities[i]);
+    for (i = 0; i < nruns; ++i)
+        _relax(nodes, n, arities[i]);
+
+    free(nodes);
+    free(keys);
+    return 0;
+}
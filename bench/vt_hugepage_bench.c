@@ -0,0 +1,103 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "vt.h"
+
+#define DEFAULT_NELEMS 32000000
+#define RANDOM_READS   20000000
+
+typedef enum {
+    BACKEND_HEAP,
+    BACKEND_MREMAP,
+    BACKEND_HUGEPAGES,
+    BACKEND_CONCURRENT          /* asks for huge pages too, which it refuses */
+} Backend;
+
+static double _now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void _nodtor(vt_Vector_Element elem)
+{
+    (void)elem;
+}
+
+/* elements are plain integers stored in the pointers, no indirection */
+static int _compare(const vt_Vector_Element a, const vt_Vector_Element b)
+{
+    uintptr_t x = (uintptr_t)a;
+    uintptr_t y = (uintptr_t)b;
+    return (x > y) - (x < y);
+}
+
+static uint64_t _xorshift(uint64_t *state)
+{
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+static void _run(const char *name, Backend backend, size_t n)
+{
+    size_t i;
+    uint64_t state = 88172645463325252ULL;
+    uintptr_t sum = 0;
+    double t0, t_fill, t_scan, t_random, t_sort;
+    vt_Vector *vt = (backend == BACKEND_CONCURRENT) ? vt_init_concurrent(1) : vt_init();
+
+    if (backend == BACKEND_MREMAP) {
+        vt_set_mremap(vt, true);
+    } else if (backend == BACKEND_HUGEPAGES) {
+        vt_set_hugepages(vt, true);
+    } else if (backend == BACKEND_CONCURRENT) {
+        /* regrowing a concurrent vector retires the old list with free() */
+        if (vt_set_mremap(vt, true) == SUCCESS || vt_set_hugepages(vt, true) == SUCCESS) {
+            fprintf(stderr, "concurrent vector took a mapped backend\n");
+            exit(EXIT_FAILURE);
+        }
+        vt_reserve(vt, 1 << 20);
+    }
+
+    t0 = _now();
+    for (i = 0; i < n; ++i)
+        vt_add(vt, (vt_Vector_Element)(uintptr_t)_xorshift(&state));
+    t_fill = _now() - t0;
+
+    t0 = _now();
+    for (i = 0; i < n; ++i)
+        sum += (uintptr_t)vt_get_at(vt, i);
+    t_scan = _now() - t0;
+
+    t0 = _now();
+    for (i = 0; i < RANDOM_READS; ++i)
+        sum += (uintptr_t)vt_get_at(vt, _xorshift(&state) % n);
+    t_random = _now() - t0;
+
+    t0 = _now();
+    vt_sort(vt, _compare);
+    t_sort = _now() - t0;
+
+    printf("%-10s fill %7.3f s  scan %7.3f s  random %7.3f s  sort %7.3f s  (%lx)\n",
+           name, t_fill, t_scan, t_random, t_sort, (unsigned long)(sum & 0xff));
+
+    vt_destroy(vt, _nodtor);
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = (argc > 1) ? strtoul(argv[1], NULL, 10) : DEFAULT_NELEMS;
+
+    printf("vt storage backends, %zu elements, %d random reads\n", n, RANDOM_READS);
+    _run("heap", BACKEND_HEAP, n);
+    _run("mremap", BACKEND_MREMAP, n);
+    _run("hugepages", BACKEND_HUGEPAGES, n);
+    _run("concurrent", BACKEND_CONCURRENT, n);
+    return 0;
+}
@@ -0,0 +1,124 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "vt.h"
+
+#define DEFAULT_MAXNELEMS 10000000
+
+/* a record sorted through pointers, as vt_Vector holds them */
+typedef struct {
+    uint64_t key;
+    char payload[24];
+} Record;
+
+static double _now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void _nodtor(vt_Vector_Element elem)
+{
+    (void)elem;
+}
+
+static uint64_t _vt_key(const vt_Vector_Element e)
+{
+    return ((const Record*)e)->key;
+}
+
+static int _vt_compare(const vt_Vector_Element a, const vt_Vector_Element b)
+{
+    uint64_t x = ((const Record*)a)->key;
+    uint64_t y = ((const Record*)b)->key;
+    return (x > y) - (x < y);
+}
+
+static int _qsort_compare(const void *a, const void *b)
+{
+    uint64_t x = (*(Record *const *)a)->key;
+    uint64_t y = (*(Record *const *)b)->key;
+    return (x > y) - (x < y);
+}
+
+static uint64_t _rand64(void)
+{
+    return ((uint64_t)rand() << 42) ^ ((uint64_t)rand() << 21) ^ (uint64_t)rand();
+}
+
+static void _run(const char *name, Record **ptrs, size_t n)
+{
+    vt_Vector *by_comp = vt_init_with_capacity(n);
+    vt_Vector *by_key = vt_init_with_capacity(n);
+    Record **copy = (Record**)malloc(n * sizeof *copy);
+    double t0, t_vt, t_qsort, t_radix;
+    size_t i;
+
+    vt_add_range(by_comp, (const vt_Vector_Element*)ptrs, n);
+    vt_add_range(by_key, (const vt_Vector_Element*)ptrs, n);
+    for (i = 0; i < n; ++i)
+        copy[i] = ptrs[i];
+
+    t0 = _now();
+    vt_sort(by_comp, _vt_compare);
+    t_vt = _now() - t0;
+
+    t0 = _now();
+    qsort(copy, n, sizeof *copy, _qsort_compare);
+    t_qsort = _now() - t0;
+
+    t0 = _now();
+    vt_sort_by_key(by_key, _vt_key);
+    t_radix = _now() - t0;
+
+    /* both vector sorts are stable, so they agree element for element */
+    for (i = 0; i < n; ++i) {
+        if (vt_get_at(by_key, i) != vt_get_at(by_comp, i)) {
+            fprintf(stderr, "%s: mismatch at %zu\n", name, i);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    printf("%-10s %9zu  vt_sort %8.4f s  qsort %8.4f s  vt_sort_by_key %8.4f s  (%.1fx, %.1fx)\n",
+           name, n, t_vt, t_qsort, t_radix, t_vt / t_radix, t_qsort / t_radix);
+
+    free(copy);
+    vt_destroy(by_key, _nodtor);
+    vt_destroy(by_comp, _nodtor);
+}
+
+int main(int argc, char **argv)
+{
+    size_t maxn = (argc > 1) ? strtoul(argv[1], NULL, 10) : DEFAULT_MAXNELEMS;
+    Record *records = (Record*)malloc(maxn * sizeof *records);
+    Record **ptrs = (Record**)malloc(maxn * sizeof *ptrs);
+    size_t n, i;
+
+    srand(42);
+    for (n = 10000; n <= maxn; n *= 10) {
+        /* records in random memory order, like a heap that has churned */
+        for (i = 0; i < n; ++i)
+            ptrs[i] = &records[i];
+        for (i = n - 1; i > 0; --i) {
+            size_t j = _rand64() % (i + 1);
+            Record *tmp = ptrs[i];
+            ptrs[i] = ptrs[j];
+            ptrs[j] = tmp;
+        }
+
+        for (i = 0; i < n; ++i)
+            records[i].key = _rand64() & 0xffffffff;
+        _run("32-bit key", ptrs, n);
+
+        for (i = 0; i < n; ++i)
+            records[i].key = _rand64();
+        _run("64-bit key", ptrs, n);
+    }
+
+    free(ptrs);
+    free(records);
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "vt.h"
+
+#define DEFAULT_MAXLOG  26
+#define NQUERIES        (1 << 20)
+
+static double _now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void _nodtor(vt_Vector_Element elem)
+{
+    (void)elem;
+}
+
+/* elements are the integers themselves, so only the vector is touched */
+static int _vt_compare(const vt_Vector_Element a, const vt_Vector_Element b)
+{
+    intptr_t x = (intptr_t)a;
+    intptr_t y = (intptr_t)b;
+    return (x > y) - (x < y);
+}
+
+static int _bsearch_compare(const void *key, const void *elem)
+{
+    intptr_t x = (intptr_t)key;
+    intptr_t y = *(const intptr_t*)elem;
+    return (x > y) - (x < y);
+}
+
+static void _run(size_t n, const intptr_t *keys)
+{
+    vt_Vector_Element *elems = (vt_Vector_Element*)malloc(n * sizeof *elems);
+    vt_Vector *vt = vt_init_with_capacity(n);
+    size_t i, sum_lb = 0, sum_bl = 0, sum_bs = 0;
+    double t0, t_lb, t_bl, t_bs;
+
+    /* even numbers, queries hit and miss about equally */
+    for (i = 0; i < n; ++i)
+        elems[i] = (vt_Vector_Element)(intptr_t)(2 * i);
+    vt_add_range(vt, elems, n);
+
+    t0 = _now();
+    for (i = 0; i < NQUERIES; ++i)
+        sum_lb += vt_lower_bound(vt, (vt_Vector_Element)(keys[i] % (2 * n)), _vt_compare);
+    t_lb = _now() - t0;
+
+    t0 = _now();
+    for (i = 0; i < NQUERIES; ++i)
+        sum_bl += vt_lower_bound_branchless(vt, (vt_Vector_Element)(keys[i] % (2 * n)),
+                                            _vt_compare);
+    t_bl = _now() - t0;
+
+    t0 = _now();
+    for (i = 0; i < NQUERIES; ++i)
+        sum_bs += (bsearch((void*)(keys[i] % (2 * n)), elems, n, sizeof *elems,
+                           _bsearch_compare) != NULL);
+    t_bs = _now() - t0;
+
+    if (sum_lb != sum_bl) {
+        fprintf(stderr, "n=%zu: lower_bound and branchless disagree\n", n);
+        exit(EXIT_FAILURE);
+    }
+
+    printf("%10zu (%8zu KiB)  lower_bound %7.1f ns  branchless %7.1f ns  bsearch %7.1f ns"
+           "  (%zu hits)\n", n, n * sizeof *elems / 1024,
+           t_lb * 1e9 / NQUERIES, t_bl * 1e9 / NQUERIES, t_bs * 1e9 / NQUERIES, sum_bs);
+
+    vt_destroy(vt, _nodtor);
+    free(elems);
+}
+
+int main(int argc, char **argv)
+{
+    size_t maxlog = (argc > 1) ? strtoul(argv[1], NULL, 10) : DEFAULT_MAXLOG;
+    intptr_t *keys = (intptr_t*)malloc(NQUERIES * sizeof *keys);
+    size_t i, log;
+
+    srand(42);
+    for (i = 0; i < NQUERIES; ++i)
+        keys[i] = ((intptr_t)rand() << 16) ^ rand();
+
+    /* from well inside L1 to well past the last level cache */
+    for (log = 10; log <= maxlog; log += 2)
+        _run((size_t)1 << log, keys);
+
+    free(keys);
+    return 0;
+}
@@ -0,0 +1,134 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "vt.h"
+
+#define SMALL_NELEMS    4096            /* fits in L1 */
+#define LARGE_NELEMS    (16 << 20)      /* well past the last level cache */
+#define TOTAL_NELEMS    (256 << 20)     /* elements scanned per measurement */
+
+static const char *_levels[] = {"loop", "scalar", "sse2", "avx2"};
+
+static double _now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/*
+ * One row per kernel: the plain loop callers write today, then the
+ * library kernel at each level, in ns per element. The plain loops are
+ * kept from being vectorized so they stay the baseline they replace.
+ */
+#define BENCH_TYPE(sfx, T, S)                                                 \
+__attribute__((noinline, optimize("no-tree-vectorize")))                      \
+static double _loop_##sfx(int op, const T *list, size_t n, T *out)            \
+{                                                                             \
+    size_t i, count = 0;                                                      \
+    S sum = 0;                                                                \
+    T lo = list[0], hi = list[0];                                             \
+    switch (op) {                                                             \
+        case 0:                                                               \
+            for (i = 0; i < n; ++i)                                           \
+                sum += list[i];                                               \
+            return (double)sum;                                               \
+        case 1:                                                               \
+            for (i = 0; i < n; ++i) {                                         \
+                lo = (list[i] < lo) ? list[i] : lo;                           \
+                hi = (list[i] > hi) ? list[i] : hi;                           \
+            }                                                                 \
+            return (double)lo + (double)hi;                                   \
+        case 2:                                                               \
+            for (i = 0; i < n; ++i)                                           \
+                count += (list[i] == 7);                                      \
+            return (double)count;                                             \
+        case 3:                                                               \
+            for (i = 0; i < n; ++i)                                           \
+                if (list[i] == -1)                                            \
+                    break;                                                    \
+            return (double)i;                                                 \
+        default:                                                              \
+            for (i = 0; i < n; ++i)                                           \
+                if (list[i] >= 0 && list[i] <= 499)                           \
+                    out[count++] = list[i];                                   \
+            return (double)count;                                             \
+    }                                                                         \
+}                                                                             \
+                                                                              \
+static double _kernel_##sfx(int op, const T *list, size_t n, T *out)          \
+{                                                                             \
+    T lo, hi;                                                                 \
+    switch (op) {                                                             \
+        case 0:                                                               \
+            return (double)vt_sum_##sfx(list, n);                             \
+        case 1:                                                               \
+            vt_minmax_##sfx(list, n, &lo, &hi);                               \
+            return (double)lo + (double)hi;                                   \
+        case 2:                                                               \
+            return (double)vt_count_##sfx(list, n, 7);                        \
+        case 3:                                                               \
+            return (double)vt_find_##sfx(list, n, -1);                        \
+        default:                                                              \
+            return (double)vt_filter_##sfx(list, n, 0, 499, out);             \
+    }                                                                         \
+}                                                                             \
+                                                                              \
+static void _bench_##sfx(size_t n)                                            \
+{                                                                             \
+    static const char *ops[] = {"sum", "minmax", "count", "find", "filter"};  \
+    T *list = (T*)malloc(n * sizeof *list);                                   \
+    T *out = (T*)malloc(n * sizeof *out);                                     \
+    size_t i, reps = (TOTAL_NELEMS / n > 0) ? TOTAL_NELEMS / n : 1;           \
+    int op, level;                                                            \
+                                                                              \
+    for (i = 0; i < n; ++i)                                                   \
+        list[i] = (T)(rand() % 1000);                                         \
+                                                                              \
+    for (op = 0; op < 5; ++op) {                                              \
+        double expect = 0;                                                    \
+        printf("%-4s %-6s %9zu", #sfx, ops[op], n);                           \
+        for (level = -1; level <= vt_SIMD_AVX2; ++level) {                    \
+            double t0, result = 0;                                            \
+            size_t r;                                                         \
+            if (level >= 0 && vt_simd_set_level((vt_SimdLevel)level) != level)\
+                continue;                                                     \
+            t0 = _now();                                                      \
+            for (r = 0; r < reps; ++r)                                        \
+                result = (level < 0) ? _loop_##sfx(op, list, n, out)          \
+                                     : _kernel_##sfx(op, list, n, out);       \
+            t0 = _now() - t0;                                                 \
+            if (level < 0)                                                    \
+                expect = result;                                              \
+            else if (op != 0 && result != expect)                             \
+                fprintf(stderr, "%s %s: result mismatch\n", #sfx, ops[op]);   \
+            printf("  %s %6.3f", _levels[level + 1], t0 * 1e9 / (reps * n));  \
+        }                                                                     \
+        printf("  ns/elem\n");                                                \
+    }                                                                         \
+    free(out);                                                                \
+    free(list);                                                               \
+}
+
+BENCH_TYPE(i32, int32_t, int64_t)
+BENCH_TYPE(i64, int64_t, int64_t)
+BENCH_TYPE(f32, float, double)
+BENCH_TYPE(f64, double, double)
+
+int main(void)
+{
+    size_t sizes[] = {SMALL_NELEMS, LARGE_NELEMS};
+    size_t i;
+
+    srand(42);
+    for (i = 0; i < sizeof sizes / sizeof *sizes; ++i) {
+        _bench_i32(sizes[i]);
+        _bench_i64(sizes[i]);
+        _bench_f32(sizes[i]);
+        _bench_f64(sizes[i]);
+    }
+    vt_simd_set_level(vt_SIMD_AVX2);
+    return 0;
+}
@@ -0,0 +1,102 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "vt.h"
+
+#define DEFAULT_NELEMS 10000000
+
+static double _now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void _nodtor(vt_Vector_Element elem)
+{
+    (void)elem;
+}
+
+static int _vt_compare(const vt_Vector_Element a, const vt_Vector_Element b)
+{
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+static int _qsort_compare(const void *a, const void *b)
+{
+    int x = **(int *const *)a;
+    int y = **(int *const *)b;
+    return (x > y) - (x < y);
+}
+
+static void _run(const char *name, int **ptrs, size_t n)
+{
+    size_t i;
+    double t0, t_vt, t_qsort;
+    int **copy = (int**)malloc(n * sizeof *copy);
+    vt_Vector *vt = vt_init();
+
+    for (i = 0; i < n; ++i)
+        vt_add(vt, ptrs[i]);
+    t0 = _now();
+    vt_sort(vt, _vt_compare);
+    t_vt = _now() - t0;
+
+    for (i = 0; i < n; ++i)
+        copy[i] = ptrs[i];
+    t0 = _now();
+    qsort(copy, n, sizeof *copy, _qsort_compare);
+    t_qsort = _now() - t0;
+
+    for (i = 0; i < n; ++i) {
+        if (*(int*)vt_get_at(vt, i) != *copy[i]) {
+            fprintf(stderr, "%s: mismatch at %zu\n", name, i);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    printf("%-14s vt_sort %8.3f s  qsort %8.3f s  (%.2fx)\n",
+           name, t_vt, t_qsort, t_qsort / t_vt);
+
+    vt_destroy(vt, _nodtor);
+    free(copy);
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = (argc > 1) ? strtoul(argv[1], NULL, 10) : DEFAULT_NELEMS;
+    int *elems = (int*)malloc(n * sizeof *elems);
+    int **ptrs = (int**)malloc(n * sizeof *ptrs);
+    size_t i;
+
+    srand(42);
+    for (i = 0; i < n; ++i) {
+        elems[i] = rand();
+        ptrs[i] = &elems[i];
+    }
+    _run("random", ptrs, n);
+
+    for (i = 0; i < n; ++i)
+        elems[i] = (int)i;
+    _run("sorted", ptrs, n);
+
+    for (i = 0; i < n; ++i)
+        elems[i] = (int)(n - i);
+    _run("reversed", ptrs, n);
+
+    /* sorted with 1% of the elements displaced */
+    for (i = 0; i < n; ++i)
+        elems[i] = (i % 100 == 0) ? rand() : (int)i;
+    _run("nearly sorted", ptrs, n);
+
+    for (i = 0; i < n; ++i)
+        elems[i] = rand() % 16;
+    _run("few unique", ptrs, n);
+
+    free(ptrs);
+    free(elems);
+    return 0;
+}
@@ -9,6 +9,7 @@
 #define INIT_LL_SIZE_VAL   0
 #define CONST_CAST(T, OBJ) (T)OBJ
 #define FUNC               __func__
+#define CACHE_LINE_SIZE    64
 
 #ifdef SYNC
     #include <pthread.h>
@@ -0,0 +1,162 @@
+#ifndef FL_H
+#define FL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "constants.h"
+
+/**
+ * @brief Blocked Bloom filter abstract data type.
+ *
+ * Every key sets its bits inside one cache line sized block, so an add
+ * or a lookup touches a single line. No false negatives; keys cannot be
+ * removed.
+ */
+typedef struct _bloom fl_Bloom;
+
+/**
+ * @brief Cuckoo filter abstract data type.
+ *
+ * A fingerprint of every key sits in one of two buckets of 4, so a
+ * lookup reads at most two buckets. Keys that were added can be removed
+ * again.
+ */
+typedef struct _cuckoo fl_Cuckoo;
+
+/* lowest rate a cuckoo filter meets, with 16-bit fingerprints */
+#define fl_CUCKOO_MIN_FPR (8.0 / 65536)
+
+/*
+ * Both filters take a 64-bit hash of the key instead of the key. They
+ * mix it again, so a plain integer key can be passed as is. Neither
+ * locks, also not in SYNC builds; hs_HashSet uses them under its lock.
+ */
+
+/**
+ * @brief Initialize a Bloom filter for n keys.
+ *
+ * Sized so the rate at n keys is fpr, not below it: about 10 bits per
+ * key for 1%, 16 for 0.1%. More keys than n raise the rate.
+ *
+ * @param n    expected number of keys.
+ * @param fpr  false positive rate at n keys, in (0, 1).
+ * @return a Bloom filter object, or NULL if fpr is out of range.
+ */
+extern LIB_EXPORT fl_Bloom *fl_bloom_init(size_t n, double fpr) NOTHROW;
+
+/**
+ * @brief Destroy a Bloom filter.
+ *
+ * @param bf  pointer to a Bloom filter.
+ */
+extern LIB_EXPORT void fl_bloom_destroy(fl_Bloom *bf) NOTHROW;
+
+/**
+ * @brief Add a key to a Bloom filter.
+ *
+ * @param bf    pointer to a Bloom filter.
+ * @param hash  hash of the key.
+ */
+extern LIB_EXPORT void fl_bloom_add(fl_Bloom *bf, uint64_t hash) NOTHROW;
+
+/**
+ * @brief Check if a key may have been added to a Bloom filter.
+ *
+ * @param bf    pointer to a Bloom filter.
+ * @param hash  hash of the key.
+ * @return false if the key was never added, true if it may have been.
+ */
+extern LIB_EXPORT bool fl_bloom_contains(const fl_Bloom *bf, uint64_t hash) NOTHROW;
+
+/**
+ * @brief Remove every key from a Bloom filter.
+ *
+ * @param bf  pointer to a Bloom filter.
+ */
+extern LIB_EXPORT void fl_bloom_clear(fl_Bloom *bf) NOTHROW;
+
+/**
+ * @brief Return the bytes a Bloom filter keeps its bits in.
+ *
+ * @param bf  pointer to a Bloom filter.
+ * @return the size of the bit array.
+ */
+extern LIB_EXPORT size_t fl_bloom_getbytes(const fl_Bloom *bf) NOTHROW;
+
+/**
+ * @brief Initialize a cuckoo filter for n keys.
+ *
+ * Fingerprints are 8 bits wide down to a rate of about 3%, 16 bits
+ * below, and can't get under fl_CUCKOO_MIN_FPR (about 1.2e-4).
+ *
+ * @param n    expected number of keys.
+ * @param fpr  false positive rate, in [fl_CUCKOO_MIN_FPR, 1).
+ * @return a cuckoo filter object, or NULL if fpr is out of range.
+ */
+extern LIB_EXPORT fl_Cuckoo *fl_cuckoo_init(size_t n, double fpr) NOTHROW;
+
+/**
+ * @brief Destroy a cuckoo filter.
+ *
+ * @param cf  pointer to a cuckoo filter.
+ */
+extern LIB_EXPORT void fl_cuckoo_destroy(fl_Cuckoo *cf) NOTHROW;
+
+/**
+ * @brief Add a key to a cuckoo filter.
+ *
+ * @param cf    pointer to a cuckoo filter.
+ * @param hash  hash of the key.
+ * @return SUCCESS, or ERROR if the filter is full and the key was not
+ *         added.
+ */
+extern LIB_EXPORT int fl_cuckoo_add(fl_Cuckoo *cf, uint64_t hash) NOTHROW;
+
+/**
+ * @brief Check if a key may have been added to a cuckoo filter.
+ *
+ * @param cf    pointer to a cuckoo filter.
+ * @param hash  hash of the key.
+ * @return false if the key is not in the filter, true if it may be.
+ */
+extern LIB_EXPORT bool fl_cuckoo_contains(const fl_Cuckoo *cf, uint64_t hash) NOTHROW;
+
+/**
+ * @brief Remove a key from a cuckoo filter.
+ *
+ * Only keys that were added may be removed, or another key that shares
+ * the fingerprint may go missing.
+ *
+ * @param cf    pointer to a cuckoo filter.
+ * @param hash  hash of the key.
+ * @return SUCCESS, or NOTFOUND if no matching fingerprint is stored.
+ */
+extern LIB_EXPORT int fl_cuckoo_remove(fl_Cuckoo *cf, uint64_t hash) NOTHROW;
+
+/**
+ * @brief Return cuckoo filter size.
+ *
+ * @param cf  pointer to a cuckoo filter.
+ * @return the number of keys in the filter.
+ */
+extern LIB_EXPORT size_t fl_cuckoo_getsize(const fl_Cuckoo *cf) NOTHROW;
+
+/**
+ * @brief Return the bytes a cuckoo filter keeps its buckets in.
+ *
+ * @param cf  pointer to a cuckoo filter.
+ * @return the size of the bucket array.
+ */
+extern LIB_EXPORT size_t fl_cuckoo_getbytes(const fl_Cuckoo *cf) NOTHROW;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FL_H */
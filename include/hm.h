@@ -5,6 +5,226 @@
 extern "C" {
 #endif
 
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "constants.h"
+
+/* default max load factor, the share of slots in use before growing */
+#if HASHMAP_MAX_LOAD_PERCENT > 0 && HASHMAP_MAX_LOAD_PERCENT < 100
+#define hm_DEFAULT_MAX_LOAD (HASHMAP_MAX_LOAD_PERCENT / 100.0)
+#else
+#define hm_DEFAULT_MAX_LOAD 0.875
+#endif
+
+/* default number of lock stripes of a concurrent mode map */
+#define hm_DEFAULT_SHARDS 128
+
+/**
+ * @brief Hash map abstract data type.
+ *
+ * Open addressing in the SwissTable layout: keys and values sit in one
+ * flat slot array, next to an array of one control byte per slot that
+ * holds 7 bits of the key hash. Lookups compare the control bytes of
+ * 16 slots at once (SSE2 where available) and only touch the slots
+ * whose byte matches.
+ */
+typedef struct _hashmap hm_HashMap;
+
+/**
+ * @brief Key hash function pointer type.
+ *
+ * The map mixes the result, so a plain identity hash of an integer key
+ * is fine.
+ */
+typedef size_t (*hm_KeyHash)(const void*);
+
+/**
+ * @brief Key compare function pointer type, 0 when the keys are equal.
+ */
+typedef int (*hm_KeyCompare)(const void*, const void*);
+
+/**
+ * @brief Key and value destructor function pointer type.
+ */
+typedef void (*hm_ElemDtor)(void*);
+
+/**
+ * @brief Entry visit function pointer type, return false to stop.
+ */
+typedef bool (*hm_EntryVisit)(const void *key, void *value, void *ctx);
+
+/**
+ * @brief Initialize a hash map.
+ *
+ * @param hash  key hash function pointer.
+ * @param comp  key compare function pointer.
+ * @return a hash map object.
+ */
+extern LIB_EXPORT hm_HashMap *hm_init(hm_KeyHash hash, hm_KeyCompare comp) NOTHROW;
+
+/**
+ * @brief Initialize a hash map with room for capacity entries.
+ *
+ * @param hash      key hash function pointer.
+ * @param comp      key compare function pointer.
+ * @param capacity  entries the map holds without growing.
+ * @return a hash map object.
+ */
+extern LIB_EXPORT hm_HashMap *hm_init_with_capacity(hm_KeyHash hash, hm_KeyCompare comp,
+                                                    size_t capacity) NOTHROW;
+
+/**
+ * @brief Initialize a hash map in concurrent mode.
+ *
+ * The map is split by hash into nshards tables, each with its own lock.
+ * hm_get, hm_contains, hm_getsize, hm_getcapacity and hm_isempty never
+ * lock and never wait for a writer; hm_put and hm_remove lock only the shard of the
+ * key, so threads writing different shards run in parallel. Replaced
+ * and removed keys and values are destroyed once no reader can still be
+ * looking at them (epoch based), but a value returned by hm_get is only
+ * valid until another thread replaces or removes it. hm_foreach locks
+ * one shard at a time. hm_set_max_load and hm_reserve must not run
+ * alongside other calls, hm_set_incremental has no effect.
+ *
+ * @param hash     key hash function pointer.
+ * @param comp     key compare function pointer.
+ * @param nshards  number of shards, rounded up to a power of two, 0
+ *                 for hm_DEFAULT_SHARDS.
+ * @return a hash map object.
+ */
+extern LIB_EXPORT hm_HashMap *hm_init_concurrent(hm_KeyHash hash, hm_KeyCompare comp,
+                                                 size_t nshards) NOTHROW;
+
+/**
+ * @brief Destroy a hash map.
+ *
+ * @param hm          pointer to a hash map.
+ * @param key_dtor    key destructor function pointer, NULL to free.
+ * @param value_dtor  value destructor function pointer, NULL to free.
+ */
+extern LIB_EXPORT void hm_destroy(hm_HashMap *hm, hm_ElemDtor key_dtor,
+                                  hm_ElemDtor value_dtor);
+
+/**
+ * @brief Set the max load factor, the share of slots in use before the
+ * map grows.
+ *
+ * Lower trades memory for shorter probes. Default hm_DEFAULT_MAX_LOAD.
+ *
+ * @param hm        pointer to a hash map.
+ * @param max_load  the load factor, in (0, 1).
+ * @return SUCCESS, or ERROR if max_load is out of range.
+ */
+extern LIB_EXPORT int hm_set_max_load(hm_HashMap *hm, double max_load) NOTHROW;
+
+/**
+ * @brief Set whether the map resizes incrementally.
+ *
+ * A full map normally moves every entry to the new table in the put
+ * that finds it full, a pause that grows with the map. Incrementally,
+ * the old table is kept and each following put, get, contains or remove
+ * moves a few of its slots over, so no single operation pays for more
+ * than a bounded slice of the resize; lookups check both tables until
+ * the old one is empty. Disabling finishes a resize in progress.
+ * Default off.
+ *
+ * @param hm      pointer to a hash map.
+ * @param enable  true to resize incrementally.
+ */
+extern LIB_EXPORT void hm_set_incremental(hm_HashMap *hm, bool enable) NOTHROW;
+
+/**
+ * @brief Make room for at least n entries.
+ *
+ * @param hm  pointer to a hash map.
+ * @param n   the number of entries.
+ * @return SUCCESS.
+ */
+extern LIB_EXPORT int hm_reserve(hm_HashMap *hm, size_t n) NOTHROW;
+
+/**
+ * @brief Map key to value.
+ *
+ * If key is already mapped the value is replaced and the old one is
+ * destroyed with dtor; the stored key is kept, key is not taken over.
+ *
+ * @param hm     pointer to a hash map.
+ * @param key    the key.
+ * @param value  the value.
+ * @param dtor   value destructor function pointer, NULL to free.
+ * @return SUCCESS.
+ */
+extern LIB_EXPORT int hm_put(hm_HashMap *hm, const void *key, const void *value,
+                             hm_ElemDtor dtor);
+
+/**
+ * @brief Get the value mapped to key.
+ *
+ * @param hm   pointer to a hash map.
+ * @param key  the key.
+ * @return the value, or NULL if key is not mapped.
+ */
+extern LIB_EXPORT void *hm_get(hm_HashMap *hm, const void *key) NOTHROW;
+
+/**
+ * @brief Check if key is mapped.
+ *
+ * @param hm   pointer to a hash map.
+ * @param key  the key.
+ * @return true if key is mapped, false if not.
+ */
+extern LIB_EXPORT bool hm_contains(hm_HashMap *hm, const void *key) NOTHROW;
+
+/**
+ * @brief Remove key and its value.
+ *
+ * @param hm          pointer to a hash map.
+ * @param key         the key.
+ * @param key_dtor    destructor for the stored key, NULL to free.
+ * @param value_dtor  value destructor function pointer, NULL to free.
+ * @return SUCCESS, or NOTFOUND if key is not mapped.
+ */
+extern LIB_EXPORT int hm_remove(hm_HashMap *hm, const void *key, hm_ElemDtor key_dtor,
+                                hm_ElemDtor value_dtor);
+
+/**
+ * @brief Visit every entry, in no particular order.
+ *
+ * The map must not be modified from visit.
+ *
+ * @param hm     pointer to a hash map.
+ * @param visit  entry visit function pointer.
+ * @param ctx    passed through to visit.
+ */
+extern LIB_EXPORT void hm_foreach(hm_HashMap *hm, hm_EntryVisit visit, void *ctx);
+
+/**
+ * @brief Return hash map size.
+ *
+ * In concurrent mode the shard sizes are summed without locking, so the
+ * result may be stale while other threads write.
+ *
+ * @param hm  pointer to a hash map.
+ * @return the number of entries.
+ */
+extern LIB_EXPORT size_t hm_getsize(hm_HashMap *hm) NOTHROW;
+
+/**
+ * @brief Return hash map capacity.
+ *
+ * @param hm  pointer to a hash map.
+ * @return the number of slots.
+ */
+extern LIB_EXPORT size_t hm_getcapacity(hm_HashMap *hm) NOTHROW;
+
+/**
+ * @brief Check if hash map is empty.
+ *
+ * @param hm  pointer to a hash map.
+ * @return true if the map is empty, false if not.
+ */
+extern LIB_EXPORT bool hm_isempty(hm_HashMap *hm) NOTHROW;
 
 #ifdef __cplusplus
 }
@@ -5,6 +5,261 @@
 extern "C" {
 #endif
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "constants.h"
+
+/**
+ * @brief Hash set abstract data type.
+ *
+ * Open addressing in the same layout as hm_HashMap: one flat array of
+ * elements next to one control byte per slot holding 7 bits of the
+ * hash, compared 16 at a time (SSE2 where available). An integer set
+ * (hs_init_int) keeps uint64_t values in the slots themselves and
+ * compares them without calling back into user code.
+ */
+typedef struct _hashset hs_HashSet;
+
+/**
+ * @brief Element hash function pointer type, mixed by the set.
+ */
+typedef size_t (*hs_ElemHash)(const void*);
+
+/**
+ * @brief Element compare function pointer type, 0 when equal.
+ */
+typedef int (*hs_ElemCompare)(const void*, const void*);
+
+/**
+ * @brief Element destructor function pointer type.
+ */
+typedef void (*hs_ElemDtor)(void*);
+
+/**
+ * @brief Element visit function pointer type, return false to stop.
+ *
+ * An integer set passes a pointer to the uint64_t value.
+ */
+typedef bool (*hs_ElemVisit)(const void *elem, void *ctx);
+
+/**
+ * @brief Approximate membership filter consulted before the table, see
+ * hs_set_filter.
+ */
+typedef enum {
+    hs_FILTER_NONE,     /* no filter (default) */
+    hs_FILTER_BLOOM,    /* blocked Bloom filter, fl_Bloom */
+    hs_FILTER_CUCKOO    /* cuckoo filter, fl_Cuckoo, keeps up with removes */
+} hs_FilterKind;
+
+/**
+ * @brief Initialize a hash set of pointer elements.
+ *
+ * @param hash  element hash function pointer.
+ * @param comp  element compare function pointer.
+ * @return a hash set object.
+ */
+extern LIB_EXPORT hs_HashSet *hs_init(hs_ElemHash hash, hs_ElemCompare comp) NOTHROW;
+
+/**
+ * @brief Initialize a hash set of uint64_t values.
+ *
+ * Only the _int element functions apply to it.
+ *
+ * @return a hash set object.
+ */
+extern LIB_EXPORT hs_HashSet *hs_init_int(void) NOTHROW;
+
+/**
+ * @brief Destroy a hash set.
+ *
+ * @param hs    pointer to a hash set.
+ * @param dtor  element destructor function pointer, NULL to free,
+ *              unused for an integer set.
+ */
+extern LIB_EXPORT void hs_destroy(hs_HashSet *hs, hs_ElemDtor dtor);
+
+/**
+ * @brief Make room for at least n elements.
+ *
+ * @param hs  pointer to a hash set.
+ * @param n   the number of elements.
+ * @return SUCCESS.
+ */
+extern LIB_EXPORT int hs_reserve(hs_HashSet *hs, size_t n) NOTHROW;
+
+/**
+ * @brief Put a filter in front of the lookups of hs_contains,
+ * hs_contains_int, hs_intersect and hs_difference.
+ *
+ * A lookup the filter rules out never touches the table, so it pays
+ * when most lookups miss and a probe costs more than the filter, as for
+ * elements kept out of memory or a table much larger than the cache next
+ * to a filter that fits. An in-memory miss already ends at the control
+ * bytes, one cache line, and a hit pays for the filter on top of the
+ * probe; see bench/fl_bench.c.
+ *
+ * The filter is sized for the set at its max load and rebuilt with the
+ * table. A Bloom filter keeps the bits of removed elements until it is
+ * rebuilt, so removes raise its rate in between. A cuckoo filter holds
+ * only a few elements with the same hash; when the elements do not fit
+ * even at twice the size, now or on a later add, the filter is dropped
+ * and lookups go to the table.
+ *
+ * @param hs    pointer to a hash set.
+ * @param kind  the filter, hs_FILTER_NONE drops the current one.
+ * @param fpr   false positive rate, in (0, 1), for hs_FILTER_CUCKOO not
+ *              below fl_CUCKOO_MIN_FPR, unused for hs_FILTER_NONE.
+ * @return SUCCESS, or ERROR if fpr is out of range or the elements do
+ *         not fit a cuckoo filter.
+ */
+extern LIB_EXPORT int hs_set_filter(hs_HashSet *hs, hs_FilterKind kind, double fpr) NOTHROW;
+
+/**
+ * @brief Add elem to the set.
+ *
+ * @param hs    pointer to a hash set.
+ * @param elem  the element, owned by the set if added.
+ * @return true if added, false if an equal element was already in the set.
+ */
+extern LIB_EXPORT bool hs_add(hs_HashSet *hs, const void *elem) NOTHROW;
+
+/**
+ * @brief Add n elements, hashing and prefetching them in batches.
+ *
+ * @param hs     pointer to a hash set.
+ * @param elems  the elements, each owned by the set if added.
+ * @param n      the number of elements.
+ * @return the number of elements added.
+ */
+extern LIB_EXPORT size_t hs_add_many(hs_HashSet *hs, const void *const *elems,
+                                     size_t n) NOTHROW;
+
+/**
+ * @brief Check if an element equal to elem is in the set.
+ *
+ * @param hs    pointer to a hash set.
+ * @param elem  the element.
+ * @return true if it is, false if not.
+ */
+extern LIB_EXPORT bool hs_contains(hs_HashSet *hs, const void *elem) NOTHROW;
+
+/**
+ * @brief Remove the element equal to elem.
+ *
+ * @param hs    pointer to a hash set.
+ * @param elem  the element.
+ * @param dtor  destructor for the stored element, NULL to free.
+ * @return SUCCESS, or NOTFOUND if no such element is in the set.
+ */
+extern LIB_EXPORT int hs_remove(hs_HashSet *hs, const void *elem, hs_ElemDtor dtor);
+
+/**
+ * @brief Add value to an integer set.
+ *
+ * @param hs     pointer to an integer hash set.
+ * @param value  the value.
+ * @return true if added, false if already in the set.
+ */
+extern LIB_EXPORT bool hs_add_int(hs_HashSet *hs, uint64_t value) NOTHROW;
+
+/**
+ * @brief Add n values to an integer set, hashing and prefetching them in
+ * batches.
+ *
+ * @param hs      pointer to an integer hash set.
+ * @param values  the values.
+ * @param n       the number of values.
+ * @return the number of values added.
+ */
+extern LIB_EXPORT size_t hs_add_many_int(hs_HashSet *hs, const uint64_t *values,
+                                         size_t n) NOTHROW;
+
+/**
+ * @brief Check if value is in an integer set.
+ *
+ * @param hs     pointer to an integer hash set.
+ * @param value  the value.
+ * @return true if it is, false if not.
+ */
+extern LIB_EXPORT bool hs_contains_int(hs_HashSet *hs, uint64_t value) NOTHROW;
+
+/**
+ * @brief Remove value from an integer set.
+ *
+ * @param hs     pointer to an integer hash set.
+ * @param value  the value.
+ * @return SUCCESS, or NOTFOUND if value is not in the set.
+ */
+extern LIB_EXPORT int hs_remove_int(hs_HashSet *hs, uint64_t value) NOTHROW;
+
+/**
+ * @brief Return a new set of the elements in a or b.
+ *
+ * The larger set is copied table and all, and only the smaller one is
+ * walked. For pointer elements the result shares the element pointers
+ * with the operands, so only one of them may be destroyed with a dtor
+ * that frees.
+ *
+ * @param a  pointer to a hash set.
+ * @param b  pointer to a hash set of the same kind, hash and compare.
+ * @return a hash set object, or NULL if a and b are of different kinds.
+ */
+extern LIB_EXPORT hs_HashSet *hs_union(hs_HashSet *a, hs_HashSet *b) NOTHROW;
+
+/**
+ * @brief Return a new set of the elements in both a and b.
+ *
+ * The smaller set is walked and looked up in the larger. Shares element
+ * pointers with the operands, as hs_union.
+ *
+ * @param a  pointer to a hash set.
+ * @param b  pointer to a hash set of the same kind, hash and compare.
+ * @return a hash set object, or NULL if a and b are of different kinds.
+ */
+extern LIB_EXPORT hs_HashSet *hs_intersect(hs_HashSet *a, hs_HashSet *b) NOTHROW;
+
+/**
+ * @brief Return a new set of the elements in a but not in b.
+ *
+ * If a is the smaller set its elements are looked up in b, otherwise a
+ * is copied and the elements of b are removed from the copy. Shares
+ * element pointers with the operands, as hs_union.
+ *
+ * @param a  pointer to a hash set.
+ * @param b  pointer to a hash set of the same kind, hash and compare.
+ * @return a hash set object, or NULL if a and b are of different kinds.
+ */
+extern LIB_EXPORT hs_HashSet *hs_difference(hs_HashSet *a, hs_HashSet *b) NOTHROW;
+
+/**
+ * @brief Visit every element, in no particular order.
+ *
+ * The set must not be modified from visit.
+ *
+ * @param hs     pointer to a hash set.
+ * @param visit  element visit function pointer.
+ * @param ctx    passed through to visit.
+ */
+extern LIB_EXPORT void hs_foreach(hs_HashSet *hs, hs_ElemVisit visit, void *ctx);
+
+/**
+ * @brief Return hash set size.
+ *
+ * @param hs  pointer to a hash set.
+ * @return the number of elements.
+ */
+extern LIB_EXPORT size_t hs_getsize(hs_HashSet *hs) NOTHROW;
+
+/**
+ * @brief Check if hash set is empty.
+ *
+ * @param hs  pointer to a hash set.
+ * @return true if the set is empty, false if not.
+ */
+extern LIB_EXPORT bool hs_isempty(hs_HashSet *hs) NOTHROW;
 
 #ifdef __cplusplus
 }
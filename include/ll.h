@@ -10,19 +10,44 @@ extern "C" {
 
 #include "constants.h"
 
+#if LL_POOL_CHUNK_NODES > 256
+#define ll_POOL_CHUNK_NODES LL_POOL_CHUNK_NODES
+#else
+#define ll_POOL_CHUNK_NODES 256
+#endif
+
+#if LL_UNROLLED_CACHELINES > 2
+#define ll_UNROLLED_CACHELINES LL_UNROLLED_CACHELINES
+#else
+#define ll_UNROLLED_CACHELINES 2
+#endif
+
 /* enumeration types */
-typedef enum {ll_SINGLY, ll_DOUBLY, ll_CIRCLY} ll_ListType;
+typedef enum {ll_SINGLY, ll_DOUBLY, ll_CIRCLY, ll_UNROLLED} ll_ListType;
+
+/* linkedlist creation flags (or'ed together), a list created without any
+ * keeps the plain list footprint */
+typedef enum {
+    ll_FLAG_NONE = 0,
+    ll_FLAG_POOL      = 1 << 0,  /* carve nodes out of ll_POOL_CHUNK_NODES sized slabs */
+    ll_FLAG_SKIPINDEX = 1 << 1,  /* O(log n) positional calls (ignored for ll_UNROLLED) */
+    ll_FLAG_HASHINDEX = 1 << 2   /* O(1) expected ll_search keyed by element pointer */
+} ll_ListFlags;
 
 /* adt types */
 typedef struct _linkedlist ll_LinkedList;
+typedef struct _iterator ll_Iterator;
 
 /* misc. function pointer types */
 typedef void (*ll_ElemDtor)(void*);
 typedef int (*ll_ElemCompare)(const void*, const void*);
 typedef void (*ll_ElemPrint)(const void*);
+typedef size_t (*ll_ElemHash)(const void*);
+typedef bool (*ll_ElemVisit)(void*, void*);    /* return false to stop */
 
 /* linkedlist ctor & dtor */
 extern LIB_EXPORT ll_LinkedList *ll_init(ll_ListType type) NOTHROW;
+extern LIB_EXPORT ll_LinkedList *ll_init_withflags(ll_ListType type, unsigned int flags) NOTHROW;
 extern LIB_EXPORT void ll_destroy(ll_LinkedList *ll, ll_ElemDtor dtor);
 
 /* insert subroutines */
@@ -50,14 +75,42 @@ extern LIB_EXPORT void ll_delete_elementatpos(ll_LinkedList *ll, size_t pos, ll_
 extern LIB_EXPORT bool ll_islinkedlistempty(const ll_LinkedList *ll) NOTHROW;
 extern LIB_EXPORT size_t ll_getlinkedlistsize(const ll_LinkedList *ll) NOTHROW;
 extern LIB_EXPORT int ll_getlinkedlisttype(const ll_LinkedList *ll) NOTHROW;
+extern LIB_EXPORT int ll_set_hashindex(ll_LinkedList *ll, ll_ElemHash hash, ll_ElemCompare comp) NOTHROW;  /* needs ll_FLAG_HASHINDEX */
 extern LIB_EXPORT bool ll_search(const ll_LinkedList *ll, const void *elem) NOTHROW;
 extern LIB_EXPORT bool ll_search_reverse(const ll_LinkedList *ll, const void *elem) NOTHROW;
 extern LIB_EXPORT void ll_reverse(ll_LinkedList *ll) NOTHROW;
+/* stable sorts. ll_sort takes the inclusive positions [min, max], a max
+ * past the end stops at the last element. linked types relink nodes in
+ * O(1) extra space; ll_UNROLLED sorts through an O(n) scratch array and
+ * falls back to an in-place O(n^2) insertion sort if that cannot be had */
 extern LIB_EXPORT void ll_sort(ll_LinkedList *ll, size_t min, size_t max, ll_ElemCompare comp);
+extern LIB_EXPORT void ll_sort_list(ll_LinkedList *ll, ll_ElemCompare comp);
+extern LIB_EXPORT int ll_insert_bulk(ll_LinkedList *ll, void *const *elems, size_t n) NOTHROW;
+/* splice and split move nodes as they are; splicing between a pooled and a
+ * plain list copies the elements into fresh nodes of dst instead, O(n) */
+extern LIB_EXPORT int ll_splice(ll_LinkedList *dst, size_t pos, ll_LinkedList *src) NOTHROW;
+extern LIB_EXPORT ll_LinkedList *ll_split(ll_LinkedList *ll, size_t pos);
 extern LIB_EXPORT int ll_exchange(ll_LinkedList *ll, const void *elem1, const void *elem2) NOTHROW;
 extern LIB_EXPORT void ll_print(const ll_LinkedList *ll, ll_ElemPrint print);
 extern LIB_EXPORT void ll_print_reverse(const ll_LinkedList *ll, ll_ElemPrint print);
 
+/* iterator subroutines
+ *
+ * WARNING (SYNC builds): ll_iter_begin locks the list and only ll_iter_end
+ * unlocks it. while an iterator is live, the iterating thread may touch
+ * that list through ll_iter_* only; any other ll_* call on it deadlocks
+ * (debug builds assert instead). other threads block until ll_iter_end.
+ * the same holds for ll_* calls on the list from an ll_foreach visit. */
+extern LIB_EXPORT ll_Iterator *ll_iter_begin(ll_LinkedList *ll) NOTHROW;
+extern LIB_EXPORT void ll_iter_end(ll_Iterator *it) NOTHROW;
+extern LIB_EXPORT bool ll_iter_hasnext(const ll_Iterator *it) NOTHROW;
+extern LIB_EXPORT bool ll_iter_hasprev(const ll_Iterator *it) NOTHROW;
+extern LIB_EXPORT void *ll_iter_next(ll_Iterator *it) NOTHROW;
+extern LIB_EXPORT void *ll_iter_prev(ll_Iterator *it) NOTHROW;
+extern LIB_EXPORT int ll_iter_erase(ll_Iterator *it, ll_ElemDtor dtor);
+extern LIB_EXPORT int ll_iter_insert(ll_Iterator *it, const void *elem) NOTHROW;
+extern LIB_EXPORT void ll_foreach(const ll_LinkedList *ll, ll_ElemVisit visit, void *ctx);
+
 #ifdef __cplusplus
 }
 #endif
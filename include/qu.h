@@ -5,6 +5,165 @@
 extern "C" {
 #endif
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "constants.h"
+
+/**
+ * @brief Bounded queue abstract data type.
+ *
+ * A power of two ring of cells, each with a sequence number that tells
+ * the lap it is free to be written or read in (Vyukov's bounded MPMC
+ * queue). Producers claim a cell by moving the tail, consumers by moving
+ * the head, both on cache lines of their own; no call allocates or
+ * locks, also not in SYNC builds.
+ *
+ * qu_push_wait and qu_pop_wait spin a while and then sleep on a futex
+ * until the queue has room or an element. Every add or take checks for
+ * sleepers on the other side and makes the wake up call only if there
+ * are any.
+ */
+typedef struct _queue qu_Queue;
+
+/**
+ * @brief Threads a queue is used from, fixed at creation.
+ *
+ * A side with a single thread moves its index with a plain store instead
+ * of a compare-and-swap. Using more threads than the mode allows is
+ * undefined.
+ */
+typedef enum {
+    qu_MPMC,    /* any number of producers and consumers */
+    qu_MPSC,    /* any number of producers, one consumer */
+    qu_SPSC     /* one producer, one consumer */
+} qu_QueueMode;
+
+/**
+ * @brief Timeout of qu_push_wait and qu_pop_wait that never expires.
+ */
+#define qu_WAIT_FOREVER (-1)
+
+/**
+ * @brief Element destructor function pointer type.
+ */
+typedef void (*qu_ElemDtor)(void*);
+
+/**
+ * @brief Initialize a queue.
+ *
+ * @param capacity  elements the queue holds, rounded up to a power of two
+ *                  and at least 2.
+ * @param mode      producer and consumer threads.
+ * @return a queue object, or NULL if capacity is 0.
+ */
+extern LIB_EXPORT qu_Queue *qu_init(size_t capacity, qu_QueueMode mode) NOTHROW;
+
+/**
+ * @brief Destroy a queue and the elements still in it.
+ *
+ * No other thread may use the queue anymore.
+ *
+ * @param qu    pointer to a queue.
+ * @param dtor  element destructor function pointer, NULL to free.
+ */
+extern LIB_EXPORT void qu_destroy(qu_Queue *qu, qu_ElemDtor dtor);
+
+/**
+ * @brief Add elem at the tail.
+ *
+ * @param qu    pointer to a queue.
+ * @param elem  the element, any pointer including NULL.
+ * @return SUCCESS, or ERROR if the queue is full.
+ */
+extern LIB_EXPORT int qu_enqueue(qu_Queue *qu, void *elem) NOTHROW;
+
+/**
+ * @brief Take the element at the head.
+ *
+ * @param qu    pointer to a queue.
+ * @param elem  set to the element.
+ * @return SUCCESS, or ERROR if the queue is empty.
+ */
+extern LIB_EXPORT int qu_dequeue(qu_Queue *qu, void **elem) NOTHROW;
+
+/**
+ * @brief Add up to n elements at the tail, claiming their cells at once.
+ *
+ * The elements added are consecutive in the queue.
+ *
+ * @param qu     pointer to a queue.
+ * @param elems  the elements.
+ * @param n      the number of elements.
+ * @return the number added, the first ones of elems; less than n if the
+ *         queue filled up.
+ */
+extern LIB_EXPORT size_t qu_enqueue_many(qu_Queue *qu, void *const *elems, size_t n) NOTHROW;
+
+/**
+ * @brief Take up to n elements from the head, claiming their cells at once.
+ *
+ * @param qu     pointer to a queue.
+ * @param elems  set to the elements, in queue order.
+ * @param n      room in elems.
+ * @return the number taken, 0 if the queue is empty.
+ */
+extern LIB_EXPORT size_t qu_dequeue_many(qu_Queue *qu, void **elems, size_t n) NOTHROW;
+
+/**
+ * @brief Add elem at the tail, waiting for room if the queue is full.
+ *
+ * Spins first, for longer while spinning keeps paying off on this queue,
+ * then sleeps until a consumer takes an element or the timeout expires.
+ *
+ * @param qu          pointer to a queue.
+ * @param elem        the element, any pointer including NULL.
+ * @param timeout_ns  most nanoseconds to wait, 0 to try once,
+ *                    qu_WAIT_FOREVER to wait until there is room.
+ * @return SUCCESS, or ERROR if the timeout expired with the queue full.
+ */
+extern LIB_EXPORT int qu_push_wait(qu_Queue *qu, void *elem, int64_t timeout_ns) NOTHROW;
+
+/**
+ * @brief Take the element at the head, waiting for one if the queue is
+ * empty.
+ *
+ * Spins and sleeps as qu_push_wait.
+ *
+ * @param qu          pointer to a queue.
+ * @param elem        set to the element.
+ * @param timeout_ns  most nanoseconds to wait, 0 to try once,
+ *                    qu_WAIT_FOREVER to wait until there is an element.
+ * @return SUCCESS, or ERROR if the timeout expired with the queue empty.
+ */
+extern LIB_EXPORT int qu_pop_wait(qu_Queue *qu, void **elem, int64_t timeout_ns) NOTHROW;
+
+/**
+ * @brief Return queue size.
+ *
+ * Only a snapshot while other threads use the queue.
+ *
+ * @param qu  pointer to a queue.
+ * @return the number of elements.
+ */
+extern LIB_EXPORT size_t qu_getsize(const qu_Queue *qu) NOTHROW;
+
+/**
+ * @brief Check if queue is empty, a snapshot as qu_getsize.
+ *
+ * @param qu  pointer to a queue.
+ * @return true if the queue is empty, false if not.
+ */
+extern LIB_EXPORT bool qu_isempty(const qu_Queue *qu) NOTHROW;
+
+/**
+ * @brief Return queue capacity.
+ *
+ * @param qu  pointer to a queue.
+ * @return the number of elements the queue holds.
+ */
+extern LIB_EXPORT size_t qu_getcapacity(const qu_Queue *qu) NOTHROW;
 
 #ifdef __cplusplus
 }
@@ -5,6 +5,149 @@
 extern "C" {
 #endif
 
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "constants.h"
+
+/* arity of a new d-ary heap, 4 children share a cache line of entries */
+#define tr_DEFAULT_ARITY 4
+#define tr_MAX_ARITY     64
+
+/**
+ * @brief Priority queue abstract data type, a min-heap under its compare
+ * function.
+ */
+typedef struct _heap tr_Heap;
+
+/**
+ * @brief Heap layout, fixed at creation.
+ */
+typedef enum {
+    tr_DARY_HEAP,       /* implicit d-ary heap in one array */
+    tr_PAIRING_HEAP     /* pairing heap, O(1) push and decrease-key */
+} tr_HeapType;
+
+/**
+ * @brief Element handle, valid from the push of the element until it is
+ * popped.
+ */
+typedef size_t tr_Handle;
+
+/**
+ * @brief Element compare function pointer type, as vt_ElemCompare:
+ * negative if a comes out before b.
+ */
+typedef int (*tr_ElemCompare)(const void*, const void*);
+
+/**
+ * @brief Element destructor function pointer type.
+ */
+typedef void (*tr_ElemDtor)(void*);
+
+/**
+ * @brief Initialize a heap.
+ *
+ * A d-ary heap starts with tr_DEFAULT_ARITY.
+ *
+ * @param type  the heap layout.
+ * @param comp  element compare function pointer.
+ * @return a heap object, or NULL if the mutex cannot be set up.
+ */
+extern LIB_EXPORT tr_Heap *tr_heap_init(tr_HeapType type, tr_ElemCompare comp) NOTHROW;
+
+/**
+ * @brief Destroy a heap and the elements still in it.
+ *
+ * @param heap  pointer to a heap.
+ * @param dtor  element destructor function pointer, NULL to free.
+ */
+extern LIB_EXPORT void tr_heap_destroy(tr_Heap *heap, tr_ElemDtor dtor);
+
+/**
+ * @brief Set the number of children per node of a d-ary heap.
+ *
+ * Wider heaps are shallower, so pushes and decrease-keys compare less
+ * while pops compare more per level. The elements are rearranged in
+ * O(n).
+ *
+ * @param heap   pointer to a d-ary heap.
+ * @param arity  children per node, in [2, tr_MAX_ARITY].
+ * @return SUCCESS, or ERROR if heap is no d-ary heap or arity is out of range.
+ */
+extern LIB_EXPORT int tr_heap_set_arity(tr_Heap *heap, unsigned arity) NOTHROW;
+
+/**
+ * @brief Add elem to the heap.
+ *
+ * @param heap  pointer to a heap.
+ * @param elem  the element, owned by the heap until popped.
+ * @return the handle of elem.
+ */
+extern LIB_EXPORT tr_Handle tr_heap_push(tr_Heap *heap, void *elem) NOTHROW;
+
+/**
+ * @brief Add n elements in O(size + n), faster than n pushes.
+ *
+ * A d-ary heap is rebuilt bottom-up. A pairing heap melds each element
+ * into the root as it goes, one comparison each, so the top is known at
+ * once and the losers wait as children of the root for the next pop.
+ *
+ * @param heap     pointer to a heap.
+ * @param elems    the elements, owned by the heap until popped.
+ * @param n        the number of elements.
+ * @param handles  set to the handle of every element, or NULL.
+ * @return SUCCESS.
+ */
+extern LIB_EXPORT int tr_heap_heapify(tr_Heap *heap, void *const *elems, size_t n,
+                                      tr_Handle *handles) NOTHROW;
+
+/**
+ * @brief Return the first element without removing it.
+ *
+ * @param heap  pointer to a heap.
+ * @return the element, or NULL if the heap is empty.
+ */
+extern LIB_EXPORT void *tr_heap_top(tr_Heap *heap) NOTHROW;
+
+/**
+ * @brief Remove and return the first element.
+ *
+ * Its handle may be handed out again.
+ *
+ * @param heap  pointer to a heap.
+ * @return the element, or NULL if the heap is empty.
+ */
+extern LIB_EXPORT void *tr_heap_pop(tr_Heap *heap) NOTHROW;
+
+/**
+ * @brief Move an element forward after its key went down.
+ *
+ * elem replaces the element of handle and must not compare after it;
+ * pass the same pointer after lowering its key in place.
+ *
+ * @param heap    pointer to a heap.
+ * @param handle  handle of an element in the heap.
+ * @param elem    the element with the lower key.
+ * @return SUCCESS, or ERROR if handle is not in the heap.
+ */
+extern LIB_EXPORT int tr_heap_decrease_key(tr_Heap *heap, tr_Handle handle, void *elem) NOTHROW;
+
+/**
+ * @brief Return heap size.
+ *
+ * @param heap  pointer to a heap.
+ * @return the number of elements.
+ */
+extern LIB_EXPORT size_t tr_heap_getsize(tr_Heap *heap) NOTHROW;
+
+/**
+ * @brief Check if heap is empty.
+ *
+ * @param heap  pointer to a heap.
+ * @return true if the heap is empty, false if not.
+ */
+extern LIB_EXPORT bool tr_heap_isempty(tr_Heap *heap) NOTHROW;
 
 #ifdef __cplusplus
 }
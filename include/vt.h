@@ -5,8 +5,12 @@
 extern "C" {
 #endif
 
+#include <assert.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "constants.h"
 
@@ -16,16 +20,45 @@ extern "C" {
 #define vt_INITIAL_VECTOR_CAPACITY 50
 #endif
 
+/* storage of at least this many bytes may be backed by mmap/mremap */
+#if VECTOR_MREMAP_BYTES > 4096
+#define vt_MREMAP_BYTES VECTOR_MREMAP_BYTES
+#else
+#define vt_MREMAP_BYTES (1 << 20)
+#endif
+
 /**
  * @brief Vector abstract data type.
  */
 typedef struct _vector vt_Vector;
 
+/**
+ * @brief Vector growth policy, applied when an add finds the vector full.
+ */
+typedef enum {
+    vt_GROW_DOUBLE,     /* capacity * 2 (default) */
+    vt_GROW_HALF,       /* capacity * 1.5 */
+    vt_GROW_FIXED       /* capacity + increment */
+} vt_GrowthPolicy;
+
 /**
  * @brief Vector element data type.
  */
 typedef void* vt_Vector_Element;
 
+/**
+ * @brief Read-only view of a concurrent mode vector.
+ *
+ * list[0, size) stays valid and unchanged until vt_snapshot_end, even
+ * if the vector grows meanwhile. vt and epoch are internal.
+ */
+typedef struct {
+    const vt_Vector_Element *list;
+    size_t size;
+    vt_Vector *vt;
+    unsigned long epoch;
+} vt_Snapshot;
+
 /**
  * @brief Vector element destructor function pointer type. 
  */
@@ -42,6 +75,11 @@ typedef int (*vt_ElemCompare)(const vt_Vector_Element,
  */
 typedef void (*vt_ElemPrint)(const vt_Vector_Element);
 
+/**
+ * @brief Vector element sort key function pointer type.
+ */
+typedef uint64_t (*vt_ElemKey)(const vt_Vector_Element);
+
 /**
  * @brief Cast to an vt_Vector_Element type.
  *
@@ -66,6 +104,32 @@ typedef void (*vt_ElemPrint)(const vt_Vector_Element);
  */
 extern LIB_EXPORT vt_Vector *vt_init(void) NOTHROW;
 
+/**
+ * @brief Initialize a vector with room for capacity elements.
+ *
+ * @param capacity  initial capacity.
+ * @return an vector object.
+ */
+extern LIB_EXPORT vt_Vector *vt_init_with_capacity(size_t capacity) NOTHROW;
+
+/**
+ * @brief Initialize a vector in concurrent (single appender) mode.
+ *
+ * vt_get, vt_get_at, vt_getsize, vt_isempty and snapshots never lock
+ * and may run on any number of threads. vt_add and vt_add_range append
+ * without locking and without blocking readers, but only one thread
+ * may append at a time. A full list is copied to a new buffer and the
+ * old one is freed once no reader can still hold it (epoch based).
+ * Other modifying calls must not run while readers are active, and
+ * the mremap/huge page backends are refused in this mode. vt_add and
+ * vt_add_range return ERROR, leaving the vector as it was, when the new
+ * buffer cannot be allocated.
+ *
+ * @param capacity  initial capacity.
+ * @return an vector object.
+ */
+extern LIB_EXPORT vt_Vector *vt_init_concurrent(size_t capacity) NOTHROW;
+
 /**
  * @brief Destroy a vector.
  * 
@@ -74,14 +138,77 @@ extern LIB_EXPORT vt_Vector *vt_init(void) NOTHROW;
  */
 extern LIB_EXPORT void vt_destroy(vt_Vector *vt, vt_ElemDtor dtor);
 
+/**
+ * @brief Set the growth policy of the vector.
+ *
+ * @param vt         pointer to a vector.
+ * @param growth     the growth policy.
+ * @param increment  elements added per growth for vt_GROW_FIXED.
+ */
+extern LIB_EXPORT void vt_set_growth(vt_Vector *vt, vt_GrowthPolicy growth,
+                                     size_t increment) NOTHROW;
+
+/**
+ * @brief Back storage of vt_MREMAP_BYTES and up with an anonymous mapping.
+ *
+ * Growing mapped storage uses mremap, which moves pages instead of
+ * copying elements. Linux only, ignored elsewhere. Off by default.
+ *
+ * @param vt      pointer to a vector.
+ * @param enable  true to use mmap/mremap for large storage.
+ * @return SUCCESS, or ERROR for a vector in concurrent mode.
+ */
+extern LIB_EXPORT int vt_set_mremap(vt_Vector *vt, bool enable) NOTHROW;
+
+/**
+ * @brief Back storage of vt_MREMAP_BYTES and up with huge pages.
+ *
+ * Like vt_set_mremap, with the mapping aligned to and rounded up to
+ * 2 MiB and advised MADV_HUGEPAGE, which cuts TLB misses on very large
+ * vectors. vt_shrink_to_fit then keeps the mapping and releases the
+ * unused tail with MADV_DONTNEED, so the capacity does not drop.
+ * Linux only, ignored elsewhere. Off by default.
+ *
+ * @param vt      pointer to a vector.
+ * @param enable  true to use huge pages for large storage.
+ * @return SUCCESS, or ERROR for a vector in concurrent mode.
+ */
+extern LIB_EXPORT int vt_set_hugepages(vt_Vector *vt, bool enable) NOTHROW;
+
+/**
+ * @brief Make room for at least capacity elements.
+ *
+ * @param vt        pointer to a vector.
+ * @param capacity  the capacity to reserve.
+ * @return SUCCESS, or ERROR if the storage could not be allocated.
+ */
+extern LIB_EXPORT int vt_reserve(vt_Vector *vt, size_t capacity) NOTHROW;
+
+/**
+ * @brief Release unused capacity.
+ *
+ * @param vt  pointer to a vector.
+ * @return SUCCESS, or ERROR if the storage could not be reallocated.
+ */
+extern LIB_EXPORT int vt_shrink_to_fit(vt_Vector *vt) NOTHROW;
+
+/**
+ * @brief Return vector capacity.
+ *
+ * @param vt  pointer to a vector.
+ * @return the number of elements the vector holds without growing.
+ */
+extern LIB_EXPORT size_t vt_getcapacity(vt_Vector *vt) NOTHROW;
+
 /**
  * @brief Add an element to the end of the vector.
  *
  * @param vt    pointer to a vector.
  * @param elem  the vector element to add.
+ * @return SUCCESS, or ERROR if the vector could not grow.
  */
-extern LIB_EXPORT void vt_add(vt_Vector *vt,
-                              const vt_Vector_Element elem) NOTHROW;
+extern LIB_EXPORT int vt_add(vt_Vector *vt,
+                             const vt_Vector_Element elem) NOTHROW;
 
 /**
  * @brief Add an element to the vector at a specific postion.
@@ -89,10 +216,12 @@ extern LIB_EXPORT void vt_add(vt_Vector *vt,
  * @param vt    pointer to a vector.
  * @param elem  the vector element to add.
  * @param pos   the vector position to add the element.
+ * @return SUCCESS, or ERROR if pos is out-of-bounds or the vector could
+ *         not grow.
  */
-extern LIB_EXPORT void vt_add_at(vt_Vector *vt,
-                                 const vt_Vector_Element elem,
-                                 size_t pos) NOTHROW;
+extern LIB_EXPORT int vt_add_at(vt_Vector *vt,
+                                const vt_Vector_Element elem,
+                                size_t pos) NOTHROW;
 
 /**
  * @brief Get an element to the end of the vector.
@@ -112,6 +241,25 @@ extern LIB_EXPORT const vt_Vector_Element vt_get(vt_Vector *vt) NOTHROW;
 extern LIB_EXPORT const vt_Vector_Element vt_get_at(vt_Vector *vt,
                                                        size_t pos) NOTHROW;
 
+/**
+ * @brief Take a snapshot of a concurrent mode vector.
+ *
+ * Keep snapshots short: buffers retired while one is open are only
+ * freed after it ends.
+ *
+ * @param vt    pointer to a vector created by vt_init_concurrent.
+ * @param snap  the snapshot to fill.
+ * @return SUCCESS, or ERROR if the vector is not in concurrent mode.
+ */
+extern LIB_EXPORT int vt_snapshot_begin(vt_Vector *vt, vt_Snapshot *snap) NOTHROW;
+
+/**
+ * @brief Release a snapshot taken with vt_snapshot_begin.
+ *
+ * @param snap  the snapshot.
+ */
+extern LIB_EXPORT void vt_snapshot_end(vt_Snapshot *snap) NOTHROW;
+
 /**
  * @brief Remove an element at the end of the vector.
  *
@@ -130,6 +278,54 @@ extern LIB_EXPORT void vt_remove(vt_Vector *vt, vt_ElemDtor dtor);
 extern LIB_EXPORT void vt_remove_at(vt_Vector *vt, size_t pos,
                                     vt_ElemDtor dtor);
 
+/**
+ * @brief Add n elements to the end of the vector.
+ *
+ * @param vt     pointer to a vector.
+ * @param elems  the vector elements to add.
+ * @param n      the number of elements.
+ * @return SUCCESS, or ERROR if the vector could not grow.
+ */
+extern LIB_EXPORT int vt_add_range(vt_Vector *vt, const vt_Vector_Element *elems,
+                                   size_t n) NOTHROW;
+
+/**
+ * @brief Insert n elements at a specific position, shifting the rest up.
+ *
+ * @param vt     pointer to a vector.
+ * @param pos    the vector position of the first inserted element.
+ * @param elems  the vector elements to insert.
+ * @param n      the number of elements.
+ * @return SUCCESS, or ERROR if pos is out-of-bounds or the vector could
+ *         not grow.
+ */
+extern LIB_EXPORT int vt_insert_range(vt_Vector *vt, size_t pos,
+                                      const vt_Vector_Element *elems, size_t n) NOTHROW;
+
+/**
+ * @brief Remove n elements starting at a specific position.
+ *
+ * @param vt    pointer to a vector.
+ * @param pos   the vector position of the first element to remove.
+ * @param n     the number of elements.
+ * @param dtor  element destructor function pointer.
+ * @return SUCCESS, or ERROR if the range is out-of-bounds.
+ */
+extern LIB_EXPORT int vt_remove_range(vt_Vector *vt, size_t pos, size_t n,
+                                      vt_ElemDtor dtor);
+
+/**
+ * @brief Copy n elements starting at a specific position into buf.
+ *
+ * @param vt   pointer to a vector.
+ * @param pos  the vector position of the first element to copy.
+ * @param n    the number of elements.
+ * @param buf  buffer with room for n elements.
+ * @return SUCCESS, or ERROR if the range is out-of-bounds.
+ */
+extern LIB_EXPORT int vt_copy_out(vt_Vector *vt, size_t pos, size_t n,
+                                  vt_Vector_Element *buf) NOTHROW;
+
 /**
  * @brief Sort vector elements.
  * @param vt    pointer to a vector.
@@ -137,6 +333,115 @@ extern LIB_EXPORT void vt_remove_at(vt_Vector *vt, size_t pos,
  */
 extern LIB_EXPORT void vt_sort(vt_Vector *vt, vt_ElemCompare comp);
 
+/**
+ * @brief Sort vector elements on several threads.
+ *
+ * The vector is cut into nthreads chunks that are sorted concurrently
+ * and then merged in parallel. The threads are started once and meet at
+ * a barrier between the sort, merge and copy phases. The result is the
+ * same as vt_sort.
+ *
+ * @param vt        pointer to a vector.
+ * @param comp      element compare function pointer.
+ * @param nthreads  number of threads, 0 for one per online cpu.
+ */
+extern LIB_EXPORT void vt_sort_parallel(vt_Vector *vt, vt_ElemCompare comp,
+                                        size_t nthreads);
+
+/**
+ * @brief Sort vector elements by an integer key.
+ *
+ * Keys are extracted once per element and sorted with an LSD radix
+ * sort, in O(n) and without calling a compare function. Keys compare
+ * as unsigned: flip the top bit of signed keys, (uint64_t)k ^ (1ULL << 63).
+ * Stable. Passes over digits that all keys share are skipped, so
+ * 32-bit keys take half the passes of 64-bit ones. Needs 32 bytes per
+ * element of scratch memory.
+ *
+ * @param vt   pointer to a vector.
+ * @param key  element key function pointer.
+ */
+extern LIB_EXPORT void vt_sort_by_key(vt_Vector *vt, vt_ElemKey key);
+
+/**
+ * @brief Binary search a sorted vector.
+ *
+ * @param vt    pointer to a vector sorted by comp.
+ * @param key   the element to look for.
+ * @param comp  element compare function pointer.
+ * @param pos   set to the position of the first element equal to key,
+ *              or where key would be inserted when there is none.
+ * @return SUCCESS if key was found, NOTFOUND if not.
+ */
+extern LIB_EXPORT int vt_bsearch(vt_Vector *vt, const vt_Vector_Element key,
+                                 vt_ElemCompare comp, size_t *pos);
+
+/**
+ * @brief Find the first element not less than key in a sorted vector.
+ *
+ * @param vt    pointer to a vector sorted by comp.
+ * @param key   the element to look for.
+ * @param comp  element compare function pointer.
+ * @return the position of the element, or the size if there is none.
+ */
+extern LIB_EXPORT size_t vt_lower_bound(vt_Vector *vt, const vt_Vector_Element key,
+                                        vt_ElemCompare comp);
+
+/**
+ * @brief Find the first element greater than key in a sorted vector.
+ *
+ * @param vt    pointer to a vector sorted by comp.
+ * @param key   the element to look for.
+ * @param comp  element compare function pointer.
+ * @return the position of the element, or the size if there is none.
+ */
+extern LIB_EXPORT size_t vt_upper_bound(vt_Vector *vt, const vt_Vector_Element key,
+                                        vt_ElemCompare comp);
+
+/**
+ * @brief vt_lower_bound for vectors much larger than the cache.
+ *
+ * Same result as vt_lower_bound, but the loop has a fixed trip count
+ * and selects the next half with a conditional move, so there are no
+ * mispredicted branches, and the two possible next probes are
+ * prefetched so cache misses overlap.
+ *
+ * @param vt    pointer to a vector sorted by comp.
+ * @param key   the element to look for.
+ * @param comp  element compare function pointer.
+ * @return the position of the element, or the size if there is none.
+ */
+extern LIB_EXPORT size_t vt_lower_bound_branchless(vt_Vector *vt,
+                                                   const vt_Vector_Element key,
+                                                   vt_ElemCompare comp);
+
+/**
+ * @brief Insert an element into a sorted vector, after equal elements.
+ *
+ * @param vt    pointer to a vector sorted by comp.
+ * @param elem  the vector element to insert.
+ * @param comp  element compare function pointer.
+ * @return the position of the inserted element, or (size_t)ERROR if the
+ *         vector could not grow.
+ */
+extern LIB_EXPORT size_t vt_insert_sorted(vt_Vector *vt, const vt_Vector_Element elem,
+                                          vt_ElemCompare comp);
+
+/**
+ * @brief Append the merge of two sorted vectors to dst.
+ *
+ * Stable: of equal elements, those of a come first. a and b are left
+ * unchanged and may be the same vector.
+ *
+ * @param dst   pointer to the destination vector.
+ * @param a     pointer to a vector sorted by comp.
+ * @param b     pointer to a vector sorted by comp.
+ * @param comp  element compare function pointer.
+ * @return SUCCESS, or ERROR if dst is a or b or dst could not grow.
+ */
+extern LIB_EXPORT int vt_merge_sorted(vt_Vector *dst, vt_Vector *a, vt_Vector *b,
+                                      vt_ElemCompare comp);
+
 /**
  * @brief Print vector elements.
  * @param vt     pointer to a vector.
@@ -160,8 +465,382 @@ extern LIB_EXPORT size_t vt_getsize(vt_Vector *vt) NOTHROW;
  */
 extern LIB_EXPORT bool vt_isempty(vt_Vector *vt) NOTHROW;
 
+/**
+ * @brief Instruction set used by the numeric kernels below.
+ */
+typedef enum {
+    vt_SIMD_SCALAR,
+    vt_SIMD_SSE2,
+    vt_SIMD_AVX2
+} vt_SimdLevel;
+
+/**
+ * @brief Return the instruction set the numeric kernels run with.
+ *
+ * Chosen on first use as the best one the cpu supports.
+ *
+ * @return the instruction set level.
+ */
+extern LIB_EXPORT vt_SimdLevel vt_simd_level(void) NOTHROW;
+
+/**
+ * @brief Cap the instruction set the numeric kernels run with.
+ *
+ * Meant for testing and benchmarking the fallbacks.
+ *
+ * @param max  the highest level to use.
+ * @return the level now in use, max or lower if unsupported.
+ */
+extern LIB_EXPORT vt_SimdLevel vt_simd_set_level(vt_SimdLevel max) NOTHROW;
+
+/*
+ * Numeric kernels over plain arrays, such as the list of a VT_DEFINE
+ * vector of int32_t, int64_t, float or double. Each has SSE2 and AVX2
+ * versions picked at runtime by cpu, and a scalar fallback.
+ */
+
+/**
+ * @brief Find the first element equal to value.
+ *
+ * @param list   pointer to the elements.
+ * @param n      the number of elements.
+ * @param value  the value to look for.
+ * @return the position of the element, or n if there is none.
+ */
+extern LIB_EXPORT size_t vt_find_i32(const int32_t *list, size_t n, int32_t value) NOTHROW;
+extern LIB_EXPORT size_t vt_find_i64(const int64_t *list, size_t n, int64_t value) NOTHROW;
+extern LIB_EXPORT size_t vt_find_f32(const float *list, size_t n, float value) NOTHROW;
+extern LIB_EXPORT size_t vt_find_f64(const double *list, size_t n, double value) NOTHROW;
+
+/**
+ * @brief Count the elements equal to value.
+ *
+ * @param list   pointer to the elements.
+ * @param n      the number of elements.
+ * @param value  the value to count.
+ * @return the number of elements equal to value.
+ */
+extern LIB_EXPORT size_t vt_count_i32(const int32_t *list, size_t n, int32_t value) NOTHROW;
+extern LIB_EXPORT size_t vt_count_i64(const int64_t *list, size_t n, int64_t value) NOTHROW;
+extern LIB_EXPORT size_t vt_count_f32(const float *list, size_t n, float value) NOTHROW;
+extern LIB_EXPORT size_t vt_count_f64(const double *list, size_t n, double value) NOTHROW;
+
+/**
+ * @brief Find the smallest and largest element.
+ *
+ * The result is unspecified if a float list holds a NaN.
+ *
+ * @param list  pointer to the elements.
+ * @param n     the number of elements.
+ * @param min   set to the smallest element.
+ * @param max   set to the largest element.
+ * @return SUCCESS, or ERROR if n is 0.
+ */
+extern LIB_EXPORT int vt_minmax_i32(const int32_t *list, size_t n,
+                                    int32_t *min, int32_t *max) NOTHROW;
+extern LIB_EXPORT int vt_minmax_i64(const int64_t *list, size_t n,
+                                    int64_t *min, int64_t *max) NOTHROW;
+extern LIB_EXPORT int vt_minmax_f32(const float *list, size_t n,
+                                    float *min, float *max) NOTHROW;
+extern LIB_EXPORT int vt_minmax_f64(const double *list, size_t n,
+                                    double *min, double *max) NOTHROW;
+
+/**
+ * @brief Sum the elements.
+ *
+ * int32_t elements are summed in 64 bits and float ones in double.
+ * int64_t sums wrap around on overflow. Float sums are added in a
+ * different order than a plain loop, so the last bits may differ.
+ *
+ * @param list  pointer to the elements.
+ * @param n     the number of elements.
+ * @return the sum, 0 if n is 0.
+ */
+extern LIB_EXPORT int64_t vt_sum_i32(const int32_t *list, size_t n) NOTHROW;
+extern LIB_EXPORT int64_t vt_sum_i64(const int64_t *list, size_t n) NOTHROW;
+extern LIB_EXPORT double vt_sum_f32(const float *list, size_t n) NOTHROW;
+extern LIB_EXPORT double vt_sum_f64(const double *list, size_t n) NOTHROW;
+
+/**
+ * @brief Copy the elements in [low, high] to out, keeping their order.
+ *
+ * out must have room for n elements; past the returned count its
+ * contents are unspecified.
+ *
+ * @param list  pointer to the elements.
+ * @param n     the number of elements.
+ * @param low   the smallest value to keep.
+ * @param high  the largest value to keep.
+ * @param out   pointer to the output buffer, must not overlap list.
+ * @return the number of elements copied.
+ */
+extern LIB_EXPORT size_t vt_filter_i32(const int32_t *list, size_t n, int32_t low,
+                                       int32_t high, int32_t *out) NOTHROW;
+extern LIB_EXPORT size_t vt_filter_i64(const int64_t *list, size_t n, int64_t low,
+                                       int64_t high, int64_t *out) NOTHROW;
+extern LIB_EXPORT size_t vt_filter_f32(const float *list, size_t n, float low,
+                                       float high, float *out) NOTHROW;
+extern LIB_EXPORT size_t vt_filter_f64(const double *list, size_t n, double low,
+                                       double high, double *out) NOTHROW;
+
+
+/**
+ * @brief Define a typed vector that stores T inline.
+ *
+ * Generates the struct type name and static inline functions with the
+ * vt_Vector surface, prefixed by name: name_init, name_destroy,
+ * name_add, name_add_at, name_get, name_get_at, name_remove,
+ * name_remove_at, name_getsize and name_isempty. Elements are copied
+ * in and out by value, so there is no per element allocation and
+ * nothing to free. get/get_at return a pointer into the storage (NULL
+ * when out-of-bounds), valid until the next add. add/add_at return
+ * SUCCESS, or ERROR when pos is out-of-bounds or the storage could not
+ * grow, which leaves the vector as it was.
+ *
+ * The generated functions, name_sort from VT_DEFINE_SORT included, do
+ * not lock, also not in SYNC builds: the pointers get/get_at return
+ * would outlive any lock anyway. Threads sharing one vector must
+ * serialize every call and every use of those pointers themselves.
+ *
+ * @param name  name of the vector type and function prefix.
+ * @param T     element type.
+ */
+#define VT_DEFINE(name, T)                                                    \
+typedef struct {                                                              \
+    size_t size;                                                              \
+    size_t capacity;                                                          \
+    T *list;                                                                  \
+} name;                                                                       \
+                                                                              \
+static inline name *name##_init(void)                                         \
+{                                                                             \
+    name *vt = (name*)calloc(1, sizeof *vt);                                  \
+    assert(vt);                                                               \
+    vt->capacity = vt_INITIAL_VECTOR_CAPACITY;                                \
+    vt->list = (T*)malloc(vt->capacity * sizeof *vt->list);                   \
+    assert(vt->list);                                                         \
+    return vt;                                                                \
+}                                                                             \
+                                                                              \
+static inline void name##_destroy(name *vt)                                   \
+{                                                                             \
+    assert(vt);                                                               \
+    free(vt->list);                                                           \
+    free(vt);                                                                 \
+}                                                                             \
+                                                                              \
+static inline int name##_grow_(name *vt)                                      \
+{                                                                             \
+    T *list = (T*)realloc(vt->list, vt->capacity * 2 * sizeof *vt->list);     \
+    if (list == NULL)                                                         \
+        return ERROR;                                                         \
+    vt->list = list;                                                          \
+    vt->capacity *= 2;                                                        \
+    return SUCCESS;                                                           \
+}                                                                             \
+                                                                              \
+static inline int name##_add(name *vt, T elem)                                \
+{                                                                             \
+    assert(vt);                                                               \
+    if (vt->size == vt->capacity && name##_grow_(vt) != SUCCESS)              \
+        return ERROR;                                                         \
+    vt->list[vt->size++] = elem;                                              \
+    return SUCCESS;                                                           \
+}                                                                             \
+                                                                              \
+static inline int name##_add_at(name *vt, T elem, size_t pos)                 \
+{                                                                             \
+    assert(vt);                                                               \
+    if (pos > vt->size)                                                       \
+        return ERROR;                                                         \
+    if (vt->size == vt->capacity && name##_grow_(vt) != SUCCESS)              \
+        return ERROR;                                                         \
+    memmove(vt->list + pos + 1, vt->list + pos,                               \
+            (vt->size - pos) * sizeof *vt->list);                             \
+    vt->list[pos] = elem;                                                     \
+    vt->size++;                                                               \
+    return SUCCESS;                                                           \
+}                                                                             \
+                                                                              \
+static inline T *name##_get(name *vt)                                         \
+{                                                                             \
+    assert(vt);                                                               \
+    return (vt->size > 0) ? &vt->list[vt->size-1] : NULL;                     \
+}                                                                             \
+                                                                              \
+static inline T *name##_get_at(name *vt, size_t pos)                          \
+{                                                                             \
+    assert(vt);                                                               \
+    return (pos < vt->size) ? &vt->list[pos] : NULL;                          \
+}                                                                             \
+                                                                              \
+static inline void name##_remove(name *vt)                                    \
+{                                                                             \
+    assert(vt);                                                               \
+    if (vt->size > 0)                                                         \
+        vt->size--;                                                           \
+}                                                                             \
+                                                                              \
+static inline void name##_remove_at(name *vt, size_t pos)                     \
+{                                                                             \
+    assert(vt);                                                               \
+    if (pos >= vt->size)                                                      \
+        return;                                                               \
+    memmove(vt->list + pos, vt->list + pos + 1,                               \
+            (vt->size - pos - 1) * sizeof *vt->list);                         \
+    vt->size--;                                                               \
+}                                                                             \
+                                                                              \
+static inline size_t name##_getsize(const name *vt)                           \
+{                                                                             \
+    assert(vt);                                                               \
+    return vt->size;                                                          \
+}                                                                             \
+                                                                              \
+static inline bool name##_isempty(const name *vt)                             \
+{                                                                             \
+    assert(vt);                                                               \
+    return vt->size == 0;                                                     \
+}
+
+/**
+ * @brief Define name_sort for a vector made by VT_DEFINE(name, T).
+ *
+ * comp is called directly as comp(const T*, const T*) returning <0, 0
+ * or >0, so the compiler can inline it (a function or a macro both
+ * work). The sort is stable: insertion sort on blocks of 32, then
+ * bottom-up merges through one scratch buffer.
+ *
+ * @param name  name given to VT_DEFINE.
+ * @param T     element type given to VT_DEFINE.
+ * @param comp  element compare function or macro.
+ */
+#define VT_DEFINE_SORT(name, T, comp)                                         \
+static inline void name##_sort(name *vt)                                      \
+{                                                                             \
+    size_t n, width, low, i, j;                                               \
+    T *src, *dst, *tmp;                                                       \
+                                                                              \
+    assert(vt);                                                               \
+    n = vt->size;                                                             \
+    src = vt->list;                                                           \
+    for (low = 0; low < n; low += 32) {                                       \
+        size_t high = (n - low < 32) ? n : low + 32;                          \
+        for (i = low + 1; i < high; ++i) {                                    \
+            T elem = src[i];                                                  \
+            for (j = i; j > low && comp(&elem, &src[j-1]) < 0; --j)           \
+                src[j] = src[j-1];                                            \
+            src[j] = elem;                                                    \
+        }                                                                     \
+    }                                                                         \
+    if (n <= 32)                                                              \
+        return;                                                               \
+                                                                              \
+    dst = (T*)malloc(n * sizeof *dst);                                        \
+    assert(dst);                                                              \
+    for (width = 32; width < n; width *= 2) {                                 \
+        for (low = 0; low < n; low += 2 * width) {                            \
+            size_t mid = (n - low < width) ? n : low + width;                 \
+            size_t high = (n - mid < width) ? n : mid + width;                \
+            size_t k = low;                                                   \
+            i = low;                                                          \
+            j = mid;                                                          \
+            while (i < mid && j < high)                                       \
+                dst[k++] = (comp(&src[j], &src[i]) < 0) ? src[j++]            \
+                                                        : src[i++];           \
+            while (i < mid)                                                   \
+                dst[k++] = src[i++];                                          \
+            while (j < high)                                                  \
+                dst[k++] = src[j++];                                          \
+        }                                                                     \
+        tmp = src;                                                            \
+        src = dst;                                                            \
+        dst = tmp;                                                            \
+    }                                                                         \
+    if (src != vt->list) {                                                    \
+        memcpy(vt->list, src, n * sizeof *src);                               \
+        free(src);                                                            \
+    } else {                                                                  \
+        free(dst);                                                            \
+    }                                                                         \
+}
+
 #ifdef __cplusplus
 }
 #endif
 
+#ifdef __cplusplus
+#include <algorithm>
+#include <functional>
+#include <new>
+#include <vector>
+
+namespace vt {
+
+/**
+ * @brief Typed vector storing T inline, the C++ counterpart of VT_DEFINE.
+ *
+ * Same surface as vt_Vector. sort takes a strict weak ordering (less
+ * than, as in the standard library) as a template parameter so it is
+ * inlined, and is stable like vt_sort. add/add_at catch std::bad_alloc
+ * and return ERROR with the vector unchanged, like VT_DEFINE. Does not
+ * lock, like VT_DEFINE.
+ */
+template <typename T>
+class Vector {
+public:
+    Vector() { list_.reserve(vt_INITIAL_VECTOR_CAPACITY); }
+
+    int add(const T &elem)
+    {
+        try {
+            list_.push_back(elem);
+        } catch (const std::bad_alloc &) {
+            return ERROR;
+        }
+        return SUCCESS;
+    }
+
+    int add_at(const T &elem, size_t pos)
+    {
+        if (pos > list_.size())
+            return ERROR;
+        try {
+            list_.insert(list_.begin() + pos, elem);
+        } catch (const std::bad_alloc &) {
+            return ERROR;
+        }
+        return SUCCESS;
+    }
+
+    T *get() { return list_.empty() ? nullptr : &list_.back(); }
+
+    T *get_at(size_t pos) { return (pos < list_.size()) ? &list_[pos] : nullptr; }
+
+    void remove()
+    {
+        if (!list_.empty())
+            list_.pop_back();
+    }
+
+    void remove_at(size_t pos)
+    {
+        if (pos < list_.size())
+            list_.erase(list_.begin() + pos);
+    }
+
+    template <typename Compare = std::less<T>>
+    void sort(Compare comp = Compare()) { std::stable_sort(list_.begin(), list_.end(), comp); }
+
+    size_t getsize() const { return list_.size(); }
+
+    bool isempty() const { return list_.empty(); }
+
+private:
+    std::vector<T> list_;
+};
+
+} /* namespace vt */
+#endif /* __cplusplus */
+
 #endif /* VT_H */
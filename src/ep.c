@@ -0,0 +1,91 @@
+#include <assert.h>
+#include <stdlib.h>
+
+#include "ep.h"
+
+/**
+ * @brief Destroy a retired element.
+ *
+ * @param node  pointer to the retired node, freed too.
+ */
+static void _destroy_retired(ep_Retired *node);
+
+
+unsigned long ep_enter(ep_Domain *ep)
+{
+    unsigned long epoch = __atomic_load_n(&ep->epoch, __ATOMIC_SEQ_CST);
+
+    /* no retry if the epoch moved meanwhile, ep_reclaim copes with
+     * readers counted under an older one */
+    __atomic_fetch_add(&ep->readers[epoch % 3].count, 1, __ATOMIC_SEQ_CST);
+    return epoch;
+}
+
+void ep_exit(ep_Domain *ep, unsigned long epoch)
+{
+    __atomic_fetch_sub(&ep->readers[epoch % 3].count, 1, __ATOMIC_RELEASE);
+}
+
+void ep_retire(ep_Domain *ep, void *elem, ep_Dtor dtor)
+{
+    ep_Retired *node = (ep_Retired*)malloc(sizeof *node);
+
+    assert(node);
+
+    /* the writer published the replacement of elem before this call and
+     * readers add to their count before loading it. that is a store then
+     * a load on either side, which only a full fence keeps in order: without
+     * it the counts below may predate the publish while a reader already
+     * holds elem */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    node->elem = elem;
+    node->dtor = dtor;
+    node->epoch = __atomic_load_n(&ep->epoch, __ATOMIC_SEQ_CST);
+    node->next = ep->retired;
+    ep->retired = node;
+    ep_reclaim(ep);
+}
+
+void ep_reclaim(ep_Domain *ep)
+{
+    unsigned long epoch = __atomic_load_n(&ep->epoch, __ATOMIC_SEQ_CST);
+    ep_Retired **link = &ep->retired;
+
+    /* advance only while every reader counts in the slot of this epoch.
+     * one that read an older epoch may count in any slot, but it then
+     * blocks one of the two advances that free what it might hold. */
+    if (__atomic_load_n(&ep->readers[(epoch + 1) % 3].count, __ATOMIC_SEQ_CST) == 0 &&
+        __atomic_load_n(&ep->readers[(epoch + 2) % 3].count, __ATOMIC_SEQ_CST) == 0) {
+        epoch++;
+        __atomic_store_n(&ep->epoch, epoch, __ATOMIC_SEQ_CST);
+    }
+
+    /* unlinked in epoch e, unreachable once epoch e+2 begins */
+    while (*link) {
+        ep_Retired *node = *link;
+        if (node->epoch + 2 <= epoch) {
+            *link = node->next;
+            _destroy_retired(node);
+        } else {
+            link = &node->next;
+        }
+    }
+}
+
+void ep_destroy(ep_Domain *ep)
+{
+    while (ep->retired) {
+        ep_Retired *next = ep->retired->next;
+        _destroy_retired(ep->retired);
+        ep->retired = next;
+    }
+}
+
+static void _destroy_retired(ep_Retired *node)
+{
+    if (node->dtor)
+        node->dtor(node->elem);
+    else
+        free(node->elem);
+    free(node);
+}
@@ -0,0 +1,93 @@
+#ifndef EP_H
+#define EP_H
+
+#include "constants.h"
+
+/*
+ * Epoch based reclamation shared by the lock-free readers of hm and vt,
+ * internal to the library.
+ *
+ * Readers bracket every access to published memory with ep_enter and
+ * ep_exit, a wait-free load and add each. A writer that unlinks memory
+ * publishes its replacement first and then hands the old memory to
+ * ep_retire; it is destroyed once the epoch has advanced twice, which
+ * no reader that could still hold it lets happen. Writers of one domain
+ * are serialized by the caller.
+ */
+
+/**
+ * @brief Destructor of retired memory, NULL means free().
+ */
+typedef void (*ep_Dtor)(void*);
+
+/**
+ * @brief Readers inside one epoch, one per cache line.
+ */
+typedef struct {
+    unsigned long count;
+    char pad[CACHE_LINE_SIZE - sizeof(unsigned long)];
+} ep_Readers;
+
+/**
+ * @brief Memory unlinked by a writer, destroyed once no reader can hold it.
+ */
+typedef struct _ep_retired {
+    void *elem;
+    ep_Dtor dtor;
+    unsigned long epoch;        /* epoch in which it was unlinked */
+    struct _ep_retired *next;
+} ep_Retired;
+
+/**
+ * @brief Reclamation domain, zero initialized.
+ */
+typedef struct {
+    ep_Readers readers[3];      /* active readers per epoch mod 3 */
+    unsigned long epoch;
+    ep_Retired *retired;
+} ep_Domain;
+
+/**
+ * @brief Enter the current epoch as a reader, wait-free: one load and
+ * one add, whatever writers do meanwhile.
+ *
+ * @param ep  pointer to domain.
+ * @return the epoch to pass to ep_exit.
+ */
+unsigned long ep_enter(ep_Domain *ep);
+
+/**
+ * @brief Leave an epoch entered with ep_enter.
+ *
+ * @param ep     pointer to domain.
+ * @param epoch  the epoch returned by ep_enter.
+ */
+void ep_exit(ep_Domain *ep, unsigned long epoch);
+
+/**
+ * @brief Hand memory that is no longer published over to the domain, it
+ * is destroyed with dtor once no reader can hold it. Writer only.
+ *
+ * @param ep    pointer to domain.
+ * @param elem  the unlinked memory.
+ * @param dtor  its destructor, NULL for free().
+ */
+void ep_retire(ep_Domain *ep, void *elem, ep_Dtor dtor);
+
+/**
+ * @brief Advance the epoch when every reader counts under the current
+ * one, and destroy what no reader can hold anymore. Never waits. Writer
+ * only.
+ *
+ * @param ep  pointer to domain.
+ */
+void ep_reclaim(ep_Domain *ep);
+
+/**
+ * @brief Destroy everything retired, with no reader left.
+ *
+ * @param ep  pointer to domain.
+ */
+void ep_destroy(ep_Domain *ep);
+
+#endif /* EP_H */
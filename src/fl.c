@@ -0,0 +1,493 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fl.h"
+
+/* 64-bit words per Bloom block, one cache line */
+#define FL_BLOCK_WORDS  (CACHE_LINE_SIZE / 8)
+#define FL_BLOCK_BITS   (FL_BLOCK_WORDS * 64)
+/* a key sets one bit in every word of its block */
+#define FL_K            FL_BLOCK_WORDS
+/* fingerprints per cuckoo bucket */
+#define FL_BUCKET_SLOTS 4
+/* share of cuckoo slots in use at the expected number of keys */
+#define FL_CUCKOO_LOAD  0.95
+/* evictions an add tries before the cuckoo filter counts as full */
+#define FL_MAX_KICKS    500
+
+struct _bloom {
+    uint64_t *blocks;       /* nblocks * FL_BLOCK_WORDS, cache line aligned */
+    size_t nblocks;
+};
+
+struct _cuckoo {
+    uint8_t *buckets;       /* nbuckets * FL_BUCKET_SLOTS fingerprints, 0 is empty */
+    size_t nbuckets;
+    unsigned width;         /* bytes per fingerprint, 1 or 2 */
+    uint16_t fp_mask;
+    size_t size;
+    uint64_t rng;           /* picks eviction victims */
+    bool full;              /* an evicted fingerprint waits in victim */
+    uint16_t victim_fp;
+    size_t victim_index;
+};
+
+/**
+ * @brief Finalize a hash so all its bits depend on all input bits.
+ */
+static inline uint64_t _mix(uint64_t x);
+
+/**
+ * @brief e^x for x <= 0, without libm.
+ */
+static double _exp(double x);
+
+/**
+ * @brief False positive rate of a Bloom filter whose blocks hold load
+ * keys on average.
+ */
+static double _bloom_fpr(double load);
+
+/**
+ * @brief Block of a key and the bits it sets there.
+ *
+ * @param bf    pointer to a Bloom filter.
+ * @param hash  hash of the key.
+ * @param mask  set to the bits of the key, one word per block word.
+ * @return the block.
+ */
+static inline const uint64_t *_bloom_block(const fl_Bloom *bf, uint64_t hash,
+                                           uint64_t mask[FL_BLOCK_WORDS]);
+
+/**
+ * @brief Fingerprint and first bucket of a key.
+ */
+static inline void _cuckoo_locate(const fl_Cuckoo *cf, uint64_t hash, uint16_t *fp,
+                                  size_t *index);
+
+/**
+ * @brief The other bucket a fingerprint in bucket index may sit in.
+ */
+static inline size_t _cuckoo_alt(const fl_Cuckoo *cf, size_t index, uint16_t fp);
+
+/**
+ * @brief Load the fingerprints of a bucket as one word, 8 or 16 bit lanes.
+ */
+static inline uint64_t _bucket_load(const fl_Cuckoo *cf, size_t index);
+
+/**
+ * @brief Store a bucket word loaded with _bucket_load.
+ */
+static inline void _bucket_store(fl_Cuckoo *cf, size_t index, uint64_t word);
+
+/**
+ * @brief Bit mask of the lanes of a bucket that hold fp, one bit per lane.
+ */
+static inline unsigned _bucket_match(const fl_Cuckoo *cf, size_t index, uint16_t fp);
+
+/**
+ * @brief Put fp in lane of a bucket.
+ */
+static inline void _bucket_set(fl_Cuckoo *cf, size_t index, unsigned lane, uint16_t fp);
+
+/**
+ * @brief Put fp in a free lane of a bucket.
+ *
+ * @return true if the bucket had room, false if not.
+ */
+static bool _bucket_insert(fl_Cuckoo *cf, size_t index, uint16_t fp);
+
+/**
+ * @brief Put fp in bucket index or its alternative, moving other
+ * fingerprints on if both are full. If no room turns up the last one
+ * moved out is kept as the victim and the filter is full.
+ */
+static void _cuckoo_place(fl_Cuckoo *cf, size_t index, uint16_t fp);
+
+
+fl_Bloom *fl_bloom_init(size_t n, double fpr)
+{
+    fl_Bloom *bf = NULL;
+    double low = 0, high = FL_BLOCK_BITS;
+    int i;
+
+    if (!(fpr > 0.0 && fpr < 1.0)) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: fpr is out of range\n", FUNC);
+        #endif
+        return NULL;
+    }
+
+    bf = (fl_Bloom*)malloc(sizeof *bf);
+    assert(bf);
+    /* the most keys per block that still meets fpr, by bisection */
+    for (i = 0; i < 40; ++i) {
+        double load = (low + high) / 2;
+        if (_bloom_fpr(load) > fpr)
+            high = load;
+        else
+            low = load;
+    }
+    bf->nblocks = (size_t)((n > 0 ? (double)n : 1.0) / low) + 1;
+    bf->blocks = (uint64_t*)aligned_alloc(CACHE_LINE_SIZE,
+                                          bf->nblocks * FL_BLOCK_WORDS * sizeof *bf->blocks);
+    assert(bf->blocks);
+    fl_bloom_clear(bf);
+    return bf;
+}
+
+void fl_bloom_destroy(fl_Bloom *bf)
+{
+    assert(bf);
+    free(bf->blocks);
+    free(bf);
+}
+
+void fl_bloom_add(fl_Bloom *bf, uint64_t hash)
+{
+    uint64_t mask[FL_BLOCK_WORDS];
+    uint64_t *block = NULL;
+    int w;
+
+    assert(bf);
+    block = CONST_CAST(uint64_t*, _bloom_block(bf, hash, mask));
+    for (w = 0; w < FL_BLOCK_WORDS; ++w)
+        block[w] |= mask[w];
+}
+
+bool fl_bloom_contains(const fl_Bloom *bf, uint64_t hash)
+{
+    uint64_t mask[FL_BLOCK_WORDS];
+    const uint64_t *block = NULL;
+    uint64_t missing = 0;
+    int w;
+
+    assert(bf);
+    block = _bloom_block(bf, hash, mask);
+    /* no early exit, the loop vectorizes */
+    for (w = 0; w < FL_BLOCK_WORDS; ++w)
+        missing |= mask[w] & ~block[w];
+    return missing == 0;
+}
+
+void fl_bloom_clear(fl_Bloom *bf)
+{
+    assert(bf);
+    memset(bf->blocks, 0, bf->nblocks * FL_BLOCK_WORDS * sizeof *bf->blocks);
+}
+
+size_t fl_bloom_getbytes(const fl_Bloom *bf)
+{
+    assert(bf);
+    return bf->nblocks * FL_BLOCK_WORDS * sizeof *bf->blocks;
+}
+
+fl_Cuckoo *fl_cuckoo_init(size_t n, double fpr)
+{
+    fl_Cuckoo *cf = NULL;
+    unsigned bits;
+    double buckets;
+
+    if (!(fpr >= fl_CUCKOO_MIN_FPR && fpr < 1.0)) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: fpr is out of range\n", FUNC);
+        #endif
+        return NULL;
+    }
+
+    cf = (fl_Cuckoo*)calloc(1, sizeof *cf);
+    assert(cf);
+    /* a lookup compares 2 buckets of FL_BUCKET_SLOTS, fpr ~ 8 / 2^bits */
+    for (bits = 4; bits < 16 && (double)(1u << bits) * fpr < 2.0 * FL_BUCKET_SLOTS; ++bits)
+        ;
+    cf->width = (bits <= 8) ? 1 : 2;
+    cf->fp_mask = (uint16_t)((1u << bits) - 1);
+
+    /* any count, rounding up to a power of two would leave up to half unused */
+    buckets = (n > 0 ? (double)n : 1.0) / (FL_BUCKET_SLOTS * FL_CUCKOO_LOAD);
+    cf->nbuckets = (size_t)buckets + 1;
+    cf->buckets = (uint8_t*)calloc(cf->nbuckets * FL_BUCKET_SLOTS, cf->width);
+    assert(cf->buckets);
+    cf->rng = 0x9e3779b97f4a7c15ULL;
+    return cf;
+}
+
+void fl_cuckoo_destroy(fl_Cuckoo *cf)
+{
+    assert(cf);
+    free(cf->buckets);
+    free(cf);
+}
+
+int fl_cuckoo_add(fl_Cuckoo *cf, uint64_t hash)
+{
+    uint16_t fp;
+    size_t index;
+
+    assert(cf);
+    if (cf->full) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: filter is full\n", FUNC);
+        #endif
+        return ERROR;
+    }
+
+    _cuckoo_locate(cf, hash, &fp, &index);
+    _cuckoo_place(cf, index, fp);
+    cf->size++;
+    return SUCCESS;
+}
+
+bool fl_cuckoo_contains(const fl_Cuckoo *cf, uint64_t hash)
+{
+    uint16_t fp;
+    size_t i1, i2;
+
+    assert(cf);
+    _cuckoo_locate(cf, hash, &fp, &i1);
+    i2 = _cuckoo_alt(cf, i1, fp);
+    if (_bucket_match(cf, i1, fp) | _bucket_match(cf, i2, fp))
+        return true;
+    return cf->full && cf->victim_fp == fp &&
+           (cf->victim_index == i1 || cf->victim_index == i2);
+}
+
+int fl_cuckoo_remove(fl_Cuckoo *cf, uint64_t hash)
+{
+    uint16_t fp;
+    size_t i1, i2, index;
+    unsigned match;
+
+    assert(cf);
+    _cuckoo_locate(cf, hash, &fp, &i1);
+    i2 = _cuckoo_alt(cf, i1, fp);
+
+    if (cf->full && cf->victim_fp == fp &&
+        (cf->victim_index == i1 || cf->victim_index == i2)) {
+        cf->full = false;
+        cf->size--;
+        return SUCCESS;
+    }
+
+    index = i1;
+    match = _bucket_match(cf, i1, fp);
+    if (!match) {
+        index = i2;
+        match = _bucket_match(cf, i2, fp);
+    }
+    if (!match) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: key not found\n", FUNC);
+        #endif
+        return NOTFOUND;
+    }
+    _bucket_set(cf, index, __builtin_ctz(match), 0);
+    cf->size--;
+
+    /* the freed lane may make room for the fingerprint waiting on the side */
+    if (cf->full) {
+        cf->full = false;
+        _cuckoo_place(cf, cf->victim_index, cf->victim_fp);
+    }
+    return SUCCESS;
+}
+
+size_t fl_cuckoo_getsize(const fl_Cuckoo *cf)
+{
+    assert(cf);
+    return cf->size;
+}
+
+size_t fl_cuckoo_getbytes(const fl_Cuckoo *cf)
+{
+    assert(cf);
+    return cf->nbuckets * FL_BUCKET_SLOTS * cf->width;
+}
+
+static inline uint64_t _mix(uint64_t x)
+{
+    /* murmur3 fmix64 */
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+static double _exp(double x)
+{
+    double r = 1, term = 1;
+    int i;
+
+    /* Taylor on x / 2^16, then square back up */
+    x /= 65536;
+    for (i = 1; i < 8; ++i) {
+        term *= x / i;
+        r += term;
+    }
+    for (i = 0; i < 16; ++i)
+        r *= r;
+    return r;
+}
+
+static double _bloom_fpr(double load)
+{
+    /*
+     * Keys land in blocks Poisson distributed, which is the locality
+     * cost of blocking. With x keys in its block a word has the bit of a
+     * lookup set with chance 1 - (63/64)^x, and the lookup needs it in
+     * all FL_K words.
+     */
+    double p = _exp(-load), unset = 1, fpr = 0;
+    size_t x, last = (size_t)(2 * load) + 64;
+    int k;
+
+    for (x = 0; x <= last; ++x) {
+        double hit = 1;
+        for (k = 0; k < FL_K; ++k)
+            hit *= 1 - unset;
+        fpr += p * hit;
+        p *= load / (x + 1);
+        unset *= 63.0 / 64;
+    }
+    return fpr;
+}
+
+static inline const uint64_t *_bloom_block(const fl_Bloom *bf, uint64_t hash,
+                                           uint64_t mask[FL_BLOCK_WORDS])
+{
+    uint64_t h = _mix(hash);
+    /* high bits pick the block, multiply-shift instead of a modulo */
+    size_t block = (size_t)(((unsigned __int128)h * bf->nblocks) >> 64);
+    /* odd salts spread the low half over a bit in every word, as Impala and Parquet do */
+    static const uint32_t salt[FL_K] = {
+        0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+        0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U
+    };
+    uint32_t low = (uint32_t)h;
+    int w;
+
+    for (w = 0; w < FL_K; ++w)
+        mask[w] = 1ULL << ((low * salt[w]) >> 26);
+    return bf->blocks + block * FL_BLOCK_WORDS;
+}
+
+static inline void _cuckoo_locate(const fl_Cuckoo *cf, uint64_t hash, uint16_t *fp,
+                                  size_t *index)
+{
+    uint64_t h = _mix(hash);
+
+    /* 0 marks an empty lane */
+    *fp = (uint16_t)(h >> 48) & cf->fp_mask;
+    if (*fp == 0)
+        *fp = 1;
+    /* the 48 bits below the fingerprint, multiply-shift instead of a modulo */
+    *index = (size_t)(((unsigned __int128)(h << 16) * cf->nbuckets) >> 64);
+}
+
+static inline size_t _cuckoo_alt(const fl_Cuckoo *cf, size_t index, uint16_t fp)
+{
+    /* h - index mod nbuckets: the alternative of the alternative is index */
+    size_t h = (size_t)(((unsigned __int128)_mix(fp) * cf->nbuckets) >> 64);
+    return (h >= index) ? h - index : h + cf->nbuckets - index;
+}
+
+static inline uint64_t _bucket_load(const fl_Cuckoo *cf, size_t index)
+{
+    uint64_t word = 0;
+    memcpy(&word, cf->buckets + index * FL_BUCKET_SLOTS * cf->width,
+           FL_BUCKET_SLOTS * cf->width);
+    return word;
+}
+
+static inline void _bucket_store(fl_Cuckoo *cf, size_t index, uint64_t word)
+{
+    memcpy(cf->buckets + index * FL_BUCKET_SLOTS * cf->width, &word,
+           FL_BUCKET_SLOTS * cf->width);
+}
+
+static inline unsigned _bucket_match(const fl_Cuckoo *cf, size_t index, uint16_t fp)
+{
+    uint64_t word = _bucket_load(cf, index);
+    uint64_t ones, highs, x, zero;
+    unsigned mask = 0, lane;
+
+    /* lanes equal to fp become zero, then the classic has-zero-byte test */
+    if (cf->width == 1) {
+        ones = 0x01010101ULL;
+        highs = 0x80808080ULL;
+    } else {
+        ones = 0x0001000100010001ULL;
+        highs = 0x8000800080008000ULL;
+    }
+    x = word ^ (ones * fp);
+    zero = (x - ones) & ~x & highs;
+    if (!zero)
+        return 0;
+    /* exact per lane, the test above can flag a lane next to a zero one */
+    for (lane = 0; lane < FL_BUCKET_SLOTS; ++lane) {
+        uint64_t v = (x >> (lane * cf->width * 8)) & ((cf->width == 1) ? 0xff : 0xffff);
+        mask |= (unsigned)(v == 0) << lane;
+    }
+    return mask;
+}
+
+static inline void _bucket_set(fl_Cuckoo *cf, size_t index, unsigned lane, uint16_t fp)
+{
+    unsigned shift = lane * cf->width * 8;
+    uint64_t lane_mask = (uint64_t)((cf->width == 1) ? 0xff : 0xffff) << shift;
+    uint64_t word = _bucket_load(cf, index);
+
+    word = (word & ~lane_mask) | ((uint64_t)fp << shift);
+    _bucket_store(cf, index, word);
+}
+
+static bool _bucket_insert(fl_Cuckoo *cf, size_t index, uint16_t fp)
+{
+    unsigned free = _bucket_match(cf, index, 0);
+
+    if (!free)
+        return false;
+    _bucket_set(cf, index, __builtin_ctz(free), fp);
+    return true;
+}
+
+static void _cuckoo_place(fl_Cuckoo *cf, size_t index, uint16_t fp)
+{
+    int kick;
+
+    if (_bucket_insert(cf, index, fp))
+        return;
+    index = _cuckoo_alt(cf, index, fp);
+    if (_bucket_insert(cf, index, fp))
+        return;
+
+    /* both buckets full, move a random fingerprint to its other bucket */
+    for (kick = 0; kick < FL_MAX_KICKS; ++kick) {
+        unsigned lane, shift;
+        uint16_t evicted;
+
+        cf->rng ^= cf->rng << 13;
+        cf->rng ^= cf->rng >> 7;
+        cf->rng ^= cf->rng << 17;
+        lane = cf->rng % FL_BUCKET_SLOTS;
+        shift = lane * cf->width * 8;
+
+        evicted = (uint16_t)(_bucket_load(cf, index) >> shift);
+        if (cf->width == 1)
+            evicted &= 0xff;
+        _bucket_set(cf, index, lane, fp);
+        fp = evicted;
+        index = _cuckoo_alt(cf, index, fp);
+        if (_bucket_insert(cf, index, fp))
+            return;
+    }
+
+    /* no room found, the last fingerprint moved out waits on the side */
+    cf->full = true;
+    cf->victim_fp = fp;
+    cf->victim_index = index;
+}
@@ -1 +1,1104 @@
+#include <assert.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
 #include "hm.h"
+#include "ep.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/* slots whose control bytes one probe step compares */
+#define HM_GROUP_WIDTH   16
+/* smallest table, one group */
+#define HM_MIN_CAPACITY  HM_GROUP_WIDTH
+/* old table slots moved per operation during an incremental resize */
+#define HM_REHASH_STEP   64
+/* concurrent mode, the shard index comes from the top bits of the hash */
+#define HM_SHARD_BITS    16
+
+/*
+ * control bytes. empty is zero so a calloc'd table needs no pass over
+ * it, full slots hold 0x80 | the low 7 bits of the hash, so the sign
+ * bit tells full from free.
+ */
+#define HM_EMPTY    ((int8_t)0)
+#define HM_DELETED  ((int8_t)1)
+#define HM_FULL(h)  ((int8_t)(0x80 | ((h) & 0x7f)))
+
+/**
+ * @brief Key and value of one entry.
+ */
+typedef struct {
+    void *key;
+    void *value;
+} HashSlot;
+
+/**
+ * @brief Open addressing table, capacity slots and their control bytes.
+ */
+typedef struct {
+    int8_t *ctrl;           /* capacity + HM_GROUP_WIDTH bytes, the tail mirrors the head */
+    HashSlot *slots;
+    size_t capacity;        /* power of two, 0 until the first put */
+    size_t size;
+    size_t growth_left;     /* puts into empty slots before the next resize */
+} HashTable;
+
+/**
+ * @brief One lock stripe of a concurrent mode map, with a table of its own.
+ *
+ * A published table is only written in place to fill empty slots, to
+ * mark full ones deleted and to swap values, so a reader never sees a
+ * slot hold two keys; deleted slots are reclaimed by copying the shard
+ * into a new table.
+ */
+typedef struct {
+    HashTable *table;           /* readers load it without locking */
+    size_t size;
+    ep_Domain ep;               /* reclaims unlinked keys, values and tables */
+    pthread_mutex_t mutex __attribute__((aligned(CACHE_LINE_SIZE)));
+} Shard;
+
+struct _hashmap {
+    HashTable table;
+    HashTable old;          /* table being moved out of, capacity 0 if none */
+    size_t rehash_pos;      /* old slots below this have been moved */
+    bool incremental;       /* resize a few slots per operation */
+    double max_load;
+    hm_KeyHash hash;
+    hm_KeyCompare comp;
+    Shard *shards;          /* concurrent mode, NULL otherwise */
+    size_t shard_mask;
+    #ifdef SYNC
+        pthread_mutex_t mutex;
+    #endif
+};
+
+/**
+ * @brief Finalize a user hash so all its bits depend on all input bits.
+ *
+ * @param hash  the user hash.
+ * @return the mixed hash.
+ */
+static inline size_t _mix(size_t hash);
+
+/**
+ * @brief Bit mask of the slots in the group at ctrl whose byte is h.
+ */
+static inline unsigned _group_match(const int8_t *ctrl, int8_t h);
+
+/**
+ * @brief Bit mask of the empty or deleted slots in the group at ctrl.
+ */
+static inline unsigned _group_match_free(const int8_t *ctrl);
+
+/**
+ * @brief Find the slot holding key in one table.
+ *
+ * @param hm     pointer to hash map.
+ * @param table  pointer to table.
+ * @param key    the key.
+ * @param hash   the mixed hash of key.
+ * @return the slot index, or SIZE_MAX if key is not in the table.
+ */
+static size_t _find(const hm_HashMap *hm, const HashTable *table, const void *key,
+                    size_t hash);
+
+/**
+ * @brief Find the slot holding key in the map, looking in the old table
+ * too during an incremental resize.
+ *
+ * @param hm     pointer to hash map.
+ * @param key    the key.
+ * @param hash   the mixed hash of key.
+ * @param table  set to the table holding the slot.
+ * @return the slot index, or SIZE_MAX if key is not mapped.
+ */
+static size_t _lookup(hm_HashMap *hm, const void *key, size_t hash, HashTable **table);
+
+/**
+ * @brief Find the first empty or deleted slot on the probe sequence of hash.
+ *
+ * @param table  pointer to table, with at least one empty slot.
+ * @param hash   the mixed hash.
+ * @return the slot index.
+ */
+static size_t _find_free(const HashTable *table, size_t hash);
+
+/**
+ * @brief Set the control byte of slot i, and its mirror past the end.
+ */
+static inline void _set_ctrl(HashTable *table, size_t i, int8_t h);
+
+/**
+ * @brief Free slot i of table, leaving a tombstone only if a probe may
+ * have gone past it.
+ */
+static void _erase_slot(HashTable *table, size_t i);
+
+/**
+ * @brief Entries a table of capacity slots holds before growing.
+ */
+static size_t _max_entries(const hm_HashMap *hm, size_t capacity);
+
+/**
+ * @brief Allocate an empty table of capacity slots.
+ */
+static void _alloc_table(const hm_HashMap *hm, HashTable *table, size_t capacity);
+
+/**
+ * @brief Release the storage of a table and mark it unallocated.
+ */
+static void _free_table(HashTable *table);
+
+/**
+ * @brief Move all entries into a new table of capacity slots, dropping
+ * the deleted ones. Finishes an incremental resize first.
+ *
+ * @param hm        pointer to hash map.
+ * @param capacity  power of two, large enough for every entry.
+ */
+static void _rehash(hm_HashMap *hm, size_t capacity);
+
+/**
+ * @brief Move up to n slots of the old table into the current one, and
+ * free the old table once it is empty.
+ *
+ * @param hm  pointer to hash map.
+ * @param n   the number of slots, SIZE_MAX to finish.
+ */
+static void _rehash_step(hm_HashMap *hm, size_t n);
+
+/**
+ * @brief Make room for one more entry, growing the table or clearing
+ * out deleted slots, all at once or incrementally.
+ *
+ * @param hm  pointer to hash map.
+ */
+static void _grow(hm_HashMap *hm);
+
+/**
+ * @brief Call visit on the entries of a table.
+ *
+ * @return false if visit stopped the walk, true if not.
+ */
+static bool _visit_table(HashTable *table, hm_EntryVisit visit, void *ctx);
+
+/**
+ * @brief Destroy the entries of a table.
+ */
+static void _destroy_entries(HashTable *table, hm_ElemDtor key_dtor, hm_ElemDtor value_dtor);
+
+/**
+ * @brief Destroy a key or value with dtor, or free it.
+ */
+static void _destroy_element(void *elem, hm_ElemDtor dtor);
+
+/**
+ * @brief Shard of a concurrent mode map that holds hash.
+ */
+static inline Shard *_shard(const hm_HashMap *hm, size_t hash);
+
+/**
+ * @brief Find the slot holding key in a published table, without locking.
+ *
+ * @param hm     pointer to hash map.
+ * @param table  pointer to table, protected by the caller's epoch.
+ * @param key    the key.
+ * @param hash   the mixed hash of key.
+ * @return the slot index, or SIZE_MAX if key is not in the table.
+ */
+static size_t _find_published(const hm_HashMap *hm, const HashTable *table, const void *key,
+                              size_t hash);
+
+/**
+ * @brief Find the first empty slot on the probe sequence of hash,
+ * passing over deleted ones.
+ *
+ * @param table  pointer to table, with at least one empty slot.
+ * @param hash   the mixed hash.
+ * @return the slot index.
+ */
+static size_t _find_empty(const HashTable *table, size_t hash);
+
+/**
+ * @brief Publish the control byte of slot i, and its mirror past the end.
+ */
+static inline void _set_ctrl_release(HashTable *table, size_t i, int8_t h);
+
+/**
+ * @brief Concurrent mode hm_put, locks the shard of key.
+ */
+static int _concurrent_put(hm_HashMap *hm, const void *key, const void *value,
+                           hm_ElemDtor dtor, size_t hash);
+
+/**
+ * @brief Concurrent mode lookup, takes no lock.
+ *
+ * @param hm     pointer to hash map.
+ * @param key    the key.
+ * @param hash   the mixed hash of key.
+ * @param value  set to the value if key is mapped, may be NULL.
+ * @return true if key is mapped, false if not.
+ */
+static bool _concurrent_get(hm_HashMap *hm, const void *key, size_t hash, void **value);
+
+/**
+ * @brief Concurrent mode hm_remove, locks the shard of key.
+ */
+static int _concurrent_remove(hm_HashMap *hm, const void *key, hm_ElemDtor key_dtor,
+                              hm_ElemDtor value_dtor, size_t hash);
+
+/**
+ * @brief Copy the entries of a shard into a new table of capacity slots,
+ * dropping the deleted ones, and publish it. Shard locked.
+ *
+ * @param hm        pointer to hash map.
+ * @param shard     pointer to shard.
+ * @param capacity  power of two, large enough for every entry.
+ */
+static void _concurrent_rehash(hm_HashMap *hm, Shard *shard, size_t capacity);
+
+/**
+ * @brief Free a HashTable and its storage, as a retired element dtor.
+ */
+static void _free_table_block(void *table);
+
+
+hm_HashMap *hm_init(hm_KeyHash hash, hm_KeyCompare comp)
+{
+    return hm_init_with_capacity(hash, comp, 0);
+}
+
+hm_HashMap *hm_init_with_capacity(hm_KeyHash hash, hm_KeyCompare comp, size_t capacity)
+{
+    hm_HashMap *hm = NULL;
+
+    assert(hash);
+    assert(comp);
+
+    hm = (hm_HashMap*)calloc(1, sizeof *hm);
+    assert(hm);
+    hm->incremental = false;
+    hm->max_load = hm_DEFAULT_MAX_LOAD;
+    hm->hash = hash;
+    hm->comp = comp;
+    #ifdef SYNC
+        if (pthread_mutex_init(&hm->mutex, NULL) != 0) {
+            int errnum = errno;
+            #ifdef ALGOS_DEBUG
+                fprintf(stderr, "%s() error: unable to initialize mutex. errorcode: %d\n",
+                        FUNC, errnum);
+            #endif
+            (void)errnum;
+            free(hm);
+            return NULL;
+        }
+    #endif
+    if (capacity > 0)
+        hm_reserve(hm, capacity);
+    return hm;
+}
+
+hm_HashMap *hm_init_concurrent(hm_KeyHash hash, hm_KeyCompare comp, size_t nshards)
+{
+    hm_HashMap *hm = hm_init(hash, comp);
+    size_t count = 1, i;
+
+    if (!hm)
+        return NULL;
+    if (nshards == 0)
+        nshards = hm_DEFAULT_SHARDS;
+    while (count < nshards && count < ((size_t)1 << HM_SHARD_BITS))
+        count *= 2;
+
+    hm->shards = (Shard*)aligned_alloc(CACHE_LINE_SIZE, count * sizeof *hm->shards);
+    assert(hm->shards);
+    memset(hm->shards, 0, count * sizeof *hm->shards);
+    hm->shard_mask = count - 1;
+    for (i = 0; i < count; ++i) {
+        Shard *shard = &hm->shards[i];
+        if (pthread_mutex_init(&shard->mutex, NULL) != 0) {
+            int errnum = errno;
+            #ifdef ALGOS_DEBUG
+                fprintf(stderr, "%s() error: unable to initialize mutex. errorcode: %d\n",
+                        FUNC, errnum);
+            #endif
+            (void)errnum;
+            while (i-- > 0) {
+                pthread_mutex_destroy(&hm->shards[i].mutex);
+                _free_table_block(hm->shards[i].table);
+            }
+            free(hm->shards);
+            hm->shards = NULL;
+            hm_destroy(hm, NULL, NULL);
+            return NULL;
+        }
+        shard->table = (HashTable*)calloc(1, sizeof *shard->table);
+        assert(shard->table);
+        _alloc_table(hm, shard->table, HM_MIN_CAPACITY);
+    }
+    return hm;
+}
+
+void hm_destroy(hm_HashMap *hm, hm_ElemDtor key_dtor, hm_ElemDtor value_dtor)
+{
+    size_t i;
+
+    assert(hm);
+    _destroy_entries(&hm->table, key_dtor, value_dtor);
+    _destroy_entries(&hm->old, key_dtor, value_dtor);
+    if (hm->shards) {
+        for (i = 0; i <= hm->shard_mask; ++i) {
+            Shard *shard = &hm->shards[i];
+            _destroy_entries(shard->table, key_dtor, value_dtor);
+            _free_table_block(shard->table);
+            ep_destroy(&shard->ep);
+            pthread_mutex_destroy(&shard->mutex);
+        }
+        free(hm->shards);
+    }
+    #ifdef SYNC
+        if (pthread_mutex_destroy(&hm->mutex) != 0) {
+            int errnum = errno;
+            #ifdef ALGOS_DEBUG
+                fprintf(stderr, "%s() error: unable to destroy mutex. errorcode: %d\n",
+                        FUNC, errnum);
+            #endif
+            (void)errnum;
+        }
+    #endif
+    _free_table(&hm->table);
+    _free_table(&hm->old);
+    free(hm);
+}
+
+int hm_set_max_load(hm_HashMap *hm, double max_load)
+{
+    HashTable *table = NULL;
+
+    assert(hm);
+    if (!(max_load > 0.0 && max_load < 1.0)) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: max_load is out of range\n", FUNC);
+        #endif
+        return ERROR;
+    }
+
+    #ifdef SYNC
+        ll_LOCK(&hm->mutex);
+    #endif
+
+    _rehash_step(hm, SIZE_MAX);
+    table = &hm->table;
+    hm->max_load = max_load;
+    if (hm->shards) {
+        size_t i;
+        for (i = 0; i <= hm->shard_mask; ++i) {
+            Shard *shard = &hm->shards[i];
+            size_t capacity;
+            pthread_mutex_lock(&shard->mutex);
+            capacity = shard->table->capacity;
+            while (_max_entries(hm, capacity) < shard->table->size + 1)
+                capacity *= 2;
+            _concurrent_rehash(hm, shard, capacity);
+            pthread_mutex_unlock(&shard->mutex);
+        }
+    } else if (table->capacity > 0) {
+        size_t capacity = table->capacity;
+        /* grow until the entries fit under the new load factor */
+        while (_max_entries(hm, capacity) < table->size + 1)
+            capacity *= 2;
+        _rehash(hm, capacity);
+    }
+
+    #ifdef SYNC
+        ll_UNLOCK(&hm->mutex);
+    #endif
+    return SUCCESS;
+}
+
+void hm_set_incremental(hm_HashMap *hm, bool enable)
+{
+    assert(hm);
+    #ifdef SYNC
+        ll_LOCK(&hm->mutex);
+    #endif
+    if (!enable)
+        _rehash_step(hm, SIZE_MAX);
+    hm->incremental = enable;
+    #ifdef SYNC
+        ll_UNLOCK(&hm->mutex);
+    #endif
+}
+
+int hm_reserve(hm_HashMap *hm, size_t n)
+{
+    size_t capacity = HM_MIN_CAPACITY;
+
+    assert(hm);
+    #ifdef SYNC
+        ll_LOCK(&hm->mutex);
+    #endif
+
+    if (hm->shards) {
+        size_t i;
+        /* hashes spread evenly over the shards */
+        n = (n + hm->shard_mask) / (hm->shard_mask + 1);
+        while (_max_entries(hm, capacity) < n)
+            capacity *= 2;
+        for (i = 0; i <= hm->shard_mask; ++i) {
+            Shard *shard = &hm->shards[i];
+            pthread_mutex_lock(&shard->mutex);
+            if (capacity > shard->table->capacity)
+                _concurrent_rehash(hm, shard, capacity);
+            pthread_mutex_unlock(&shard->mutex);
+        }
+    } else {
+        while (_max_entries(hm, capacity) < n)
+            capacity *= 2;
+        if (capacity > hm->table.capacity)
+            _rehash(hm, capacity);
+    }
+
+    #ifdef SYNC
+        ll_UNLOCK(&hm->mutex);
+    #endif
+    return SUCCESS;
+}
+
+int hm_put(hm_HashMap *hm, const void *key, const void *value, hm_ElemDtor dtor)
+{
+    HashTable *table = NULL;
+    size_t hash, i;
+
+    assert(hm);
+    hash = _mix(hm->hash(key));
+    if (hm->shards)
+        return _concurrent_put(hm, key, value, dtor, hash);
+
+    #ifdef SYNC
+        ll_LOCK(&hm->mutex);
+    #endif
+
+    if (hm->old.capacity > 0)
+        _rehash_step(hm, HM_REHASH_STEP);
+
+    i = _lookup(hm, key, hash, &table);
+    if (i != SIZE_MAX) {
+        _destroy_element(table->slots[i].value, dtor);
+        table->slots[i].value = CONST_CAST(void*, value);
+    } else {
+        table = &hm->table;
+        i = _find_free(table, hash);
+        /* reusing a deleted slot costs no growth */
+        if (table->capacity == 0 || (table->growth_left == 0 && table->ctrl[i] == HM_EMPTY)) {
+            _grow(hm);
+            i = _find_free(table, hash);
+        }
+        if (table->ctrl[i] == HM_EMPTY)
+            table->growth_left--;
+        _set_ctrl(table, i, HM_FULL(hash));
+        table->slots[i].key = CONST_CAST(void*, key);
+        table->slots[i].value = CONST_CAST(void*, value);
+        table->size++;
+    }
+
+    #ifdef SYNC
+        ll_UNLOCK(&hm->mutex);
+    #endif
+    return SUCCESS;
+}
+
+void *hm_get(hm_HashMap *hm, const void *key)
+{
+    HashTable *table = NULL;
+    void *value = NULL;
+    size_t hash, i;
+
+    assert(hm);
+    hash = _mix(hm->hash(key));
+    if (hm->shards) {
+        _concurrent_get(hm, key, hash, &value);
+        return value;
+    }
+
+    #ifdef SYNC
+        ll_LOCK(&hm->mutex);
+    #endif
+    if (hm->old.capacity > 0)
+        _rehash_step(hm, HM_REHASH_STEP);
+    i = _lookup(hm, key, hash, &table);
+    if (i != SIZE_MAX)
+        value = table->slots[i].value;
+    #ifdef SYNC
+        ll_UNLOCK(&hm->mutex);
+    #endif
+    return value;
+}
+
+bool hm_contains(hm_HashMap *hm, const void *key)
+{
+    HashTable *table = NULL;
+    size_t hash, i;
+
+    assert(hm);
+    hash = _mix(hm->hash(key));
+    if (hm->shards)
+        return _concurrent_get(hm, key, hash, NULL);
+
+    #ifdef SYNC
+        ll_LOCK(&hm->mutex);
+    #endif
+    if (hm->old.capacity > 0)
+        _rehash_step(hm, HM_REHASH_STEP);
+    i = _lookup(hm, key, hash, &table);
+    #ifdef SYNC
+        ll_UNLOCK(&hm->mutex);
+    #endif
+    return i != SIZE_MAX;
+}
+
+int hm_remove(hm_HashMap *hm, const void *key, hm_ElemDtor key_dtor, hm_ElemDtor value_dtor)
+{
+    HashTable *table = NULL;
+    size_t hash, i;
+
+    assert(hm);
+    hash = _mix(hm->hash(key));
+    if (hm->shards)
+        return _concurrent_remove(hm, key, key_dtor, value_dtor, hash);
+
+    #ifdef SYNC
+        ll_LOCK(&hm->mutex);
+    #endif
+
+    if (hm->old.capacity > 0)
+        _rehash_step(hm, HM_REHASH_STEP);
+
+    i = _lookup(hm, key, hash, &table);
+    if (i == SIZE_MAX) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: key not found\n", FUNC);
+        #endif
+        #ifdef SYNC
+            ll_UNLOCK(&hm->mutex);
+        #endif
+        return NOTFOUND;
+    }
+
+    _destroy_element(table->slots[i].key, key_dtor);
+    _destroy_element(table->slots[i].value, value_dtor);
+    _erase_slot(table, i);
+
+    #ifdef SYNC
+        ll_UNLOCK(&hm->mutex);
+    #endif
+    return SUCCESS;
+}
+
+void hm_foreach(hm_HashMap *hm, hm_EntryVisit visit, void *ctx)
+{
+    assert(hm);
+    assert(visit);
+
+    if (hm->shards) {
+        bool more = true;
+        size_t i;
+        for (i = 0; i <= hm->shard_mask && more; ++i) {
+            Shard *shard = &hm->shards[i];
+            pthread_mutex_lock(&shard->mutex);
+            more = _visit_table(shard->table, visit, ctx);
+            pthread_mutex_unlock(&shard->mutex);
+        }
+        return;
+    }
+
+    #ifdef SYNC
+        ll_LOCK(&hm->mutex);
+    #endif
+    if (_visit_table(&hm->table, visit, ctx))
+        _visit_table(&hm->old, visit, ctx);
+    #ifdef SYNC
+        ll_UNLOCK(&hm->mutex);
+    #endif
+}
+
+size_t hm_getsize(hm_HashMap *hm)
+{
+    size_t size;
+
+    assert(hm);
+    if (hm->shards) {
+        size_t i;
+        for (size = 0, i = 0; i <= hm->shard_mask; ++i)
+            size += __atomic_load_n(&hm->shards[i].size, __ATOMIC_RELAXED);
+        return size;
+    }
+
+    #ifdef SYNC
+        ll_LOCK(&hm->mutex);
+    #endif
+    size = hm->table.size + hm->old.size;
+    #ifdef SYNC
+        ll_UNLOCK(&hm->mutex);
+    #endif
+    return size;
+}
+
+size_t hm_getcapacity(hm_HashMap *hm)
+{
+    size_t capacity;
+
+    assert(hm);
+    if (hm->shards) {
+        size_t i;
+        for (capacity = 0, i = 0; i <= hm->shard_mask; ++i) {
+            Shard *shard = &hm->shards[i];
+            unsigned long epoch = ep_enter(&shard->ep);
+            HashTable *table = __atomic_load_n(&shard->table, __ATOMIC_ACQUIRE);
+            capacity += table->capacity;
+            ep_exit(&shard->ep, epoch);
+        }
+        return capacity;
+    }
+
+    #ifdef SYNC
+        ll_LOCK(&hm->mutex);
+    #endif
+    capacity = hm->table.capacity;
+    #ifdef SYNC
+        ll_UNLOCK(&hm->mutex);
+    #endif
+    return capacity;
+}
+
+bool hm_isempty(hm_HashMap *hm)
+{
+    return hm_getsize(hm) == 0;
+}
+
+static inline size_t _mix(size_t hash)
+{
+    /* murmur3 fmix64 */
+    uint64_t x = hash;
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return (size_t)x;
+}
+
+static inline unsigned _group_match(const int8_t *ctrl, int8_t h)
+{
+    #ifdef __SSE2__
+        __m128i group = _mm_loadu_si128((const __m128i*)ctrl);
+        return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(h)));
+    #else
+        unsigned mask = 0;
+        int i;
+        for (i = 0; i < HM_GROUP_WIDTH; ++i)
+            mask |= (unsigned)(ctrl[i] == h) << i;
+        return mask;
+    #endif
+}
+
+static inline unsigned _group_match_free(const int8_t *ctrl)
+{
+    /* full slots are the only negative control bytes */
+    #ifdef __SSE2__
+        return ~(unsigned)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)ctrl)) & 0xffff;
+    #else
+        unsigned mask = 0;
+        int i;
+        for (i = 0; i < HM_GROUP_WIDTH; ++i)
+            mask |= (unsigned)(ctrl[i] >= 0) << i;
+        return mask;
+    #endif
+}
+
+static size_t _find(const hm_HashMap *hm, const HashTable *table, const void *key,
+                    size_t hash)
+{
+    size_t mask = table->capacity - 1;
+    size_t pos, step = 0;
+    int8_t h2 = HM_FULL(hash);
+
+    if (table->capacity == 0)
+        return SIZE_MAX;
+
+    /* triangular steps over groups reach every group of a power of two table */
+    for (pos = (hash >> 7) & mask;; pos = (pos + step) & mask) {
+        unsigned match = _group_match(table->ctrl + pos, h2);
+        while (match) {
+            size_t i = (pos + __builtin_ctz(match)) & mask;
+            if (hm->comp(table->slots[i].key, key) == 0)
+                return i;
+            match &= match - 1;
+        }
+        if (_group_match(table->ctrl + pos, HM_EMPTY))
+            return SIZE_MAX;
+        step += HM_GROUP_WIDTH;
+    }
+}
+
+static size_t _lookup(hm_HashMap *hm, const void *key, size_t hash, HashTable **table)
+{
+    size_t i = _find(hm, &hm->table, key, hash);
+
+    *table = &hm->table;
+    if (i == SIZE_MAX && hm->old.capacity > 0) {
+        i = _find(hm, &hm->old, key, hash);
+        *table = &hm->old;
+    }
+    return i;
+}
+
+static size_t _find_free(const HashTable *table, size_t hash)
+{
+    size_t mask = table->capacity - 1;
+    size_t pos, step = 0;
+
+    if (table->capacity == 0)
+        return 0;
+
+    for (pos = (hash >> 7) & mask;; pos = (pos + step) & mask) {
+        unsigned match = _group_match_free(table->ctrl + pos);
+        if (match)
+            return (pos + __builtin_ctz(match)) & mask;
+        step += HM_GROUP_WIDTH;
+    }
+}
+
+static inline void _set_ctrl(HashTable *table, size_t i, int8_t h)
+{
+    table->ctrl[i] = h;
+    if (i < HM_GROUP_WIDTH)
+        table->ctrl[table->capacity + i] = h;
+}
+
+static void _erase_slot(HashTable *table, size_t i)
+{
+    size_t before = (i - HM_GROUP_WIDTH) & (table->capacity - 1);
+    unsigned empty_before = _group_match(table->ctrl + before, HM_EMPTY);
+    unsigned empty_after = _group_match(table->ctrl + i, HM_EMPTY);
+
+    table->size--;
+
+    /*
+     * a probe only moves past a group with no empty slot. if every
+     * group window around i has one, no probe went past i and the slot
+     * can be empty again; otherwise it must stay a tombstone.
+     */
+    if (empty_before && empty_after &&
+        (size_t)(__builtin_ctz(empty_after) + __builtin_clz(empty_before) - 16) < HM_GROUP_WIDTH) {
+        _set_ctrl(table, i, HM_EMPTY);
+        table->growth_left++;
+    } else {
+        _set_ctrl(table, i, HM_DELETED);
+    }
+}
+
+static size_t _max_entries(const hm_HashMap *hm, size_t capacity)
+{
+    size_t max = (size_t)(capacity * hm->max_load);
+    /* keep an empty slot so probes end */
+    return (max < capacity) ? max : capacity - 1;
+}
+
+static void _alloc_table(const hm_HashMap *hm, HashTable *table, size_t capacity)
+{
+    table->capacity = capacity;
+    /* large zeroed blocks come straight from the kernel, no pass over them */
+    table->ctrl = (int8_t*)calloc(capacity + HM_GROUP_WIDTH, sizeof *table->ctrl);
+    assert(table->ctrl);
+    table->slots = (HashSlot*)malloc(capacity * sizeof *table->slots);
+    assert(table->slots);
+    table->size = 0;
+    table->growth_left = _max_entries(hm, capacity);
+}
+
+static void _free_table(HashTable *table)
+{
+    free(table->ctrl);
+    free(table->slots);
+    memset(table, 0, sizeof *table);
+}
+
+static void _rehash(hm_HashMap *hm, size_t capacity)
+{
+    _rehash_step(hm, SIZE_MAX);
+    hm->old = hm->table;
+    hm->rehash_pos = 0;
+    _alloc_table(hm, &hm->table, capacity);
+    _rehash_step(hm, SIZE_MAX);
+}
+
+static void _rehash_step(hm_HashMap *hm, size_t n)
+{
+    HashTable *old = &hm->old;
+    HashTable *table = &hm->table;
+    size_t end;
+
+    if (old->capacity == 0)
+        return;
+
+    end = (n < old->capacity - hm->rehash_pos) ? hm->rehash_pos + n : old->capacity;
+    for (; hm->rehash_pos < end; ++hm->rehash_pos) {
+        size_t i = hm->rehash_pos;
+        if (old->ctrl[i] < 0) {
+            size_t hash = _mix(hm->hash(old->slots[i].key));
+            size_t j = _find_free(table, hash);
+            if (table->ctrl[j] == HM_EMPTY) {
+                assert(table->growth_left > 0);
+                table->growth_left--;
+            }
+            _set_ctrl(table, j, HM_FULL(hash));
+            table->slots[j] = old->slots[i];
+            table->size++;
+            /* a tombstone keeps probes for the old slots behind it going */
+            _set_ctrl(old, i, HM_DELETED);
+            old->size--;
+        }
+    }
+    if (hm->rehash_pos == old->capacity)
+        _free_table(old);
+}
+
+static void _grow(hm_HashMap *hm)
+{
+    HashTable *table = &hm->table;
+    size_t capacity = (table->capacity > 0) ? table->capacity : HM_MIN_CAPACITY;
+    size_t size;
+
+    /* the new table filled up before the old one emptied */
+    _rehash_step(hm, SIZE_MAX);
+    if (table->growth_left > 0)
+        return;
+
+    /* mostly tombstones, clearing them out makes enough room */
+    size = table->size;
+    if (table->capacity > 0 && size + 1 > _max_entries(hm, capacity) / 2)
+        capacity *= 2;
+    while (_max_entries(hm, capacity) < size + 1)
+        capacity *= 2;
+
+    if (!hm->incremental || table->capacity == 0) {
+        _rehash(hm, capacity);
+        return;
+    }
+
+    /*
+     * move the entries over a few at a time from the next operations on.
+     * every operation moves HM_REHASH_STEP old slots and uses at most one
+     * slot of the new table, so leave room for that many besides the
+     * entries; at the default load doubling already does.
+     */
+    while (_max_entries(hm, capacity) < size + 1 + table->capacity / HM_REHASH_STEP + 1)
+        capacity *= 2;
+    hm->old = *table;
+    hm->rehash_pos = 0;
+    _alloc_table(hm, table, capacity);
+    _rehash_step(hm, HM_REHASH_STEP);
+}
+
+static bool _visit_table(HashTable *table, hm_EntryVisit visit, void *ctx)
+{
+    size_t pos;
+
+    for (pos = 0; pos < table->capacity; pos += HM_GROUP_WIDTH) {
+        unsigned full = ~_group_match_free(table->ctrl + pos) & 0xffff;
+        while (full) {
+            HashSlot *slot = &table->slots[pos + __builtin_ctz(full)];
+            if (!visit(slot->key, slot->value, ctx))
+                return false;
+            full &= full - 1;
+        }
+    }
+    return true;
+}
+
+static void _destroy_entries(HashTable *table, hm_ElemDtor key_dtor, hm_ElemDtor value_dtor)
+{
+    size_t i;
+
+    for (i = 0; i < table->capacity; ++i) {
+        if (table->ctrl[i] < 0) {
+            _destroy_element(table->slots[i].key, key_dtor);
+            _destroy_element(table->slots[i].value, value_dtor);
+        }
+    }
+}
+
+static void _destroy_element(void *elem, hm_ElemDtor dtor)
+{
+    if (dtor)
+        dtor(elem);
+    else
+        free(elem);
+}
+
+static inline Shard *_shard(const hm_HashMap *hm, size_t hash)
+{
+    /* the table position comes from the low bits, keep the two apart */
+    return &hm->shards[(hash >> (sizeof(size_t) * 8 - HM_SHARD_BITS)) & hm->shard_mask];
+}
+
+static size_t _find_published(const hm_HashMap *hm, const HashTable *table, const void *key,
+                              size_t hash)
+{
+    size_t mask = table->capacity - 1;
+    size_t pos, step = 0;
+    int8_t h2 = HM_FULL(hash);
+
+    for (pos = (hash >> 7) & mask;; pos = (pos + step) & mask) {
+        unsigned match = _group_match(table->ctrl + pos, h2);
+        /* pairs with _set_ctrl_release, a full byte comes after its key */
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        while (match) {
+            size_t i = (pos + __builtin_ctz(match)) & mask;
+            if (hm->comp(__atomic_load_n(&table->slots[i].key, __ATOMIC_RELAXED), key) == 0)
+                return i;
+            match &= match - 1;
+        }
+        if (_group_match(table->ctrl + pos, HM_EMPTY))
+            return SIZE_MAX;
+        step += HM_GROUP_WIDTH;
+    }
+}
+
+static size_t _find_empty(const HashTable *table, size_t hash)
+{
+    size_t mask = table->capacity - 1;
+    size_t pos, step = 0;
+
+    for (pos = (hash >> 7) & mask;; pos = (pos + step) & mask) {
+        unsigned match = _group_match(table->ctrl + pos, HM_EMPTY);
+        if (match)
+            return (pos + __builtin_ctz(match)) & mask;
+        step += HM_GROUP_WIDTH;
+    }
+}
+
+static inline void _set_ctrl_release(HashTable *table, size_t i, int8_t h)
+{
+    __atomic_store_n(&table->ctrl[i], h, __ATOMIC_RELEASE);
+    if (i < HM_GROUP_WIDTH)
+        __atomic_store_n(&table->ctrl[table->capacity + i], h, __ATOMIC_RELEASE);
+}
+
+static int _concurrent_put(hm_HashMap *hm, const void *key, const void *value,
+                           hm_ElemDtor dtor, size_t hash)
+{
+    Shard *shard = _shard(hm, hash);
+    HashTable *table = NULL;
+    size_t i;
+
+    pthread_mutex_lock(&shard->mutex);
+
+    table = shard->table;
+    i = _find(hm, table, key, hash);
+    if (i != SIZE_MAX) {
+        void *old = table->slots[i].value;
+        __atomic_store_n(&table->slots[i].value, CONST_CAST(void*, value), __ATOMIC_RELEASE);
+        ep_retire(&shard->ep, old, dtor);
+    } else {
+        /* deleted slots are not reused in place, a reader may be reading them */
+        if (table->growth_left == 0) {
+            size_t capacity = table->capacity;
+            if (table->size + 1 > _max_entries(hm, capacity) / 2)
+                capacity *= 2;
+            _concurrent_rehash(hm, shard, capacity);
+            table = shard->table;
+        }
+        i = _find_empty(table, hash);
+        __atomic_store_n(&table->slots[i].key, CONST_CAST(void*, key), __ATOMIC_RELAXED);
+        __atomic_store_n(&table->slots[i].value, CONST_CAST(void*, value), __ATOMIC_RELAXED);
+        _set_ctrl_release(table, i, HM_FULL(hash));
+        table->growth_left--;
+        table->size++;
+        __atomic_store_n(&shard->size, shard->size + 1, __ATOMIC_RELAXED);
+    }
+
+    pthread_mutex_unlock(&shard->mutex);
+    return SUCCESS;
+}
+
+static bool _concurrent_get(hm_HashMap *hm, const void *key, size_t hash, void **value)
+{
+    Shard *shard = _shard(hm, hash);
+    unsigned long epoch = ep_enter(&shard->ep);
+    HashTable *table = __atomic_load_n(&shard->table, __ATOMIC_ACQUIRE);
+    size_t i = _find_published(hm, table, key, hash);
+
+    if (i != SIZE_MAX && value)
+        *value = __atomic_load_n(&table->slots[i].value, __ATOMIC_ACQUIRE);
+    ep_exit(&shard->ep, epoch);
+    return i != SIZE_MAX;
+}
+
+static int _concurrent_remove(hm_HashMap *hm, const void *key, hm_ElemDtor key_dtor,
+                              hm_ElemDtor value_dtor, size_t hash)
+{
+    Shard *shard = _shard(hm, hash);
+    HashTable *table = NULL;
+    size_t i;
+
+    pthread_mutex_lock(&shard->mutex);
+
+    table = shard->table;
+    i = _find(hm, table, key, hash);
+    if (i == SIZE_MAX) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: key not found\n", FUNC);
+        #endif
+        pthread_mutex_unlock(&shard->mutex);
+        return NOTFOUND;
+    }
+
+    /* always a tombstone, an empty slot would be filled again in place */
+    _set_ctrl_release(table, i, HM_DELETED);
+    table->size--;
+    __atomic_store_n(&shard->size, shard->size - 1, __ATOMIC_RELAXED);
+    ep_retire(&shard->ep, table->slots[i].key, key_dtor);
+    ep_retire(&shard->ep, table->slots[i].value, value_dtor);
+
+    pthread_mutex_unlock(&shard->mutex);
+    return SUCCESS;
+}
+
+static void _concurrent_rehash(hm_HashMap *hm, Shard *shard, size_t capacity)
+{
+    HashTable *old = shard->table;
+    HashTable *table = (HashTable*)malloc(sizeof *table);
+    size_t i;
+
+    assert(table);
+    _alloc_table(hm, table, capacity);
+    /* readers keep using the old table until the new one is published */
+    for (i = 0; i < old->capacity; ++i) {
+        if (old->ctrl[i] < 0) {
+            size_t hash = _mix(hm->hash(old->slots[i].key));
+            size_t j = _find_empty(table, hash);
+            _set_ctrl(table, j, HM_FULL(hash));
+            table->slots[j] = old->slots[i];
+            table->growth_left--;
+            table->size++;
+        }
+    }
+
+    __atomic_store_n(&shard->table, table, __ATOMIC_RELEASE);
+    ep_retire(&shard->ep, old, _free_table_block);
+}
+
+static void _free_table_block(void *table)
+{
+    _free_table((HashTable*)table);
+    free(table);
+}
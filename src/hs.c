@@ -1 +1,1011 @@
+#include <assert.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fl.h"
 #include "hs.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/* slots whose control bytes one probe step compares */
+#define HS_GROUP_WIDTH   16
+/* smallest table, one group */
+#define HS_MIN_CAPACITY  HS_GROUP_WIDTH
+/* elements hashed and prefetched ahead by the bulk adds */
+#define HS_BATCH         16
+
+/* control bytes, as in hm.c: empty is zero, full is 0x80 | 7 hash bits */
+#define HS_EMPTY    ((int8_t)0)
+#define HS_DELETED  ((int8_t)1)
+#define HS_FULL(h)  ((int8_t)(0x80 | ((h) & 0x7f)))
+
+#define HS_INLINE   static inline __attribute__((always_inline))
+
+struct _hashset {
+    int8_t *ctrl;           /* capacity + HS_GROUP_WIDTH bytes, the tail mirrors the head */
+    uint64_t *slots;        /* values of an integer set, element pointers otherwise */
+    size_t capacity;        /* power of two, 0 until the first add */
+    size_t size;
+    size_t growth_left;     /* adds into empty slots before the next resize */
+    bool ints;              /* integer set */
+    hs_ElemHash hash;
+    hs_ElemCompare comp;
+    hs_FilterKind filter;
+    double filter_fpr;
+    fl_Bloom *bloom;        /* the filter of kind filter, NULL for the other kind */
+    fl_Cuckoo *cuckoo;
+    size_t filter_keys;     /* keys the filter was sized for */
+    size_t filter_left;     /* adds before the filter is rebuilt */
+    #ifdef SYNC
+        pthread_mutex_t mutex;
+    #endif
+};
+
+/**
+ * @brief Allocate a set with no table.
+ *
+ * @param hash  element hash function pointer, NULL for an integer set.
+ * @param comp  element compare function pointer, NULL for an integer set.
+ * @return a hash set object, or NULL if the mutex cannot be set up.
+ */
+static hs_HashSet *_alloc_set(hs_ElemHash hash, hs_ElemCompare comp);
+
+/**
+ * @brief Finalize a hash so all its bits depend on all input bits.
+ */
+static inline size_t _mix(size_t hash);
+
+/**
+ * @brief Mixed hash of a slot value.
+ */
+HS_INLINE size_t _hash(const hs_HashSet *hs, uint64_t elem, bool ints);
+
+/**
+ * @brief Check if two slot values are equal elements.
+ */
+HS_INLINE bool _equal(const hs_HashSet *hs, uint64_t a, uint64_t b, bool ints);
+
+/**
+ * @brief Bit mask of the slots in the group at ctrl whose byte is h.
+ */
+static inline unsigned _group_match(const int8_t *ctrl, int8_t h);
+
+/**
+ * @brief Bit mask of the empty or deleted slots in the group at ctrl.
+ */
+static inline unsigned _group_match_free(const int8_t *ctrl);
+
+/**
+ * @brief Find the slot holding elem.
+ *
+ * Inlined with a constant ints, so the integer set probe compares the
+ * values in place.
+ *
+ * @param hs    pointer to hash set.
+ * @param elem  the slot value.
+ * @param hash  the mixed hash of elem.
+ * @param ints  hs is an integer set.
+ * @return the slot index, or SIZE_MAX if elem is not in the set.
+ */
+HS_INLINE size_t _find(const hs_HashSet *hs, uint64_t elem, size_t hash, bool ints);
+
+/**
+ * @brief _find behind the filter of the set, if any.
+ */
+HS_INLINE size_t _lookup(const hs_HashSet *hs, uint64_t elem, size_t hash, bool ints);
+
+/**
+ * @brief Find the first empty or deleted slot on the probe sequence of hash.
+ */
+static size_t _find_free(const hs_HashSet *hs, size_t hash);
+
+/**
+ * @brief Set the control byte of slot i, and its mirror past the end.
+ */
+static inline void _set_ctrl(hs_HashSet *hs, size_t i, int8_t h);
+
+/**
+ * @brief Add elem unless an equal element is in the set, growing if full.
+ *
+ * @return true if added, false if not.
+ */
+HS_INLINE bool _insert(hs_HashSet *hs, uint64_t elem, size_t hash, bool ints);
+
+/**
+ * @brief Add an element known not to be in the set, with room reserved.
+ */
+static void _insert_unique(hs_HashSet *hs, uint64_t elem, size_t hash);
+
+/**
+ * @brief Shared body of hs_add_many and hs_add_many_int.
+ *
+ * Hashes a batch of elements and prefetches their first groups before
+ * inserting any, so the cache misses of a batch overlap.
+ *
+ * @param hs     pointer to hash set.
+ * @param elems  uint64_t values of an integer set, element pointers otherwise.
+ * @param n      the number of elements.
+ * @param ints   hs is an integer set.
+ * @return the number of elements added.
+ */
+HS_INLINE size_t _add_many(hs_HashSet *hs, const void *elems, size_t n, bool ints);
+
+/**
+ * @brief Free slot i, leaving a tombstone only if a probe may have gone
+ * past it.
+ */
+static void _erase(hs_HashSet *hs, size_t i);
+
+/**
+ * @brief Elements a table of capacity slots holds before growing.
+ */
+static inline size_t _max_entries(size_t capacity);
+
+/**
+ * @brief Smallest capacity that holds n elements.
+ */
+static size_t _capacity_for(size_t n);
+
+/**
+ * @brief Move all elements into a new table of capacity slots, dropping
+ * the deleted ones.
+ */
+static void _rehash(hs_HashSet *hs, size_t capacity);
+
+/**
+ * @brief Make room for n more elements, growing the table or clearing
+ * out deleted slots.
+ */
+static void _make_room(hs_HashSet *hs, size_t n);
+
+/**
+ * @brief Replace the filter with an empty one for n keys.
+ */
+static void _filter_reset(hs_HashSet *hs, size_t n);
+
+/**
+ * @brief Replace the filter with one for n keys holding every element,
+ * or for 2n if a cuckoo filter cannot take them all. Drops the filter if
+ * neither does.
+ *
+ * @return true, or false if the filter was dropped.
+ */
+static bool _filter_build(hs_HashSet *hs, size_t n);
+
+/**
+ * @brief Add a hash to the filter.
+ *
+ * @return true, or false if the filter is full and it was not added.
+ */
+static bool _filter_put(hs_HashSet *hs, size_t hash);
+
+/**
+ * @brief Add the hash of an element just stored to the filter, if any,
+ * rebuilding it once it has taken the adds it was sized for or is full.
+ */
+static inline void _filter_add(hs_HashSet *hs, size_t hash);
+
+/**
+ * @brief Check that a and b hold the same kind of elements.
+ */
+static bool _compatible(const hs_HashSet *a, const hs_HashSet *b);
+
+/**
+ * @brief New set of the same kind as src, copying its table if copy is
+ * true, else empty with room for n elements.
+ */
+static hs_HashSet *_derive(const hs_HashSet *src, bool copy, size_t n);
+
+#ifdef SYNC
+/**
+ * @brief Lock two sets in address order, once if they are the same.
+ */
+static void _lock_sets(hs_HashSet *a, hs_HashSet *b);
+
+/**
+ * @brief Unlock sets locked with _lock_sets.
+ */
+static void _unlock_sets(hs_HashSet *a, hs_HashSet *b);
+#endif
+
+
+hs_HashSet *hs_init(hs_ElemHash hash, hs_ElemCompare comp)
+{
+    assert(hash);
+    assert(comp);
+    return _alloc_set(hash, comp);
+}
+
+hs_HashSet *hs_init_int(void)
+{
+    hs_HashSet *hs = _alloc_set(NULL, NULL);
+    if (hs)
+        hs->ints = true;
+    return hs;
+}
+
+void hs_destroy(hs_HashSet *hs, hs_ElemDtor dtor)
+{
+    size_t i;
+
+    assert(hs);
+    if (!hs->ints) {
+        for (i = 0; i < hs->capacity; ++i) {
+            if (hs->ctrl[i] < 0) {
+                void *elem = (void*)(uintptr_t)hs->slots[i];
+                if (dtor)
+                    dtor(elem);
+                else
+                    free(elem);
+            }
+        }
+    }
+    #ifdef SYNC
+        if (pthread_mutex_destroy(&hs->mutex) != 0) {
+            int errnum = errno;
+            #ifdef ALGOS_DEBUG
+                fprintf(stderr, "%s() error: unable to destroy mutex. errorcode: %d\n",
+                        FUNC, errnum);
+            #endif
+            (void)errnum;
+        }
+    #endif
+    if (hs->bloom)
+        fl_bloom_destroy(hs->bloom);
+    if (hs->cuckoo)
+        fl_cuckoo_destroy(hs->cuckoo);
+    free(hs->ctrl);
+    free(hs->slots);
+    free(hs);
+}
+
+int hs_reserve(hs_HashSet *hs, size_t n)
+{
+    size_t capacity = _capacity_for(n);
+
+    assert(hs);
+    #ifdef SYNC
+        ll_LOCK(&hs->mutex);
+    #endif
+    if (capacity > hs->capacity)
+        _rehash(hs, capacity);
+    #ifdef SYNC
+        ll_UNLOCK(&hs->mutex);
+    #endif
+    return SUCCESS;
+}
+
+int hs_set_filter(hs_HashSet *hs, hs_FilterKind kind, double fpr)
+{
+    int rc = SUCCESS;
+
+    assert(hs);
+    if ((kind != hs_FILTER_NONE && !(fpr > 0.0 && fpr < 1.0)) ||
+        (kind == hs_FILTER_CUCKOO && fpr < fl_CUCKOO_MIN_FPR)) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: fpr is out of range\n", FUNC);
+        #endif
+        return ERROR;
+    }
+
+    #ifdef SYNC
+        ll_LOCK(&hs->mutex);
+    #endif
+    hs->filter = kind;
+    hs->filter_fpr = fpr;
+    if (kind == hs_FILTER_NONE)
+        _filter_reset(hs, 0);
+    else if (!_filter_build(hs, _max_entries(hs->capacity > 0 ? hs->capacity : HS_MIN_CAPACITY)))
+        rc = ERROR;
+    #ifdef SYNC
+        ll_UNLOCK(&hs->mutex);
+    #endif
+    return rc;
+}
+
+bool hs_add(hs_HashSet *hs, const void *elem)
+{
+    uint64_t e = (uintptr_t)elem;
+    bool added;
+
+    assert(hs);
+    assert(!hs->ints);
+    #ifdef SYNC
+        ll_LOCK(&hs->mutex);
+    #endif
+    added = _insert(hs, e, _hash(hs, e, false), false);
+    #ifdef SYNC
+        ll_UNLOCK(&hs->mutex);
+    #endif
+    return added;
+}
+
+size_t hs_add_many(hs_HashSet *hs, const void *const *elems, size_t n)
+{
+    size_t added;
+
+    assert(hs);
+    assert(!hs->ints);
+    #ifdef SYNC
+        ll_LOCK(&hs->mutex);
+    #endif
+    added = _add_many(hs, elems, n, false);
+    #ifdef SYNC
+        ll_UNLOCK(&hs->mutex);
+    #endif
+    return added;
+}
+
+bool hs_contains(hs_HashSet *hs, const void *elem)
+{
+    uint64_t e = (uintptr_t)elem;
+    size_t i;
+
+    assert(hs);
+    assert(!hs->ints);
+    #ifdef SYNC
+        ll_LOCK(&hs->mutex);
+    #endif
+    i = _lookup(hs, e, _hash(hs, e, false), false);
+    #ifdef SYNC
+        ll_UNLOCK(&hs->mutex);
+    #endif
+    return i != SIZE_MAX;
+}
+
+int hs_remove(hs_HashSet *hs, const void *elem, hs_ElemDtor dtor)
+{
+    uint64_t e = (uintptr_t)elem;
+    void *stored = NULL;
+    size_t i;
+
+    assert(hs);
+    assert(!hs->ints);
+    #ifdef SYNC
+        ll_LOCK(&hs->mutex);
+    #endif
+    i = _find(hs, e, _hash(hs, e, false), false);
+    if (i == SIZE_MAX) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: element not found\n", FUNC);
+        #endif
+        #ifdef SYNC
+            ll_UNLOCK(&hs->mutex);
+        #endif
+        return NOTFOUND;
+    }
+    stored = (void*)(uintptr_t)hs->slots[i];
+    _erase(hs, i);
+    #ifdef SYNC
+        ll_UNLOCK(&hs->mutex);
+    #endif
+
+    if (dtor)
+        dtor(stored);
+    else
+        free(stored);
+    return SUCCESS;
+}
+
+bool hs_add_int(hs_HashSet *hs, uint64_t value)
+{
+    bool added;
+
+    assert(hs);
+    assert(hs->ints);
+    #ifdef SYNC
+        ll_LOCK(&hs->mutex);
+    #endif
+    added = _insert(hs, value, _hash(hs, value, true), true);
+    #ifdef SYNC
+        ll_UNLOCK(&hs->mutex);
+    #endif
+    return added;
+}
+
+size_t hs_add_many_int(hs_HashSet *hs, const uint64_t *values, size_t n)
+{
+    size_t added;
+
+    assert(hs);
+    assert(hs->ints);
+    #ifdef SYNC
+        ll_LOCK(&hs->mutex);
+    #endif
+    added = _add_many(hs, values, n, true);
+    #ifdef SYNC
+        ll_UNLOCK(&hs->mutex);
+    #endif
+    return added;
+}
+
+bool hs_contains_int(hs_HashSet *hs, uint64_t value)
+{
+    size_t i;
+
+    assert(hs);
+    assert(hs->ints);
+    #ifdef SYNC
+        ll_LOCK(&hs->mutex);
+    #endif
+    i = _lookup(hs, value, _hash(hs, value, true), true);
+    #ifdef SYNC
+        ll_UNLOCK(&hs->mutex);
+    #endif
+    return i != SIZE_MAX;
+}
+
+int hs_remove_int(hs_HashSet *hs, uint64_t value)
+{
+    size_t i;
+
+    assert(hs);
+    assert(hs->ints);
+    #ifdef SYNC
+        ll_LOCK(&hs->mutex);
+    #endif
+    i = _find(hs, value, _hash(hs, value, true), true);
+    if (i != SIZE_MAX)
+        _erase(hs, i);
+    #ifdef SYNC
+        ll_UNLOCK(&hs->mutex);
+    #endif
+    return (i != SIZE_MAX) ? SUCCESS : NOTFOUND;
+}
+
+hs_HashSet *hs_union(hs_HashSet *a, hs_HashSet *b)
+{
+    hs_HashSet *big = NULL, *small = NULL, *res = NULL;
+    size_t i;
+
+    assert(a);
+    assert(b);
+    if (!_compatible(a, b))
+        return NULL;
+
+    #ifdef SYNC
+        _lock_sets(a, b);
+    #endif
+
+    big = (a->size >= b->size) ? a : b;
+    small = (big == a) ? b : a;
+    res = _derive(big, true, 0);
+    for (i = 0; i < small->capacity; ++i) {
+        if (small->ctrl[i] < 0) {
+            uint64_t e = small->slots[i];
+            _insert(res, e, _hash(res, e, res->ints), res->ints);
+        }
+    }
+
+    #ifdef SYNC
+        _unlock_sets(a, b);
+    #endif
+    return res;
+}
+
+hs_HashSet *hs_intersect(hs_HashSet *a, hs_HashSet *b)
+{
+    hs_HashSet *big = NULL, *small = NULL, *res = NULL;
+    size_t i;
+
+    assert(a);
+    assert(b);
+    if (!_compatible(a, b))
+        return NULL;
+
+    #ifdef SYNC
+        _lock_sets(a, b);
+    #endif
+
+    big = (a->size >= b->size) ? a : b;
+    small = (big == a) ? b : a;
+    res = _derive(small, false, small->size);
+    for (i = 0; i < small->capacity; ++i) {
+        if (small->ctrl[i] < 0) {
+            uint64_t e = small->slots[i];
+            size_t hash = _hash(small, e, small->ints);
+            if (_lookup(big, e, hash, big->ints) != SIZE_MAX)
+                _insert_unique(res, e, hash);
+        }
+    }
+
+    #ifdef SYNC
+        _unlock_sets(a, b);
+    #endif
+    return res;
+}
+
+hs_HashSet *hs_difference(hs_HashSet *a, hs_HashSet *b)
+{
+    hs_HashSet *res = NULL;
+    size_t i;
+
+    assert(a);
+    assert(b);
+    if (!_compatible(a, b))
+        return NULL;
+
+    #ifdef SYNC
+        _lock_sets(a, b);
+    #endif
+
+    if (a->size <= b->size) {
+        /* keep the elements of a that b lacks */
+        res = _derive(a, false, a->size);
+        for (i = 0; i < a->capacity; ++i) {
+            if (a->ctrl[i] < 0) {
+                uint64_t e = a->slots[i];
+                size_t hash = _hash(a, e, a->ints);
+                if (_lookup(b, e, hash, b->ints) == SIZE_MAX)
+                    _insert_unique(res, e, hash);
+            }
+        }
+    } else {
+        /* drop the elements of b from a copy of a */
+        res = _derive(a, true, 0);
+        for (i = 0; i < b->capacity; ++i) {
+            if (b->ctrl[i] < 0) {
+                uint64_t e = b->slots[i];
+                size_t j = _find(res, e, _hash(res, e, res->ints), res->ints);
+                if (j != SIZE_MAX)
+                    _erase(res, j);
+            }
+        }
+    }
+
+    #ifdef SYNC
+        _unlock_sets(a, b);
+    #endif
+    return res;
+}
+
+void hs_foreach(hs_HashSet *hs, hs_ElemVisit visit, void *ctx)
+{
+    size_t pos;
+
+    assert(hs);
+    assert(visit);
+    #ifdef SYNC
+        ll_LOCK(&hs->mutex);
+    #endif
+
+    for (pos = 0; pos < hs->capacity; pos += HS_GROUP_WIDTH) {
+        unsigned full = ~_group_match_free(hs->ctrl + pos) & 0xffff;
+        while (full) {
+            uint64_t *slot = &hs->slots[pos + __builtin_ctz(full)];
+            const void *elem = hs->ints ? (const void*)slot : (const void*)(uintptr_t)*slot;
+            if (!visit(elem, ctx))
+                goto out;
+            full &= full - 1;
+        }
+    }
+
+out:
+    #ifdef SYNC
+        ll_UNLOCK(&hs->mutex);
+    #endif
+    return;
+}
+
+size_t hs_getsize(hs_HashSet *hs)
+{
+    size_t size;
+
+    assert(hs);
+    #ifdef SYNC
+        ll_LOCK(&hs->mutex);
+    #endif
+    size = hs->size;
+    #ifdef SYNC
+        ll_UNLOCK(&hs->mutex);
+    #endif
+    return size;
+}
+
+bool hs_isempty(hs_HashSet *hs)
+{
+    return hs_getsize(hs) == 0;
+}
+
+static hs_HashSet *_alloc_set(hs_ElemHash hash, hs_ElemCompare comp)
+{
+    hs_HashSet *hs = (hs_HashSet*)calloc(1, sizeof *hs);
+
+    assert(hs);
+    hs->hash = hash;
+    hs->comp = comp;
+    #ifdef SYNC
+        if (pthread_mutex_init(&hs->mutex, NULL) != 0) {
+            int errnum = errno;
+            #ifdef ALGOS_DEBUG
+                fprintf(stderr, "%s() error: unable to initialize mutex. errorcode: %d\n",
+                        FUNC, errnum);
+            #endif
+            (void)errnum;
+            free(hs);
+            return NULL;
+        }
+    #endif
+    return hs;
+}
+
+static inline size_t _mix(size_t hash)
+{
+    /* murmur3 fmix64 */
+    uint64_t x = hash;
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return (size_t)x;
+}
+
+HS_INLINE size_t _hash(const hs_HashSet *hs, uint64_t elem, bool ints)
+{
+    return _mix(ints ? (size_t)elem : hs->hash((const void*)(uintptr_t)elem));
+}
+
+HS_INLINE bool _equal(const hs_HashSet *hs, uint64_t a, uint64_t b, bool ints)
+{
+    return ints ? a == b : hs->comp((const void*)(uintptr_t)a, (const void*)(uintptr_t)b) == 0;
+}
+
+static inline unsigned _group_match(const int8_t *ctrl, int8_t h)
+{
+    #ifdef __SSE2__
+        __m128i group = _mm_loadu_si128((const __m128i*)ctrl);
+        return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(h)));
+    #else
+        unsigned mask = 0;
+        int i;
+        for (i = 0; i < HS_GROUP_WIDTH; ++i)
+            mask |= (unsigned)(ctrl[i] == h) << i;
+        return mask;
+    #endif
+}
+
+static inline unsigned _group_match_free(const int8_t *ctrl)
+{
+    /* full slots are the only negative control bytes */
+    #ifdef __SSE2__
+        return ~(unsigned)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)ctrl)) & 0xffff;
+    #else
+        unsigned mask = 0;
+        int i;
+        for (i = 0; i < HS_GROUP_WIDTH; ++i)
+            mask |= (unsigned)(ctrl[i] >= 0) << i;
+        return mask;
+    #endif
+}
+
+HS_INLINE size_t _find(const hs_HashSet *hs, uint64_t elem, size_t hash, bool ints)
+{
+    size_t mask = hs->capacity - 1;
+    size_t pos, step = 0;
+    int8_t h2 = HS_FULL(hash);
+
+    if (hs->capacity == 0)
+        return SIZE_MAX;
+
+    /* triangular steps over groups reach every group of a power of two table */
+    for (pos = (hash >> 7) & mask;; pos = (pos + step) & mask) {
+        unsigned match = _group_match(hs->ctrl + pos, h2);
+        while (match) {
+            size_t i = (pos + __builtin_ctz(match)) & mask;
+            if (_equal(hs, hs->slots[i], elem, ints))
+                return i;
+            match &= match - 1;
+        }
+        if (_group_match(hs->ctrl + pos, HS_EMPTY))
+            return SIZE_MAX;
+        step += HS_GROUP_WIDTH;
+    }
+}
+
+HS_INLINE size_t _lookup(const hs_HashSet *hs, uint64_t elem, size_t hash, bool ints)
+{
+    /* most misses end here, without touching the table */
+    if (hs->bloom && !fl_bloom_contains(hs->bloom, hash))
+        return SIZE_MAX;
+    if (hs->cuckoo && !fl_cuckoo_contains(hs->cuckoo, hash))
+        return SIZE_MAX;
+    return _find(hs, elem, hash, ints);
+}
+
+static size_t _find_free(const hs_HashSet *hs, size_t hash)
+{
+    size_t mask = hs->capacity - 1;
+    size_t pos, step = 0;
+
+    for (pos = (hash >> 7) & mask;; pos = (pos + step) & mask) {
+        unsigned match = _group_match_free(hs->ctrl + pos);
+        if (match)
+            return (pos + __builtin_ctz(match)) & mask;
+        step += HS_GROUP_WIDTH;
+    }
+}
+
+static inline void _set_ctrl(hs_HashSet *hs, size_t i, int8_t h)
+{
+    hs->ctrl[i] = h;
+    if (i < HS_GROUP_WIDTH)
+        hs->ctrl[hs->capacity + i] = h;
+}
+
+HS_INLINE bool _insert(hs_HashSet *hs, uint64_t elem, size_t hash, bool ints)
+{
+    size_t i;
+
+    if (_find(hs, elem, hash, ints) != SIZE_MAX)
+        return false;
+
+    if (hs->capacity == 0)
+        _make_room(hs, 1);
+    i = _find_free(hs, hash);
+    /* reusing a deleted slot costs no growth */
+    if (hs->ctrl[i] == HS_EMPTY) {
+        if (hs->growth_left == 0) {
+            _make_room(hs, 1);
+            i = _find_free(hs, hash);
+        }
+        hs->growth_left--;
+    }
+    _set_ctrl(hs, i, HS_FULL(hash));
+    hs->slots[i] = elem;
+    hs->size++;
+    _filter_add(hs, hash);
+    return true;
+}
+
+static void _insert_unique(hs_HashSet *hs, uint64_t elem, size_t hash)
+{
+    size_t i = _find_free(hs, hash);
+
+    assert(hs->growth_left > 0 || hs->ctrl[i] != HS_EMPTY);
+    if (hs->ctrl[i] == HS_EMPTY)
+        hs->growth_left--;
+    _set_ctrl(hs, i, HS_FULL(hash));
+    hs->slots[i] = elem;
+    hs->size++;
+    _filter_add(hs, hash);
+}
+
+HS_INLINE size_t _add_many(hs_HashSet *hs, const void *elems, size_t n, bool ints)
+{
+    uint64_t batch[HS_BATCH];
+    size_t hashes[HS_BATCH];
+    size_t added = 0, base, k, m;
+
+    for (base = 0; base < n; base += m) {
+        m = (n - base < HS_BATCH) ? n - base : HS_BATCH;
+        /* room first, a resize would move the prefetched groups */
+        if (hs->growth_left < m)
+            _make_room(hs, m);
+
+        for (k = 0; k < m; ++k) {
+            size_t pos;
+            batch[k] = ints ? ((const uint64_t*)elems)[base + k]
+                            : (uintptr_t)((const void *const *)elems)[base + k];
+            hashes[k] = _hash(hs, batch[k], ints);
+            pos = (hashes[k] >> 7) & (hs->capacity - 1);
+            __builtin_prefetch(hs->ctrl + pos);
+            __builtin_prefetch(hs->slots + pos);
+        }
+        for (k = 0; k < m; ++k)
+            added += _insert(hs, batch[k], hashes[k], ints);
+    }
+    return added;
+}
+
+static void _erase(hs_HashSet *hs, size_t i)
+{
+    size_t before = (i - HS_GROUP_WIDTH) & (hs->capacity - 1);
+    unsigned empty_before = _group_match(hs->ctrl + before, HS_EMPTY);
+    unsigned empty_after = _group_match(hs->ctrl + i, HS_EMPTY);
+
+    hs->size--;
+    if (hs->cuckoo) {
+        fl_cuckoo_remove(hs->cuckoo, _hash(hs, hs->slots[i], hs->ints));
+        hs->filter_left++;
+    }
+
+    /* a probe may have gone past i only if some group window around it is full */
+    if (empty_before && empty_after &&
+        (size_t)(__builtin_ctz(empty_after) + __builtin_clz(empty_before) - 16) < HS_GROUP_WIDTH) {
+        _set_ctrl(hs, i, HS_EMPTY);
+        hs->growth_left++;
+    } else {
+        _set_ctrl(hs, i, HS_DELETED);
+    }
+}
+
+static inline size_t _max_entries(size_t capacity)
+{
+    /* load factor 7/8, as hm_DEFAULT_MAX_LOAD */
+    return capacity - capacity / 8;
+}
+
+static size_t _capacity_for(size_t n)
+{
+    size_t capacity = HS_MIN_CAPACITY;
+
+    while (_max_entries(capacity) < n)
+        capacity *= 2;
+    return capacity;
+}
+
+static void _rehash(hs_HashSet *hs, size_t capacity)
+{
+    int8_t *ctrl = hs->ctrl;
+    uint64_t *slots = hs->slots;
+    size_t old_capacity = hs->capacity;
+    size_t i;
+
+    hs->capacity = capacity;
+    /* calloc'd control bytes are already empty */
+    hs->ctrl = (int8_t*)calloc(capacity + HS_GROUP_WIDTH, sizeof *hs->ctrl);
+    assert(hs->ctrl);
+    hs->slots = (uint64_t*)malloc(capacity * sizeof *hs->slots);
+    assert(hs->slots);
+    hs->growth_left = _max_entries(capacity) - hs->size;
+    if (hs->filter != hs_FILTER_NONE)
+        _filter_reset(hs, _max_entries(capacity));
+
+    for (i = 0; i < old_capacity; ++i) {
+        if (ctrl[i] < 0) {
+            uint64_t e = slots[i];
+            size_t hash = _hash(hs, e, hs->ints);
+            size_t j = _find_free(hs, hash);
+            _set_ctrl(hs, j, HS_FULL(hash));
+            hs->slots[j] = e;
+            _filter_add(hs, hash);
+        }
+    }
+
+    free(ctrl);
+    free(slots);
+}
+
+static void _make_room(hs_HashSet *hs, size_t n)
+{
+    size_t capacity = (hs->capacity > 0) ? hs->capacity : HS_MIN_CAPACITY;
+
+    /* mostly tombstones, clearing them out makes enough room */
+    if (hs->capacity > 0 && hs->size + n > _max_entries(capacity) / 2)
+        capacity *= 2;
+    while (_max_entries(capacity) < hs->size + n)
+        capacity *= 2;
+    _rehash(hs, capacity);
+}
+
+static void _filter_reset(hs_HashSet *hs, size_t n)
+{
+    if (hs->bloom)
+        fl_bloom_destroy(hs->bloom);
+    if (hs->cuckoo)
+        fl_cuckoo_destroy(hs->cuckoo);
+    hs->bloom = NULL;
+    hs->cuckoo = NULL;
+    hs->filter_keys = n;
+    hs->filter_left = n;
+
+    if (hs->filter == hs_FILTER_BLOOM)
+        hs->bloom = fl_bloom_init(n, hs->filter_fpr);
+    else if (hs->filter == hs_FILTER_CUCKOO)
+        hs->cuckoo = fl_cuckoo_init(n, hs->filter_fpr);
+}
+
+static bool _filter_build(hs_HashSet *hs, size_t n)
+{
+    int tries;
+    size_t i;
+
+    /*
+     * Elements with the same hash share both buckets and the fingerprint,
+     * and no size holds more of them than two buckets do; a larger filter
+     * only helps against an unlucky spread, so twice the size is the last
+     * try before lookups go to the table alone.
+     */
+    for (tries = 0; tries < 2; ++tries, n *= 2) {
+        bool done = true;
+        _filter_reset(hs, n);
+        for (i = 0; i < hs->capacity && done; ++i) {
+            if (hs->ctrl[i] < 0)
+                done = _filter_put(hs, _hash(hs, hs->slots[i], hs->ints));
+        }
+        if (done)
+            return true;
+    }
+
+    #ifdef ALGOS_DEBUG
+        fprintf(stderr, "%s() error: too many equal hashes for a cuckoo filter, dropping it\n",
+                FUNC);
+    #endif
+    hs->filter = hs_FILTER_NONE;
+    _filter_reset(hs, 0);
+    return false;
+}
+
+static bool _filter_put(hs_HashSet *hs, size_t hash)
+{
+    if (hs->filter_left == 0)
+        return false;
+    hs->filter_left--;
+    if (hs->bloom) {
+        fl_bloom_add(hs->bloom, hash);
+        return true;
+    }
+    return fl_cuckoo_add(hs->cuckoo, hash) == SUCCESS;
+}
+
+static inline void _filter_add(hs_HashSet *hs, size_t hash)
+{
+    if (hs->filter == hs_FILTER_NONE || _filter_put(hs, hash))
+        return;
+    /*
+     * The element is already stored, so the rebuild takes it in. At least
+     * twice the size keeps rebuilds apart, a Bloom filter rebuilt after
+     * removes gets back to its size.
+     */
+    _filter_build(hs, (hs->filter_keys > 2 * hs->size) ? hs->filter_keys : 2 * hs->size);
+}
+
+static bool _compatible(const hs_HashSet *a, const hs_HashSet *b)
+{
+    if (a->ints != b->ints || a->hash != b->hash || a->comp != b->comp) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: sets of different kinds\n", FUNC);
+        #endif
+        return false;
+    }
+    return true;
+}
+
+static hs_HashSet *_derive(const hs_HashSet *src, bool copy, size_t n)
+{
+    hs_HashSet *res = _alloc_set(src->hash, src->comp);
+
+    assert(res);
+    res->ints = src->ints;
+    if (copy && src->capacity > 0) {
+        res->capacity = src->capacity;
+        res->ctrl = (int8_t*)malloc(src->capacity + HS_GROUP_WIDTH);
+        assert(res->ctrl);
+        memcpy(res->ctrl, src->ctrl, src->capacity + HS_GROUP_WIDTH);
+        res->slots = (uint64_t*)malloc(src->capacity * sizeof *res->slots);
+        assert(res->slots);
+        memcpy(res->slots, src->slots, src->capacity * sizeof *res->slots);
+        res->size = src->size;
+        res->growth_left = src->growth_left;
+    } else if (n > 0) {
+        _rehash(res, _capacity_for(n));
+    }
+    return res;
+}
+
+#ifdef SYNC
+static void _lock_sets(hs_HashSet *a, hs_HashSet *b)
+{
+    if (a == b) {
+        ll_LOCK(&a->mutex);
+    } else if ((uintptr_t)a < (uintptr_t)b) {
+        ll_LOCK(&a->mutex);
+        ll_LOCK(&b->mutex);
+    } else {
+        ll_LOCK(&b->mutex);
+        ll_LOCK(&a->mutex);
+    }
+}
+
+static void _unlock_sets(hs_HashSet *a, hs_HashSet *b)
+{
+    ll_UNLOCK(&a->mutex);
+    if (a != b)
+        ll_UNLOCK(&b->mutex);
+}
+#endif
@@ -1,10 +1,30 @@
 #include <assert.h>
+#include <errno.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
 
 #include "ll.h"
 
+#ifdef SYNC
+/**
+ * mutex of a list the function only reads, getters take it as well.
+ */
+#define LL_MUTEX(LL) CONST_CAST(pthread_mutex_t*, &(LL)->mutex)
+
+#ifndef NDEBUG
+/**
+ * list mutexes check for errors in debug builds, so taking one the thread
+ * already holds (an ll_* call while its iterator is live) asserts instead
+ * of deadlocking.
+ */
+#undef ll_LOCK
+#define ll_LOCK(M) do { int lockrc = pthread_mutex_lock((M)); \
+                        assert(lockrc != EDEADLK && "list locked by a live iterator"); \
+                        (void)lockrc; } while (0)
+#endif
+#endif
+
 /**
  * singly node type.
  */
@@ -23,10 +43,124 @@ typedef struct _dn {
 } DoublyNode;
 
 /**
- * generic linkedlist type.
+ * unrolled node type, several elements per block. the block is sized
+ * to ll_UNROLLED_CACHELINES whole cache lines.
+ */
+#define UNROLLED_NODE_ELEMS ((ll_UNROLLED_CACHELINES * CACHE_LINE_SIZE - \
+                              2 * sizeof(void*) - sizeof(size_t)) / sizeof(void*))
+
+typedef struct _un {
+    struct _un *next;
+    struct _un *prev;
+    size_t count;
+    void *elems[UNROLLED_NODE_ELEMS];
+} UnrolledNode;
+
+/**
+ * node pool chunk header (nodes are carved out after it).
+ */
+typedef struct _nodechunk {
+    struct _nodechunk *next;
+    size_t bytes;
+} NodeChunk;
+
+/**
+ * slab allocator for linkedlist nodes. pooled lists that trade nodes
+ * through ll_splice or ll_split end up in one pool family: pools are
+ * merged union-find style and only the root of a family holds chunks and
+ * the free list. refs counts the lists and merged pools pointing at a
+ * pool, the root releases its chunks with the last of them. nodes are
+ * taken and returned outside the list
+ * mutex as well (element dtors run unlocked), so SYNC builds guard each
+ * root with a mutex of its own.
+ */
+typedef struct _nodepool {
+    struct _nodepool *parent;
+    size_t refs;
+    size_t node_size;
+    size_t chunk_nodes;
+    size_t bump_left;
+    char *bump;
+    void *freelist;
+    void *freelist_tail;
+    NodeChunk *chunks;
+    NodeChunk *chunks_tail;
+    #ifdef SYNC
+        pthread_mutex_t mutex;
+    #endif
+} NodePool;
+
+/**
+ * skip index entry. lane i links to the next entry with at least i+1
+ * lanes, span counts the list positions that link steps over.
+ */
+#define SKIPINDEX_MAXLEVEL 32
+
+typedef struct _skipentry {
+    void *node;
+    struct {
+        struct _skipentry *next;
+        size_t span;
+    } lanes[];
+} SkipEntry;
+
+/**
+ * indexable skip list over the nodes of a (singly, doubly, circly)
+ * linkedlist, giving O(log n) positional lookups.
+ */
+typedef struct _skipindex {
+    size_t level;
+    size_t length;
+    unsigned int seed;
+    SkipEntry *head;
+} SkipIndex;
+
+/**
+ * hash index slot, one per element occurrence.
+ */
+typedef struct _hashslot {
+    void *elem;
+    size_t hash;
+    bool used;
+} HashSlot;
+
+/**
+ * open addressing (linear probing) side index for ll_search. a NULL
+ * hash keys elements by pointer identity.
+ */
+#define HASHINDEX_INITIAL_CAPACITY 64
+
+typedef struct _hashindex {
+    size_t capacity;
+    size_t count;
+    ll_ElemHash hash;
+    ll_ElemCompare comp;
+    HashSlot *slots;
+} HashIndex;
+
+/**
+ * optional linkedlist state: node pool and side indexes. a list created
+ * with flags is allocated with it right behind the list header, a list
+ * created without flags does not carry it at all.
+ */
+typedef struct _listext {
+    NodePool *pool;
+    SkipIndex *index;
+    HashIndex *hindex;
+} ListExt;
+
+#define LL_EXT(LL)       ((ListExt*)(CONST_CAST(ll_LinkedList*, (LL)) + 1))
+#define LL_POOL(LL)      ((LL)->flags ? LL_EXT(LL)->pool : NULL)
+#define LL_SKIPINDEX(LL) ((LL)->flags ? LL_EXT(LL)->index : NULL)
+#define LL_HASHINDEX(LL) ((LL)->flags ? LL_EXT(LL)->hindex : NULL)
+
+/**
+ * generic linkedlist type. flags fills the padding in front of size, so
+ * the header is as large as a list without options ever was.
  */
 struct _linkedlist {
     ll_ListType type;
+    unsigned int flags;
     size_t size;
     #ifdef SYNC
         pthread_mutex_t mutex;
@@ -34,11 +168,38 @@ struct _linkedlist {
     union {
         SinglyNode *s_head;
         DoublyNode *d_head;
+        UnrolledNode *u_head;
     };
     union {
         SinglyNode *s_tail;
         DoublyNode *d_tail;
+        UnrolledNode *u_tail;
+    };
+};
+
+/**
+ * linkedlist iterator. the cursor sits in the gap between two elements:
+ * after *_before for linked types, before u_node->elems[idx] for
+ * unrolled. *_last is the element handed out by the last next/prev,
+ * which is what erase removes. pos counts the elements before the
+ * cursor, so edits through it update the skip index in place.
+ */
+struct _iterator {
+    ll_LinkedList *ll;
+    union {
+        SinglyNode *s_before;
+        DoublyNode *d_before;
+        UnrolledNode *u_node;
     };
+    union {
+        SinglyNode *s_last;
+        DoublyNode *d_last;
+        UnrolledNode *u_last;
+    };
+    SinglyNode *s_lastpred;
+    size_t idx;
+    size_t lastidx;
+    size_t pos;
 };
 
 /**
@@ -51,29 +212,243 @@ static inline void _defaultdtor(void *elem)
 }
 
 /**
- * create a singly node (heap alloc).
+ * destructor that leaves the element alone, for elements changing lists.
+ */
+static inline void _nodtor(void *elem)
+{
+    (void)elem;
+}
+
+/**
+ * create a node pool handing out nodes of node_size bytes. NULL if its
+ * mutex cannot be set up, the list then allocates nodes from the heap.
+ */
+static NodePool *_init_nodepool(size_t node_size, size_t chunk_nodes);
+
+/**
+ * drop a reference to a node pool. the last one of a family releases
+ * all chunks at once.
+ */
+static void _nodepool_release(NodePool *pool);
+
+/**
+ * take another reference to a node pool.
+ */
+static NodePool *_nodepool_share(NodePool *pool);
+
+/**
+ * join the families of two node pools, the root of a's family takes over
+ * the chunks and free list of b's.
+ */
+static void _nodepool_merge(NodePool *a, NodePool *b);
+
+/**
+ * take a zeroed node from the pool (free list first, then current chunk).
+ */
+static void *_nodepool_alloc(NodePool *pool);
+
+/**
+ * take n nodes from the pool under one lock, chained through their first
+ * word. the caller overwrites every node in full.
+ */
+static void *_nodepool_allocchain(NodePool *pool, size_t n);
+
+/**
+ * return a node to the pool free list.
+ */
+static void _nodepool_free(NodePool *pool, void *node);
+
+/**
+ * create a singly node (pool or heap alloc).
  */
-static SinglyNode *_init_singlynode(const void *elem);
+static SinglyNode *_init_singlynode(ll_LinkedList *ll, const void *elem);
 
 /**
- * create a doubly node (heap alloc).
+ * create a doubly node (pool or heap alloc).
  */
-static DoublyNode *_init_doublynode(const void *elem);
+static DoublyNode *_init_doublynode(ll_LinkedList *ll, const void *elem);
 
 /**
  * destroy singly node.
  */
-static void _destroy_singlynode(SinglyNode *node, ll_ElemDtor dtor);
+static void _destroy_singlynode(ll_LinkedList *ll, SinglyNode *node, ll_ElemDtor dtor);
 
 /**
  * destroy doubly node.
  */
-static void _destroy_doublynode(DoublyNode *node, ll_ElemDtor dtor);
+static void _destroy_doublynode(ll_LinkedList *ll, DoublyNode *node, ll_ElemDtor dtor);
+
+/**
+ * create an empty, cache line aligned unrolled node (pool or heap alloc).
+ */
+static UnrolledNode *_init_unrollednode(ll_LinkedList *ll);
+
+/**
+ * destroy unrolled node (elements are left alone).
+ */
+static void _destroy_unrollednode(ll_LinkedList *ll, UnrolledNode *node);
+
+/**
+ * destroy a single element with dtor, or the default dtor.
+ */
+static void _destroy_element(void *elem, ll_ElemDtor dtor);
+
+/**
+ * find the unrolled node holding position *pos, walking from whichever
+ * end is closer. *pos is rewritten to the index inside the node.
+ */
+static UnrolledNode *_unrolled_locate(const ll_LinkedList *ll, size_t *pos);
+
+/**
+ * find the first unrolled node holding elem, its index goes to *idx.
+ */
+static UnrolledNode *_unrolled_find(const ll_LinkedList *ll, const void *elem, size_t *idx);
+
+/**
+ * step an unrolled (node, index) cursor to the next element.
+ */
+static void _unrolled_advance(UnrolledNode **node, size_t *idx);
+
+/**
+ * insert elem at index *idx of node, splitting a full node in two.
+ * returns the node that ended up holding elem, its index goes to *idx.
+ */
+static UnrolledNode *_unrolled_insertat(ll_LinkedList *ll, UnrolledNode *node, size_t *idx,
+                                        const void *elem);
+
+/**
+ * remove and return the element at index idx of node, merging
+ * underfull neighbours and dropping empty nodes.
+ */
+static void *_unrolled_removeat(ll_LinkedList *ll, UnrolledNode *node, size_t idx);
+
+/**
+ * create a skip index for an empty list.
+ */
+static SkipIndex *_init_skipindex(void);
+
+/**
+ * destroy skip index and all of its entries.
+ */
+static void _destroy_skipindex(SkipIndex *index);
+
+/**
+ * drop every entry, leaving an index for an empty list.
+ */
+static void _skipindex_clear(SkipIndex *index);
+
+/**
+ * fill index with entries for the n nodes of a chain starting at node,
+ * in O(n). whatever index held before is dropped.
+ */
+static void _skipindex_build(SkipIndex *index, ll_ListType type, void *node, size_t n);
+
+/**
+ * find the skip index entry at position pos.
+ */
+static SkipEntry *_skipindex_find(SkipIndex *index, size_t pos);
+
+/**
+ * record node as inserted at position pos (no-op without an index).
+ */
+static void _skipindex_insert(ll_LinkedList *ll, size_t pos, void *node);
+
+/**
+ * record removal of position pos (no-op without an index).
+ */
+static void _skipindex_delete(ll_LinkedList *ll, size_t pos);
+
+/**
+ * move the entries of positions [pos, length) into the empty index
+ * rest in O(log n), spans are cut at pos on every lane.
+ */
+static void _skipindex_cut(SkipIndex *index, size_t pos, SkipIndex *rest);
+
+/**
+ * append all entries of rest to index in O(log n), leaving rest empty.
+ */
+static void _skipindex_join(SkipIndex *index, SkipIndex *rest);
+
+/**
+ * move all entries of other into index at position pos in O(log n).
+ */
+static void _skipindex_insertindex(SkipIndex *index, size_t pos, SkipIndex *other);
+
+/**
+ * record a chain of n nodes starting at first as inserted at position
+ * pos, O(n + log size) (no-op without an index).
+ */
+static void _skipindex_insertchain(ll_LinkedList *ll, size_t pos, void *first, size_t n);
+
+/**
+ * point the n entries from position pos on at the chain starting at
+ * node, after nodes were relinked without moving positions (no-op
+ * without an index).
+ */
+static void _skipindex_relabel(ll_LinkedList *ll, size_t pos, void *node, size_t n);
+
+/**
+ * create an empty hash index (pointer keyed when hash is NULL).
+ */
+static HashIndex *_init_hashindex(ll_ElemHash hash, ll_ElemCompare comp);
+
+/**
+ * destroy hash index.
+ */
+static void _destroy_hashindex(HashIndex *hindex);
+
+/**
+ * record an element occurrence (no-op without a hash index).
+ */
+static void _hashindex_add(ll_LinkedList *ll, const void *elem);
+
+/**
+ * forget the occurrence of exactly this element pointer (no-op without
+ * a hash index).
+ */
+static void _hashindex_remove(ll_LinkedList *ll, const void *elem);
+
+/**
+ * check the hash index for an element equal to elem.
+ */
+static bool _hashindex_contains(const HashIndex *hindex, const void *elem);
+
+/**
+ * return the node at position pos-1, or the head sentinel for pos 0,
+ * through the skip index when there is one. only reads the index.
+ */
+static void *_locate(const ll_LinkedList *ll, size_t pos);
+
+/**
+ * stable bottom-up merge sort of a NULL terminated chain of n singly
+ * nodes, relinking in place. the last node goes to *tail.
+ */
+static SinglyNode *_sort_singlychain(SinglyNode *head, size_t n, ll_ElemCompare comp,
+                                     SinglyNode **tail);
+
+/**
+ * stable bottom-up merge sort of a NULL terminated chain of n doubly
+ * nodes, relinking in place and repairing prev links. the last node
+ * goes to *tail.
+ */
+static DoublyNode *_sort_doublychain(DoublyNode *head, size_t n, ll_ElemCompare comp,
+                                     DoublyNode **tail);
+
+/**
+ * stable bottom-up merge sort of an element array using scratch.
+ */
+static void _sort_array(void **elems, void **scratch, size_t n, ll_ElemCompare comp);
+
+/**
+ * stable insertion sort of the n (unrolled) elements from elems[idx] of
+ * node on, in place. the fallback when no scratch array can be had.
+ */
+static void _sort_unrolled(UnrolledNode *node, size_t idx, size_t n, ll_ElemCompare comp);
 
 /**
- * merge 2 sorted linkedlists into original.
+ * stable sort of positions [min, max), max is clamped to the list size.
  */
-static void _merge(ll_LinkedList *ll, size_t min, size_t mid, size_t max, ll_ElemCompare comp);
+static void _sort_range(ll_LinkedList *ll, size_t min, size_t max, ll_ElemCompare comp);
 
 /**
  * recursive function for printing (singly, circly) linkedlist
@@ -82,79 +457,212 @@ static void _merge(ll_LinkedList *ll, size_t min, size_t mid, size_t max, ll_Ele
 static void _print_reverse(SinglyNode *start, SinglyNode *end, ll_ElemPrint print);
 
 /**
- * recursive function for searching (singly, circly) linkedlist
- * in reverse order.
+ * function for searching (singly, circly) linkedlist in reverse order.
+ * a singly chain can only be walked forwards and the answer does not
+ * depend on direction, so this walks forwards and stops at the first hit.
  */
 static bool _search_reverse(SinglyNode *start, SinglyNode *end, const void *elem);
 
+/**
+ * forget every element in the hash index, keeping its capacity.
+ */
+static void _hashindex_clear(HashIndex *hindex);
+
+/**
+ * visit callback adding an element to the hash index of ctx (a list).
+ */
+static bool _hashindex_visitadd(void *elem, void *ctx);
+
+/**
+ * visit callback removing an element from the hash index of ctx (a list).
+ */
+static bool _hashindex_visitremove(void *elem, void *ctx);
+
+/**
+ * visit the elements in order until visit returns false (no locking).
+ */
+static void _visit(const ll_LinkedList *ll, ll_ElemVisit visit, void *ctx);
+
+/**
+ * split node at idx, moving elems[idx, count) into a new node linked
+ * right after it. returns the new node.
+ */
+static UnrolledNode *_unrolled_splitat(ll_LinkedList *ll, UnrolledNode *node, size_t idx);
+
+/**
+ * insert n elements at position pos with nodes from the list's own
+ * allocator (no locking). appending to a singly/circly list is O(n)
+ * without walking to the end: the tail sentinel takes the first
+ * element and a fresh node becomes the sentinel.
+ */
+static void _insert_array(ll_LinkedList *ll, size_t pos, void *const *elems, size_t n);
+
+/**
+ * let two pooled lists take nodes from one pool family, so nodes can
+ * move between them as they are (no locking).
+ */
+static void _share_nodepool(ll_LinkedList *dst, ll_LinkedList *src);
+
+/**
+ * move all of src into dst at pos in fresh nodes of dst, for lists whose
+ * nodes come from different allocators (no locking). returns ERROR, with
+ * both lists untouched, when the scratch array cannot be allocated.
+ */
+static int _move_elements(ll_LinkedList *dst, size_t pos, ll_LinkedList *src);
+
+/**
+ * move the whole (singly, circly) chain of src to the end of dst in O(1):
+ * dst's tail sentinel takes src's first element, src's tail sentinel
+ * becomes dst's, and src's first node becomes src's new tail sentinel.
+ * sizes and indexes are left to the caller.
+ */
+static void _singly_append(ll_LinkedList *dst, ll_LinkedList *src);
+
+#ifdef SYNC
+/**
+ * initialize a list mutex, error checking in debug builds.
+ */
+static int _init_listmutex(pthread_mutex_t *mutex);
+
+/**
+ * lock two lists in address order so concurrent splices cannot deadlock.
+ */
+static void _lock_pair(ll_LinkedList *a, ll_LinkedList *b);
+
+/**
+ * unlock two lists locked by _lock_pair.
+ */
+static void _unlock_pair(ll_LinkedList *a, ll_LinkedList *b);
+#endif
+
 
 ll_LinkedList *ll_init(ll_ListType type)
+{
+    return ll_init_withflags(type, ll_FLAG_NONE);
+}
+
+ll_LinkedList *ll_init_withflags(ll_ListType type, unsigned int flags)
 {
     ll_LinkedList *ll = NULL;
+    size_t bytes = 0;
+
+    flags &= ll_FLAG_POOL | ll_FLAG_SKIPINDEX | ll_FLAG_HASHINDEX;
+    bytes = sizeof *ll + (flags ? sizeof(ListExt) : 0);
+
     switch (type) {
         case ll_CIRCLY:
-            ll = (ll_LinkedList*)calloc(1, sizeof *ll); 
+            ll = (ll_LinkedList*)calloc(1, bytes); 
             assert(ll);
             ll->type = type;
+            ll->flags = flags;
             ll->size = INIT_LL_SIZE_VAL;
             #ifdef SYNC
-                if (pthread_mutex_init(&ll->mutex, NULL) != 0) {
+                if (_init_listmutex(&ll->mutex) != 0) {
                     int errnum = errno;
                     #ifdef ALGOS_DEBUG
                         fprintf(stderr, "%s() error: unable to initialize mutex. errorcode: %d\n",
                                 FUNC, errnum);
                     #endif
+                    (void)errnum;
                     free(ll);
                     return NULL;
                 }
             #endif
-            ll->s_head = _init_singlynode(NULL);
-            ll->s_tail = _init_singlynode(NULL);
+            if (flags & ll_FLAG_POOL)
+                LL_EXT(ll)->pool = _init_nodepool(sizeof(SinglyNode), ll_POOL_CHUNK_NODES);
+            if (flags & ll_FLAG_HASHINDEX)
+                LL_EXT(ll)->hindex = _init_hashindex(NULL, NULL);
+            if (flags & ll_FLAG_SKIPINDEX)
+                LL_EXT(ll)->index = _init_skipindex();
+            ll->s_head = _init_singlynode(ll, NULL);
+            ll->s_tail = _init_singlynode(ll, NULL);
             ll->s_head->next = ll->s_tail;
             ll->s_tail->next = ll->s_head;
             break;
         case ll_DOUBLY:
-            ll = (ll_LinkedList*)calloc(1, sizeof *ll); 
+            ll = (ll_LinkedList*)calloc(1, bytes); 
             assert(ll);
             ll->type = type;
+            ll->flags = flags;
             ll->size = INIT_LL_SIZE_VAL;
             #ifdef SYNC
-                if (pthread_mutex_init(&ll->mutex, NULL) != 0) {
+                if (_init_listmutex(&ll->mutex) != 0) {
                     int errnum = errno;
                     #ifdef ALGOS_DEBUG
                         fprintf(stderr, "%s() error: unable to initialize mutex. errorcode: %d\n",
                                 FUNC, errnum);
                     #endif
+                    (void)errnum;
                     free(ll);
                     return NULL;
                 }
             #endif
-            ll->d_head = _init_doublynode(NULL);
-            ll->d_tail = _init_doublynode(NULL);
+            if (flags & ll_FLAG_POOL)
+                LL_EXT(ll)->pool = _init_nodepool(sizeof(DoublyNode), ll_POOL_CHUNK_NODES);
+            if (flags & ll_FLAG_HASHINDEX)
+                LL_EXT(ll)->hindex = _init_hashindex(NULL, NULL);
+            if (flags & ll_FLAG_SKIPINDEX)
+                LL_EXT(ll)->index = _init_skipindex();
+            ll->d_head = _init_doublynode(ll, NULL);
+            ll->d_tail = _init_doublynode(ll, NULL);
             ll->d_head->next = ll->d_tail;
             ll->d_head->prev = ll->d_head;
             ll->d_tail->next = ll->d_tail;
             ll->d_tail->prev = ll->d_head;
             break;
         case ll_SINGLY:
-            ll = (ll_LinkedList*)calloc(1, sizeof *ll); 
+            ll = (ll_LinkedList*)calloc(1, bytes); 
             assert(ll);
             ll->type = type;
+            ll->flags = flags;
             ll->size = INIT_LL_SIZE_VAL;
             #ifdef SYNC
-                if (pthread_mutex_init(&ll->mutex, NULL) != 0) {
+                if (_init_listmutex(&ll->mutex) != 0) {
                     int errnum = errno;
                     #ifdef ALGOS_DEBUG
                         fprintf(stderr, "%s() error: unable to initialize mutex. errorcode: %d\n",
                                 FUNC, errnum);
                     #endif
+                    (void)errnum;
                     free(ll);
                     return NULL;
                 }
             #endif
-            ll->s_head = _init_singlynode(NULL);
-            ll->s_tail = _init_singlynode(NULL);
+            if (flags & ll_FLAG_POOL)
+                LL_EXT(ll)->pool = _init_nodepool(sizeof(SinglyNode), ll_POOL_CHUNK_NODES);
+            if (flags & ll_FLAG_HASHINDEX)
+                LL_EXT(ll)->hindex = _init_hashindex(NULL, NULL);
+            if (flags & ll_FLAG_SKIPINDEX)
+                LL_EXT(ll)->index = _init_skipindex();
+            ll->s_head = _init_singlynode(ll, NULL);
+            ll->s_tail = _init_singlynode(ll, NULL);
             ll->s_head->next = ll->s_tail;
+            ll->s_tail->next = ll->s_tail;
+            break;
+        case ll_UNROLLED:
+            ll = (ll_LinkedList*)calloc(1, bytes); 
+            assert(ll);
+            ll->type = type;
+            ll->flags = flags;
+            ll->size = INIT_LL_SIZE_VAL;
+            #ifdef SYNC
+                if (_init_listmutex(&ll->mutex) != 0) {
+                    int errnum = errno;
+                    #ifdef ALGOS_DEBUG
+                        fprintf(stderr, "%s() error: unable to initialize mutex. errorcode: %d\n",
+                                FUNC, errnum);
+                    #endif
+                    (void)errnum;
+                    free(ll);
+                    return NULL;
+                }
+            #endif
+            if (flags & ll_FLAG_POOL)
+                LL_EXT(ll)->pool = _init_nodepool(sizeof(UnrolledNode), ll_POOL_CHUNK_NODES);
+            if (flags & ll_FLAG_HASHINDEX)
+                LL_EXT(ll)->hindex = _init_hashindex(NULL, NULL);
+            ll->u_head = NULL;
+            ll->u_tail = NULL;
             break;
         default:
             #ifdef ALGOS_DEBUG
@@ -176,11 +684,11 @@ void ll_destroy(ll_LinkedList *ll, ll_ElemDtor dtor)
                 SinglyNode *nextnode = NULL;
                 while (curnode && curnode->next != ll->s_head) {
                     nextnode = curnode->next;
-                    _destroy_singlynode(curnode, dtor);
+                    _destroy_singlynode(ll, curnode, dtor);
                     curnode = nextnode;
                 }
-                _destroy_singlynode(ll->s_head, dtor);
-                _destroy_singlynode(ll->s_tail, dtor);
+                _destroy_singlynode(ll, ll->s_head, dtor);
+                _destroy_singlynode(ll, ll->s_tail, dtor);
             }
             break;
         case ll_DOUBLY:
@@ -189,11 +697,11 @@ void ll_destroy(ll_LinkedList *ll, ll_ElemDtor dtor)
                 DoublyNode *nextnode = NULL;
                 while (curnode && curnode != curnode->next) {
                     nextnode = curnode->next;
-                    _destroy_doublynode(curnode, dtor);
+                    _destroy_doublynode(ll, curnode, dtor);
                     curnode = nextnode;
                 }
-                _destroy_doublynode(ll->d_head, dtor);
-                _destroy_doublynode(ll->d_tail, dtor);
+                _destroy_doublynode(ll, ll->d_head, dtor);
+                _destroy_doublynode(ll, ll->d_tail, dtor);
             }
             break;
         case ll_SINGLY:
@@ -202,11 +710,28 @@ void ll_destroy(ll_LinkedList *ll, ll_ElemDtor dtor)
                 SinglyNode *nextnode = NULL;
                 while (curnode && curnode != curnode->next) {
                     nextnode = curnode->next;
-                    _destroy_singlynode(curnode, dtor);
+                    _destroy_singlynode(ll, curnode, dtor);
+                    curnode = nextnode;
+                }
+                _destroy_singlynode(ll, ll->s_head, dtor);
+                _destroy_singlynode(ll, ll->s_tail, dtor);
+            }
+            break;
+        case ll_UNROLLED:
+            {
+                UnrolledNode *curnode = ll->u_head;
+                UnrolledNode *nextnode = NULL;
+                size_t i;
+
+                if (dtor == NULL)
+                    dtor = _defaultdtor;
+                while (curnode) {
+                    for (i = 0; i < curnode->count; ++i)
+                        dtor(curnode->elems[i]);
+                    nextnode = curnode->next;
+                    _destroy_unrollednode(ll, curnode);
                     curnode = nextnode;
                 }
-                _destroy_singlynode(ll->s_head, dtor);
-                _destroy_singlynode(ll->s_tail, dtor);
             }
             break;
         default:
@@ -222,334 +747,2062 @@ void ll_destroy(ll_LinkedList *ll, ll_ElemDtor dtor)
                 fprintf(stderr, "%s() error: unable to destroy mutex. errorcode: %d\n",
                         FUNC, errnum);
             #endif
+            (void)errnum;
         }
     #endif
+    if (ll->flags) {
+        ListExt *ext = LL_EXT(ll);
+        if (ext->index)
+            _destroy_skipindex(ext->index);
+        if (ext->hindex)
+            _destroy_hashindex(ext->hindex);
+        if (ext->pool)
+            _nodepool_release(ext->pool);
+    }
     free(ll);
     ll = NULL;
 }
 
-static SinglyNode *_init_singlynode(const void *elem)
+static NodePool *_init_nodepool(size_t node_size, size_t chunk_nodes)
 {
-    SinglyNode *node = (SinglyNode*)calloc(1, sizeof *node);       
-    assert(node);
-    node->elem = CONST_CAST(void*, elem);
-    node->next = NULL;
-    return node;
+    NodePool *pool = (NodePool*)calloc(1, sizeof *pool);
+    assert(pool);
+    pool->parent = NULL;
+    pool->refs = 1;
+    pool->node_size = node_size;
+    pool->chunk_nodes = chunk_nodes;
+    pool->bump_left = 0;
+    pool->bump = NULL;
+    pool->freelist = NULL;
+    pool->freelist_tail = NULL;
+    pool->chunks = NULL;
+    pool->chunks_tail = NULL;
+    #ifdef SYNC
+        if (pthread_mutex_init(&pool->mutex, NULL) != 0) {
+            int errnum = errno;
+            #ifdef ALGOS_DEBUG
+                fprintf(stderr, "%s() error: unable to initialize mutex. errorcode: %d\n",
+                        FUNC, errnum);
+            #endif
+            (void)errnum;
+            free(pool);
+            return NULL;
+        }
+    #endif
+    return pool;
 }
 
-static DoublyNode *_init_doublynode(const void *elem)
+static void _nodepool_release(NodePool *pool)
 {
-    DoublyNode *node = (DoublyNode*)calloc(1, sizeof *node);       
-    assert(node);
-    node->elem = CONST_CAST(void*, elem);
-    node->next = NULL;
-    node->prev = NULL;
-    return node;
+    while (pool && __atomic_sub_fetch(&pool->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+        NodePool *parent = __atomic_load_n(&pool->parent, __ATOMIC_ACQUIRE);
+        if (parent == NULL) {
+            NodeChunk *chunk = pool->chunks;
+            NodeChunk *next = NULL;
+            while (chunk) {
+                next = chunk->next;
+                free(chunk);
+                chunk = next;
+            }
+        }
+        #ifdef SYNC
+            pthread_mutex_destroy(&pool->mutex);
+        #endif
+        free(pool);
+        pool = parent;
+    }
 }
 
-static void _destroy_singlynode(SinglyNode *node, ll_ElemDtor dtor)
+static NodePool *_nodepool_share(NodePool *pool)
 {
-    if (dtor == NULL)
-        dtor = _defaultdtor;
-
-    dtor(node->elem);
-    node->next = NULL;
-    free(node);
-    node = NULL;
+    __atomic_add_fetch(&pool->refs, 1, __ATOMIC_RELAXED);
+    return pool;
 }
 
-static void _destroy_doublynode(DoublyNode *node, ll_ElemDtor dtor)
+/**
+ * find the root of the family of pool.
+ */
+static NodePool *_nodepool_root(NodePool *pool)
 {
-    if (dtor == NULL)
-        dtor = _defaultdtor;
+    NodePool *parent = NULL;
+    while ((parent = __atomic_load_n(&pool->parent, __ATOMIC_ACQUIRE)) != NULL)
+        pool = parent;
+    return pool;
+}
+
+/**
+ * return the root of the family of pool, locked in SYNC builds. a root
+ * only stops being one under its own mutex, so the check is repeated
+ * once it is held.
+ */
+static NodePool *_nodepool_lockroot(NodePool *pool)
+{
+    #ifdef SYNC
+        for (;;) {
+            NodePool *root = _nodepool_root(pool);
+            ll_LOCK(&root->mutex);
+            if (__atomic_load_n(&root->parent, __ATOMIC_ACQUIRE) == NULL)
+                return root;
+            ll_UNLOCK(&root->mutex);
+        }
+    #else
+        return _nodepool_root(pool);
+    #endif
+}
+
+static void _nodepool_merge(NodePool *a, NodePool *b)
+{
+    NodePool *ra = NULL;
+    NodePool *rb = NULL;
+
+    for (;;) {
+        ra = _nodepool_root(a);
+        rb = _nodepool_root(b);
+        if (ra == rb)
+            return;
+        #ifdef SYNC
+            /* address order, as in _lock_pair */
+            ll_LOCK((ra < rb) ? &ra->mutex : &rb->mutex);
+            ll_LOCK((ra < rb) ? &rb->mutex : &ra->mutex);
+            if (__atomic_load_n(&ra->parent, __ATOMIC_ACQUIRE) == NULL &&
+                __atomic_load_n(&rb->parent, __ATOMIC_ACQUIRE) == NULL)
+                break;
+            ll_UNLOCK(&ra->mutex);
+            ll_UNLOCK(&rb->mutex);
+        #else
+            break;
+        #endif
+    }
+
+    /* the rest of rb's current chunk goes on its free list */
+    while (rb->bump_left > 0) {
+        *(void**)rb->bump = rb->freelist;
+        if (rb->freelist == NULL)
+            rb->freelist_tail = rb->bump;
+        rb->freelist = rb->bump;
+        rb->bump += rb->node_size;
+        rb->bump_left--;
+    }
+    if (rb->freelist) {
+        *(void**)rb->freelist_tail = ra->freelist;
+        if (ra->freelist == NULL)
+            ra->freelist_tail = rb->freelist_tail;
+        ra->freelist = rb->freelist;
+    }
+    if (rb->chunks) {
+        rb->chunks_tail->next = ra->chunks;
+        if (ra->chunks == NULL)
+            ra->chunks_tail = rb->chunks_tail;
+        ra->chunks = rb->chunks;
+    }
+    rb->freelist = rb->freelist_tail = NULL;
+    rb->chunks = rb->chunks_tail = NULL;
+    rb->bump = NULL;
+    _nodepool_share(ra);
+    __atomic_store_n(&rb->parent, ra, __ATOMIC_RELEASE);
+
+    #ifdef SYNC
+        ll_UNLOCK(&ra->mutex);
+        ll_UNLOCK(&rb->mutex);
+    #endif
+}
+
+/**
+ * take a node from a locked root (free list first, then current chunk).
+ */
+static void *_nodepool_take(NodePool *root)
+{
+    void *node = NULL;
+
+    if (root->freelist) {
+        node = root->freelist;
+        root->freelist = *(void**)node;
+        if (root->freelist == NULL)
+            root->freelist_tail = NULL;
+    } else {
+        if (root->bump_left == 0) {
+            /* header takes a whole cache line so nodes stay line aligned */
+            size_t bytes = CACHE_LINE_SIZE + root->chunk_nodes * root->node_size;
+            bytes = (bytes + CACHE_LINE_SIZE - 1) & ~((size_t)CACHE_LINE_SIZE - 1);
+            NodeChunk *chunk = (NodeChunk*)aligned_alloc(CACHE_LINE_SIZE, bytes);
+            assert(chunk);
+            chunk->bytes = bytes;
+            chunk->next = root->chunks;
+            if (root->chunks == NULL)
+                root->chunks_tail = chunk;
+            root->chunks = chunk;
+            root->bump = (char*)chunk + CACHE_LINE_SIZE;
+            root->bump_left = root->chunk_nodes;
+        }
+        node = root->bump;
+        root->bump += root->node_size;
+        root->bump_left--;
+    }
+    return node;
+}
+
+static void *_nodepool_alloc(NodePool *pool)
+{
+    NodePool *root = _nodepool_lockroot(pool);
+    void *node = _nodepool_take(root);
+    #ifdef SYNC
+        ll_UNLOCK(&root->mutex);
+    #endif
+    memset(node, 0, root->node_size);
+    return node;
+}
+
+static void *_nodepool_allocchain(NodePool *pool, size_t n)
+{
+    NodePool *root = _nodepool_lockroot(pool);
+    void *chain = NULL;
+    void **link = &chain;
+
+    /* chained in the order taken, so bump nodes come out in address order */
+    while (n--) {
+        *link = _nodepool_take(root);
+        link = (void**)*link;
+    }
+    *link = NULL;
+    #ifdef SYNC
+        ll_UNLOCK(&root->mutex);
+    #endif
+    return chain;
+}
+
+static void _nodepool_free(NodePool *pool, void *node)
+{
+    NodePool *root = _nodepool_lockroot(pool);
+    *(void**)node = root->freelist;
+    if (root->freelist == NULL)
+        root->freelist_tail = node;
+    root->freelist = node;
+    #ifdef SYNC
+        ll_UNLOCK(&root->mutex);
+    #endif
+}
+
+static SinglyNode *_init_singlynode(ll_LinkedList *ll, const void *elem)
+{
+    NodePool *pool = LL_POOL(ll);
+    SinglyNode *node = (SinglyNode*)(pool ? _nodepool_alloc(pool) : calloc(1, sizeof *node));
+    assert(node);
+    node->elem = CONST_CAST(void*, elem);
+    node->next = NULL;
+    return node;
+}
+
+static DoublyNode *_init_doublynode(ll_LinkedList *ll, const void *elem)
+{
+    NodePool *pool = LL_POOL(ll);
+    DoublyNode *node = (DoublyNode*)(pool ? _nodepool_alloc(pool) : calloc(1, sizeof *node));
+    assert(node);
+    node->elem = CONST_CAST(void*, elem);
+    node->next = NULL;
+    node->prev = NULL;
+    return node;
+}
+
+static void _destroy_singlynode(ll_LinkedList *ll, SinglyNode *node, ll_ElemDtor dtor)
+{
+    if (dtor == NULL)
+        dtor = _defaultdtor;
+
+    dtor(node->elem);
+    node->next = NULL;
+    if (LL_POOL(ll))
+        _nodepool_free(LL_POOL(ll), node);
+    else
+        free(node);
+    node = NULL;
+}
+
+static void _destroy_doublynode(ll_LinkedList *ll, DoublyNode *node, ll_ElemDtor dtor)
+{
+    if (dtor == NULL)
+        dtor = _defaultdtor;
 
     dtor(node->elem);
     node->next = NULL;
     node->prev = NULL;
-    free(node);
+    if (LL_POOL(ll))
+        _nodepool_free(LL_POOL(ll), node);
+    else
+        free(node);
     node = NULL;
 }
 
-int ll_insert(ll_LinkedList *ll, const void *elem)
-{
-    assert(ll);
+static SkipIndex *_init_skipindex(void)
+{
+    SkipIndex *index = (SkipIndex*)calloc(1, sizeof *index);
+    assert(index);
+    index->head = (SkipEntry*)calloc(1, sizeof *index->head +
+                                     SKIPINDEX_MAXLEVEL * sizeof index->head->lanes[0]);
+    assert(index->head);
+    index->level = 1;
+    index->length = 0;
+    index->seed = 0x9e3779b9u;
+    return index;
+}
+
+static void _skipindex_clear(SkipIndex *index)
+{
+    SkipEntry *entry = index->head->lanes[0].next;
+    SkipEntry *next = NULL;
+    while (entry) {
+        next = entry->lanes[0].next;
+        free(entry);
+        entry = next;
+    }
+    memset(index->head->lanes, 0, SKIPINDEX_MAXLEVEL * sizeof index->head->lanes[0]);
+    index->level = 1;
+    index->length = 0;
+}
+
+static void _destroy_skipindex(SkipIndex *index)
+{
+    _skipindex_clear(index);
+    free(index->head);
+    free(index);
+}
+
+/**
+ * draw a level with p = 1/4 (xorshift32).
+ */
+static size_t _skipindex_randomlevel(SkipIndex *index)
+{
+    size_t level = 1;
+    unsigned int x = index->seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    index->seed = x;
+    while ((x & 3) == 0 && level < SKIPINDEX_MAXLEVEL) {
+        level++;
+        x >>= 2;
+    }
+    return level;
+}
+
+static SkipEntry *_skipindex_newentry(size_t level, void *node)
+{
+    SkipEntry *entry = (SkipEntry*)malloc(sizeof *entry + level * sizeof entry->lanes[0]);
+    assert(entry);
+    entry->node = node;
+    return entry;
+}
+
+/**
+ * drop the unused top lanes of the header.
+ */
+static void _skipindex_trim(SkipIndex *index)
+{
+    while (index->level > 1 && index->head->lanes[index->level-1].next == NULL)
+        index->level--;
+}
+
+static void _skipindex_build(SkipIndex *index, ll_ListType type, void *node, size_t n)
+{
+    SkipEntry *last[SKIPINDEX_MAXLEVEL];
+    size_t lastpos[SKIPINDEX_MAXLEVEL];
+    SkipEntry *entry = NULL;
+    size_t i, lvl, pos = 0;
+
+    _skipindex_clear(index);
+    for (i = 0; i < SKIPINDEX_MAXLEVEL; ++i) {
+        last[i] = index->head;
+        lastpos[i] = 0;
+    }
+
+    for (pos = 1; pos <= n; ++pos) {
+        lvl = _skipindex_randomlevel(index);
+        entry = _skipindex_newentry(lvl, node);
+        for (i = 0; i < lvl; ++i) {
+            last[i]->lanes[i].next = entry;
+            last[i]->lanes[i].span = pos - lastpos[i];
+            last[i] = entry;
+            lastpos[i] = pos;
+        }
+        if (lvl > index->level)
+            index->level = lvl;
+        if (type == ll_DOUBLY)
+            node = ((DoublyNode*)node)->next;
+        else
+            node = ((SinglyNode*)node)->next;
+    }
+
+    for (i = 0; i < index->level; ++i) {
+        last[i]->lanes[i].next = NULL;
+        last[i]->lanes[i].span = n - lastpos[i];
+    }
+    index->length = n;
+}
+
+static SkipEntry *_skipindex_find(SkipIndex *index, size_t pos)
+{
+    SkipEntry *entry = index->head;
+    size_t traversed = 0;
+    size_t i = index->level;
+
+    /* entries are 1-based inside the index, the header sits at 0 */
+    pos++;
+    while (i-- > 0) {
+        while (entry->lanes[i].next && traversed + entry->lanes[i].span <= pos) {
+            traversed += entry->lanes[i].span;
+            entry = entry->lanes[i].next;
+        }
+        if (traversed == pos)
+            return entry;
+    }
+    return NULL;
+}
+
+static void _skipindex_insert(ll_LinkedList *ll, size_t pos, void *node)
+{
+    SkipIndex *index = LL_SKIPINDEX(ll);
+    SkipEntry *update[SKIPINDEX_MAXLEVEL];
+    size_t rank[SKIPINDEX_MAXLEVEL];
+    SkipEntry *entry = NULL;
+    size_t i, lvl;
+
+    if (index == NULL)
+        return;
+
+    entry = index->head;
+    i = index->level;
+    while (i-- > 0) {
+        rank[i] = (i == index->level-1) ? 0 : rank[i+1];
+        while (entry->lanes[i].next && rank[i] + entry->lanes[i].span <= pos) {
+            rank[i] += entry->lanes[i].span;
+            entry = entry->lanes[i].next;
+        }
+        update[i] = entry;
+    }
+
+    lvl = _skipindex_randomlevel(index);
+    if (lvl > index->level) {
+        for (i = index->level; i < lvl; ++i) {
+            rank[i] = 0;
+            update[i] = index->head;
+            update[i]->lanes[i].next = NULL;
+            update[i]->lanes[i].span = index->length;
+        }
+        index->level = lvl;
+    }
+
+    entry = _skipindex_newentry(lvl, node);
+    for (i = 0; i < lvl; ++i) {
+        entry->lanes[i].next = update[i]->lanes[i].next;
+        update[i]->lanes[i].next = entry;
+        entry->lanes[i].span = update[i]->lanes[i].span - (pos - rank[i]);
+        update[i]->lanes[i].span = (pos - rank[i]) + 1;
+    }
+    for (i = lvl; i < index->level; ++i)
+        update[i]->lanes[i].span++;
+    index->length++;
+}
+
+static void _skipindex_delete(ll_LinkedList *ll, size_t pos)
+{
+    SkipIndex *index = LL_SKIPINDEX(ll);
+    SkipEntry *update[SKIPINDEX_MAXLEVEL] = {NULL};
+    SkipEntry *entry = NULL;
+    size_t traversed = 0;
+    size_t i;
+
+    if (index == NULL)
+        return;
+
+    entry = index->head;
+    i = index->level;
+    while (i-- > 0) {
+        while (entry->lanes[i].next && traversed + entry->lanes[i].span <= pos) {
+            traversed += entry->lanes[i].span;
+            entry = entry->lanes[i].next;
+        }
+        update[i] = entry;
+    }
+
+    entry = update[0]->lanes[0].next;
+    for (i = 0; i < index->level; ++i) {
+        if (update[i]->lanes[i].next == entry) {
+            update[i]->lanes[i].span += entry->lanes[i].span - 1;
+            update[i]->lanes[i].next = entry->lanes[i].next;
+        } else {
+            update[i]->lanes[i].span--;
+        }
+    }
+    _skipindex_trim(index);
+    index->length--;
+    free(entry);
+}
+
+static void _skipindex_cut(SkipIndex *index, size_t pos, SkipIndex *rest)
+{
+    SkipEntry *entry = index->head;
+    size_t traversed = 0;
+    size_t i = index->level;
+
+    /* on every lane, the last entry at or before pos ends index and
+     * whatever follows it starts rest */
+    while (i-- > 0) {
+        while (entry->lanes[i].next && traversed + entry->lanes[i].span <= pos) {
+            traversed += entry->lanes[i].span;
+            entry = entry->lanes[i].next;
+        }
+        rest->head->lanes[i].next = entry->lanes[i].next;
+        rest->head->lanes[i].span = traversed + entry->lanes[i].span - pos;
+        entry->lanes[i].next = NULL;
+        entry->lanes[i].span = pos - traversed;
+    }
+
+    rest->level = index->level;
+    rest->length = index->length - pos;
+    index->length = pos;
+    _skipindex_trim(index);
+    _skipindex_trim(rest);
+}
+
+static void _skipindex_join(SkipIndex *index, SkipIndex *rest)
+{
+    SkipEntry *update[SKIPINDEX_MAXLEVEL];
+    size_t rank[SKIPINDEX_MAXLEVEL];
+    SkipEntry *entry = index->head;
+    size_t traversed = 0;
+    size_t i = index->level;
+    size_t level = (rest->level > index->level) ? rest->level : index->level;
+
+    if (rest->length == 0)
+        return;
+
+    /* last entry on every lane, its span reaches the end of index */
+    while (i-- > 0) {
+        while (entry->lanes[i].next) {
+            traversed += entry->lanes[i].span;
+            entry = entry->lanes[i].next;
+        }
+        update[i] = entry;
+        rank[i] = traversed;
+    }
+    for (i = index->level; i < level; ++i) {
+        update[i] = index->head;
+        rank[i] = 0;
+        index->head->lanes[i].next = NULL;
+        index->head->lanes[i].span = index->length;
+    }
+
+    for (i = 0; i < level; ++i) {
+        if (i < rest->level) {
+            update[i]->lanes[i].next = rest->head->lanes[i].next;
+            update[i]->lanes[i].span = (index->length - rank[i]) + rest->head->lanes[i].span;
+        } else {
+            update[i]->lanes[i].span += rest->length;
+        }
+    }
+
+    index->level = level;
+    index->length += rest->length;
+    memset(rest->head->lanes, 0, SKIPINDEX_MAXLEVEL * sizeof rest->head->lanes[0]);
+    rest->level = 1;
+    rest->length = 0;
+}
+
+static void _skipindex_insertindex(SkipIndex *index, size_t pos, SkipIndex *other)
+{
+    SkipIndex *rest = _init_skipindex();
+    _skipindex_cut(index, pos, rest);
+    _skipindex_join(index, other);
+    _skipindex_join(index, rest);
+    _destroy_skipindex(rest);
+}
+
+static void _skipindex_insertchain(ll_LinkedList *ll, size_t pos, void *first, size_t n)
+{
+    SkipIndex *index = LL_SKIPINDEX(ll);
+    SkipIndex *chain = NULL;
+
+    if (index == NULL || n == 0)
+        return;
+
+    chain = _init_skipindex();
+    chain->seed = index->seed;
+    _skipindex_build(chain, ll->type, first, n);
+    index->seed = chain->seed;
+    _skipindex_insertindex(index, pos, chain);
+    _destroy_skipindex(chain);
+}
+
+static void _skipindex_relabel(ll_LinkedList *ll, size_t pos, void *node, size_t n)
+{
+    SkipIndex *index = LL_SKIPINDEX(ll);
+    SkipEntry *entry = NULL;
+
+    if (index == NULL || n == 0)
+        return;
+
+    for (entry = _skipindex_find(index, pos); n--; entry = entry->lanes[0].next) {
+        entry->node = node;
+        if (ll->type == ll_DOUBLY)
+            node = ((DoublyNode*)node)->next;
+        else
+            node = ((SinglyNode*)node)->next;
+    }
+}
+
+static HashIndex *_init_hashindex(ll_ElemHash hash, ll_ElemCompare comp)
+{
+    HashIndex *hindex = (HashIndex*)calloc(1, sizeof *hindex);
+    assert(hindex);
+    hindex->capacity = HASHINDEX_INITIAL_CAPACITY;
+    hindex->count = 0;
+    hindex->hash = hash;
+    hindex->comp = comp;
+    hindex->slots = (HashSlot*)calloc(hindex->capacity, sizeof *hindex->slots);
+    assert(hindex->slots);
+    return hindex;
+}
+
+static void _destroy_hashindex(HashIndex *hindex)
+{
+    free(hindex->slots);
+    free(hindex);
+}
+
+/**
+ * hash an element with the user hash, or mix its address bits.
+ */
+static size_t _hashindex_hash(const HashIndex *hindex, const void *elem)
+{
+    if (hindex->hash)
+        return hindex->hash(elem);
+
+    size_t h = (size_t)(ADDR)elem;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
+
+static void _hashindex_place(HashIndex *hindex, void *elem, size_t hash)
+{
+    size_t mask = hindex->capacity - 1;
+    size_t i = hash & mask;
+    while (hindex->slots[i].used)
+        i = (i + 1) & mask;
+    hindex->slots[i].elem = elem;
+    hindex->slots[i].hash = hash;
+    hindex->slots[i].used = true;
+    hindex->count++;
+}
+
+static void _hashindex_grow(HashIndex *hindex)
+{
+    HashSlot *old = hindex->slots;
+    size_t oldcap = hindex->capacity;
+    size_t i;
+
+    hindex->capacity *= 2;
+    hindex->count = 0;
+    hindex->slots = (HashSlot*)calloc(hindex->capacity, sizeof *hindex->slots);
+    assert(hindex->slots);
+    for (i = 0; i < oldcap; ++i) {
+        if (old[i].used)
+            _hashindex_place(hindex, old[i].elem, old[i].hash);
+    }
+    free(old);
+}
+
+static void _hashindex_add(ll_LinkedList *ll, const void *elem)
+{
+    HashIndex *hindex = LL_HASHINDEX(ll);
+    if (hindex == NULL)
+        return;
+
+    /* keep load factor at or below 3/4 */
+    if (4 * (hindex->count + 1) > 3 * hindex->capacity)
+        _hashindex_grow(hindex);
+    _hashindex_place(hindex, CONST_CAST(void*, elem), _hashindex_hash(hindex, elem));
+}
+
+static void _hashindex_remove(ll_LinkedList *ll, const void *elem)
+{
+    HashIndex *hindex = LL_HASHINDEX(ll);
+    size_t mask, hash, i, j;
+
+    if (hindex == NULL)
+        return;
+
+    mask = hindex->capacity - 1;
+    hash = _hashindex_hash(hindex, elem);
+    for (i = hash & mask; hindex->slots[i].used; i = (i + 1) & mask) {
+        if (hindex->slots[i].elem == elem && hindex->slots[i].hash == hash)
+            break;
+    }
+    if (!hindex->slots[i].used)
+        return;
+
+    /* backward shift deletion keeps probe chains unbroken */
+    for (j = (i + 1) & mask; hindex->slots[j].used; j = (j + 1) & mask) {
+        size_t home = hindex->slots[j].hash & mask;
+        bool movable = (i <= j) ? (home <= i || home > j) : (home <= i && home > j);
+        if (movable) {
+            hindex->slots[i] = hindex->slots[j];
+            i = j;
+        }
+    }
+    hindex->slots[i].used = false;
+    hindex->slots[i].elem = NULL;
+    hindex->count--;
+}
+
+static bool _hashindex_contains(const HashIndex *hindex, const void *elem)
+{
+    size_t mask = hindex->capacity - 1;
+    size_t hash = _hashindex_hash(hindex, elem);
+    size_t i;
+
+    for (i = hash & mask; hindex->slots[i].used; i = (i + 1) & mask) {
+        if (hindex->slots[i].hash != hash)
+            continue;
+        if (hindex->comp ? hindex->comp(hindex->slots[i].elem, elem) == 0
+                         : hindex->slots[i].elem == elem)
+            return true;
+    }
+    return false;
+}
+
+static void *_locate(const ll_LinkedList *ll, size_t pos)
+{
+    if (pos == 0)
+        return (ll->type == ll_DOUBLY) ? (void*)ll->d_head : (void*)ll->s_head;
+
+    if (LL_SKIPINDEX(ll))
+        return _skipindex_find(LL_SKIPINDEX(ll), pos-1)->node;
+
+    if (ll->type == ll_DOUBLY) {
+        DoublyNode *tmp = ll->d_head;
+        while (pos--)
+            tmp = tmp->next;
+        return tmp;
+    } else {
+        SinglyNode *tmp = ll->s_head;
+        while (pos--)
+            tmp = tmp->next;
+        return tmp;
+    }
+}
+
+static UnrolledNode *_init_unrollednode(ll_LinkedList *ll)
+{
+    UnrolledNode *node = NULL;
+    if (LL_POOL(ll)) {
+        node = (UnrolledNode*)_nodepool_alloc(LL_POOL(ll));
+    } else {
+        node = (UnrolledNode*)aligned_alloc(CACHE_LINE_SIZE, sizeof *node);
+        assert(node);
+        memset(node, 0, sizeof *node);
+    }
+    node->next = NULL;
+    node->prev = NULL;
+    node->count = 0;
+    return node;
+}
+
+static void _destroy_unrollednode(ll_LinkedList *ll, UnrolledNode *node)
+{
+    node->next = NULL;
+    node->prev = NULL;
+    if (LL_POOL(ll))
+        _nodepool_free(LL_POOL(ll), node);
+    else
+        free(node);
+}
+
+static void _destroy_element(void *elem, ll_ElemDtor dtor)
+{
+    if (dtor == NULL)
+        dtor = _defaultdtor;
+    dtor(elem);
+}
+
+static UnrolledNode *_unrolled_locate(const ll_LinkedList *ll, size_t *pos)
+{
+    UnrolledNode *node = NULL;
+    size_t idx = *pos;
+
+    if (idx < ll->size / 2) {
+        node = ll->u_head;
+        while (idx >= node->count) {
+            idx -= node->count;
+            node = node->next;
+        }
+    } else {
+        /* number of elements from pos up to the end */
+        size_t rem = ll->size - idx;
+        node = ll->u_tail;
+        while (rem > node->count) {
+            rem -= node->count;
+            node = node->prev;
+        }
+        idx = node->count - rem;
+    }
+    *pos = idx;
+    return node;
+}
+
+static UnrolledNode *_unrolled_find(const ll_LinkedList *ll, const void *elem, size_t *idx)
+{
+    UnrolledNode *node = ll->u_head;
+    size_t i;
+    while (node) {
+        for (i = 0; i < node->count; ++i) {
+            if (node->elems[i] == elem) {
+                *idx = i;
+                return node;
+            }
+        }
+        node = node->next;
+    }
+    return NULL;
+}
+
+static void _unrolled_advance(UnrolledNode **node, size_t *idx)
+{
+    if (++(*idx) == (*node)->count) {
+        *node = (*node)->next;
+        *idx = 0;
+    }
+}
+
+static UnrolledNode *_unrolled_insertat(ll_LinkedList *ll, UnrolledNode *node, size_t *where,
+                                        const void *elem)
+{
+    size_t idx = *where;
+
+    if (node == NULL) {
+        node = _init_unrollednode(ll);
+        ll->u_head = node;
+        ll->u_tail = node;
+        idx = 0;
+    } else if (node->count == UNROLLED_NODE_ELEMS) {
+        UnrolledNode *sibling = _init_unrollednode(ll);
+        sibling->prev = node;
+        sibling->next = node->next;
+        if (node->next)
+            node->next->prev = sibling;
+        else
+            ll->u_tail = sibling;
+        node->next = sibling;
+
+        if (idx == node->count) {
+            /* appending, start a fresh node instead of leaving two half full */
+            node = sibling;
+            idx = 0;
+        } else {
+            size_t half = node->count / 2;
+            memcpy(sibling->elems, node->elems + half,
+                   (node->count - half) * sizeof *node->elems);
+            sibling->count = node->count - half;
+            node->count = half;
+            if (idx > half) {
+                node = sibling;
+                idx -= half;
+            }
+        }
+    }
+
+    memmove(node->elems + idx + 1, node->elems + idx,
+            (node->count - idx) * sizeof *node->elems);
+    node->elems[idx] = CONST_CAST(void*, elem);
+    node->count++;
+    ll->size++;
+    _hashindex_add(ll, elem);
+    *where = idx;
+    return node;
+}
+
+static void *_unrolled_removeat(ll_LinkedList *ll, UnrolledNode *node, size_t idx)
+{
+    void *elem = node->elems[idx];
+
+    memmove(node->elems + idx, node->elems + idx + 1,
+            (node->count - idx - 1) * sizeof *node->elems);
+    node->count--;
+    ll->size--;
+    _hashindex_remove(ll, elem);
+
+    if (node->count == 0) {
+        if (node->prev)
+            node->prev->next = node->next;
+        else
+            ll->u_head = node->next;
+        if (node->next)
+            node->next->prev = node->prev;
+        else
+            ll->u_tail = node->prev;
+        _destroy_unrollednode(ll, node);
+    } else if (node->next && node->count < UNROLLED_NODE_ELEMS / 2 &&
+               node->count + node->next->count <= UNROLLED_NODE_ELEMS) {
+        UnrolledNode *next = node->next;
+        memcpy(node->elems + node->count, next->elems, next->count * sizeof *next->elems);
+        node->count += next->count;
+        node->next = next->next;
+        if (next->next)
+            next->next->prev = node;
+        else
+            ll->u_tail = node;
+        _destroy_unrollednode(ll, next);
+    }
+    return elem;
+}
+
+int ll_insert(ll_LinkedList *ll, const void *elem)
+{
+    assert(ll);
+
+    switch (ll->type) {
+        case ll_CIRCLY:
+        case ll_SINGLY:
+            {
+                SinglyNode *node = _init_singlynode(ll, elem);
+                node->elem = CONST_CAST(void*, elem);
+
+                #ifdef SYNC
+                    ll_LOCK(&ll->mutex);
+                #endif
+
+                node->next = ll->s_head->next;
+                ll->s_head->next = node;
+                ll->size++;
+                _hashindex_add(ll, node->elem);
+                _skipindex_insert(ll, 0, node);
+
+                #ifdef SYNC
+                    ll_UNLOCK(&ll->mutex);
+                #endif
+            }
+            break;
+        case ll_DOUBLY:
+            {
+                DoublyNode *node = _init_doublynode(ll, elem);
+                node->elem = CONST_CAST(void*, elem);
+
+                #ifdef SYNC
+                    ll_LOCK(&ll->mutex);
+                #endif
+
+                node->next = ll->d_head->next;
+                node->prev = ll->d_head;
+                ll->d_head->next->prev = node;
+                ll->d_head->next = node;
+                ll->size++;
+                _hashindex_add(ll, node->elem);
+                _skipindex_insert(ll, 0, node);
+
+                #ifdef SYNC
+                    ll_UNLOCK(&ll->mutex);
+                #endif
+            }
+            break;
+        case ll_UNROLLED:
+            {
+                #ifdef SYNC
+                    ll_LOCK(&ll->mutex);
+                #endif
+
+                size_t idx = 0;
+                _unrolled_insertat(ll, ll->u_head, &idx, elem);
+
+                #ifdef SYNC
+                    ll_UNLOCK(&ll->mutex);
+                #endif
+            }
+            break;
+         default:
+            #ifdef ALGOS_DEBUG
+                fprintf(stderr, "%s() error: invalid linkedlist type\n", FUNC);
+            #endif
+            return ERROR;
+    }
+    return SUCCESS;
+}
+
+int ll_insert_atend(ll_LinkedList *ll, const void *elem)
+{
+    assert(ll);
+
+    if (ll_islinkedlistempty(ll))
+        return ll_insert(ll, elem);
+
+    switch (ll->type) {
+        case ll_SINGLY:
+            {
+                SinglyNode *node = _init_singlynode(ll, elem);
+
+                #ifdef SYNC
+                    ll_LOCK(&ll->mutex);
+                #endif
+
+                SinglyNode *tmp = ll->s_head->next;
+                while (tmp->next != tmp->next->next)
+                    tmp = tmp->next;
+
+                node->elem = CONST_CAST(void*, elem);
+                node->next = tmp->next;
+                tmp->next = node;
+                ll->size++;
+                _hashindex_add(ll, node->elem);
+                _skipindex_insert(ll, ll->size-1, node);
+
+                #ifdef SYNC
+                    ll_UNLOCK(&ll->mutex);
+                #endif
+            }
+            break;
+        case ll_DOUBLY:
+            {
+                DoublyNode *node = _init_doublynode(ll, elem);
+
+                #ifdef SYNC
+                    ll_LOCK(&ll->mutex);
+                #endif
+
+                DoublyNode *tmp = ll->d_head->next;
+                while (tmp->next != tmp->next->next)
+                    tmp = tmp->next;
+
+                node->elem = CONST_CAST(void*, elem);
+                node->next = tmp->next;
+                node->prev = tmp;
+                tmp->next->prev = node;
+                tmp->next = node;
+                ll->size++;
+                _hashindex_add(ll, node->elem);
+                _skipindex_insert(ll, ll->size-1, node);
+
+                #ifdef SYNC
+                    ll_UNLOCK(&ll->mutex);
+                #endif
+            }
+            break;
+        case ll_CIRCLY:
+            {
+                SinglyNode *node = _init_singlynode(ll, elem);
+
+                #ifdef SYNC
+                    ll_LOCK(&ll->mutex);
+                #endif
+
+                SinglyNode *tmp = ll->s_head->next;
+                while (tmp->next->next != ll->s_head)
+                    tmp = tmp->next;
+
+                node->elem = CONST_CAST(void*, elem);
+                node->next = tmp->next;
+                tmp->next = node;
+                ll->size++;
+                _hashindex_add(ll, node->elem);
+                _skipindex_insert(ll, ll->size-1, node);
+
+                #ifdef SYNC
+                    ll_UNLOCK(&ll->mutex);
+                #endif
+            }
+            break;
+        case ll_UNROLLED:
+            {
+                #ifdef SYNC
+                    ll_LOCK(&ll->mutex);
+                #endif
+
+                size_t idx = ll->u_tail->count;
+                _unrolled_insertat(ll, ll->u_tail, &idx, elem);
+
+                #ifdef SYNC
+                    ll_UNLOCK(&ll->mutex);
+                #endif
+            }
+            break;
+        default:
+            #ifdef ALGOS_DEBUG
+                fprintf(stderr, "%s() error: invalid linkedlist type\n", FUNC);
+            #endif
+            return ERROR;
+    }
+    return SUCCESS;
+}
+
+int ll_insert_before(ll_LinkedList *ll, const void *elem, const void *new_elem)
+{
+    bool found = false;
+
+    assert(ll);
+
+    if (ll_islinkedlistempty(ll)) {
+        int rc = ll_insert(ll, new_elem);
+        if (SUCCESS == rc)
+            return ll_insert(ll, elem);
+        else
+            return rc;
+    }
+
+    switch (ll->type) {
+        case ll_SINGLY:
+            {
+                SinglyNode *node = _init_singlynode(ll, elem);
+
+                #ifdef SYNC
+                    ll_LOCK(&ll->mutex);
+                #endif
+
+                SinglyNode *tmp = ll->s_head->next;
+                size_t pos = 0;
+                while (tmp->next != tmp->next->next) {
+                    if (tmp->next->elem == elem) {
+                        found = true;
+                        node->elem = CONST_CAST(void*, new_elem);
+                        node->next = tmp->next;
+                        tmp->next = node;
+                        ll->size++;
+                        _hashindex_add(ll, node->elem);
+                        _skipindex_insert(ll, pos+1, node);
+                        break;
+                    }
+                    tmp = tmp->next;
+                    pos++;
+                }
+
+                #ifdef SYNC
+                    ll_UNLOCK(&ll->mutex);
+                #endif
+            }
+            break;
+        case ll_DOUBLY:
+            {
+                DoublyNode *node = _init_doublynode(ll, elem);
+
+                #ifdef SYNC
+                    ll_LOCK(&ll->mutex);
+                #endif
+
+                DoublyNode *tmp = ll->d_head->next;
+                size_t pos = 0;
+                while (tmp->next != tmp->next->next) {
+                    if (tmp->next->elem == elem) {
+                        found = true;
+                        node->elem = CONST_CAST(void*, new_elem);
+                        node->next = tmp->next;
+                        node->prev = tmp;
+                        tmp->next->prev = node;
+                        tmp->next = node;
+                        ll->size++;
+                        _hashindex_add(ll, node->elem);
+                        _skipindex_insert(ll, pos+1, node);
+                        break;
+                    }
+                    tmp = tmp->next;
+                    pos++;
+                }
+
+                #ifdef SYNC
+                    ll_UNLOCK(&ll->mutex);
+                #endif
+            }
+            break;
+        case ll_CIRCLY:
+            {
+                SinglyNode *node = _init_singlynode(ll, elem);
+
+                #ifdef SYNC
+                    ll_LOCK(&ll->mutex);
+                #endif
+
+                SinglyNode *tmp = ll->s_head->next;
+                size_t pos = 0;
+                while (tmp->next->next != ll->s_head) {
+                    if (tmp->next->elem == elem) {
+                        found = true;
+                        node->elem = CONST_CAST(void*, new_elem);
+                        node->next = tmp->next;
+                        tmp->next = node;
+                        ll->size++;
+                        _hashindex_add(ll, node->elem);
+                        _skipindex_insert(ll, pos+1, node);
+                        break;
+                    }
+                    tmp = tmp->next;
+                    pos++;
+                }
+
+                #ifdef SYNC
+                    ll_UNLOCK(&ll->mutex);
+                #endif
+            }
+            break;
+        case ll_UNROLLED:
+            {
+                #ifdef SYNC
+                    ll_LOCK(&ll->mutex);
+                #endif
+
+                size_t idx = 0;
+                UnrolledNode *node = _unrolled_find(ll, elem, &idx);
+                if (node) {
+                    found = true;
+                    _unrolled_insertat(ll, node, &idx, new_elem);
+                }
+
+                #ifdef SYNC
+                    ll_UNLOCK(&ll->mutex);
+                #endif
+            }
+            break;
+        default:
+            #ifdef ALGOS_DEBUG
+                fprintf(stderr, "%s() error: invalid linkedlist type\n", FUNC);
+            #endif
+            return ERROR;
+    }
+
+    if (!found) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: linkedlist elem not found\n", FUNC);
+        #endif
+        return NOTFOUND;
+    }
+    return SUCCESS;
+}
+
+int ll_insert_after(ll_LinkedList *ll, const void *elem, const void *new_elem)
+{
+    bool found = false;
+
+    assert(ll);
+
+    if (ll_islinkedlistempty(ll)) {
+        int rc = ll_insert(ll, elem);
+        if (SUCCESS == rc)
+            rc = ll_insert(ll, new_elem);
+        return rc;
+    }
+
+    switch (ll->type) {
+        case ll_SINGLY:
+            {
+                SinglyNode *node = _init_singlynode(ll, elem);
+
+                #ifdef SYNC
+                    ll_LOCK(&ll->mutex);
+                #endif
+
+                SinglyNode *tmp = ll->s_head->next;
+                size_t pos = 0;
+                while (tmp->next != tmp->next->next) {
+                    if (tmp->elem == elem) {
+                        found = true;
+                        node->elem = CONST_CAST(void*, new_elem);
+                        node->next = tmp->next;
+                        tmp->next = node;
+                        ll->size++;
+                        _hashindex_add(ll, node->elem);
+                        _skipindex_insert(ll, pos+1, node);
+                        break;
+                    }
+                    tmp = tmp->next;
+                    pos++;
+                }
+
+                #ifdef SYNC
+                    ll_UNLOCK(&ll->mutex);
+                #endif
+            }
+            break;
+        case ll_DOUBLY:
+            {
+                DoublyNode *node = _init_doublynode(ll, elem);
+
+                #ifdef SYNC
+                    ll_LOCK(&ll->mutex);
+                #endif
+
+                DoublyNode *tmp = ll->d_head->next;
+                size_t pos = 0;
+                while (tmp->next != tmp->next->next) {
+                    if (tmp->elem == elem) {
+                        found = true;
+                        node->elem = CONST_CAST(void*, new_elem);
+                        node->next = tmp->next;
+                        node->prev = tmp;
+                        tmp->next->prev = node;
+                        tmp->next = node;
+                        ll->size++;
+                        _hashindex_add(ll, node->elem);
+                        _skipindex_insert(ll, pos+1, node);
+                        break;
+                    }
+                    tmp = tmp->next;
+                    pos++;
+                }
+
+                #ifdef SYNC
+                    ll_UNLOCK(&ll->mutex);
+                #endif
+            }
+            break;
+        case ll_CIRCLY:
+            {
+                SinglyNode *node = _init_singlynode(ll, elem);
+
+                #ifdef SYNC
+                    ll_LOCK(&ll->mutex);
+                #endif
+
+                SinglyNode *tmp = ll->s_head->next;
+                size_t pos = 0;
+                while (tmp->next->next != ll->s_head) {
+                    if (tmp->elem == elem) {
+                        found = true;
+                        node->elem = CONST_CAST(void*, new_elem);
+                        node->next = tmp->next;
+                        tmp->next = node;
+                        ll->size++;
+                        _hashindex_add(ll, node->elem);
+                        _skipindex_insert(ll, pos+1, node);
+                        break;
+                    }
+                    tmp = tmp->next;
+                    pos++;
+                }
+
+                #ifdef SYNC
+                    ll_UNLOCK(&ll->mutex);
+                #endif
+            }
+            break;
+        case ll_UNROLLED:
+            {
+                #ifdef SYNC
+                    ll_LOCK(&ll->mutex);
+                #endif
+
+                size_t idx = 0;
+                UnrolledNode *node = _unrolled_find(ll, elem, &idx);
+                if (node) {
+                    found = true;
+                    idx++;
+                    _unrolled_insertat(ll, node, &idx, new_elem);
+                }
+
+                #ifdef SYNC
+                    ll_UNLOCK(&ll->mutex);
+                #endif
+            }
+            break;
+        default:
+            #ifdef ALGOS_DEBUG
+                fprintf(stderr, "%s() error: invalid linkedlist type\n", FUNC);
+            #endif
+            return ERROR;
+    }
+
+    if (!found) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: linkedlist elem not found\n", FUNC);
+        #endif
+        return NOTFOUND;
+    }
+    return SUCCESS;
+}
+
+void *ll_get(const ll_LinkedList *ll)
+{
+    void *elem = NULL;
+
+    assert(ll);
+
+    if (ll_islinkedlistempty(ll)) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: linkedlist is empty\n", FUNC);
+        #endif
+        return NULL;
+    }
+
+    switch (ll->type) {
+        case ll_CIRCLY:
+        case ll_SINGLY:
+            #ifdef SYNC
+                ll_LOCK(LL_MUTEX(ll));
+            #endif
+            elem = ll->s_head->next->elem;
+            #ifdef SYNC
+                ll_UNLOCK(LL_MUTEX(ll));
+            #endif
+            break;
+        case ll_DOUBLY:
+            #ifdef SYNC
+                ll_LOCK(LL_MUTEX(ll));
+            #endif
+            elem = ll->d_head->next->elem;
+            #ifdef SYNC
+                ll_UNLOCK(LL_MUTEX(ll));
+            #endif
+            break;
+        case ll_UNROLLED:
+            #ifdef SYNC
+                ll_LOCK(LL_MUTEX(ll));
+            #endif
+            elem = ll->u_head->elems[0];
+            #ifdef SYNC
+                ll_UNLOCK(LL_MUTEX(ll));
+            #endif
+            break;
+        default:
+            #ifdef ALGOS_DEBUG
+                fprintf(stderr, "%s() error: invalid linkedlist type\n", FUNC);
+            #endif
+            break;
+    }
+    return elem;
+}
+
+void *ll_get_atend(const ll_LinkedList *ll)
+{
+    void *elem = NULL;
+
+    assert(ll);
+
+    if (ll_islinkedlistempty(ll)) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: linkedlist is empty\n", FUNC);
+        #endif
+        return NULL;
+    }
+
+    switch (ll->type) {
+        case ll_CIRCLY:
+            {
+                #ifdef SYNC
+                    ll_LOCK(LL_MUTEX(ll));
+                #endif
+
+                SinglyNode *tmp = ll->s_head->next;
+                while (tmp->next->next != ll->s_head)
+                    tmp = tmp->next;
+                elem = tmp->elem;
+
+                #ifdef SYNC
+                    ll_UNLOCK(LL_MUTEX(ll));
+                #endif
+            }
+            break;
+        case ll_DOUBLY:
+            {
+                #ifdef SYNC
+                    ll_LOCK(LL_MUTEX(ll));
+                #endif
+
+                DoublyNode *tmp = ll->d_head->next;
+                while (tmp->next != tmp->next->next)
+                    tmp = tmp->next;
+                elem = tmp->elem;
+
+                #ifdef SYNC
+                    ll_UNLOCK(LL_MUTEX(ll));
+                #endif
+            }
+            break;
+        case ll_SINGLY:
+            {
+                #ifdef SYNC
+                    ll_LOCK(LL_MUTEX(ll));
+                #endif
+
+                SinglyNode *tmp = ll->s_head->next;
+                while (tmp->next != tmp->next->next)
+                    tmp = tmp->next;
+                elem = tmp->elem;
+
+                #ifdef SYNC
+                    ll_UNLOCK(LL_MUTEX(ll));
+                #endif
+            }
+            break;
+        case ll_UNROLLED:
+            #ifdef SYNC
+                ll_LOCK(LL_MUTEX(ll));
+            #endif
+            elem = ll->u_tail->elems[ll->u_tail->count-1];
+            #ifdef SYNC
+                ll_UNLOCK(LL_MUTEX(ll));
+            #endif
+            break;
+        default:
+            #ifdef ALGOS_DEBUG
+                fprintf(stderr, "%s() error: invalid linkedlist type\n", FUNC);
+            #endif
+            break;
+    }
+    return elem;
+}
+
+void *ll_get_before(const ll_LinkedList *ll, const void *elem)
+{
+    void *element = NULL;
+
+    assert(ll);
+
+    if (ll_islinkedlistempty(ll)) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: linkedlist is empty\n", FUNC);
+        #endif
+        return NULL;
+    }
+
+    switch (ll->type) {
+        case ll_CIRCLY:
+            {
+                #ifdef SYNC
+                    ll_LOCK(LL_MUTEX(ll));
+                #endif
+
+                SinglyNode *tmp = ll->s_head->next;
+                while (tmp->next->next != ll->s_head) {
+                    if (tmp->next->elem == elem) {
+                        element = tmp->elem;
+                        break;
+                    }
+                    tmp = tmp->next;
+                }
+
+                #ifdef SYNC
+                    ll_UNLOCK(LL_MUTEX(ll));
+                #endif
+            }
+            break;
+        case ll_DOUBLY:
+            {
+                #ifdef SYNC
+                    ll_LOCK(LL_MUTEX(ll));
+                #endif
+
+                DoublyNode *tmp = ll->d_head->next;
+                while (tmp->next != tmp->next->next) {
+                    if (tmp->next->elem == elem) {
+                        element = tmp->elem;
+                        break;
+                    }
+                    tmp = tmp->next;
+                }
+
+                #ifdef SYNC
+                    ll_UNLOCK(LL_MUTEX(ll));
+                #endif
+            }
+            break;
+        case ll_SINGLY:
+            {
+                #ifdef SYNC
+                    ll_LOCK(LL_MUTEX(ll));
+                #endif
+
+                SinglyNode *tmp = ll->s_head->next;
+                while (tmp->next != tmp->next->next) {
+                    if (tmp->next->elem == elem) {
+                        element = tmp->elem;
+                        break;
+                    }
+                    tmp = tmp->next;
+                }
+
+                #ifdef SYNC
+                    ll_UNLOCK(LL_MUTEX(ll));
+                #endif
+            }
+            break;
+        case ll_UNROLLED:
+            {
+                #ifdef SYNC
+                    ll_LOCK(LL_MUTEX(ll));
+                #endif
+
+                size_t idx = 0;
+                UnrolledNode *node = _unrolled_find(ll, elem, &idx);
+                if (node && idx > 0)
+                    element = node->elems[idx-1];
+                else if (node && node->prev)
+                    element = node->prev->elems[node->prev->count-1];
+
+                #ifdef SYNC
+                    ll_UNLOCK(LL_MUTEX(ll));
+                #endif
+            }
+            break;
+        default:
+            #ifdef ALGOS_DEBUG
+                fprintf(stderr, "%s() error: invalid linkedlist type\n", FUNC);
+            #endif
+            break;
+    }
+    return element;
+}
+
+void *ll_get_after(const ll_LinkedList *ll, const void *elem)
+{
+    void *element = NULL;
+
+    assert(ll);
+
+    if (ll_islinkedlistempty(ll)) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: linkedlist is empty\n", FUNC);
+        #endif
+        return NULL;
+    }
+
+    switch (ll->type) {
+        case ll_SINGLY:
+            {
+                #ifdef SYNC
+                    ll_LOCK(LL_MUTEX(ll));
+                #endif
+
+                SinglyNode *tmp = ll->s_head->next;
+                while (tmp->next != tmp->next->next) {
+                    if (tmp->elem == elem) {
+                        element = tmp->next->elem;
+                        break;
+                    }
+                    tmp = tmp->next;
+                }
+
+                #ifdef SYNC
+                    ll_UNLOCK(LL_MUTEX(ll));
+                #endif
+            }
+            break;
+        case ll_DOUBLY:
+            {
+                #ifdef SYNC
+                    ll_LOCK(LL_MUTEX(ll));
+                #endif
+
+                DoublyNode *tmp = ll->d_head->next;
+                while (tmp->next != tmp->next->next) {
+                    if (tmp->elem == elem) {
+                        element = tmp->next->elem;
+                        break;
+                    }
+                    tmp = tmp->next;
+                }
+
+                #ifdef SYNC
+                    ll_UNLOCK(LL_MUTEX(ll));
+                #endif
+            }
+            break;
+        case ll_CIRCLY:
+            {
+                #ifdef SYNC
+                    ll_LOCK(LL_MUTEX(ll));
+                #endif
+
+                SinglyNode *tmp = ll->s_head->next;
+                while (tmp->next->next != ll->s_head) {
+                    if (tmp->elem == elem) {
+                        element = tmp->next->elem;
+                        break;
+                    }
+                    tmp = tmp->next;
+                }
+
+                #ifdef SYNC
+                    ll_UNLOCK(LL_MUTEX(ll));
+                #endif
+            }
+            break;
+        case ll_UNROLLED:
+            {
+                #ifdef SYNC
+                    ll_LOCK(LL_MUTEX(ll));
+                #endif
+
+                size_t idx = 0;
+                UnrolledNode *node = _unrolled_find(ll, elem, &idx);
+                if (node && idx+1 < node->count)
+                    element = node->elems[idx+1];
+                else if (node && node->next)
+                    element = node->next->elems[0];
+
+                #ifdef SYNC
+                    ll_UNLOCK(LL_MUTEX(ll));
+                #endif
+            }
+            break;
+        default:
+            #ifdef ALGOS_DEBUG
+                fprintf(stderr, "%s() error: invalid linkedlist type\n", FUNC);
+            #endif
+            break;
+    }
+    return element;
+}
+
+void ll_delete(ll_LinkedList *ll, const void *elem, ll_ElemDtor dtor)
+{
+    assert(ll);
+
+    switch (ll->type) {
+        case ll_CIRCLY:
+            {
+                SinglyNode *node = NULL;
+
+                #ifdef SYNC
+                    ll_LOCK(&ll->mutex);
+                #endif
+
+                SinglyNode *tmp = ll->s_head->next;
+                size_t pos = 0;
+                while (tmp->next->next != ll->s_head) {
+                    if (tmp->next->elem == elem) {
+                        node = tmp->next;
+                        tmp->next = tmp->next->next;
+                        ll->size--;
+                        _hashindex_remove(ll, node->elem);
+                        _skipindex_delete(ll, pos+1);
+                        _destroy_singlynode(ll, node, dtor);
+                        break;
+                    }
+                    tmp = tmp->next;
+                    pos++;
+                }
+
+                #ifdef SYNC
+                    ll_UNLOCK(&ll->mutex);
+                #endif
+            }
+            break;
+        case ll_DOUBLY:
+            {
+                DoublyNode *node = NULL;
 
-    switch (ll->type) {
-        case ll_CIRCLY:
+                #ifdef SYNC
+                    ll_LOCK(&ll->mutex);
+                #endif
+
+                DoublyNode *tmp = ll->d_head->next;
+                size_t pos = 0;
+                while (tmp->next != tmp->next->next) {
+                    if (tmp->next->elem == elem) {
+                        node = tmp->next;
+                        tmp->next = tmp->next->next;
+                        tmp->next->prev = tmp;
+                        ll->size--;
+                        _hashindex_remove(ll, node->elem);
+                        _skipindex_delete(ll, pos+1);
+                        _destroy_doublynode(ll, node, dtor);
+                        break;
+                    }
+                    tmp = tmp->next;
+                    pos++;
+                }
+
+                #ifdef SYNC
+                    ll_UNLOCK(&ll->mutex);
+                #endif
+            }
+            break;
         case ll_SINGLY:
             {
-                SinglyNode *node = _init_singlynode(elem);
-                node->elem = CONST_CAST(void*, elem);
+                SinglyNode *node = NULL;
 
                 #ifdef SYNC
                     ll_LOCK(&ll->mutex);
                 #endif
 
-                node->next = ll->s_head->next;
-                ll->s_head->next = node;
-                ll->size++;
+                SinglyNode *tmp = ll->s_head->next;
+                size_t pos = 0;
+                while (tmp->next != tmp->next->next) {
+                    if (tmp->next->elem == elem) {
+                        node = tmp->next;
+                        tmp->next = tmp->next->next;
+                        ll->size--;
+                        _hashindex_remove(ll, node->elem);
+                        _skipindex_delete(ll, pos+1);
+                        _destroy_singlynode(ll, node, dtor);
+                        break;
+                    }
+                    tmp = tmp->next;
+                    pos++;
+                }
 
                 #ifdef SYNC
                     ll_UNLOCK(&ll->mutex);
                 #endif
             }
             break;
-        case ll_DOUBLY:
+        case ll_UNROLLED:
             {
-                DoublyNode *node = _init_doublynode(elem);
-                node->elem = CONST_CAST(void*, elem);
+                void *element = NULL;
+                bool removed = false;
 
                 #ifdef SYNC
                     ll_LOCK(&ll->mutex);
                 #endif
 
-                node->next = ll->d_head->next;
-                node->prev = ll->d_head;
-                ll->d_head->next->prev = node;
-                ll->d_head->next = node;
-                ll->size++;
+                size_t idx = 0;
+                UnrolledNode *node = _unrolled_find(ll, elem, &idx);
+                if (node) {
+                    element = _unrolled_removeat(ll, node, idx);
+                    removed = true;
+                }
 
                 #ifdef SYNC
                     ll_UNLOCK(&ll->mutex);
                 #endif
+
+                if (removed)
+                    _destroy_element(element, dtor);
             }
             break;
-         default:
+        default:
             #ifdef ALGOS_DEBUG
                 fprintf(stderr, "%s() error: invalid linkedlist type\n", FUNC);
             #endif
-            return ERROR;
+            break;
     }
-    return SUCCESS;
 }
 
-int ll_insert_atend(ll_LinkedList *ll, const void *elem)
+void ll_delete_atend(ll_LinkedList *ll, ll_ElemDtor dtor)
 {
     assert(ll);
 
-    if (ll_islinkedlistempty(ll))
-        return ll_insert(ll, elem);
-
     switch (ll->type) {
+        case ll_CIRCLY:
         case ll_SINGLY:
             {
-                SinglyNode *node = _init_singlynode(elem);
+                SinglyNode *node = NULL;
 
                 #ifdef SYNC
                     ll_LOCK(&ll->mutex);
                 #endif
 
-                SinglyNode *tmp = ll->s_head->next;
-                while (tmp->next != tmp->next->next)
-                    tmp = tmp->next;
-
-                node->elem = CONST_CAST(void*, elem);
-                node->next = tmp->next;
-                tmp->next = node;
-                ll->size++;
+                if (ll->size > 0) {
+                    SinglyNode *tmp = (SinglyNode*)_locate(ll, ll->size-1);
+                    node = tmp->next;
+                    tmp->next = node->next;
+                    ll->size--;
+                    _hashindex_remove(ll, node->elem);
+                    _skipindex_delete(ll, ll->size);
+                }
 
                 #ifdef SYNC
                     ll_UNLOCK(&ll->mutex);
                 #endif
+
+                if (node)
+                    _destroy_singlynode(ll, node, dtor);
             }
             break;
         case ll_DOUBLY:
             {
-                DoublyNode *node = _init_doublynode(elem);
+                DoublyNode *node = NULL;
 
                 #ifdef SYNC
                     ll_LOCK(&ll->mutex);
                 #endif
 
-                DoublyNode *tmp = ll->d_head->next;
-                while (tmp->next != tmp->next->next)
-                    tmp = tmp->next;
-
-                node->elem = CONST_CAST(void*, elem);
-                node->next = tmp->next;
-                node->prev = tmp;
-                tmp->next = node;
-                ll->size++;
+                if (ll->size > 0) {
+                    DoublyNode *tmp = NULL;
+                    node = ll->d_tail->prev;
+                    tmp = node->prev;
+                    tmp->next = ll->d_tail;
+                    ll->d_tail->prev = tmp;
+                    ll->size--;
+                    _hashindex_remove(ll, node->elem);
+                    _skipindex_delete(ll, ll->size);
+                }
 
                 #ifdef SYNC
                     ll_UNLOCK(&ll->mutex);
                 #endif
+
+                if (node)
+                    _destroy_doublynode(ll, node, dtor);
             }
             break;
-        case ll_CIRCLY:
+        case ll_UNROLLED:
             {
-                SinglyNode *node = _init_singlynode(elem);
+                void *element = NULL;
+                bool removed = false;
 
                 #ifdef SYNC
                     ll_LOCK(&ll->mutex);
                 #endif
 
-                SinglyNode *tmp = ll->s_head->next;
-                while (tmp->next->next != ll->s_head)
-                    tmp = tmp->next;
-
-                node->elem = CONST_CAST(void*, elem);
-                node->next = tmp->next;
-                tmp->next = node;
-                ll->size++;
+                if (ll->u_tail) {
+                    element = _unrolled_removeat(ll, ll->u_tail, ll->u_tail->count-1);
+                    removed = true;
+                }
 
                 #ifdef SYNC
                     ll_UNLOCK(&ll->mutex);
                 #endif
+
+                if (removed)
+                    _destroy_element(element, dtor);
             }
             break;
         default:
             #ifdef ALGOS_DEBUG
                 fprintf(stderr, "%s() error: invalid linkedlist type\n", FUNC);
             #endif
-            return ERROR;
+            break;
     }
-    return SUCCESS;
 }
 
-int ll_insert_before(ll_LinkedList *ll, const void *elem, const void *new_elem)
+void ll_delete_before(ll_LinkedList *ll, const void *elem, ll_ElemDtor dtor)
 {
-    bool found = false;
-
     assert(ll);
 
-    if (ll_islinkedlistempty(ll)) {
-        int rc = ll_insert(ll, new_elem);
-        if (SUCCESS == rc)
-            return ll_insert(ll, elem);
-        else
-            return rc;
-    }
-
     switch (ll->type) {
-        case ll_SINGLY:
+        case ll_CIRCLY:
             {
-                SinglyNode *node = _init_singlynode(elem);
+                SinglyNode *node = NULL;
 
                 #ifdef SYNC
                     ll_LOCK(&ll->mutex);
                 #endif
 
                 SinglyNode *tmp = ll->s_head->next;
-                while (tmp->next != tmp->next->next) {
-                    if (tmp->next->elem == elem) {
-                        found = true;
-                        node->elem = CONST_CAST(void*, new_elem);
-                        node->next = tmp->next;
-                        tmp->next = node;
-                        ll->size++;
-                        break;
-                    }
+                while (tmp->next->next != ll->s_head)
                     tmp = tmp->next;
-                }
+
+                node = tmp->next;
+                tmp->next = tmp->next->next;
+                ll->size--;
+                _hashindex_remove(ll, node->elem);
+                _skipindex_delete(ll, ll->size);
 
                 #ifdef SYNC
                     ll_UNLOCK(&ll->mutex);
                 #endif
+
+                _destroy_singlynode(ll, node, dtor);
             }
             break;
         case ll_DOUBLY:
             {
-                DoublyNode *node = _init_doublynode(elem);
+                DoublyNode *node = NULL;
 
                 #ifdef SYNC
                     ll_LOCK(&ll->mutex);
                 #endif
 
                 DoublyNode *tmp = ll->d_head->next;
-                while (tmp->next != tmp->next->next) {
-                    if (tmp->next->elem == elem) {
-                        found = true;
-                        node->elem = CONST_CAST(void*, new_elem);
-                        node->next = tmp->next;
-                        node->prev = tmp;
-                        tmp->next = node;
-                        ll->size++;
-                        break;
-                    }
+                while (tmp->next->next != tmp->next->next->next)
                     tmp = tmp->next;
-                }
+
+                node = tmp->next;
+                tmp->next = tmp->next->next;
+                tmp->next->prev = tmp;
+                ll->size--;
+                _hashindex_remove(ll, node->elem);
+                _skipindex_delete(ll, ll->size);
 
                 #ifdef SYNC
                     ll_UNLOCK(&ll->mutex);
                 #endif
+
+                _destroy_doublynode(ll, node, dtor);
             }
             break;
-        case ll_CIRCLY:
+        case ll_SINGLY:
             {
-                SinglyNode *node = _init_singlynode(elem);
+                SinglyNode *node = NULL;
 
                 #ifdef SYNC
                     ll_LOCK(&ll->mutex);
                 #endif
 
                 SinglyNode *tmp = ll->s_head->next;
-                while (tmp->next->next != ll->s_head) {
-                    if (tmp->next->elem == elem) {
-                        found = true;
-                        node->elem = CONST_CAST(void*, new_elem);
-                        node->next = tmp->next;
-                        tmp->next = node;
-                        ll->size++;
-                        break;
-                    }
+                while (tmp->next->next != tmp->next->next->next)
                     tmp = tmp->next;
+
+                node = tmp->next;
+                tmp->next = tmp->next->next;
+                ll->size--;
+                _hashindex_remove(ll, node->elem);
+                _skipindex_delete(ll, ll->size);
+
+                #ifdef SYNC
+                    ll_UNLOCK(&ll->mutex);
+                #endif
+
+                _destroy_singlynode(ll, node, dtor);
+            }
+            break;
+        case ll_UNROLLED:
+            {
+                void *element = NULL;
+                bool removed = false;
+
+                #ifdef SYNC
+                    ll_LOCK(&ll->mutex);
+                #endif
+
+                size_t idx = 0;
+                UnrolledNode *node = _unrolled_find(ll, elem, &idx);
+                if (node && idx > 0) {
+                    element = _unrolled_removeat(ll, node, idx-1);
+                    removed = true;
+                } else if (node && node->prev) {
+                    element = _unrolled_removeat(ll, node->prev, node->prev->count-1);
+                    removed = true;
                 }
 
                 #ifdef SYNC
                     ll_UNLOCK(&ll->mutex);
                 #endif
+
+                if (removed)
+                    _destroy_element(element, dtor);
             }
             break;
         default:
             #ifdef ALGOS_DEBUG
                 fprintf(stderr, "%s() error: invalid linkedlist type\n", FUNC);
             #endif
-            return ERROR;
-    }
-
-    if (!found) {
-        #ifdef ALGOS_DEBUG
-            fprintf(stderr, "%s() error: linkedlist elem not found\n", FUNC);
-        #endif
-        return NOTFOUND;
+            break;
     }
-    return SUCCESS;
 }
 
-int ll_insert_after(ll_LinkedList *ll, const void *elem, const void *new_elem)
+void ll_delete_after(ll_LinkedList *ll, const void *elem, ll_ElemDtor dtor)
 {
-    bool found = false;
-
     assert(ll);
 
-    if (ll_islinkedlistempty(ll)) {
-        int rc = ll_insert(ll, elem);
-        if (SUCCESS == rc)
-            rc = ll_insert(ll, new_elem);
-        return rc;
-    }
-
     switch (ll->type) {
-        case ll_SINGLY:
+        case ll_CIRCLY:
             {
-                SinglyNode *node = _init_singlynode(elem);
+                SinglyNode *node = NULL;
 
                 #ifdef SYNC
                     ll_LOCK(&ll->mutex);
                 #endif
 
                 SinglyNode *tmp = ll->s_head->next;
-                while (tmp->next != tmp->next->next) {
+                size_t pos = 0;
+                while (tmp->next != ll->s_head) {
                     if (tmp->elem == elem) {
-                        found = true;
-                        node->elem = CONST_CAST(void*, new_elem);
-                        node->next = tmp->next;
-                        tmp->next = node;
-                        ll->size++;
+                        node = tmp->next;
+                        tmp->next = tmp->next->next;
+                        ll->size--;
+                        _hashindex_remove(ll, node->elem);
+                        _skipindex_delete(ll, pos+1);
+                        _destroy_singlynode(ll, node, dtor);
                         break;
                     }
                     tmp = tmp->next;
+                    pos++;
                 }
 
                 #ifdef SYNC
@@ -559,24 +2812,56 @@ int ll_insert_after(ll_LinkedList *ll, const void *elem, const void *new_elem)
             break;
         case ll_DOUBLY:
             {
-                DoublyNode *node = _init_doublynode(elem);
+                DoublyNode *node = NULL;
 
                 #ifdef SYNC
                     ll_LOCK(&ll->mutex);
                 #endif
 
                 DoublyNode *tmp = ll->d_head->next;
+                size_t pos = 0;
                 while (tmp->next != tmp->next->next) {
                     if (tmp->elem == elem) {
-                        found = true;
-                        node->elem = CONST_CAST(void*, new_elem);
-                        node->next = tmp->next;
-                        node->prev = tmp;
-                        tmp->next = node;
-                        ll->size++;
+                        node = tmp->next;
+                        tmp->next = tmp->next->next;
+                        tmp->next->prev = tmp;
+                        ll->size--;
+                        _hashindex_remove(ll, node->elem);
+                        _skipindex_delete(ll, pos+1);
+                        _destroy_doublynode(ll, node, dtor);
+                        break;
+                    }
+                    tmp = tmp->next;
+                    pos++;
+                }
+
+                #ifdef SYNC
+                    ll_UNLOCK(&ll->mutex);
+                #endif
+            }
+            break;
+        case ll_SINGLY:
+            {
+                SinglyNode *node = NULL;
+
+                #ifdef SYNC
+                    ll_LOCK(&ll->mutex);
+                #endif
+
+                SinglyNode *tmp = ll->s_head->next;
+                size_t pos = 0;
+                while (tmp->next != tmp->next->next) {
+                    if (tmp->elem == elem) {
+                        node = tmp->next;
+                        tmp->next = tmp->next->next;
+                        ll->size--;
+                        _hashindex_remove(ll, node->elem);
+                        _skipindex_delete(ll, pos+1);
+                        _destroy_singlynode(ll, node, dtor);
                         break;
                     }
                     tmp = tmp->next;
+                    pos++;
                 }
 
                 #ifdef SYNC
@@ -584,80 +2869,129 @@ int ll_insert_after(ll_LinkedList *ll, const void *elem, const void *new_elem)
                 #endif
             }
             break;
-        case ll_CIRCLY:
+        case ll_UNROLLED:
             {
-                SinglyNode *node = _init_singlynode(elem);
+                void *element = NULL;
+                bool removed = false;
 
                 #ifdef SYNC
                     ll_LOCK(&ll->mutex);
                 #endif
 
-                SinglyNode *tmp = ll->s_head->next;
-                while (tmp->next->next != ll->s_head) {
-                    if (tmp->elem == elem) {
-                        found = true;
-                        node->elem = CONST_CAST(void*, new_elem);
-                        node->next = tmp->next;
-                        tmp->next = node;
-                        ll->size++;
-                        break;
-                    }
-                    tmp = tmp->next;
+                size_t idx = 0;
+                UnrolledNode *node = _unrolled_find(ll, elem, &idx);
+                if (node && idx+1 < node->count) {
+                    element = _unrolled_removeat(ll, node, idx+1);
+                    removed = true;
+                } else if (node && node->next) {
+                    element = _unrolled_removeat(ll, node->next, 0);
+                    removed = true;
                 }
 
                 #ifdef SYNC
                     ll_UNLOCK(&ll->mutex);
                 #endif
+
+                if (removed)
+                    _destroy_element(element, dtor);
             }
             break;
         default:
             #ifdef ALGOS_DEBUG
                 fprintf(stderr, "%s() error: invalid linkedlist type\n", FUNC);
             #endif
-            return ERROR;
-    }
-
-    if (!found) {
-        #ifdef ALGOS_DEBUG
-            fprintf(stderr, "%s() error: linkedlist elem not found\n", FUNC);
-        #endif
-        return NOTFOUND;
+            break;
     }
-    return SUCCESS;
 }
 
-void *ll_get(const ll_LinkedList *ll)
+int ll_insert_elementatpos(ll_LinkedList *ll, const void *elem, size_t pos)
 {
-    void *elem = NULL;
+    int rc = ERROR;
 
     assert(ll);
 
-    if (ll_islinkedlistempty(ll)) {
-        #ifdef ALGOS_DEBUG
-            fprintf(stderr, "%s() error: linkedlist is empty\n", FUNC);
-        #endif
-        return NULL;
-    }
-
     switch (ll->type) {
         case ll_CIRCLY:
         case ll_SINGLY:
-            #ifdef SYNC
-                ll_LOCK(&ll->mutex);
-            #endif
-            elem = ll->s_head->next->elem;
-            #ifdef SYNC
-                ll_UNLOCK(&ll->mutex);
-            #endif
+            {
+                #ifdef SYNC
+                    ll_LOCK(&ll->mutex);
+                #endif
+
+                if (pos > ll->size) {
+                    #ifdef ALGOS_DEBUG
+                        fprintf(stderr, "%s() error: pos is too high\n", FUNC);
+                    #endif
+                } else {
+                    SinglyNode *tmp = (SinglyNode*)_locate(ll, pos);
+                    SinglyNode *node = _init_singlynode(ll, elem);
+
+                    node->next = tmp->next;
+                    tmp->next = node;
+                    ll->size++;
+                    _hashindex_add(ll, node->elem);
+                    _skipindex_insert(ll, pos, node);
+                    rc = SUCCESS;
+                }
+
+                #ifdef SYNC
+                    ll_UNLOCK(&ll->mutex);
+                #endif
+            }
             break;
         case ll_DOUBLY:
-            #ifdef SYNC
-                ll_LOCK(&ll->mutex);
-            #endif
-            elem = ll->d_head->next->elem;
-            #ifdef SYNC
-                ll_UNLOCK(&ll->mutex);
-            #endif
+            {
+                #ifdef SYNC
+                    ll_LOCK(&ll->mutex);
+                #endif
+
+                if (pos > ll->size) {
+                    #ifdef ALGOS_DEBUG
+                        fprintf(stderr, "%s() error: pos is too high\n", FUNC);
+                    #endif
+                } else {
+                    DoublyNode *tmp = (DoublyNode*)_locate(ll, pos);
+                    DoublyNode *node = _init_doublynode(ll, elem);
+
+                    node->next = tmp->next;
+                    node->prev = tmp;
+                    tmp->next->prev = node;
+                    tmp->next = node;
+                    ll->size++;
+                    _hashindex_add(ll, node->elem);
+                    _skipindex_insert(ll, pos, node);
+                    rc = SUCCESS;
+                }
+
+                #ifdef SYNC
+                    ll_UNLOCK(&ll->mutex);
+                #endif
+            }
+            break;
+        case ll_UNROLLED:
+            {
+                #ifdef SYNC
+                    ll_LOCK(&ll->mutex);
+                #endif
+
+                if (pos > ll->size) {
+                    #ifdef ALGOS_DEBUG
+                        fprintf(stderr, "%s() error: pos is too high\n", FUNC);
+                    #endif
+                } else if (pos == ll->size) {
+                    size_t idx = ll->u_tail ? ll->u_tail->count : 0;
+                    _unrolled_insertat(ll, ll->u_tail, &idx, elem);
+                    rc = SUCCESS;
+                } else {
+                    UnrolledNode *node = _unrolled_locate(ll, &pos);
+                    _unrolled_insertat(ll, node, &pos, elem);
+                    rc = SUCCESS;
+                }
+
+                #ifdef SYNC
+                    ll_UNLOCK(&ll->mutex);
+                #endif
+            }
             break;
         default:
             #ifdef ALGOS_DEBUG
@@ -665,10 +2999,10 @@ void *ll_get(const ll_LinkedList *ll)
             #endif
             break;
     }
-    return elem;
+    return rc;
 }
 
-void *ll_get_atend(const ll_LinkedList *ll)
+void *ll_get_elementatpos(const ll_LinkedList *ll, size_t pos)
 {
     void *elem = NULL;
 
@@ -683,50 +3017,63 @@ void *ll_get_atend(const ll_LinkedList *ll)
 
     switch (ll->type) {
         case ll_CIRCLY:
+        case ll_SINGLY:
             {
                 #ifdef SYNC
-                    ll_LOCK(&ll->mutex);
+                    ll_LOCK(LL_MUTEX(ll));
                 #endif
 
-                SinglyNode *tmp = ll->s_head->next;
-                while (tmp->next->next != ll->s_head)
-                    tmp = tmp->next;
-                elem = tmp->elem;
+                if (pos >= ll->size) {
+                    #ifdef ALGOS_DEBUG
+                        fprintf(stderr, "%s() error: pos is out-of-bounds\n", FUNC);
+                    #endif
+                } else {
+                    SinglyNode *tmp = (SinglyNode*)_locate(ll, pos+1);
+                    elem = tmp->elem;
+                }
 
                 #ifdef SYNC
-                    ll_UNLOCK(&ll->mutex);
+                    ll_UNLOCK(LL_MUTEX(ll));
                 #endif
             }
             break;
         case ll_DOUBLY:
             {
                 #ifdef SYNC
-                    ll_LOCK(&ll->mutex);
+                    ll_LOCK(LL_MUTEX(ll));
                 #endif
 
-                DoublyNode *tmp = ll->d_head->next;
-                while (tmp->next != tmp->next->next)
-                    tmp = tmp->next;
-                elem = tmp->elem;
+                if (pos >= ll->size) {
+                    #ifdef ALGOS_DEBUG
+                        fprintf(stderr, "%s() error: pos is out-of-bounds\n", FUNC);
+                    #endif
+                } else {
+                    DoublyNode *tmp = (DoublyNode*)_locate(ll, pos+1);
+                    elem = tmp->elem;
+                }
 
                 #ifdef SYNC
-                    ll_UNLOCK(&ll->mutex);
+                    ll_UNLOCK(LL_MUTEX(ll));
                 #endif
             }
             break;
-        case ll_SINGLY:
+        case ll_UNROLLED:
             {
                 #ifdef SYNC
-                    ll_LOCK(&ll->mutex);
+                    ll_LOCK(LL_MUTEX(ll));
                 #endif
 
-                SinglyNode *tmp = ll->s_head->next;
-                while (tmp->next != tmp->next->next)
-                    tmp = tmp->next;
-                elem = tmp->elem;
+                if (pos >= ll->size) {
+                    #ifdef ALGOS_DEBUG
+                        fprintf(stderr, "%s() error: pos is out-of-bounds\n", FUNC);
+                    #endif
+                } else {
+                    UnrolledNode *node = _unrolled_locate(ll, &pos);
+                    elem = node->elems[pos];
+                }
 
                 #ifdef SYNC
-                    ll_UNLOCK(&ll->mutex);
+                    ll_UNLOCK(LL_MUTEX(ll));
                 #endif
             }
             break;
@@ -739,33 +3086,38 @@ void *ll_get_atend(const ll_LinkedList *ll)
     return elem;
 }
 
-void *ll_get_before(const ll_LinkedList *ll, const void *elem)
+void ll_delete_elementatpos(ll_LinkedList *ll, size_t pos, ll_ElemDtor dtor)
 {
-    void *element = NULL;
-
     assert(ll);
 
     if (ll_islinkedlistempty(ll)) {
         #ifdef ALGOS_DEBUG
             fprintf(stderr, "%s() error: linkedlist is empty\n", FUNC);
         #endif
-        return NULL;
+        return;
     }
 
     switch (ll->type) {
         case ll_CIRCLY:
+        case ll_SINGLY:
             {
                 #ifdef SYNC
                     ll_LOCK(&ll->mutex);
                 #endif
 
-                SinglyNode *tmp = ll->s_head->next;
-                while (tmp->next->next != ll->s_head) {
-                    if (tmp->next->elem == elem) {
-                        element = tmp->elem;
-                        break;
-                    }
-                    tmp = tmp->next;
+                if (pos >= ll->size) {
+                    #ifdef ALGOS_DEBUG
+                        fprintf(stderr, "%s() error: pos is out-of-bounds\n", FUNC);
+                    #endif
+                } else {
+                    SinglyNode *tmp = (SinglyNode*)_locate(ll, pos);
+                    SinglyNode *node = tmp->next;
+
+                    tmp->next = node->next;
+                    ll->size--;
+                    _hashindex_remove(ll, node->elem);
+                    _skipindex_delete(ll, pos);
+                    _destroy_singlynode(ll, node, dtor);
                 }
 
                 #ifdef SYNC
@@ -779,13 +3131,20 @@ void *ll_get_before(const ll_LinkedList *ll, const void *elem)
                     ll_LOCK(&ll->mutex);
                 #endif
 
-                DoublyNode *tmp = ll->d_head->next;
-                while (tmp->next != tmp->next->next) {
-                    if (tmp->next->elem == elem) {
-                        element = tmp->elem;
-                        break;
-                    }
-                    tmp = tmp->next;
+                if (pos >= ll->size) {
+                    #ifdef ALGOS_DEBUG
+                        fprintf(stderr, "%s() error: pos is out-of-bounds\n", FUNC);
+                    #endif
+                } else {
+                    DoublyNode *tmp = (DoublyNode*)_locate(ll, pos);
+                    DoublyNode *node = tmp->next;
+
+                    tmp->next = node->next;
+                    node->next->prev = tmp;
+                    ll->size--;
+                    _hashindex_remove(ll, node->elem);
+                    _skipindex_delete(ll, pos);
+                    _destroy_doublynode(ll, node, dtor);
                 }
 
                 #ifdef SYNC
@@ -793,24 +3152,31 @@ void *ll_get_before(const ll_LinkedList *ll, const void *elem)
                 #endif
             }
             break;
-        case ll_SINGLY:
+        case ll_UNROLLED:
             {
+                void *element = NULL;
+                bool removed = false;
+
                 #ifdef SYNC
                     ll_LOCK(&ll->mutex);
                 #endif
 
-                SinglyNode *tmp = ll->s_head->next;
-                while (tmp->next != tmp->next->next) {
-                    if (tmp->next->elem == elem) {
-                        element = tmp->elem;
-                        break;
-                    }
-                    tmp = tmp->next;
+                if (pos >= ll->size) {
+                    #ifdef ALGOS_DEBUG
+                        fprintf(stderr, "%s() error: pos is out-of-bounds\n", FUNC);
+                    #endif
+                } else {
+                    UnrolledNode *node = _unrolled_locate(ll, &pos);
+                    element = _unrolled_removeat(ll, node, pos);
+                    removed = true;
                 }
 
                 #ifdef SYNC
                     ll_UNLOCK(&ll->mutex);
                 #endif
+
+                if (removed)
+                    _destroy_element(element, dtor);
             }
             break;
         default:
@@ -819,81 +3185,128 @@ void *ll_get_before(const ll_LinkedList *ll, const void *elem)
             #endif
             break;
     }
-    return element;
 }
 
-void *ll_get_after(const ll_LinkedList *ll, const void *elem)
+bool ll_islinkedlistempty(const ll_LinkedList *ll)
 {
-    void *element = NULL;
+    bool empty = true;
+
+    assert(ll);
+
+    switch (ll->type) {
+        case ll_CIRCLY:
+        case ll_SINGLY:
+            #ifdef SYNC
+                ll_LOCK(LL_MUTEX(ll));
+            #endif
+            empty = (ll->s_head->next == ll->s_tail);
+            #ifdef SYNC
+                ll_UNLOCK(LL_MUTEX(ll));
+            #endif
+            break;
+        case ll_DOUBLY:
+            #ifdef SYNC
+                ll_LOCK(LL_MUTEX(ll));
+            #endif
+            empty = (ll->d_head->next == ll->d_tail);
+            #ifdef SYNC
+                ll_UNLOCK(LL_MUTEX(ll));
+            #endif
+            break;
+        case ll_UNROLLED:
+            #ifdef SYNC
+                ll_LOCK(LL_MUTEX(ll));
+            #endif
+            empty = (ll->u_head == NULL);
+            #ifdef SYNC
+                ll_UNLOCK(LL_MUTEX(ll));
+            #endif
+            break;
+        default:
+            #ifdef ALGOS_DEBUG
+                fprintf(stderr, "%s() error: invalid linkedlist type\n", FUNC);
+            #endif
+            break;
+    }
+    return empty;
+}
+
+size_t ll_getlinkedlistsize(const ll_LinkedList *ll)
+{
+    size_t size = 0;
+
+    assert(ll);
+
+    #ifdef SYNC
+        ll_LOCK(LL_MUTEX(ll));
+    #endif
+    size = ll->size;
+    #ifdef SYNC
+        ll_UNLOCK(LL_MUTEX(ll));
+    #endif
+    return size;
+}
+
+int ll_getlinkedlisttype(const ll_LinkedList *ll)
+{
+    assert(ll);
+    return ll->type;  
+}
 
+int ll_set_hashindex(ll_LinkedList *ll, ll_ElemHash hash, ll_ElemCompare comp)
+{
     assert(ll);
 
-    if (ll_islinkedlistempty(ll)) {
+    if ((hash == NULL) != (comp == NULL)) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: hash and comp go together\n", FUNC);
+        #endif
+        return ERROR;
+    }
+
+    if (!(ll->flags & ll_FLAG_HASHINDEX)) {
         #ifdef ALGOS_DEBUG
-            fprintf(stderr, "%s() error: linkedlist is empty\n", FUNC);
+            fprintf(stderr, "%s() error: linkedlist created without ll_FLAG_HASHINDEX\n", FUNC);
         #endif
-        return NULL;
+        return ERROR;
     }
 
+    #ifdef SYNC
+        ll_LOCK(&ll->mutex);
+    #endif
+
+    _destroy_hashindex(LL_EXT(ll)->hindex);
+    LL_EXT(ll)->hindex = _init_hashindex(hash, comp);
+
     switch (ll->type) {
+        case ll_CIRCLY:
         case ll_SINGLY:
             {
-                #ifdef SYNC
-                    ll_LOCK(&ll->mutex);
-                #endif
-
                 SinglyNode *tmp = ll->s_head->next;
-                while (tmp->next != tmp->next->next) {
-                    if (tmp->elem == elem) {
-                        element = tmp->next->elem;
-                        break;
-                    }
+                while (tmp != ll->s_tail) {
+                    _hashindex_add(ll, tmp->elem);
                     tmp = tmp->next;
                 }
-
-                #ifdef SYNC
-                    ll_UNLOCK(&ll->mutex);
-                #endif
             }
             break;
         case ll_DOUBLY:
             {
-                #ifdef SYNC
-                    ll_LOCK(&ll->mutex);
-                #endif
-
                 DoublyNode *tmp = ll->d_head->next;
-                while (tmp->next != tmp->next->next) {
-                    if (tmp->elem == elem) {
-                        element = tmp->next->elem;
-                        break;
-                    }
+                while (tmp != ll->d_tail) {
+                    _hashindex_add(ll, tmp->elem);
                     tmp = tmp->next;
                 }
-
-                #ifdef SYNC
-                    ll_UNLOCK(&ll->mutex);
-                #endif
             }
             break;
-        case ll_CIRCLY:
+        case ll_UNROLLED:
             {
-                #ifdef SYNC
-                    ll_LOCK(&ll->mutex);
-                #endif
-
-                SinglyNode *tmp = ll->s_head->next;
-                while (tmp->next->next != ll->s_head) {
-                    if (tmp->elem == elem) {
-                        element = tmp->next->elem;
-                        break;
-                    }
+                UnrolledNode *tmp = ll->u_head;
+                size_t i;
+                while (tmp) {
+                    for (i = 0; i < tmp->count; ++i)
+                        _hashindex_add(ll, tmp->elems[i]);
                     tmp = tmp->next;
                 }
-
-                #ifdef SYNC
-                    ll_UNLOCK(&ll->mutex);
-                #endif
             }
             break;
         default:
@@ -902,84 +3315,86 @@ void *ll_get_after(const ll_LinkedList *ll, const void *elem)
             #endif
             break;
     }
-    return element;
+
+    #ifdef SYNC
+        ll_UNLOCK(&ll->mutex);
+    #endif
+    return SUCCESS;
 }
 
-void ll_delete(ll_LinkedList *ll, const void *elem, ll_ElemDtor dtor)
+bool ll_search(const ll_LinkedList *ll, const void *elem)
 {
+    bool found = false;
+
     assert(ll);
 
+    if (ll_islinkedlistempty(ll))
+        return false;
+
+    if (LL_HASHINDEX(ll)) {
+        #ifdef SYNC
+            ll_LOCK(LL_MUTEX(ll));
+        #endif
+        found = _hashindex_contains(LL_EXT(ll)->hindex, elem);
+        #ifdef SYNC
+            ll_UNLOCK(LL_MUTEX(ll));
+        #endif
+        return found;
+    }
+
     switch (ll->type) {
         case ll_CIRCLY:
+        case ll_SINGLY:
             {
-                SinglyNode *node = NULL;
-
                 #ifdef SYNC
-                    ll_LOCK(&ll->mutex);
+                    ll_LOCK(LL_MUTEX(ll));
                 #endif
 
                 SinglyNode *tmp = ll->s_head->next;
-                while (tmp->next->next != ll->s_head) {
-                    if (tmp->next->elem == elem) {
-                        node = tmp->next;
-                        tmp->next = tmp->next->next;
-                        _destroy_singlynode(node, dtor);
+                while (tmp != ll->s_tail) {
+                    if (tmp->elem == elem) {
+                        found = true;
                         break;
                     }
                     tmp = tmp->next;
                 }
 
                 #ifdef SYNC
-                    ll_UNLOCK(&ll->mutex);
+                    ll_UNLOCK(LL_MUTEX(ll));
                 #endif
             }
             break;
         case ll_DOUBLY:
             {
-                DoublyNode *node = NULL;
-
                 #ifdef SYNC
-                    ll_LOCK(&ll->mutex);
+                    ll_LOCK(LL_MUTEX(ll));
                 #endif
 
                 DoublyNode *tmp = ll->d_head->next;
-                while (tmp->next != tmp->next->next) {
-                    if (tmp->next->elem == elem) {
-                        node = tmp->next;
-                        tmp->next = tmp->next->next;
-                        tmp->next->next->prev = tmp;
-                        _destroy_doublynode(node, dtor);
+                while (tmp != ll->d_tail) {
+                    if (tmp->elem == elem) {
+                        found = true;
                         break;
                     }
                     tmp = tmp->next;
                 }
 
                 #ifdef SYNC
-                    ll_UNLOCK(&ll->mutex);
+                    ll_UNLOCK(LL_MUTEX(ll));
                 #endif
             }
             break;
-        case ll_SINGLY:
+        case ll_UNROLLED:
             {
-                SinglyNode *node = NULL;
-
                 #ifdef SYNC
-                    ll_LOCK(&ll->mutex);
+                    ll_LOCK(LL_MUTEX(ll));
                 #endif
 
-                SinglyNode *tmp = ll->s_head->next;
-                while (tmp->next != tmp->next->next) {
-                    if (tmp->next->elem == elem) {
-                        node = tmp->next;
-                        tmp->next = tmp->next->next;
-                        _destroy_singlynode(node, dtor);
-                        break;
-                    }
-                    tmp = tmp->next;
-                }
+                size_t idx = 0;
+                found = (_unrolled_find(ll, elem, &idx) != NULL);
 
                 #ifdef SYNC
-                    ll_UNLOCK(&ll->mutex);
+                    ll_UNLOCK(LL_MUTEX(ll));
                 #endif
             }
             break;
@@ -989,159 +3404,85 @@ void ll_delete(ll_LinkedList *ll, const void *elem, ll_ElemDtor dtor)
             #endif
             break;
     }
+    return found;
 }
 
-void ll_delete_atend(ll_LinkedList *ll, ll_ElemDtor dtor)
+bool ll_search_reverse(const ll_LinkedList *ll, const void *elem)
 {
-    assert(ll);
-
-    switch (ll->type) {
-        case ll_CIRCLY:
-            {
-                SinglyNode *node = NULL;
-
-                #ifdef SYNC
-                    ll_LOCK(&ll->mutex);
-                #endif
-
-                SinglyNode *tmp = ll->s_head->next;
-                while (tmp->next->next != ll->s_head)
-                    tmp = tmp->next;
-
-                node = tmp->next;
-                tmp->next = tmp->next->next;
- 
-                #ifdef SYNC
-                    ll_UNLOCK(&ll->mutex);
-                #endif
-
-                _destroy_singlynode(node, dtor);
-
-            }
-            break;
-        case ll_DOUBLY:
-            {
-                DoublyNode *node = NULL;
-
-                #ifdef SYNC
-                    ll_LOCK(&ll->mutex);
-                #endif
-
-                DoublyNode *tmp = ll->d_head->next;
-                while (tmp->next->next != tmp->next->next->next)
-                    tmp = tmp->next;
-
-                node = tmp->next;
-                tmp->next = tmp->next->next;
-                tmp->next->next->prev = tmp;
-
-                #ifdef SYNC
-                    ll_UNLOCK(&ll->mutex);
-                #endif
-
-                _destroy_doublynode(node, dtor);
-            }
-            break;
-        case ll_SINGLY:
-            {
-                SinglyNode *node = NULL;
-
-                #ifdef SYNC
-                    ll_LOCK(&ll->mutex);
-                #endif
-
-                SinglyNode *tmp = ll->s_head->next;
-                while (tmp->next->next != tmp->next->next->next)
-                    tmp = tmp->next;
-
-                node = tmp->next;
-                tmp->next = tmp->next->next;
+    bool found = false;
 
-                #ifdef SYNC
-                    ll_UNLOCK(&ll->mutex);
-                #endif
+    assert(ll);
 
-                _destroy_singlynode(node, dtor);
-            }
-            break;
-        default:
-            #ifdef ALGOS_DEBUG
-                fprintf(stderr, "%s() error: invalid linkedlist type\n", FUNC);
-            #endif
-            break;
+    if (ll_islinkedlistempty(ll)) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: linkedlist is empty\n", FUNC);
+        #endif
+        return found;
     }
-}
 
-void ll_delete_before(ll_LinkedList *ll, const void *elem, ll_ElemDtor dtor)
-{
-    assert(ll);
+    if (LL_HASHINDEX(ll)) {
+        #ifdef SYNC
+            ll_LOCK(LL_MUTEX(ll));
+        #endif
+        found = _hashindex_contains(LL_EXT(ll)->hindex, elem);
+        #ifdef SYNC
+            ll_UNLOCK(LL_MUTEX(ll));
+        #endif
+        return found;
+    }
 
     switch (ll->type) {
         case ll_CIRCLY:
-            {
-                SinglyNode *node = NULL;
-
-                #ifdef SYNC
-                    ll_LOCK(&ll->mutex);
-                #endif
-
-                SinglyNode *tmp = ll->s_head->next;
-                while (tmp->next->next != ll->s_head)
-                    tmp = tmp->next;
-
-                node = tmp->next;
-                tmp->next = tmp->next->next;
-
-                #ifdef SYNC
-                    ll_UNLOCK(&ll->mutex);
-                #endif
-
-                _destroy_singlynode(node, dtor);
-            }
+        case ll_SINGLY:
+            #ifdef SYNC
+                ll_LOCK(LL_MUTEX(ll));
+            #endif
+            found = _search_reverse(ll->s_head->next, ll->s_tail, elem);
+            #ifdef SYNC
+                ll_UNLOCK(LL_MUTEX(ll));
+            #endif
             break;
         case ll_DOUBLY:
             {
-                DoublyNode *node = NULL;
-
                 #ifdef SYNC
-                    ll_LOCK(&ll->mutex);
+                    ll_LOCK(LL_MUTEX(ll));
                 #endif
 
-                DoublyNode *tmp = ll->d_head->next;
-                while (tmp->next->next != tmp->next->next->next)
-                    tmp = tmp->next;
-
-                node = tmp->next;
-                tmp->next = tmp->next->next;
-                tmp->next->next->prev = tmp;
+                DoublyNode *tmp = ll->d_tail->prev;
+                while (tmp != ll->d_head) {
+                    if (tmp->elem == elem) {
+                        found = true;
+                        break;
+                    }
+                    tmp = tmp->prev;
+                }
 
                 #ifdef SYNC
-                    ll_UNLOCK(&ll->mutex);
+                    ll_UNLOCK(LL_MUTEX(ll));
                 #endif
-
-                _destroy_doublynode(node, dtor);
             }
             break;
-        case ll_SINGLY:
+        case ll_UNROLLED:
             {
-                SinglyNode *node = NULL;
-
                 #ifdef SYNC
-                    ll_LOCK(&ll->mutex);
+                    ll_LOCK(LL_MUTEX(ll));
                 #endif
 
-                SinglyNode *tmp = ll->s_head->next;
-                while (tmp->next->next != tmp->next->next->next)
-                    tmp = tmp->next;
-
-                node = tmp->next;
-                tmp->next = tmp->next->next;
+                UnrolledNode *tmp = ll->u_tail;
+                size_t i;
+                while (tmp && !found) {
+                    for (i = tmp->count; i > 0; --i) {
+                        if (tmp->elems[i-1] == elem) {
+                            found = true;
+                            break;
+                        }
+                    }
+                    tmp = tmp->prev;
+                }
 
                 #ifdef SYNC
-                    ll_UNLOCK(&ll->mutex);
+                    ll_UNLOCK(LL_MUTEX(ll));
                 #endif
-
-                _destroy_singlynode(node, dtor);
             }
             break;
         default:
@@ -1150,31 +3491,40 @@ void ll_delete_before(ll_LinkedList *ll, const void *elem, ll_ElemDtor dtor)
             #endif
             break;
     }
+    return found;
 }
 
-void ll_delete_after(ll_LinkedList *ll, const void *elem, ll_ElemDtor dtor)
+void ll_reverse(ll_LinkedList *ll)
 {
     assert(ll);
 
+    if (ll_islinkedlistempty(ll)) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: linkedlist is empty\n", FUNC);
+        #endif
+        return;
+    }
+
     switch (ll->type) {
         case ll_CIRCLY:
+        case ll_SINGLY:
             {
-                SinglyNode *node = NULL;
-
                 #ifdef SYNC
                     ll_LOCK(&ll->mutex);
                 #endif
 
+                /* sentinels stay put, only the nodes between them turn around */
                 SinglyNode *tmp = ll->s_head->next;
-                while (tmp->next != ll->s_head) {
-                    if (tmp->elem == elem) {
-                        node = tmp->next;
-                        tmp->next = tmp->next->next;
-                        _destroy_singlynode(node, dtor);
-                        break;
-                    }
-                    tmp = tmp->next;
+                SinglyNode *prev = ll->s_tail;
+                SinglyNode *node = NULL;
+                while (tmp != ll->s_tail) {
+                    node = tmp->next;
+                    tmp->next = prev;
+                    prev = tmp;
+                    tmp = node;
                 }
+                ll->s_head->next = prev;
+                _skipindex_relabel(ll, 0, prev, ll->size);
 
                 #ifdef SYNC
                     ll_UNLOCK(&ll->mutex);
@@ -1183,47 +3533,54 @@ void ll_delete_after(ll_LinkedList *ll, const void *elem, ll_ElemDtor dtor)
             break;
         case ll_DOUBLY:
             {
-                DoublyNode *node = NULL;
-
                 #ifdef SYNC
                     ll_LOCK(&ll->mutex);
                 #endif
 
-                DoublyNode *tmp = ll->d_head->next;
-                while (tmp->next != tmp->next->next) {
-                    if (tmp->elem == elem) {
-                        node = tmp->next;
-                        tmp->next = tmp->next->next;
-                        tmp->next->next->prev = tmp;
-                        _destroy_doublynode(node, dtor);
-                        break;
-                    }
-                    tmp = tmp->next;
+                DoublyNode *first = ll->d_head->next;
+                DoublyNode *last = ll->d_tail->prev;
+                DoublyNode *tmp = first;
+                DoublyNode *node = NULL;
+                while (tmp != ll->d_tail) {
+                    node = tmp->next;
+                    tmp->next = tmp->prev;
+                    tmp->prev = node;
+                    tmp = node;
                 }
+                first->next = ll->d_tail;
+                last->prev = ll->d_head;
+                ll->d_head->next = last;
+                ll->d_tail->prev = first;
+                _skipindex_relabel(ll, 0, last, ll->size);
 
                 #ifdef SYNC
                     ll_UNLOCK(&ll->mutex);
                 #endif
             }
             break;
-        case ll_SINGLY:
+        case ll_UNROLLED:
             {
-                SinglyNode *node = NULL;
-
                 #ifdef SYNC
                     ll_LOCK(&ll->mutex);
                 #endif
 
-                SinglyNode *tmp = ll->s_head->next;
-                while (tmp->next != tmp->next->next) {
-                    if (tmp->elem == elem) {
-                        node = tmp->next;
-                        tmp->next = tmp->next->next;
-                        _destroy_singlynode(node, dtor);
-                        break;
+                UnrolledNode *tmp = ll->u_head;
+                UnrolledNode *node = NULL;
+                size_t i;
+                while (tmp) {
+                    for (i = 0; i < tmp->count / 2; ++i) {
+                        void *e = tmp->elems[i];
+                        tmp->elems[i] = tmp->elems[tmp->count-1-i];
+                        tmp->elems[tmp->count-1-i] = e;
                     }
-                    tmp = tmp->next;
+                    node = tmp->next;
+                    tmp->next = tmp->prev;
+                    tmp->prev = node;
+                    tmp = node;
                 }
+                node = ll->u_head;
+                ll->u_head = ll->u_tail;
+                ll->u_tail = node;
 
                 #ifdef SYNC
                     ll_UNLOCK(&ll->mutex);
@@ -1238,12 +3595,126 @@ void ll_delete_after(ll_LinkedList *ll, const void *elem, ll_ElemDtor dtor)
     }
 }
 
-int ll_insert_elementatpos(ll_LinkedList *ll, const void *elem, size_t pos)
+void ll_sort(ll_LinkedList *ll, size_t min, size_t max, ll_ElemCompare comp)
+{
+    assert(ll);
+    assert(comp);
+
+    /* min and max are both sorted, as they always were */
+    _sort_range(ll, min, (max < (size_t)-1) ? max + 1 : max, comp);
+}
+
+void ll_sort_list(ll_LinkedList *ll, ll_ElemCompare comp)
+{
+    assert(ll);
+    assert(comp);
+
+    _sort_range(ll, 0, (size_t)-1, comp);
+}
+
+static void _sort_range(ll_LinkedList *ll, size_t min, size_t max, ll_ElemCompare comp)
+{
+    #ifdef SYNC
+        ll_LOCK(&ll->mutex);
+    #endif
+
+    if (max > ll->size)
+        max = ll->size;
+
+    if (min + 1 >= max) {
+        #ifdef SYNC
+            ll_UNLOCK(&ll->mutex);
+        #endif
+        return;
+    }
+
+    switch (ll->type) {
+        case ll_CIRCLY:
+        case ll_SINGLY:
+            {
+                size_t i;
+                SinglyNode *prev = (SinglyNode*)_locate(ll, min);
+                SinglyNode *last = prev;
+                SinglyNode *tail = NULL;
+                for (i = min; i < max; ++i)
+                    last = last->next;
+                SinglyNode *after = last->next;
+
+                last->next = NULL;
+                prev->next = _sort_singlychain(prev->next, max - min, comp, &tail);
+                tail->next = after;
+                _skipindex_relabel(ll, min, prev->next, max - min);
+            }
+            break;
+        case ll_DOUBLY:
+            {
+                size_t i;
+                DoublyNode *prev = (DoublyNode*)_locate(ll, min);
+                DoublyNode *last = prev;
+                DoublyNode *tail = NULL;
+                for (i = min; i < max; ++i)
+                    last = last->next;
+                DoublyNode *after = last->next;
+
+                last->next = NULL;
+                prev->next = _sort_doublychain(prev->next, max - min, comp, &tail);
+                prev->next->prev = prev;
+                tail->next = after;
+                after->prev = tail;
+                _skipindex_relabel(ll, min, prev->next, max - min);
+            }
+            break;
+        case ll_UNROLLED:
+            {
+                size_t i, k, n = max - min;
+                size_t idx = min;
+                UnrolledNode *node = _unrolled_locate(ll, &idx);
+                UnrolledNode *start = node;
+                size_t start_idx = idx;
+                void **elems = (void**)malloc(2 * n * sizeof *elems);
+
+                if (elems == NULL) {
+                    _sort_unrolled(start, start_idx, n, comp);
+                    break;
+                }
+                for (k = 0; k < n; ++k) {
+                    elems[k] = node->elems[idx];
+                    _unrolled_advance(&node, &idx);
+                }
+                _sort_array(elems, elems + n, n, comp);
+                for (i = 0, node = start, idx = start_idx; i < n; ++i) {
+                    node->elems[idx] = elems[i];
+                    _unrolled_advance(&node, &idx);
+                }
+                free(elems);
+            }
+            break;
+        default:
+            #ifdef ALGOS_DEBUG
+                fprintf(stderr, "%s() error: invalid linkedlist type\n", FUNC);
+            #endif
+            break;
+    }
+
+    #ifdef SYNC
+        ll_UNLOCK(&ll->mutex);
+    #endif
+}
+
+
+int ll_exchange(ll_LinkedList *ll, const void *elem1, const void *elem2)
 {
     int rc = ERROR;
 
     assert(ll);
 
+    if (ll_islinkedlistempty(ll)) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: linkedlist is empty\n", FUNC);
+        #endif
+        return rc;
+    }
+
     switch (ll->type) {
         case ll_CIRCLY:
             {
@@ -1251,28 +3722,20 @@ int ll_insert_elementatpos(ll_LinkedList *ll, const void *elem, size_t pos)
                     ll_LOCK(&ll->mutex);
                 #endif
 
-                if (pos > ll->size) {
-                    #ifdef ALGOS_DEBUG
-                        fprintf(stderr, "%s() error: pos is too high\n", FUNC);
-                    #endif
-                } else {
-                    SinglyNode *tmp = ll->s_head;
-                    SinglyNode *node = _init_singlynode(elem);
-
-                    if (pos == 0) {
-                        node->next = tmp->next;
-                        tmp->next = node;
-                    } else {
-                        while (--pos && tmp->next != ll->s_head)
-                            tmp = tmp->next;
-
-                        if (tmp->next == ll->s_head)
-                            return rc;
-
-                        node->next = tmp->next;
-                        tmp->next = node;
-                    }
-                    ll->size++;
+                SinglyNode *tmp = ll->s_head->next;
+                SinglyNode *n1 = NULL;
+                SinglyNode *n2 = NULL;
+                while (tmp->next->next != ll->s_head) {
+                    if (tmp->elem == elem1)
+                        n1 = tmp;
+                    else if (tmp->elem == elem2)
+                        n2 = tmp;
+                    tmp = tmp->next;
+                }
+                if (n1 != NULL && n2 != NULL) {
+                    void *e = n1->elem;
+                    n1->elem = n2->elem;
+                    n2->elem = e;
                     rc = SUCCESS;
                 }
 
@@ -1287,32 +3750,20 @@ int ll_insert_elementatpos(ll_LinkedList *ll, const void *elem, size_t pos)
                     ll_LOCK(&ll->mutex);
                 #endif
 
-                if (pos > ll->size) {
-                    #ifdef ALGOS_DEBUG
-                        fprintf(stderr, "%s() error: pos is too high\n", FUNC);
-                    #endif
-                } else {
-                    DoublyNode *tmp = ll->d_head;
-                    DoublyNode *node = _init_doublynode(elem);
-
-                    if (pos == 0) {
-                        node->next = tmp->next;
-                        node->prev = tmp;
-                        tmp->next->prev = node;
-                        tmp->next = node;
-                    } else {
-                        while (--pos && tmp != tmp->next)
-                            tmp = tmp->next;
-
-                        if (tmp == tmp->next)
-                            return rc;
-
-                        node->next = tmp->next;
-                        node->prev = tmp;
-                        tmp->next->prev = node;
-                        tmp->next = node;
-                    }
-                    ll->size++;
+                DoublyNode *tmp = ll->d_head->next;
+                DoublyNode *n1 = NULL;
+                DoublyNode *n2 = NULL;
+                while (tmp->next != tmp->next->next) {
+                    if (tmp->elem == elem1)
+                        n1 = tmp;
+                    else if (tmp->elem == elem2)
+                        n2 = tmp;
+                    tmp = tmp->next;
+                }
+                if (n1 != NULL && n2 != NULL) {
+                    void *e = n1->elem;
+                    n1->elem = n2->elem;
+                    n2->elem = e;
                     rc = SUCCESS;
                 }
 
@@ -1327,28 +3778,41 @@ int ll_insert_elementatpos(ll_LinkedList *ll, const void *elem, size_t pos)
                     ll_LOCK(&ll->mutex);
                 #endif
 
-                if (pos > ll->size) {
-                    #ifdef ALGOS_DEBUG
-                        fprintf(stderr, "%s() error: pos is too high\n", FUNC);
-                    #endif
-                } else {
-                    SinglyNode *tmp = ll->s_head;
-                    SinglyNode *node = _init_singlynode(elem);
-
-                    if (pos == 0) {
-                        node->next = tmp->next;
-                        tmp->next = node;
-                    } else {
-                        while (--pos && tmp != tmp->next)
-                            tmp = tmp->next;
+                SinglyNode *tmp = ll->s_head->next;
+                SinglyNode *n1 = NULL;
+                SinglyNode *n2 = NULL;
+                while (tmp->next != tmp->next->next) {
+                    if (tmp->elem == elem1)
+                        n1 = tmp;
+                    else if (tmp->elem == elem2)
+                        n2 = tmp;
+                    tmp = tmp->next;
+                }
+                if (NULL != n1 && NULL != n2) {
+                    void *e = n1->elem;
+                    n1->elem = n2->elem;
+                    n2->elem = e;
+                    rc = SUCCESS;
+                }
 
-                        if (tmp == tmp->next)
-                            return rc;
+                #ifdef SYNC
+                    ll_UNLOCK(&ll->mutex);
+                #endif
+            }
+            break;
+        case ll_UNROLLED:
+            {
+                #ifdef SYNC
+                    ll_LOCK(&ll->mutex);
+                #endif
 
-                        node->next = tmp->next;
-                        tmp->next = node;
-                    }
-                    ll->size++;
+                size_t i1 = 0, i2 = 0;
+                UnrolledNode *n1 = _unrolled_find(ll, elem1, &i1);
+                UnrolledNode *n2 = _unrolled_find(ll, elem2, &i2);
+                if (n1 != NULL && n2 != NULL) {
+                    void *e = n1->elems[i1];
+                    n1->elems[i1] = n2->elems[i2];
+                    n2->elems[i2] = e;
                     rc = SUCCESS;
                 }
 
@@ -1363,113 +3827,87 @@ int ll_insert_elementatpos(ll_LinkedList *ll, const void *elem, size_t pos)
             #endif
             break;
     }
+    if (ERROR == rc) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: elements not found in linkedlist\n", FUNC);
+        #endif
+    }
     return rc;
 }
 
-void *ll_get_elementatpos(const ll_LinkedList *ll, size_t pos)
+void ll_print(const ll_LinkedList *ll, ll_ElemPrint print)
 {
-    void *elem = NULL;
-
     assert(ll);
-
-    if (ll_islinkedlistempty(ll)) {
-        #ifdef ALGOS_DEBUG
-            fprintf(stderr, "%s() error: linkedlist is empty\n", FUNC);
-        #endif
-        return NULL;
-    }
+    assert(print);
 
     switch (ll->type) {
         case ll_CIRCLY:
             {
                 #ifdef SYNC
-                    ll_LOCK(&ll->mutex);
+                    ll_LOCK(LL_MUTEX(ll));
                 #endif
 
-                if (pos >= ll->size) {
-                    #ifdef ALGOS_DEBUG
-                        fprintf(stderr, "%s() error: pos is out-of-bounds\n", FUNC);
-                    #endif
-                } else {
-                    SinglyNode *tmp = ll->s_head;
-
-                    if (pos == 0) {
-                        elem = tmp->next->elem;
-                    } else {
-                        while (--pos && tmp->next != ll->s_head)
-                            tmp = tmp->next;
-
-                        if (tmp->next == ll->s_head)
-                            return NULL;
-
-                        elem = tmp->elem;
-                    }
+                SinglyNode *tmp = ll->s_head->next;
+                while (tmp->next->next != ll->s_head) {
+                    print(tmp->elem);
+                    tmp = tmp->next;
                 }
 
                 #ifdef SYNC
-                    ll_UNLOCK(&ll->mutex);
+                    ll_UNLOCK(LL_MUTEX(ll));
                 #endif
             }
             break;
         case ll_DOUBLY:
             {
                 #ifdef SYNC
-                    ll_LOCK(&ll->mutex);
+                    ll_LOCK(LL_MUTEX(ll));
                 #endif
 
-                if (pos >= ll->size) {
-                    #ifdef ALGOS_DEBUG
-                        fprintf(stderr, "%s() error: pos is out-of-bounds\n", FUNC);
-                    #endif
-                } else {
-                    DoublyNode *tmp = ll->d_head;
-
-                    if (pos == 0) {
-                        elem = tmp->next->elem;
-                    } else {
-                        while (--pos && tmp != tmp->next)
-                            tmp = tmp->next;
-
-                        if (tmp == tmp->next)
-                            return NULL;
-
-                        elem = tmp->elem;
-                    }
+                DoublyNode *tmp = ll->d_head->next;
+                while (tmp->next != tmp->next->next) {
+                    print(tmp->elem);
+                    tmp = tmp->next;
                 }
 
                 #ifdef SYNC
-                    ll_UNLOCK(&ll->mutex);
+                    ll_UNLOCK(LL_MUTEX(ll));
                 #endif
             }
             break;
         case ll_SINGLY:
             {
                 #ifdef SYNC
-                    ll_LOCK(&ll->mutex);
+                    ll_LOCK(LL_MUTEX(ll));
                 #endif
 
-                if (pos >= ll->size) {
-                    #ifdef ALGOS_DEBUG
-                        fprintf(stderr, "%s() error: pos is out-of-bounds\n", FUNC);
-                    #endif
-                } else {
-                    SinglyNode *tmp = ll->s_head;
-
-                    if (pos == 0) {
-                        elem = tmp->next->elem;
-                    } else {
-                        while (--pos && tmp != tmp->next)
-                            tmp = tmp->next;
+                SinglyNode *tmp = ll->s_head->next;
+                while (tmp->next != tmp->next->next) {
+                    print(tmp->elem);
+                    tmp = tmp->next;
+                }
 
-                        if (tmp == tmp->next)
-                            return NULL;
+                #ifdef SYNC
+                    ll_UNLOCK(LL_MUTEX(ll));
+                #endif
+            }
+            break;
+        case ll_UNROLLED:
+            {
+                #ifdef SYNC
+                    ll_LOCK(LL_MUTEX(ll));
+                #endif
 
-                        elem = tmp->elem;
-                    }
+                UnrolledNode *tmp = ll->u_head;
+                size_t i;
+                while (tmp) {
+                    for (i = 0; i < tmp->count; ++i)
+                        print(tmp->elems[i]);
+                    tmp = tmp->next;
                 }
 
                 #ifdef SYNC
-                    ll_UNLOCK(&ll->mutex);
+                    ll_UNLOCK(LL_MUTEX(ll));
                 #endif
             }
             break;
@@ -1479,131 +3917,57 @@ void *ll_get_elementatpos(const ll_LinkedList *ll, size_t pos)
             #endif
             break;
     }
-    return elem;
 }
 
-void ll_delete_elementatpos(ll_LinkedList *ll, size_t pos, ll_ElemDtor dtor)
+void ll_print_reverse(const ll_LinkedList *ll, ll_ElemPrint print)
 {
     assert(ll);
-
-    if (ll_islinkedlistempty(ll)) {
-        #ifdef ALGOS_DEBUG
-            fprintf(stderr, "%s() error: linkedlist is empty\n", FUNC);
-        #endif
-        return;
-    }
+    assert(print);
 
     switch (ll->type) {
         case ll_CIRCLY:
-            {
-                #ifdef SYNC
-                    ll_LOCK(&ll->mutex);
-                #endif
-
-                if (pos >= ll->size) {
-                    #ifdef ALGOS_DEBUG
-                        fprintf(stderr, "%s() error: pos is out-of-bounds\n", FUNC);
-                    #endif
-                } else {
-                    SinglyNode *tmp = ll->s_head;
-                    SinglyNode *node = NULL;
-
-                    if (pos == 0) {
-                        node = tmp->next;
-                        tmp->next = tmp->next->next;
-                        _destroy_singlynode(node, dtor);
-                    } else {
-                        while (--pos && tmp->next != ll->s_head)
-                            tmp = tmp->next;
-
-                        if (tmp->next != ll->s_head)
-                            return;
-
-                        node = tmp->next;
-                        tmp->next = tmp->next->next;
-                        _destroy_singlynode(node, dtor);
-                    }
-                    ll->size--;
-                }
-
-                #ifdef SYNC
-                    ll_UNLOCK(&ll->mutex);
-                #endif
-            }
+        case ll_SINGLY:
+            #ifdef SYNC
+                ll_LOCK(LL_MUTEX(ll));
+            #endif
+            _print_reverse(ll->s_head->next, ll->s_tail, print);
+            #ifdef SYNC
+                ll_UNLOCK(LL_MUTEX(ll));
+            #endif
             break;
         case ll_DOUBLY:
             {
                 #ifdef SYNC
-                    ll_LOCK(&ll->mutex);
+                    ll_LOCK(LL_MUTEX(ll));
                 #endif
 
-                if (pos >= ll->size) {
-                    #ifdef ALGOS_DEBUG
-                        fprintf(stderr, "%s() error: pos is out-of-bounds\n", FUNC);
-                    #endif
-                } else {
-                    DoublyNode *tmp = ll->d_head;
-                    DoublyNode *node = NULL;
-
-                    if (pos == 0) {
-                        node = tmp->next;
-                        tmp->next = tmp->next->next;
-                        tmp->next->next->prev = tmp;
-                        _destroy_doublynode(node, dtor);
-                    } else {
-                        while (--pos && tmp != tmp->next)
-                            tmp = tmp->next;
-
-                        if (tmp == tmp->next)
-                            return;
-
-                        node = tmp->next;
-                        tmp->next = tmp->next->next;
-                        tmp->next->next->prev = tmp;
-                        _destroy_doublynode(node, dtor);
-                    }
-                    ll->size--;
+                DoublyNode *tmp = ll->d_tail->prev;
+                while (tmp->prev != ll->d_head) {
+                    print(tmp->elem);
+                    tmp = tmp->prev;
                 }
 
                 #ifdef SYNC
-                    ll_UNLOCK(&ll->mutex);
+                    ll_UNLOCK(LL_MUTEX(ll));
                 #endif
             }
             break;
-        case ll_SINGLY:
+        case ll_UNROLLED:
             {
                 #ifdef SYNC
-                    ll_LOCK(&ll->mutex);
+                    ll_LOCK(LL_MUTEX(ll));
                 #endif
 
-                if (pos >= ll->size) {
-                    #ifdef ALGOS_DEBUG
-                        fprintf(stderr, "%s() error: pos is out-of-bounds\n", FUNC);
-                    #endif
-                } else {
-                    SinglyNode *tmp = ll->s_head;
-                    SinglyNode *node = NULL;
-
-                    if (pos == 0) {
-                        node = tmp->next;
-                        tmp->next = tmp->next->next;
-                        _destroy_singlynode(node, dtor);
-                    } else {
-                        while (--pos && tmp != tmp->next)
-                            tmp = tmp->next;
-
-                        if (tmp == tmp->next)
-                            return;
-
-                        node = tmp->next;
-                        tmp->next = tmp->next->next;
-                        _destroy_singlynode(node, dtor);
-                    }
-                    ll->size--;
+                UnrolledNode *tmp = ll->u_tail;
+                size_t i;
+                while (tmp) {
+                    for (i = tmp->count; i > 0; --i)
+                        print(tmp->elems[i-1]);
+                    tmp = tmp->prev;
                 }
 
                 #ifdef SYNC
-                    ll_UNLOCK(&ll->mutex);
+                    ll_UNLOCK(LL_MUTEX(ll));
                 #endif
             }
             break;
@@ -1615,460 +3979,859 @@ void ll_delete_elementatpos(ll_LinkedList *ll, size_t pos, ll_ElemDtor dtor)
     }
 }
 
-bool ll_islinkedlistempty(const ll_LinkedList *ll)
+ll_Iterator *ll_iter_begin(ll_LinkedList *ll)
 {
-    bool empty = true;
+    ll_Iterator *it = NULL;
 
     assert(ll);
 
+    it = (ll_Iterator*)calloc(1, sizeof *it);
+    assert(it);
+    it->ll = ll;
+
+    #ifdef SYNC
+        ll_LOCK(&ll->mutex);
+    #endif
+
     switch (ll->type) {
         case ll_CIRCLY:
         case ll_SINGLY:
-            #ifdef SYNC
-                ll_LOCK(&ll->mutex);
-            #endif
-            empty = (ll->s_head->next == ll->s_tail);
-            #ifdef SYNC
-                ll_UNLOCK(&ll->mutex);
-            #endif
+            it->s_before = ll->s_head;
             break;
         case ll_DOUBLY:
-            #ifdef SYNC
-                ll_LOCK(&ll->mutex);
+            it->d_before = ll->d_head;
+            break;
+        case ll_UNROLLED:
+            it->u_node = ll->u_head;
+            it->idx = 0;
+            break;
+        default:
+            #ifdef ALGOS_DEBUG
+                fprintf(stderr, "%s() error: invalid linkedlist type\n", FUNC);
             #endif
-            empty = (ll->d_head->next == ll->d_tail);
             #ifdef SYNC
                 ll_UNLOCK(&ll->mutex);
             #endif
+            free(it);
+            return NULL;
+    }
+    return it;
+}
+
+void ll_iter_end(ll_Iterator *it)
+{
+    assert(it);
+    #ifdef SYNC
+        ll_UNLOCK(&it->ll->mutex);
+    #endif
+    free(it);
+}
+
+bool ll_iter_hasnext(const ll_Iterator *it)
+{
+    bool hasnext = false;
+
+    assert(it);
+
+    switch (it->ll->type) {
+        case ll_CIRCLY:
+        case ll_SINGLY:
+            hasnext = (it->s_before->next != it->ll->s_tail);
+            break;
+        case ll_DOUBLY:
+            hasnext = (it->d_before->next != it->ll->d_tail);
+            break;
+        case ll_UNROLLED:
+            hasnext = it->u_node && (it->idx < it->u_node->count || it->u_node->next);
             break;
         default:
-            #ifdef ALGOS_DEBUG
-                fprintf(stderr, "%s() error: invalid linkedlist type\n", FUNC);
-            #endif
             break;
     }
-    return empty;
+    return hasnext;
 }
 
-size_t ll_getlinkedlistsize(const ll_LinkedList *ll)
+bool ll_iter_hasprev(const ll_Iterator *it)
 {
-    size_t size = 0;
+    bool hasprev = false;
 
-    assert(ll);
+    assert(it);
 
-    #ifdef SYNC
-        ll_LOCK(&ll->mutex);
-    #endif
-    size = ll->size;
-    #ifdef SYNC
-        ll_UNLOCK(&ll->mutex);
-    #endif
-    return size;
+    switch (it->ll->type) {
+        case ll_CIRCLY:
+        case ll_SINGLY:
+            hasprev = (it->s_before != it->ll->s_head);
+            break;
+        case ll_DOUBLY:
+            hasprev = (it->d_before != it->ll->d_head);
+            break;
+        case ll_UNROLLED:
+            hasprev = it->u_node && (it->idx > 0 || it->u_node->prev);
+            break;
+        default:
+            break;
+    }
+    return hasprev;
 }
 
-int ll_getlinkedlisttype(const ll_LinkedList *ll)
+void *ll_iter_next(ll_Iterator *it)
 {
-    assert(ll);
-    return ll->type;  
+    void *elem = NULL;
+
+    assert(it);
+
+    if (!ll_iter_hasnext(it)) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: iterator is at the end\n", FUNC);
+        #endif
+        return NULL;
+    }
+
+    it->pos++;
+    switch (it->ll->type) {
+        case ll_CIRCLY:
+        case ll_SINGLY:
+            it->s_lastpred = it->s_before;
+            it->s_before = it->s_before->next;
+            it->s_last = it->s_before;
+            elem = it->s_last->elem;
+            break;
+        case ll_DOUBLY:
+            it->d_before = it->d_before->next;
+            it->d_last = it->d_before;
+            elem = it->d_last->elem;
+            break;
+        case ll_UNROLLED:
+            if (it->idx == it->u_node->count) {
+                it->u_node = it->u_node->next;
+                it->idx = 0;
+            }
+            it->u_last = it->u_node;
+            it->lastidx = it->idx;
+            elem = it->u_node->elems[it->idx++];
+            break;
+        default:
+            break;
+    }
+    return elem;
 }
 
-bool ll_search(const ll_LinkedList *ll, const void *elem)
+void *ll_iter_prev(ll_Iterator *it)
 {
-    bool found = false;
+    void *elem = NULL;
 
-    assert(ll);
+    assert(it);
 
-    if (ll_islinkedlistempty(ll))
-        return false;
+    if (!ll_iter_hasprev(it)) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: iterator is at the beginning\n", FUNC);
+        #endif
+        return NULL;
+    }
 
-    switch (ll->type) {
+    it->pos--;
+    switch (it->ll->type) {
         case ll_CIRCLY:
+        case ll_SINGLY:
             {
-                #ifdef SYNC
-                    ll_LOCK(&ll->mutex);
-                #endif
-
-                SinglyNode *tmp = ll->s_head->next;
-                while (tmp->next->next != ll->s_head) {
-                    if (tmp->elem == elem)
-                        found = true;
+                /* no back links, find the predecessor from the head (O(n)) */
+                SinglyNode *tmp = it->ll->s_head;
+                while (tmp->next != it->s_before)
                     tmp = tmp->next;
-                }
-
-                #ifdef SYNC
-                    ll_UNLOCK(&ll->mutex);
-                #endif
+                it->s_last = it->s_before;
+                it->s_lastpred = tmp;
+                it->s_before = tmp;
+                elem = it->s_last->elem;
             }
             break;
         case ll_DOUBLY:
-            {
-                #ifdef SYNC
-                    ll_LOCK(&ll->mutex);
-                #endif
-
-                DoublyNode *tmp = ll->d_head->next;
-                while (tmp->next != tmp->next->next) {
-                    if (tmp->elem == elem)
-                        found = true;
-                    tmp = tmp->next;
-                }
-
-                #ifdef SYNC
-                    ll_UNLOCK(&ll->mutex);
-                #endif
+            it->d_last = it->d_before;
+            it->d_before = it->d_before->prev;
+            elem = it->d_last->elem;
+            break;
+        case ll_UNROLLED:
+            if (it->idx == 0) {
+                it->u_node = it->u_node->prev;
+                it->idx = it->u_node->count;
             }
+            elem = it->u_node->elems[--it->idx];
+            it->u_last = it->u_node;
+            it->lastidx = it->idx;
             break;
+        default:
+            break;
+    }
+    return elem;
+}
+
+int ll_iter_erase(ll_Iterator *it, ll_ElemDtor dtor)
+{
+    ll_LinkedList *ll = NULL;
+
+    assert(it);
+    ll = it->ll;
+
+    switch (ll->type) {
+        case ll_CIRCLY:
         case ll_SINGLY:
             {
-                #ifdef SYNC
-                    ll_LOCK(&ll->mutex);
-                #endif
-
-                SinglyNode *tmp = ll->s_head->next;
-                while (tmp->next != tmp->next->next) {
-                    if (tmp->elem == elem)
-                        found = true;
-                    tmp = tmp->next;
+                SinglyNode *node = it->s_last;
+                if (node == NULL)
+                    break;
+
+                it->s_lastpred->next = node->next;
+                if (it->s_before == node) {
+                    it->s_before = it->s_lastpred;
+                    it->pos--;
+                }
+                ll->size--;
+                _hashindex_remove(ll, node->elem);
+                _skipindex_delete(ll, it->pos);
+                _destroy_singlynode(ll, node, dtor);
+                it->s_last = NULL;
+                return SUCCESS;
+            }
+        case ll_DOUBLY:
+            {
+                DoublyNode *node = it->d_last;
+                if (node == NULL)
+                    break;
+
+                node->prev->next = node->next;
+                node->next->prev = node->prev;
+                if (it->d_before == node) {
+                    it->d_before = node->prev;
+                    it->pos--;
                 }
-
-                #ifdef SYNC
-                    ll_UNLOCK(&ll->mutex);
-                #endif
+                ll->size--;
+                _hashindex_remove(ll, node->elem);
+                _skipindex_delete(ll, it->pos);
+                _destroy_doublynode(ll, node, dtor);
+                it->d_last = NULL;
+                return SUCCESS;
+            }
+        case ll_UNROLLED:
+            {
+                UnrolledNode *node = it->u_last;
+                if (node == NULL)
+                    break;
+
+                /* the cursor sits right next to the element, in the same node */
+                UnrolledNode *next = node->next;
+                UnrolledNode *prev = node->prev;
+                bool drops = (node->count == 1);
+                void *elem = _unrolled_removeat(ll, node, it->lastidx);
+
+                /* after a next the erased element sat right before the cursor */
+                if (it->idx != it->lastidx)
+                    it->pos--;
+
+                if (!drops) {
+                    it->u_node = node;
+                    it->idx = it->lastidx;
+                } else if (next) {
+                    it->u_node = next;
+                    it->idx = 0;
+                } else {
+                    it->u_node = prev;
+                    it->idx = prev ? prev->count : 0;
+                }
+                it->u_last = NULL;
+                _destroy_element(elem, dtor);
+                return SUCCESS;
             }
-            break;
         default:
-            #ifdef ALGOS_DEBUG
-                fprintf(stderr, "%s() error: invalid linkedlist type\n", FUNC);
-            #endif
             break;
     }
-    return found;
+
+    #ifdef ALGOS_DEBUG
+        fprintf(stderr, "%s() error: no element to erase\n", FUNC);
+    #endif
+    return ERROR;
 }
 
-bool ll_search_reverse(const ll_LinkedList *ll, const void *elem)
+int ll_iter_insert(ll_Iterator *it, const void *elem)
 {
-    bool found = false;
-
-    assert(ll);
+    ll_LinkedList *ll = NULL;
 
-    if (ll_islinkedlistempty(ll)) {
-        #ifdef ALGOS_DEBUG
-            fprintf(stderr, "%s() error: linkedlist is empty\n", FUNC);
-        #endif
-        return found;
-    }
+    assert(it);
+    ll = it->ll;
 
     switch (ll->type) {
         case ll_CIRCLY:
         case ll_SINGLY:
-            #ifdef SYNC
-                ll_LOCK(&ll->mutex);
-            #endif
-            found = _search_reverse(ll->s_head->next, ll->s_tail, elem);
-            #ifdef SYNC
-                ll_UNLOCK(&ll->mutex);
-            #endif
+            {
+                SinglyNode *node = _init_singlynode(ll, elem);
+                node->next = it->s_before->next;
+                it->s_before->next = node;
+                it->s_before = node;
+                it->s_last = NULL;
+                ll->size++;
+                _hashindex_add(ll, node->elem);
+                _skipindex_insert(ll, it->pos++, node);
+            }
             break;
         case ll_DOUBLY:
             {
-                #ifdef SYNC
-                    ll_LOCK(&ll->mutex);
-                #endif
-
-                DoublyNode *tmp = ll->d_tail->prev;
-                while (tmp->prev != ll->d_head) {
-                    if (tmp->elem == elem)
-                        found = true;
-                    tmp = tmp->prev;
-                }
-
-                #ifdef SYNC
-                    ll_UNLOCK(&ll->mutex);
-                #endif
+                DoublyNode *node = _init_doublynode(ll, elem);
+                node->next = it->d_before->next;
+                node->prev = it->d_before;
+                it->d_before->next->prev = node;
+                it->d_before->next = node;
+                it->d_before = node;
+                it->d_last = NULL;
+                ll->size++;
+                _hashindex_add(ll, node->elem);
+                _skipindex_insert(ll, it->pos++, node);
+            }
+            break;
+        case ll_UNROLLED:
+            {
+                size_t idx = it->idx;
+                it->u_node = _unrolled_insertat(ll, it->u_node, &idx, elem);
+                it->idx = idx + 1;
+                it->u_last = NULL;
+                it->pos++;
             }
             break;
         default:
             #ifdef ALGOS_DEBUG
                 fprintf(stderr, "%s() error: invalid linkedlist type\n", FUNC);
             #endif
-            break;
+            return ERROR;
     }
-    return found;
+    return SUCCESS;
 }
 
-void ll_reverse(ll_LinkedList *ll)
+void ll_foreach(const ll_LinkedList *ll, ll_ElemVisit visit, void *ctx)
 {
     assert(ll);
+    assert(visit);
 
-    if (ll_islinkedlistempty(ll)) {
+    #ifdef SYNC
+        ll_LOCK(LL_MUTEX(ll));
+    #endif
+
+    _visit(ll, visit, ctx);
+
+    #ifdef SYNC
+        ll_UNLOCK(LL_MUTEX(ll));
+    #endif
+}
+
+int ll_insert_bulk(ll_LinkedList *ll, void *const *elems, size_t n)
+{
+    assert(ll);
+
+    if (n == 0)
+        return SUCCESS;
+    if (elems == NULL) {
         #ifdef ALGOS_DEBUG
-            fprintf(stderr, "%s() error: linkedlist is empty\n", FUNC);
+            fprintf(stderr, "%s() error: no elements\n", FUNC);
         #endif
-        return;
+        return ERROR;
     }
 
-    switch (ll->type) {
-        case ll_CIRCLY:
-            {
-                #ifdef SYNC
-                    ll_LOCK(&ll->mutex);
-                #endif
+    #ifdef SYNC
+        ll_LOCK(&ll->mutex);
+    #endif
 
-                SinglyNode *tmp = ll->s_head->next;
-                SinglyNode *prev = ll->s_head;
-                SinglyNode *node = NULL;
+    _insert_array(ll, ll->size, elems, n);
 
-                while (tmp->next != ll->s_head) {
-                    node = tmp->next; 
-                    tmp->next = prev;
-                    prev = tmp;
-                    tmp = node;
-                }
-                node = ll->s_head;
-                ll->s_head = ll->s_tail;
-                ll->s_tail = node;
+    #ifdef SYNC
+        ll_UNLOCK(&ll->mutex);
+    #endif
+    return SUCCESS;
+}
 
-                #ifdef SYNC
-                    ll_UNLOCK(&ll->mutex);
-                #endif
+int ll_splice(ll_LinkedList *dst, size_t pos, ll_LinkedList *src)
+{
+    SkipIndex *moved = NULL;
+    void *relabel = NULL;
+    size_t relabelpos = 0;
+
+    assert(dst);
+    assert(src);
+
+    if (dst == src || dst->type != src->type) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: lists must be distinct and of the same type\n", FUNC);
+        #endif
+        return ERROR;
+    }
+
+    #ifdef SYNC
+        _lock_pair(dst, src);
+    #endif
+
+    if (pos > dst->size) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: invalid position\n", FUNC);
+        #endif
+        #ifdef SYNC
+            _unlock_pair(dst, src);
+        #endif
+        return ERROR;
+    }
+
+    if (src->size == 0) {
+        #ifdef SYNC
+            _unlock_pair(dst, src);
+        #endif
+        return SUCCESS;
+    }
+
+    /* a node goes back to the allocator it came from, so when only one
+     * list is pooled the elements move into fresh nodes of dst */
+    if ((LL_POOL(dst) == NULL) != (LL_POOL(src) == NULL)) {
+        int rc = _move_elements(dst, pos, src);
+        if (rc == SUCCESS) {
+            if (LL_HASHINDEX(src))
+                _hashindex_clear(LL_EXT(src)->hindex);
+            if (LL_SKIPINDEX(src))
+                _skipindex_clear(LL_SKIPINDEX(src));
+        }
+        #ifdef SYNC
+            _unlock_pair(dst, src);
+        #endif
+        return rc;
+    }
+
+    /* nodes change lists as they are, pooled ones bring their pool along */
+    _share_nodepool(dst, src);
+
+    if (LL_HASHINDEX(dst))
+        _visit(src, _hashindex_visitadd, dst);
+    if (LL_HASHINDEX(src))
+        _hashindex_clear(LL_EXT(src)->hindex);
+
+    /* src's entries join dst's index as they are, an unindexed src gets
+     * entries built while its chain is still whole */
+    if (LL_SKIPINDEX(dst)) {
+        moved = LL_SKIPINDEX(src);
+        if (moved == NULL) {
+            void *first = (src->type == ll_DOUBLY) ? (void*)src->d_head->next
+                                                   : (void*)src->s_head->next;
+            moved = _init_skipindex();
+            if (src->type != ll_UNROLLED)
+                _skipindex_build(moved, src->type, first, src->size);
+        }
+    } else if (LL_SKIPINDEX(src)) {
+        _skipindex_clear(LL_SKIPINDEX(src));
+    }
+
+    switch (dst->type) {
+        case ll_CIRCLY:
+        case ll_SINGLY:
+            if (pos == dst->size) {
+                /* dst's tail sentinel now holds src's first element */
+                relabel = dst->s_tail;
+                relabelpos = pos;
+                _singly_append(dst, src);
+            } else if (pos == 0) {
+                /* append dst to src and trade chains, src's tail sentinel
+                 * now holds dst's first element */
+                SinglyNode *head = NULL;
+                SinglyNode *tail = NULL;
+                relabel = src->s_tail;
+                relabelpos = src->size;
+                _singly_append(src, dst);
+                head = dst->s_head;
+                tail = dst->s_tail;
+                dst->s_head = src->s_head;
+                dst->s_tail = src->s_tail;
+                src->s_head = head;
+                src->s_tail = tail;
+            } else {
+                SinglyNode *prev = (SinglyNode*)_locate(dst, pos);
+                SinglyNode *first = src->s_head->next;
+                SinglyNode *last = first;
+                while (last->next != src->s_tail)
+                    last = last->next;
+                last->next = prev->next;
+                prev->next = first;
+                src->s_head->next = src->s_tail;
             }
             break;
         case ll_DOUBLY:
             {
-                #ifdef SYNC
-                    ll_LOCK(&ll->mutex);
-                #endif
-
-                DoublyNode *tmp = ll->d_head->next;
-                DoublyNode *node = NULL;
-                while (tmp->next != tmp->next->next) {
-                    node = tmp->next;
-                    tmp->next = tmp->prev;
-                    tmp->prev = node;
-                    tmp = node;
-                }
-                node = ll->d_head;
-                ll->d_head = ll->d_tail;
-                ll->d_tail = node;
-
-                #ifdef SYNC
-                    ll_UNLOCK(&ll->mutex);
-                #endif
+                DoublyNode *prev = (pos == dst->size) ? dst->d_tail->prev
+                                                      : (DoublyNode*)_locate(dst, pos);
+                DoublyNode *first = src->d_head->next;
+                DoublyNode *last = src->d_tail->prev;
+                last->next = prev->next;
+                prev->next->prev = last;
+                prev->next = first;
+                first->prev = prev;
+                src->d_head->next = src->d_tail;
+                src->d_tail->prev = src->d_head;
             }
             break;
-        case ll_SINGLY:
+        case ll_UNROLLED:
             {
-                #ifdef SYNC
-                    ll_LOCK(&ll->mutex);
-                #endif
+                UnrolledNode *before = NULL;
+                UnrolledNode *after = NULL;
 
-                SinglyNode *tmp = ll->s_head->next;
-                SinglyNode *prev = ll->s_head;
-                SinglyNode *node = NULL;
-                while (tmp->next != tmp->next->next) {
-                    node = tmp->next; 
-                    tmp->next = prev;
-                    prev = tmp;
-                    tmp = node;
+                if (pos == 0) {
+                    after = dst->u_head;
+                } else if (pos == dst->size) {
+                    before = dst->u_tail;
+                } else {
+                    size_t idx = pos;
+                    UnrolledNode *node = _unrolled_locate(dst, &idx);
+                    if (idx == 0) {
+                        before = node->prev;
+                        after = node;
+                    } else {
+                        before = node;
+                        after = _unrolled_splitat(dst, node, idx);
+                    }
                 }
-                node = ll->s_head;
-                ll->s_head = ll->s_tail;
-                ll->s_tail = node;
 
-                #ifdef SYNC
-                    ll_UNLOCK(&ll->mutex);
-                #endif
+                src->u_head->prev = before;
+                if (before)
+                    before->next = src->u_head;
+                else
+                    dst->u_head = src->u_head;
+                src->u_tail->next = after;
+                if (after)
+                    after->prev = src->u_tail;
+                else
+                    dst->u_tail = src->u_tail;
+                src->u_head = NULL;
+                src->u_tail = NULL;
             }
             break;
         default:
-            #ifdef ALGOS_DEBUG
-                fprintf(stderr, "%s() error: invalid linkedlist type\n", FUNC);
-            #endif
             break;
     }
-}
-
-void ll_sort(ll_LinkedList *ll, size_t min, size_t max, ll_ElemCompare comp)
-{
-    assert(ll);
-    assert(comp);
 
-    if (min < max) {
-        size_t mid = (min + max) / 2;
-        ll_sort(ll, min, mid, comp);
-        ll_sort(ll, mid+1, max, comp);
-        _merge(ll, min, mid+1, max, comp);
+    if (moved) {
+        _skipindex_insertindex(LL_SKIPINDEX(dst), pos, moved);
+        if (moved != LL_SKIPINDEX(src))
+            _destroy_skipindex(moved);
+        if (relabel)
+            _skipindex_relabel(dst, relabelpos, relabel, 1);
     }
-}
+    dst->size += src->size;
+    src->size = 0;
 
+    #ifdef SYNC
+        _unlock_pair(dst, src);
+    #endif
+    return SUCCESS;
+}
 
-int ll_exchange(ll_LinkedList *ll, const void *elem1, const void *elem2)
+ll_LinkedList *ll_split(ll_LinkedList *ll, size_t pos)
 {
-    int rc = ERROR;
+    ll_LinkedList *rest = NULL;
 
     assert(ll);
 
-    if (ll_islinkedlistempty(ll)) {
+    #ifdef SYNC
+        ll_LOCK(&ll->mutex);
+    #endif
+
+    if (pos > ll->size) {
         #ifdef ALGOS_DEBUG
-            fprintf(stderr, "%s() error: linkedlist is empty\n", FUNC);
+            fprintf(stderr, "%s() error: invalid position\n", FUNC);
         #endif
-        return rc;
+        #ifdef SYNC
+            ll_UNLOCK(&ll->mutex);
+        #endif
+        return NULL;
+    }
+
+    rest = ll_init_withflags(ll->type, ll->flags);
+    if (rest == NULL) {
+        #ifdef SYNC
+            ll_UNLOCK(&ll->mutex);
+        #endif
+        return NULL;
     }
 
+    /* rest's index is still empty, it only takes over the keying */
+    if (LL_HASHINDEX(ll)) {
+        LL_EXT(rest)->hindex->hash = LL_EXT(ll)->hindex->hash;
+        LL_EXT(rest)->hindex->comp = LL_EXT(ll)->hindex->comp;
+    }
+
+    if (pos == ll->size) {
+        #ifdef SYNC
+            ll_UNLOCK(&ll->mutex);
+        #endif
+        return rest;
+    }
+
+    /* a pooled ll gave rest a pool for its sentinels, join the two */
+    _share_nodepool(ll, rest);
+
     switch (ll->type) {
         case ll_CIRCLY:
+        case ll_SINGLY:
             {
-                #ifdef SYNC
-                    ll_LOCK(&ll->mutex);
-                #endif
-
-                SinglyNode *tmp = ll->s_head->next;
-                SinglyNode *n1 = NULL;
-                SinglyNode *n2 = NULL;
-                while (tmp->next->next != ll->s_head) {
-                    if (tmp->elem == elem1)
-                        n1 = tmp;
-                    else if (tmp->elem == elem2)
-                        n2 = tmp;
-                    tmp = tmp->next;
-                }
-                if (n1 != NULL && n2 != NULL) {
-                    void *e = n1->elem;
-                    n1->elem = n2->elem;
-                    n2->elem = e;
-                    rc = SUCCESS;
-                }
-
-                #ifdef SYNC
-                    ll_UNLOCK(&ll->mutex);
-                #endif
+                /* trade tail sentinels, the moved chain already ends in ours */
+                SinglyNode *prev = (SinglyNode*)_locate(ll, pos);
+                SinglyNode *tail = rest->s_tail;
+                rest->s_head->next = prev->next;
+                rest->s_tail = ll->s_tail;
+                rest->s_tail->next = (ll->type == ll_CIRCLY) ? rest->s_head : rest->s_tail;
+                ll->s_tail = tail;
+                ll->s_tail->next = (ll->type == ll_CIRCLY) ? ll->s_head : ll->s_tail;
+                prev->next = ll->s_tail;
             }
             break;
         case ll_DOUBLY:
             {
-                #ifdef SYNC
-                    ll_LOCK(&ll->mutex);
-                #endif
+                DoublyNode *prev = (DoublyNode*)_locate(ll, pos);
+                DoublyNode *first = prev->next;
+                DoublyNode *last = ll->d_tail->prev;
+                first->prev = rest->d_head;
+                rest->d_head->next = first;
+                last->next = rest->d_tail;
+                rest->d_tail->prev = last;
+                prev->next = ll->d_tail;
+                ll->d_tail->prev = prev;
+            }
+            break;
+        case ll_UNROLLED:
+            {
+                size_t idx = pos;
+                UnrolledNode *first = _unrolled_locate(ll, &idx);
+                if (idx > 0)
+                    first = _unrolled_splitat(ll, first, idx);
+                rest->u_head = first;
+                rest->u_tail = ll->u_tail;
+                ll->u_tail = first->prev;
+                if (ll->u_tail)
+                    ll->u_tail->next = NULL;
+                else
+                    ll->u_head = NULL;
+                first->prev = NULL;
+            }
+            break;
+        default:
+            break;
+    }
 
-                DoublyNode *tmp = ll->d_head->next;
-                DoublyNode *n1 = NULL;
-                DoublyNode *n2 = NULL;
-                while (tmp->next != tmp->next->next) {
-                    if (tmp->elem == elem1)
-                        n1 = tmp;
-                    else if (tmp->elem == elem2)
-                        n2 = tmp;
-                    tmp = tmp->next;
-                }
-                if (n1 != NULL && n2 != NULL) {
-                    void *e = n1->elem;
-                    n1->elem = n2->elem;
-                    n2->elem = e;
-                    rc = SUCCESS;
-                }
+    rest->size = ll->size - pos;
+    ll->size = pos;
+    if (LL_SKIPINDEX(ll))
+        _skipindex_cut(LL_SKIPINDEX(ll), pos, LL_SKIPINDEX(rest));
+    if (LL_HASHINDEX(ll)) {
+        _visit(rest, _hashindex_visitremove, ll);
+        _visit(rest, _hashindex_visitadd, rest);
+    }
+
+    #ifdef SYNC
+        ll_UNLOCK(&ll->mutex);
+    #endif
+    return rest;
+}
+
+
+static bool _search_reverse(SinglyNode *start, SinglyNode *end, const void *elem)
+{
+    while (start != end) {
+        if (start->elem == elem)
+            return true;
+        start = start->next;
+    }
+    return false;
+}
+
+static void _print_reverse(SinglyNode *start, SinglyNode *end, ll_ElemPrint print)
+{
+    if (start == end)
+        return;
+    _print_reverse(start->next, end, print);
+    print(start->elem);
+}
 
-                #ifdef SYNC
-                    ll_UNLOCK(&ll->mutex);
-                #endif
-            }
-            break;
-        case ll_SINGLY:
-            {
-                #ifdef SYNC
-                    ll_LOCK(&ll->mutex);
-                #endif
+/**
+ * cut a chain after count nodes, returning the remainder.
+ */
+static SinglyNode *_split_singlychain(SinglyNode *node, size_t count)
+{
+    while (node && --count)
+        node = node->next;
+    if (node == NULL)
+        return NULL;
+    SinglyNode *rest = node->next;
+    node->next = NULL;
+    return rest;
+}
 
-                SinglyNode *tmp = ll->s_head->next;
-                SinglyNode *n1 = NULL;
-                SinglyNode *n2 = NULL;
-                while (tmp->next != tmp->next->next) {
-                    if (tmp->elem == elem1)
-                        n1 = tmp;
-                    else if (tmp->elem == elem2)
-                        n2 = tmp;
-                    tmp = tmp->next;
-                }
-                if (NULL != n1 && NULL != n2) {
-                    void *e = n1->elem;
-                    n1->elem = n2->elem;
-                    n2->elem = e;
-                    rc = SUCCESS;
+static SinglyNode *_sort_singlychain(SinglyNode *head, size_t n, ll_ElemCompare comp,
+                                     SinglyNode **tail)
+{
+    SinglyNode dummy;
+    SinglyNode *last = &dummy;
+    size_t width;
+
+    dummy.next = head;
+    for (width = 1; width < n; width *= 2) {
+        SinglyNode *cur = dummy.next;
+        last = &dummy;
+        while (cur) {
+            SinglyNode *left = cur;
+            SinglyNode *right = _split_singlychain(left, width);
+            cur = _split_singlychain(right, width);
+
+            /* ties take from the left run, keeping the sort stable */
+            while (left && right) {
+                if (comp(left->elem, right->elem) <= 0) {
+                    last->next = left;
+                    left = left->next;
+                } else {
+                    last->next = right;
+                    right = right->next;
                 }
+                last = last->next;
+            }
+            last->next = left ? left : right;
+            while (last->next)
+                last = last->next;
+        }
+    }
 
-                #ifdef SYNC
-                    ll_UNLOCK(&ll->mutex);
-                #endif
+    if (last == &dummy) {
+        /* single pass never ran (n <= 1) */
+        last = dummy.next;
+        while (last && last->next)
+            last = last->next;
+    }
+    *tail = last;
+    return dummy.next;
+}
+
+/**
+ * cut a chain after count nodes, returning the remainder.
+ */
+static DoublyNode *_split_doublychain(DoublyNode *node, size_t count)
+{
+    while (node && --count)
+        node = node->next;
+    if (node == NULL)
+        return NULL;
+    DoublyNode *rest = node->next;
+    node->next = NULL;
+    return rest;
+}
+
+static DoublyNode *_sort_doublychain(DoublyNode *head, size_t n, ll_ElemCompare comp,
+                                     DoublyNode **tail)
+{
+    DoublyNode dummy;
+    DoublyNode *last = &dummy;
+    DoublyNode *node = NULL;
+    size_t width;
+
+    dummy.next = head;
+    for (width = 1; width < n; width *= 2) {
+        DoublyNode *cur = dummy.next;
+        last = &dummy;
+        while (cur) {
+            DoublyNode *left = cur;
+            DoublyNode *right = _split_doublychain(left, width);
+            cur = _split_doublychain(right, width);
+
+            /* ties take from the left run, keeping the sort stable */
+            while (left && right) {
+                if (comp(left->elem, right->elem) <= 0) {
+                    last->next = left;
+                    left = left->next;
+                } else {
+                    last->next = right;
+                    right = right->next;
+                }
+                last = last->next;
             }
-            break;
-        default:
-            #ifdef ALGOS_DEBUG
-                fprintf(stderr, "%s() error: invalid linkedlist type\n", FUNC);
-            #endif
-            break;
+            last->next = left ? left : right;
+            while (last->next)
+                last = last->next;
+        }
     }
-    if (ERROR == rc) {
-        #ifdef ALGOS_DEBUG
-            fprintf(stderr, "%s() error: elements not found in linkedlist\n", FUNC);
-        #endif
+
+    /* only next links move during the merge, fix prev links in one pass */
+    for (node = dummy.next, last = NULL; node; last = node, node = node->next)
+        node->prev = last;
+    *tail = last;
+    return dummy.next;
+}
+
+static void _sort_array(void **elems, void **scratch, size_t n, ll_ElemCompare comp)
+{
+    void **src = elems;
+    void **dst = scratch;
+    size_t width, lo;
+
+    for (width = 1; width < n; width *= 2) {
+        for (lo = 0; lo < n; lo += 2 * width) {
+            size_t mid = (lo + width < n) ? lo + width : n;
+            size_t hi = (lo + 2 * width < n) ? lo + 2 * width : n;
+            size_t i = lo, j = mid, k = lo;
+            while (i < mid && j < hi)
+                dst[k++] = (comp(src[i], src[j]) <= 0) ? src[i++] : src[j++];
+            while (i < mid)
+                dst[k++] = src[i++];
+            while (j < hi)
+                dst[k++] = src[j++];
+        }
+        void **swap = src;
+        src = dst;
+        dst = swap;
     }
-    return rc;
+    if (src != elems)
+        memcpy(elems, src, n * sizeof *elems);
 }
 
-void ll_print(const ll_LinkedList *ll, ll_ElemPrint print)
+static void _hashindex_clear(HashIndex *hindex)
 {
-    assert(ll);
-    assert(print);
+    memset(hindex->slots, 0, hindex->capacity * sizeof *hindex->slots);
+    hindex->count = 0;
+}
 
+static bool _hashindex_visitadd(void *elem, void *ctx)
+{
+    _hashindex_add((ll_LinkedList*)ctx, elem);
+    return true;
+}
+
+static bool _hashindex_visitremove(void *elem, void *ctx)
+{
+    _hashindex_remove((ll_LinkedList*)ctx, elem);
+    return true;
+}
+
+static void _visit(const ll_LinkedList *ll, ll_ElemVisit visit, void *ctx)
+{
     switch (ll->type) {
         case ll_CIRCLY:
+        case ll_SINGLY:
             {
-                #ifdef SYNC
-                    ll_LOCK(&ll->mutex);
-                #endif
-
                 SinglyNode *tmp = ll->s_head->next;
-                while (tmp->next->next != ll->s_head) {
-                    print(tmp->elem);
+                while (tmp != ll->s_tail && visit(tmp->elem, ctx))
                     tmp = tmp->next;
-                }
-
-                #ifdef SYNC
-                    ll_UNLOCK(&ll->mutex);
-                #endif
             }
             break;
         case ll_DOUBLY:
             {
-                #ifdef SYNC
-                    ll_LOCK(&ll->mutex);
-                #endif
-
                 DoublyNode *tmp = ll->d_head->next;
-                while (tmp->next != tmp->next->next) {
-                    print(tmp->elem);
+                while (tmp != ll->d_tail && visit(tmp->elem, ctx))
                     tmp = tmp->next;
-                }
-
-                #ifdef SYNC
-                    ll_UNLOCK(&ll->mutex);
-                #endif
             }
             break;
-        case ll_SINGLY:
+        case ll_UNROLLED:
             {
-                #ifdef SYNC
-                    ll_LOCK(&ll->mutex);
-                #endif
-
-                SinglyNode *tmp = ll->s_head->next;
-                while (tmp->next != tmp->next->next) {
-                    print(tmp->elem);
+                UnrolledNode *tmp = ll->u_head;
+                size_t i;
+                while (tmp) {
+                    for (i = 0; i < tmp->count; ++i) {
+                        if (!visit(tmp->elems[i], ctx))
+                            return;
+                    }
                     tmp = tmp->next;
                 }
-
-                #ifdef SYNC
-                    ll_UNLOCK(&ll->mutex);
-                #endif
             }
             break;
         default:
@@ -2079,190 +4842,302 @@ void ll_print(const ll_LinkedList *ll, ll_ElemPrint print)
     }
 }
 
-void ll_print_reverse(const ll_LinkedList *ll, ll_ElemPrint print)
+static void _sort_unrolled(UnrolledNode *node, size_t idx, size_t n, ll_ElemCompare comp)
 {
-    assert(ll);
-    assert(print);
+    UnrolledNode *hole = NULL, *prev = NULL;
+    size_t j, k, hidx, pidx;
+
+    for (k = 1; k < n; ++k) {
+        _unrolled_advance(&node, &idx);
+        void *elem = node->elems[idx];
+
+        /* shift greater elements up one slot, walking back across nodes */
+        hole = node;
+        hidx = idx;
+        for (j = k; j > 0; --j) {
+            prev = hole;
+            pidx = hidx;
+            if (pidx == 0) {
+                prev = prev->prev;
+                pidx = prev->count;
+            }
+            pidx--;
+            if (comp(prev->elems[pidx], elem) <= 0)
+                break;
+            hole->elems[hidx] = prev->elems[pidx];
+            hole = prev;
+            hidx = pidx;
+        }
+        hole->elems[hidx] = elem;
+    }
+}
+
+static UnrolledNode *_unrolled_splitat(ll_LinkedList *ll, UnrolledNode *node, size_t idx)
+{
+    UnrolledNode *rest = _init_unrollednode(ll);
+
+    rest->count = node->count - idx;
+    memcpy(rest->elems, node->elems + idx, rest->count * sizeof *rest->elems);
+    node->count = idx;
+
+    rest->prev = node;
+    rest->next = node->next;
+    if (node->next)
+        node->next->prev = rest;
+    else
+        ll->u_tail = rest;
+    node->next = rest;
+    return rest;
+}
+
+/**
+ * unlink the first node of a chain from _nodepool_allocchain.
+ */
+static inline void *_chain_pop(void **chain)
+{
+    void *node = *chain;
+    *chain = *(void**)node;
+    return node;
+}
+
+static void _insert_array(ll_LinkedList *ll, size_t pos, void *const *elems, size_t n)
+{
+    void *chain = NULL;
+    void *first = NULL;
+    size_t i;
+
+    if (n == 0)
+        return;
+
+    /* a pooled list takes all n nodes (sentinel included) under one lock */
+    if (LL_POOL(ll) && ll->type != ll_UNROLLED)
+        chain = _nodepool_allocchain(LL_POOL(ll), n);
 
     switch (ll->type) {
         case ll_CIRCLY:
         case ll_SINGLY:
-            #ifdef SYNC
-                ll_LOCK(&ll->mutex);
-            #endif
-            _print_reverse(ll->s_head->next, ll->s_tail, print);
-            #ifdef SYNC
-                ll_UNLOCK(&ll->mutex);
-            #endif
+            {
+                SinglyNode *prev = NULL;
+                SinglyNode *next = NULL;
+
+                i = 0;
+                if (pos == ll->size) {
+                    /* the old tail sentinel holds elems[0], a new one goes last */
+                    prev = ll->s_tail;
+                    prev->elem = elems[i++];
+                    first = prev;
+                    next = chain ? (SinglyNode*)_chain_pop(&chain) : _init_singlynode(ll, NULL);
+                    next->elem = NULL;
+                    next->next = (ll->type == ll_CIRCLY) ? ll->s_head : next;
+                    ll->s_tail = next;
+                    _hashindex_add(ll, prev->elem);
+                } else {
+                    prev = (SinglyNode*)_locate(ll, pos);
+                    next = prev->next;
+                }
+                for (; i < n; ++i) {
+                    SinglyNode *node = chain ? (SinglyNode*)_chain_pop(&chain)
+                                             : _init_singlynode(ll, NULL);
+                    node->elem = elems[i];
+                    prev->next = node;
+                    prev = node;
+                    _hashindex_add(ll, node->elem);
+                    if (first == NULL)
+                        first = node;
+                }
+                prev->next = next;
+            }
             break;
         case ll_DOUBLY:
             {
-                #ifdef SYNC
-                    ll_LOCK(&ll->mutex);
-                #endif
-
-                DoublyNode *tmp = ll->d_tail->prev;
-                while (tmp->prev != ll->d_head) {
-                    print(tmp->elem);
-                    tmp = tmp->prev;
+                DoublyNode *prev = (pos == ll->size) ? ll->d_tail->prev
+                                                     : (DoublyNode*)_locate(ll, pos);
+                DoublyNode *next = prev->next;
+
+                for (i = 0; i < n; ++i) {
+                    DoublyNode *node = chain ? (DoublyNode*)_chain_pop(&chain)
+                                             : _init_doublynode(ll, NULL);
+                    node->elem = elems[i];
+                    node->prev = prev;
+                    prev->next = node;
+                    prev = node;
+                    _hashindex_add(ll, node->elem);
+                    if (first == NULL)
+                        first = node;
                 }
-
-                #ifdef SYNC
-                    ll_UNLOCK(&ll->mutex);
-                #endif
+                prev->next = next;
+                next->prev = prev;
+            }
+            break;
+        case ll_UNROLLED:
+            {
+                UnrolledNode *node = NULL;
+                UnrolledNode *after = NULL;
+                size_t idx = pos;
+
+                if (ll->u_head == NULL) {
+                    node = _init_unrollednode(ll);
+                    ll->u_head = node;
+                    ll->u_tail = node;
+                    idx = 0;
+                } else if (pos == ll->size) {
+                    node = ll->u_tail;
+                    idx = node->count;
+                } else {
+                    node = _unrolled_locate(ll, &idx);
+                }
+                if (idx < node->count)
+                    _unrolled_splitat(ll, node, idx);
+                after = node->next;
+
+                /* fill whole blocks */
+                for (i = 0; i < n; ++i) {
+                    if (node->count == UNROLLED_NODE_ELEMS) {
+                        UnrolledNode *fresh = _init_unrollednode(ll);
+                        fresh->prev = node;
+                        node->next = fresh;
+                        node = fresh;
+                    }
+                    node->elems[node->count++] = elems[i];
+                    _hashindex_add(ll, elems[i]);
+                }
+                node->next = after;
+                if (after)
+                    after->prev = node;
+                else
+                    ll->u_tail = node;
             }
             break;
         default:
             #ifdef ALGOS_DEBUG
                 fprintf(stderr, "%s() error: invalid linkedlist type\n", FUNC);
             #endif
-            break;
+            return;
     }
+
+    ll->size += n;
+    _skipindex_insertchain(ll, pos, first, n);
 }
 
-static bool _search_reverse(SinglyNode *start, SinglyNode *end, const void *elem)
+static void _share_nodepool(ll_LinkedList *dst, ll_LinkedList *src)
 {
-    if (start == end)
-        return false;
-
-    #ifdef SYNC
-        ll_LOCK(&ll->mutex);
-    #endif
-    _search_reverse(start->next, end, elem);
-    #ifdef SYNC
-        ll_UNLOCK(&ll->mutex);
-    #endif
-
-    if (start->elem == elem)
-        return true;
-    return false;
+    if (LL_POOL(dst) && LL_POOL(src))
+        _nodepool_merge(LL_POOL(dst), LL_POOL(src));
 }
 
-static void _merge(ll_LinkedList *ll, size_t min, size_t mid, size_t max, ll_ElemCompare comp)
+static int _move_elements(ll_LinkedList *dst, size_t pos, ll_LinkedList *src)
 {
-    void *copy_list[max];
-    memset(copy_list, 0, max*sizeof(size_t));
+    void **elems = (void**)malloc(src->size * sizeof *elems);
+    size_t n = 0;
 
-    assert(ll);
+    if (elems == NULL) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: out of memory\n", FUNC);
+        #endif
+        return ERROR;
+    }
 
-    switch (ll->type) {
+    switch (src->type) {
         case ll_CIRCLY:
         case ll_SINGLY:
             {
-                #ifdef SYNC
-                    ll_LOCK(&ll->mutex);
-                #endif
-
-                size_t i, j, k;
-                SinglyNode *tmp = ll->s_head;
-                SinglyNode *n1 = ll->s_head->next;
-                SinglyNode *n2 = NULL;
-
-                for (i = 0; i < min; ++i)
-                    n1 = n1->next;
-                
-                for (j = i, n2 = n1; j < mid; ++j)
-                    n2 = n2->next;
-               
-                for (k = 0; i < mid && j < max; k++) {
-                    int result = comp(n1->elem, n2->elem);
-                    if (result < 1) {
-                        copy_list[k] = n1->elem;
-                        n1 = n1->next;
-                        i++;
-                    } else {
-                        copy_list[k] = n2->elem;
-                        n2 = n2->next;
-                        j++;
-                    }
-                }
-
-                while (i < mid) {
-                    copy_list[k++] = n1->elem;
-                    n1 = n1->next;
-                    i++;
-                }
-
-                while (j < max) {
-                    copy_list[k++] = n2->elem;
-                    n2 = n2->next;
-                    j++;
-                }
-                
-                for (k = 0; k < max; k++) {
-                    tmp->next->elem = copy_list[k];
-                    tmp = tmp->next;
+                SinglyNode *tmp = src->s_head->next;
+                SinglyNode *next = NULL;
+                while (tmp != src->s_tail) {
+                    next = tmp->next;
+                    elems[n++] = tmp->elem;
+                    _destroy_singlynode(src, tmp, _nodtor);
+                    tmp = next;
                 }
-
-                #ifdef SYNC
-                    ll_UNLOCK(&ll->mutex);
-                #endif
+                src->s_head->next = src->s_tail;
             }
             break;
         case ll_DOUBLY:
             {
-                #ifdef SYNC
-                    ll_LOCK(&ll->mutex);
-                #endif
-
-                size_t i, j, k;
-                DoublyNode *tmp = ll->d_head;
-                DoublyNode *n1 = ll->d_head->next;
-                DoublyNode *n2 = NULL;
-
-                for (i = 0; i < min; ++i)
-                    n1 = n1->next;
-                
-                for (j = i, n2 = n1; j < mid; ++j)
-                    n2 = n2->next;
-               
-                for (k = 0; i < mid && j < max; k++) {
-                    int result = comp(n1->elem, n2->elem);
-                    if (result < 1) {
-                        copy_list[k] = n1->elem;
-                        n1 = n1->next;
-                        i++;
-                    } else {
-                        copy_list[k] = n2->elem;
-                        n2 = n2->next;
-                        j++;
-                    }
-                }
-
-                while (i < mid) {
-                    copy_list[k++] = n1->elem;
-                    n1 = n1->next;
-                    i++;
-                }
-
-                while (j < max) {
-                    copy_list[k++] = n2->elem;
-                    n2 = n2->next;
-                    j++;
+                DoublyNode *tmp = src->d_head->next;
+                DoublyNode *next = NULL;
+                while (tmp != src->d_tail) {
+                    next = tmp->next;
+                    elems[n++] = tmp->elem;
+                    _destroy_doublynode(src, tmp, _nodtor);
+                    tmp = next;
                 }
-                
-                for (k = 0; k < max; k++) {
-                    tmp->next->elem = copy_list[k];
-                    tmp = tmp->next;
+                src->d_head->next = src->d_tail;
+                src->d_tail->prev = src->d_head;
+            }
+            break;
+        case ll_UNROLLED:
+            {
+                UnrolledNode *tmp = src->u_head;
+                UnrolledNode *next = NULL;
+                while (tmp) {
+                    next = tmp->next;
+                    memcpy(elems + n, tmp->elems, tmp->count * sizeof *elems);
+                    n += tmp->count;
+                    _destroy_unrollednode(src, tmp);
+                    tmp = next;
                 }
-
-                #ifdef SYNC
-                    ll_UNLOCK(&ll->mutex);
-                #endif
+                src->u_head = NULL;
+                src->u_tail = NULL;
             }
             break;
         default:
-            #ifdef ALGOS_DEBUG
-                fprintf(stderr, "%s() error: invalid linkedlist type\n", FUNC);
-            #endif
             break;
     }
+
+    src->size = 0;
+    _insert_array(dst, pos, elems, n);
+    free(elems);
+    return SUCCESS;
 }
 
-static void _print_reverse(SinglyNode *start, SinglyNode *end, ll_ElemPrint print)
+static void _singly_append(ll_LinkedList *dst, ll_LinkedList *src)
 {
-    if (start == end)
-        return;
-    _print_reverse(start->next, end, print);
-    print(start->elem);
+    SinglyNode *tail = dst->s_tail;
+    SinglyNode *first = src->s_head->next;
+
+    tail->elem = first->elem;
+    tail->next = first->next;
+    dst->s_tail = src->s_tail;
+    dst->s_tail->next = (dst->type == ll_CIRCLY) ? dst->s_head : dst->s_tail;
+
+    first->elem = NULL;
+    first->next = (src->type == ll_CIRCLY) ? src->s_head : first;
+    src->s_head->next = first;
+    src->s_tail = first;
+}
+
+#ifdef SYNC
+static int _init_listmutex(pthread_mutex_t *mutex)
+{
+    #ifdef NDEBUG
+        return pthread_mutex_init(mutex, NULL);
+    #else
+        pthread_mutexattr_t attr;
+        int rc = pthread_mutexattr_init(&attr);
+        if (rc == 0) {
+            pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_ERRORCHECK);
+            rc = pthread_mutex_init(mutex, &attr);
+            pthread_mutexattr_destroy(&attr);
+        }
+        return rc;
+    #endif
+}
+
+static void _lock_pair(ll_LinkedList *a, ll_LinkedList *b)
+{
+    if (a < b) {
+        ll_LOCK(&a->mutex);
+        ll_LOCK(&b->mutex);
+    } else {
+        ll_LOCK(&b->mutex);
+        ll_LOCK(&a->mutex);
+    }
+}
+
+static void _unlock_pair(ll_LinkedList *a, ll_LinkedList *b)
+{
+    ll_UNLOCK(&a->mutex);
+    ll_UNLOCK(&b->mutex);
 }
+#endif
@@ -1 +1,452 @@
+#include <assert.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <linux/membarrier.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <sched.h>
+#endif
+
 #include "qu.h"
+
+/* tries a waiter spins through before it sleeps, adapted between the two */
+#define QU_MIN_SPIN  8
+#define QU_MAX_SPIN  1024
+
+typedef struct {
+    size_t seq;             /* position the cell is free for, position + 1 once written */
+    void *elem;
+} Cell;
+
+/**
+ * Sleepers on one side of a queue: consumers waiting for an element or
+ * producers waiting for room.
+ */
+typedef struct {
+    uint32_t seq;           /* futex word, bumped by every wake up */
+    uint32_t waiters;       /* threads asleep or about to be */
+    unsigned spin;          /* tries before sleeping */
+} __attribute__((aligned(CACHE_LINE_SIZE))) WaitSide;
+
+struct _queue {
+    Cell *cells;
+    size_t mask;            /* capacity - 1 */
+    qu_QueueMode mode;
+    bool asymmetric;        /* sleepers fence for the other threads, see _notify */
+    /* producers and consumers each spin on a line of their own */
+    size_t tail __attribute__((aligned(CACHE_LINE_SIZE)));  /* next position to enqueue */
+    size_t head __attribute__((aligned(CACHE_LINE_SIZE)));  /* next position to dequeue */
+    WaitSide not_empty;     /* consumers */
+    WaitSide not_full;      /* producers */
+};
+
+/**
+ * @brief Claim up to n consecutive ready cells at an index.
+ *
+ * A cell at position pos is ready for producers when its sequence is pos,
+ * for consumers when it is pos + 1. The claim moves the index past the
+ * cells, with a compare-and-swap if other threads move it too.
+ *
+ * @param qu      pointer to a queue.
+ * @param index   &qu->tail for producers, &qu->head for consumers.
+ * @param ready   0 for producers, 1 for consumers.
+ * @param shared  more than one thread moves index.
+ * @param n       most cells to claim.
+ * @param first   set to the position of the first cell claimed.
+ * @return the number of cells claimed, 0 if the queue is full for
+ *         producers or empty for consumers.
+ */
+static inline size_t _claim(qu_Queue *qu, size_t *index, size_t ready, bool shared,
+                            size_t n, size_t *first);
+
+/**
+ * @brief Write elems into claimed cells and hand them to consumers.
+ */
+static inline void _publish(qu_Queue *qu, size_t first, void *const *elems, size_t n);
+
+/**
+ * @brief Read elems out of claimed cells and hand the cells back to
+ * producers, a lap later.
+ */
+static inline void _consume(qu_Queue *qu, size_t first, void **elems, size_t n);
+
+/**
+ * @brief Add up to n elements and wake consumers for them.
+ *
+ * @return the number added.
+ */
+static inline size_t _push(qu_Queue *qu, void *const *elems, size_t n);
+
+/**
+ * @brief Take up to n elements and wake producers for the room.
+ *
+ * @return the number taken.
+ */
+static inline size_t _pop(qu_Queue *qu, void **elems, size_t n);
+
+/**
+ * @brief Wake up to n sleepers of a side, if it has any.
+ */
+static inline void _notify(qu_Queue *qu, WaitSide *side, size_t n);
+
+/**
+ * @brief Shared body of qu_push_wait and qu_pop_wait.
+ *
+ * @param qu          pointer to a queue.
+ * @param push        add *elem if true, take into *elem if false.
+ * @param elem        the element.
+ * @param timeout_ns  as qu_push_wait.
+ * @return SUCCESS, or ERROR if the timeout expired.
+ */
+static int _wait(qu_Queue *qu, bool push, void **elem, int64_t timeout_ns);
+
+/**
+ * @brief Sleep while *word is val, at most timeout_ns if not negative.
+ */
+static void _futex_wait(uint32_t *word, uint32_t val, int64_t timeout_ns);
+
+/**
+ * @brief Wake up to n threads sleeping on word.
+ */
+static void _futex_wake(uint32_t *word, int n);
+
+/**
+ * @brief CLOCK_MONOTONIC in nanoseconds.
+ */
+static int64_t _now_ns(void);
+
+/**
+ * @brief Hint to the core that this is a spin loop.
+ */
+static inline void _cpu_relax(void);
+
+
+qu_Queue *qu_init(size_t capacity, qu_QueueMode mode)
+{
+    qu_Queue *qu = NULL;
+    size_t cap = 2, bytes, i;
+
+    if (capacity == 0) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: capacity is 0\n", FUNC);
+        #endif
+        return NULL;
+    }
+    /* with one cell, written for this lap would read as free for the next */
+    while (cap < capacity)
+        cap *= 2;
+
+    qu = (qu_Queue*)aligned_alloc(CACHE_LINE_SIZE, sizeof *qu);
+    assert(qu);
+    /* aligned_alloc wants a multiple of the alignment */
+    bytes = (cap * sizeof *qu->cells + CACHE_LINE_SIZE - 1) & ~(size_t)(CACHE_LINE_SIZE - 1);
+    qu->cells = (Cell*)aligned_alloc(CACHE_LINE_SIZE, bytes);
+    assert(qu->cells);
+    for (i = 0; i < cap; ++i) {
+        qu->cells[i].seq = i;
+        qu->cells[i].elem = NULL;
+    }
+    qu->mask = cap - 1;
+    qu->mode = mode;
+    qu->tail = 0;
+    qu->head = 0;
+    qu->not_empty.seq = qu->not_full.seq = 0;
+    qu->not_empty.waiters = qu->not_full.waiters = 0;
+    qu->not_empty.spin = qu->not_full.spin = QU_MIN_SPIN;
+    #ifdef __linux__
+        qu->asymmetric = syscall(SYS_membarrier, MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED,
+                                 0, 0) == 0;
+    #else
+        qu->asymmetric = false;
+    #endif
+    return qu;
+}
+
+void qu_destroy(qu_Queue *qu, qu_ElemDtor dtor)
+{
+    void *elem = NULL;
+
+    assert(qu);
+    while (qu_dequeue(qu, &elem) == SUCCESS) {
+        if (dtor)
+            dtor(elem);
+        else
+            free(elem);
+    }
+    free(qu->cells);
+    free(qu);
+}
+
+int qu_enqueue(qu_Queue *qu, void *elem)
+{
+    assert(qu);
+    if (!_push(qu, &elem, 1)) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: queue is full\n", FUNC);
+        #endif
+        return ERROR;
+    }
+    return SUCCESS;
+}
+
+int qu_dequeue(qu_Queue *qu, void **elem)
+{
+    assert(qu);
+    assert(elem);
+    return _pop(qu, elem, 1) ? SUCCESS : ERROR;
+}
+
+size_t qu_enqueue_many(qu_Queue *qu, void *const *elems, size_t n)
+{
+    assert(qu);
+    assert(elems || n == 0);
+    return (n > 0) ? _push(qu, elems, n) : 0;
+}
+
+size_t qu_dequeue_many(qu_Queue *qu, void **elems, size_t n)
+{
+    assert(qu);
+    assert(elems || n == 0);
+    return (n > 0) ? _pop(qu, elems, n) : 0;
+}
+
+int qu_push_wait(qu_Queue *qu, void *elem, int64_t timeout_ns)
+{
+    assert(qu);
+    return _wait(qu, true, &elem, timeout_ns);
+}
+
+int qu_pop_wait(qu_Queue *qu, void **elem, int64_t timeout_ns)
+{
+    assert(qu);
+    assert(elem);
+    return _wait(qu, false, elem, timeout_ns);
+}
+
+size_t qu_getsize(const qu_Queue *qu)
+{
+    size_t head, tail;
+
+    assert(qu);
+    /* head first, the tail read after it can only be further on */
+    head = __atomic_load_n(&qu->head, __ATOMIC_ACQUIRE);
+    tail = __atomic_load_n(&qu->tail, __ATOMIC_ACQUIRE);
+    return (tail - head > qu->mask + 1) ? qu->mask + 1 : tail - head;
+}
+
+bool qu_isempty(const qu_Queue *qu)
+{
+    return qu_getsize(qu) == 0;
+}
+
+size_t qu_getcapacity(const qu_Queue *qu)
+{
+    assert(qu);
+    return qu->mask + 1;
+}
+
+static inline size_t _claim(qu_Queue *qu, size_t *index, size_t ready, bool shared,
+                            size_t n, size_t *first)
+{
+    size_t pos = __atomic_load_n(index, __ATOMIC_RELAXED);
+
+    for (;;) {
+        intptr_t diff = 0;
+        size_t k;
+
+        for (k = 0; k < n; ++k) {
+            size_t seq = __atomic_load_n(&qu->cells[(pos + k) & qu->mask].seq, __ATOMIC_ACQUIRE);
+            diff = (intptr_t)(seq - (pos + k + ready));
+            if (diff != 0)
+                break;
+        }
+
+        if (k > 0) {
+            if (!shared) {
+                __atomic_store_n(index, pos + k, __ATOMIC_RELAXED);
+                *first = pos;
+                return k;
+            }
+            /* a failed swap reloads pos */
+            if (__atomic_compare_exchange_n(index, &pos, pos + k, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                *first = pos;
+                return k;
+            }
+        } else if (diff < 0) {
+            /* the cell is a lap behind: still full for producers, not yet written for consumers */
+            return 0;
+        } else {
+            /* another thread took pos already */
+            pos = __atomic_load_n(index, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static inline void _publish(qu_Queue *qu, size_t first, void *const *elems, size_t n)
+{
+    size_t i;
+
+    for (i = 0; i < n; ++i) {
+        Cell *cell = &qu->cells[(first + i) & qu->mask];
+        cell->elem = elems[i];
+        __atomic_store_n(&cell->seq, first + i + 1, __ATOMIC_RELEASE);
+    }
+}
+
+static inline void _consume(qu_Queue *qu, size_t first, void **elems, size_t n)
+{
+    size_t i;
+
+    for (i = 0; i < n; ++i) {
+        Cell *cell = &qu->cells[(first + i) & qu->mask];
+        elems[i] = cell->elem;
+        __atomic_store_n(&cell->seq, first + i + qu->mask + 1, __ATOMIC_RELEASE);
+    }
+}
+
+static inline size_t _push(qu_Queue *qu, void *const *elems, size_t n)
+{
+    size_t first, claimed = _claim(qu, &qu->tail, 0, qu->mode != qu_SPSC, n, &first);
+
+    if (claimed > 0) {
+        _publish(qu, first, elems, claimed);
+        _notify(qu, &qu->not_empty, claimed);
+    }
+    return claimed;
+}
+
+static inline size_t _pop(qu_Queue *qu, void **elems, size_t n)
+{
+    size_t first, claimed = _claim(qu, &qu->head, 1, qu->mode == qu_MPMC, n, &first);
+
+    if (claimed > 0) {
+        _consume(qu, first, elems, claimed);
+        _notify(qu, &qu->not_full, claimed);
+    }
+    return claimed;
+}
+
+static inline void _notify(qu_Queue *qu, WaitSide *side, size_t n)
+{
+    /*
+     * A waiter counts itself in and then tries the queue once more, so
+     * either it sees the cells just handed over or this sees it. That
+     * takes a full fence between those cell stores and the load of
+     * waiters. With membarrier a waiter about to sleep forces it on every
+     * running thread instead, and the adds and takes get away with a
+     * compiler barrier.
+     */
+    if (qu->asymmetric)
+        __atomic_signal_fence(__ATOMIC_SEQ_CST);
+    else
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&side->waiters, __ATOMIC_RELAXED) == 0)
+        return;
+    __atomic_fetch_add(&side->seq, 1, __ATOMIC_RELEASE);
+    _futex_wake(&side->seq, (n > INT_MAX) ? INT_MAX : (int)n);
+}
+
+static int _wait(qu_Queue *qu, bool push, void **elem, int64_t timeout_ns)
+{
+    WaitSide *side = push ? &qu->not_full : &qu->not_empty;
+    unsigned spin = __atomic_load_n(&side->spin, __ATOMIC_RELAXED);
+    int64_t deadline = 0;
+    unsigned i;
+
+    #define QU_TRY() (push ? _push(qu, elem, 1) : _pop(qu, elem, 1))
+
+    if (QU_TRY())
+        return SUCCESS;
+    if (timeout_ns == 0)
+        return ERROR;
+
+    for (i = 0; i < spin; ++i) {
+        _cpu_relax();
+        if (QU_TRY()) {
+            /* spinning paid off, allow more of it */
+            __atomic_store_n(&side->spin, (spin * 2 < QU_MAX_SPIN) ? spin * 2 : QU_MAX_SPIN,
+                             __ATOMIC_RELAXED);
+            return SUCCESS;
+        }
+    }
+    __atomic_store_n(&side->spin, (spin / 2 > QU_MIN_SPIN) ? spin / 2 : QU_MIN_SPIN,
+                     __ATOMIC_RELAXED);
+
+    if (timeout_ns > 0)
+        deadline = _now_ns() + timeout_ns;
+    for (;;) {
+        uint32_t seq = __atomic_load_n(&side->seq, __ATOMIC_ACQUIRE);
+        int64_t left = -1;
+
+        __atomic_fetch_add(&side->waiters, 1, __ATOMIC_SEQ_CST);
+        #ifdef __linux__
+            if (qu->asymmetric)
+                syscall(SYS_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0, 0);
+        #endif
+        if (QU_TRY()) {
+            __atomic_fetch_sub(&side->waiters, 1, __ATOMIC_RELAXED);
+            return SUCCESS;
+        }
+        if (timeout_ns > 0) {
+            left = deadline - _now_ns();
+            if (left <= 0) {
+                __atomic_fetch_sub(&side->waiters, 1, __ATOMIC_RELAXED);
+                return ERROR;
+            }
+        }
+        _futex_wait(&side->seq, seq, left);
+        __atomic_fetch_sub(&side->waiters, 1, __ATOMIC_RELAXED);
+    }
+
+    #undef QU_TRY
+}
+
+static void _futex_wait(uint32_t *word, uint32_t val, int64_t timeout_ns)
+{
+    #ifdef __linux__
+        struct timespec ts;
+
+        ts.tv_sec = (time_t)(timeout_ns / 1000000000);
+        ts.tv_nsec = (long)(timeout_ns % 1000000000);
+        /* EAGAIN if word moved on already, EINTR and ETIMEDOUT alike go back to the caller's loop */
+        syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, val, (timeout_ns < 0) ? NULL : &ts, NULL, 0);
+    #else
+        (void)word;
+        (void)val;
+        (void)timeout_ns;
+        sched_yield();
+    #endif
+}
+
+static void _futex_wake(uint32_t *word, int n)
+{
+    #ifdef __linux__
+        syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, n, NULL, NULL, 0);
+    #else
+        (void)word;
+        (void)n;
+    #endif
+}
+
+static int64_t _now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static inline void _cpu_relax(void)
+{
+    #if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+    #elif defined(__aarch64__)
+        __asm__ __volatile__("yield");
+    #endif
+}
@@ -1 +1,553 @@
+#include <assert.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
 #include "tr.h"
+
+/* no node */
+#define TR_NIL           SIZE_MAX
+/* prev of a pairing node on the free list */
+#define TR_FREE          (SIZE_MAX - 1)
+/* handles of a new heap */
+#define TR_MIN_CAPACITY  16
+/* entries before entries[1] in the block, so that it starts a cache line */
+#define TR_ENTRY_PAD     (CACHE_LINE_SIZE / sizeof(Entry) - 1)
+
+typedef struct {
+    void *elem;
+    tr_Handle handle;
+} Entry;
+
+typedef struct {
+    void *elem;
+    size_t child;           /* first child */
+    size_t next;            /* next sibling, the next free node while free */
+    size_t prev;            /* parent of a first child, else previous sibling; TR_FREE while free */
+} PairNode;
+
+struct _heap {
+    tr_HeapType type;
+    tr_ElemCompare comp;
+    unsigned arity;
+    unsigned shift;         /* log2 of arity if a power of two, else 0 */
+    size_t size;
+    size_t capacity;        /* handles, and entries of a d-ary heap */
+    size_t used;            /* handles handed out so far, free or not */
+    size_t free;            /* first free handle, TR_NIL if none */
+    /* d-ary heap */
+    Entry *block;           /* cache line aligned allocation entries points into */
+    Entry *entries;         /* entries[0] is first, children of i from arity * i + 1 */
+    size_t *pos;            /* index in entries per handle, the next free handle while free */
+    /* pairing heap */
+    PairNode *nodes;        /* per handle */
+    size_t root;
+    #ifdef SYNC
+        pthread_mutex_t mutex;
+    #endif
+};
+
+/**
+ * @brief Resize the per handle arrays, and entries of a d-ary heap.
+ *
+ * @param heap      pointer to a heap.
+ * @param capacity  the new number of handles, at least heap->used.
+ */
+static void _resize(tr_Heap *heap, size_t capacity);
+
+/**
+ * @brief Take a handle off the free list, or a new one.
+ */
+static tr_Handle _new_handle(tr_Heap *heap);
+
+/**
+ * @brief Put a handle on the free list.
+ */
+static void _release_handle(tr_Heap *heap, tr_Handle handle);
+
+/**
+ * @brief Check that handle belongs to an element in the heap.
+ */
+static bool _valid_handle(const tr_Heap *heap, tr_Handle handle);
+
+/**
+ * @brief Index of the parent of entry i > 0.
+ */
+static inline size_t _parent(const tr_Heap *heap, size_t i);
+
+/**
+ * @brief Move entry i towards the top until its parent comes before it.
+ */
+static void _sift_up(tr_Heap *heap, size_t i);
+
+/**
+ * @brief Move entry i towards the leaves until it comes before its
+ * children.
+ */
+static void _sift_down(tr_Heap *heap, size_t i);
+
+/**
+ * @brief Restore the heap order of all entries bottom-up, in O(n).
+ */
+static void _rebuild(tr_Heap *heap);
+
+/**
+ * @brief Link two pairing heap roots, the later one becoming the first
+ * child of the other.
+ *
+ * @return the root that comes first. Its next and prev are left as they
+ *         were.
+ */
+static size_t _meld(tr_Heap *heap, size_t a, size_t b);
+
+/**
+ * @brief Meld a list of sibling subtrees into one, in two passes: pairs
+ * left to right, then the pairs right to left.
+ *
+ * @param heap   pointer to a pairing heap.
+ * @param first  the first sibling.
+ * @return the root of the melded tree.
+ */
+static size_t _combine(tr_Heap *heap, size_t first);
+
+/**
+ * @brief Add elem as a new root.
+ */
+static tr_Handle _push(tr_Heap *heap, void *elem);
+
+
+tr_Heap *tr_heap_init(tr_HeapType type, tr_ElemCompare comp)
+{
+    tr_Heap *heap = (tr_Heap*)calloc(1, sizeof *heap);
+
+    assert(heap);
+    assert(comp);
+    heap->type = type;
+    heap->comp = comp;
+    heap->arity = tr_DEFAULT_ARITY;
+    heap->shift = __builtin_ctz(tr_DEFAULT_ARITY);
+    heap->free = TR_NIL;
+    heap->root = TR_NIL;
+    #ifdef SYNC
+        if (pthread_mutex_init(&heap->mutex, NULL) != 0) {
+            int errnum = errno;
+            #ifdef ALGOS_DEBUG
+                fprintf(stderr, "%s() error: unable to initialize mutex. errorcode: %d\n",
+                        FUNC, errnum);
+            #endif
+            (void)errnum;
+            free(heap);
+            return NULL;
+        }
+    #endif
+    _resize(heap, TR_MIN_CAPACITY);
+    return heap;
+}
+
+void tr_heap_destroy(tr_Heap *heap, tr_ElemDtor dtor)
+{
+    size_t i;
+
+    assert(heap);
+    for (i = 0; i < heap->used; ++i) {
+        void *elem = NULL;
+        if (heap->type == tr_DARY_HEAP) {
+            if (i >= heap->size)
+                break;
+            elem = heap->entries[i].elem;
+        } else {
+            if (heap->nodes[i].prev == TR_FREE)
+                continue;
+            elem = heap->nodes[i].elem;
+        }
+        if (dtor)
+            dtor(elem);
+        else
+            free(elem);
+    }
+    #ifdef SYNC
+        if (pthread_mutex_destroy(&heap->mutex) != 0) {
+            int errnum = errno;
+            #ifdef ALGOS_DEBUG
+                fprintf(stderr, "%s() error: unable to destroy mutex. errorcode: %d\n",
+                        FUNC, errnum);
+            #endif
+            (void)errnum;
+        }
+    #endif
+    free(heap->block);
+    free(heap->pos);
+    free(heap->nodes);
+    free(heap);
+}
+
+int tr_heap_set_arity(tr_Heap *heap, unsigned arity)
+{
+    assert(heap);
+    if (heap->type != tr_DARY_HEAP || arity < 2 || arity > tr_MAX_ARITY) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: no d-ary heap or arity out of range\n", FUNC);
+        #endif
+        return ERROR;
+    }
+
+    #ifdef SYNC
+        ll_LOCK(&heap->mutex);
+    #endif
+    heap->arity = arity;
+    heap->shift = ((arity & (arity - 1)) == 0) ? __builtin_ctz(arity) : 0;
+    _rebuild(heap);
+    #ifdef SYNC
+        ll_UNLOCK(&heap->mutex);
+    #endif
+    return SUCCESS;
+}
+
+tr_Handle tr_heap_push(tr_Heap *heap, void *elem)
+{
+    tr_Handle handle;
+
+    assert(heap);
+    #ifdef SYNC
+        ll_LOCK(&heap->mutex);
+    #endif
+    handle = _push(heap, elem);
+    if (heap->type == tr_DARY_HEAP)
+        _sift_up(heap, heap->size - 1);
+    #ifdef SYNC
+        ll_UNLOCK(&heap->mutex);
+    #endif
+    return handle;
+}
+
+int tr_heap_heapify(tr_Heap *heap, void *const *elems, size_t n, tr_Handle *handles)
+{
+    size_t i, capacity;
+
+    assert(heap);
+    assert(elems || n == 0);
+    #ifdef SYNC
+        ll_LOCK(&heap->mutex);
+    #endif
+
+    for (capacity = heap->capacity; capacity < heap->size + n; capacity *= 2)
+        ;
+    if (capacity > heap->capacity)
+        _resize(heap, capacity);
+    for (i = 0; i < n; ++i) {
+        tr_Handle handle = _push(heap, elems[i]);
+        if (handles)
+            handles[i] = handle;
+    }
+    if (heap->type == tr_DARY_HEAP)
+        _rebuild(heap);
+
+    #ifdef SYNC
+        ll_UNLOCK(&heap->mutex);
+    #endif
+    return SUCCESS;
+}
+
+void *tr_heap_top(tr_Heap *heap)
+{
+    void *elem = NULL;
+
+    assert(heap);
+    #ifdef SYNC
+        ll_LOCK(&heap->mutex);
+    #endif
+    if (heap->size == 0) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: heap is empty\n", FUNC);
+        #endif
+    } else {
+        elem = (heap->type == tr_DARY_HEAP) ? heap->entries[0].elem
+                                            : heap->nodes[heap->root].elem;
+    }
+    #ifdef SYNC
+        ll_UNLOCK(&heap->mutex);
+    #endif
+    return elem;
+}
+
+void *tr_heap_pop(tr_Heap *heap)
+{
+    void *elem = NULL;
+
+    assert(heap);
+    #ifdef SYNC
+        ll_LOCK(&heap->mutex);
+    #endif
+
+    if (heap->size == 0) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: heap is empty\n", FUNC);
+        #endif
+    } else if (heap->type == tr_DARY_HEAP) {
+        elem = heap->entries[0].elem;
+        _release_handle(heap, heap->entries[0].handle);
+        heap->size--;
+        if (heap->size > 0) {
+            heap->entries[0] = heap->entries[heap->size];
+            _sift_down(heap, 0);
+        }
+    } else {
+        size_t root = heap->root;
+        elem = heap->nodes[root].elem;
+        heap->root = (heap->nodes[root].child != TR_NIL)
+                   ? _combine(heap, heap->nodes[root].child) : TR_NIL;
+        _release_handle(heap, root);
+        heap->size--;
+    }
+
+    #ifdef SYNC
+        ll_UNLOCK(&heap->mutex);
+    #endif
+    return elem;
+}
+
+int tr_heap_decrease_key(tr_Heap *heap, tr_Handle handle, void *elem)
+{
+    assert(heap);
+    #ifdef SYNC
+        ll_LOCK(&heap->mutex);
+    #endif
+
+    if (!_valid_handle(heap, handle)) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: handle not in heap\n", FUNC);
+        #endif
+        #ifdef SYNC
+            ll_UNLOCK(&heap->mutex);
+        #endif
+        return ERROR;
+    }
+
+    if (heap->type == tr_DARY_HEAP) {
+        heap->entries[heap->pos[handle]].elem = elem;
+        _sift_up(heap, heap->pos[handle]);
+    } else {
+        PairNode *nodes = heap->nodes;
+        nodes[handle].elem = elem;
+        if (handle != heap->root) {
+            /* cut the subtree out and meld it with the root */
+            size_t prev = nodes[handle].prev;
+            if (nodes[prev].child == handle)
+                nodes[prev].child = nodes[handle].next;
+            else
+                nodes[prev].next = nodes[handle].next;
+            if (nodes[handle].next != TR_NIL)
+                nodes[nodes[handle].next].prev = prev;
+            heap->root = _meld(heap, heap->root, handle);
+            nodes[heap->root].next = nodes[heap->root].prev = TR_NIL;
+        }
+    }
+
+    #ifdef SYNC
+        ll_UNLOCK(&heap->mutex);
+    #endif
+    return SUCCESS;
+}
+
+size_t tr_heap_getsize(tr_Heap *heap)
+{
+    size_t size;
+
+    assert(heap);
+    #ifdef SYNC
+        ll_LOCK(&heap->mutex);
+    #endif
+    size = heap->size;
+    #ifdef SYNC
+        ll_UNLOCK(&heap->mutex);
+    #endif
+    return size;
+}
+
+bool tr_heap_isempty(tr_Heap *heap)
+{
+    return tr_heap_getsize(heap) == 0;
+}
+
+static void _resize(tr_Heap *heap, size_t capacity)
+{
+    if (heap->type == tr_DARY_HEAP) {
+        /* aligned_alloc has no realloc, and wants a multiple of the alignment */
+        size_t bytes = ((capacity + TR_ENTRY_PAD) * sizeof(Entry) + CACHE_LINE_SIZE - 1)
+                     & ~(size_t)(CACHE_LINE_SIZE - 1);
+        Entry *block = (Entry*)aligned_alloc(CACHE_LINE_SIZE, bytes);
+        assert(block);
+        if (heap->block)
+            memcpy(block + TR_ENTRY_PAD, heap->entries, heap->size * sizeof(Entry));
+        free(heap->block);
+        heap->block = block;
+        heap->entries = block + TR_ENTRY_PAD;
+        heap->pos = (size_t*)realloc(heap->pos, capacity * sizeof *heap->pos);
+        assert(heap->pos);
+    } else {
+        heap->nodes = (PairNode*)realloc(heap->nodes, capacity * sizeof *heap->nodes);
+        assert(heap->nodes);
+    }
+    heap->capacity = capacity;
+}
+
+static tr_Handle _new_handle(tr_Heap *heap)
+{
+    tr_Handle handle = heap->free;
+
+    if (handle != TR_NIL) {
+        heap->free = (heap->type == tr_DARY_HEAP) ? heap->pos[handle] : heap->nodes[handle].next;
+        return handle;
+    }
+    if (heap->used == heap->capacity)
+        _resize(heap, heap->capacity * 2);
+    return heap->used++;
+}
+
+static void _release_handle(tr_Heap *heap, tr_Handle handle)
+{
+    if (heap->type == tr_DARY_HEAP) {
+        heap->pos[handle] = heap->free;
+    } else {
+        heap->nodes[handle].next = heap->free;
+        heap->nodes[handle].prev = TR_FREE;
+    }
+    heap->free = handle;
+}
+
+static bool _valid_handle(const tr_Heap *heap, tr_Handle handle)
+{
+    if (handle >= heap->used)
+        return false;
+    /* no entry carries a free handle, whatever its pos holds */
+    if (heap->type == tr_DARY_HEAP)
+        return heap->pos[handle] < heap->size && heap->entries[heap->pos[handle]].handle == handle;
+    return heap->nodes[handle].prev != TR_FREE;
+}
+
+static inline size_t _parent(const tr_Heap *heap, size_t i)
+{
+    return heap->shift ? (i - 1) >> heap->shift : (i - 1) / heap->arity;
+}
+
+static void _sift_up(tr_Heap *heap, size_t i)
+{
+    Entry e = heap->entries[i];
+
+    /* move parents down into the hole, and e once into its place */
+    while (i > 0) {
+        size_t parent = _parent(heap, i);
+        if (heap->comp(e.elem, heap->entries[parent].elem) >= 0)
+            break;
+        heap->entries[i] = heap->entries[parent];
+        heap->pos[heap->entries[i].handle] = i;
+        i = parent;
+    }
+    heap->entries[i] = e;
+    heap->pos[e.handle] = i;
+}
+
+static void _sift_down(tr_Heap *heap, size_t i)
+{
+    Entry e = heap->entries[i];
+    size_t n = heap->size;
+
+    for (;;) {
+        size_t first = heap->shift ? (i << heap->shift) + 1 : i * heap->arity + 1;
+        size_t last, best, c;
+
+        if (first >= n)
+            break;
+        last = (n - first > heap->arity) ? first + heap->arity : n;
+        best = first;
+        for (c = first + 1; c < last; ++c) {
+            if (heap->comp(heap->entries[c].elem, heap->entries[best].elem) < 0)
+                best = c;
+        }
+        if (heap->comp(heap->entries[best].elem, e.elem) >= 0)
+            break;
+        heap->entries[i] = heap->entries[best];
+        heap->pos[heap->entries[i].handle] = i;
+        i = best;
+    }
+    heap->entries[i] = e;
+    heap->pos[e.handle] = i;
+}
+
+static void _rebuild(tr_Heap *heap)
+{
+    size_t i;
+
+    if (heap->size < 2)
+        return;
+    /* the leaves are heaps already, sift the rest from the last parent up */
+    for (i = _parent(heap, heap->size - 1) + 1; i-- > 0;)
+        _sift_down(heap, i);
+}
+
+static size_t _meld(tr_Heap *heap, size_t a, size_t b)
+{
+    PairNode *nodes = heap->nodes;
+
+    if (heap->comp(nodes[b].elem, nodes[a].elem) < 0) {
+        size_t tmp = a;
+        a = b;
+        b = tmp;
+    }
+    nodes[b].prev = a;
+    nodes[b].next = nodes[a].child;
+    if (nodes[a].child != TR_NIL)
+        nodes[nodes[a].child].prev = b;
+    nodes[a].child = b;
+    return a;
+}
+
+static size_t _combine(tr_Heap *heap, size_t first)
+{
+    PairNode *nodes = heap->nodes;
+    size_t pairs = TR_NIL, root;
+
+    /* first pass: meld pairs, stacking the results through next */
+    while (first != TR_NIL) {
+        size_t a = first, b = nodes[a].next;
+        if (b == TR_NIL) {
+            first = TR_NIL;
+        } else {
+            first = nodes[b].next;
+            a = _meld(heap, a, b);
+        }
+        nodes[a].next = pairs;
+        pairs = a;
+    }
+
+    /* second pass: the stack pops right to left, meld each into the result */
+    root = pairs;
+    pairs = nodes[root].next;
+    while (pairs != TR_NIL) {
+        size_t next = nodes[pairs].next;
+        root = _meld(heap, root, pairs);
+        pairs = next;
+    }
+    nodes[root].next = nodes[root].prev = TR_NIL;
+    return root;
+}
+
+static tr_Handle _push(tr_Heap *heap, void *elem)
+{
+    tr_Handle handle = _new_handle(heap);
+
+    if (heap->type == tr_DARY_HEAP) {
+        heap->entries[heap->size].elem = elem;
+        heap->entries[heap->size].handle = handle;
+        heap->pos[handle] = heap->size;
+    } else {
+        PairNode *node = &heap->nodes[handle];
+        node->elem = elem;
+        node->child = node->next = node->prev = TR_NIL;
+        heap->root = (heap->root == TR_NIL) ? handle : _meld(heap, heap->root, handle);
+        heap->nodes[heap->root].next = heap->nodes[heap->root].prev = TR_NIL;
+    }
+    heap->size++;
+    return handle;
+}
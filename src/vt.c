@@ -1,12 +1,50 @@
+#define _GNU_SOURCE
 #include <assert.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
 #include "vt.h"
+#include "ep.h"
+
+/* runs shorter than this are extended with insertion sort */
+#define VT_SORT_MINRUN  32
+/* run stack depth, run lengths grow at least like fibonacci numbers */
+#define VT_SORT_MAXRUNS 96
+/* alignment and rounding of huge page backed storage */
+#define VT_HUGEPAGE_SIZE (2 * 1024 * 1024)
+/* smallest chunk worth a thread of its own in vt_sort_parallel */
+#define VT_SORT_PARALLEL_MINCHUNK 65536
+/* radix sort digit width, 11 bits keeps the counts in L1 */
+#define VT_RADIX_BITS    11
+#define VT_RADIX_BUCKETS (1 << VT_RADIX_BITS)
+#define VT_RADIX_PASSES  ((64 + VT_RADIX_BITS - 1) / VT_RADIX_BITS)
+/* below this many elements vt_sort_by_key uses insertion sort */
+#define VT_RADIX_MIN     64
+
+/**
+ * @brief Element with its sort key, what vt_sort_by_key moves around.
+ */
+typedef struct {
+    uint64_t key;
+    vt_Vector_Element elem;
+} KeyedElement;
 
 struct _vector {
     size_t size;
     size_t index;
     size_t capacity;
+    size_t increment;           /* for vt_GROW_FIXED */
+    vt_GrowthPolicy growth;
+    bool use_mremap;            /* back large storage with mmap/mremap */
+    bool use_hugepages;         /* ... and ask for transparent huge pages */
+    bool mapped;                /* list is an anonymous mapping */
+    bool concurrent;            /* lock-free readers, single appender */
+    ep_Domain ep;               /* concurrent mode, reclaims replaced lists */
     #ifdef SYNC
         pthread_mutex_t mutex;
     #endif
@@ -22,42 +60,279 @@ struct _vector {
 static void _destroy_element(vt_Vector_Element *elem, vt_ElemDtor dtor);
 
 /**
- * @brief Double the capacity of the vector.
+ * @brief Grow the capacity of the vector by its growth policy, to at
+ * least needed elements.
  *
- * @param vt  pointer to a pointer to vector.
+ * @param vt      pointer to vector.
+ * @param needed  the capacity required.
+ * @return SUCCESS, or ERROR if the storage could not be resized.
  */ 
-static void _grow_vector(vt_Vector **vt);
+static int _grow_vector(vt_Vector *vt, size_t needed);
+
+/**
+ * @brief Move the vector storage to a buffer of capacity elements.
+ *
+ * Storage of at least vt_MREMAP_BYTES goes to an anonymous mapping when
+ * use_mremap or use_hugepages is set (never in concurrent mode), so regrowing it remaps pages
+ * instead of copying. Mapped storage is rounded up to whole pages (huge
+ * pages with use_hugepages) and the extra room is added to the capacity.
+ * Shrinking huge page storage keeps the mapping and hands the unused
+ * tail back with MADV_DONTNEED.
+ *
+ * @param vt        pointer to vector.
+ * @param capacity  the new capacity, at least the vector size.
+ * @return SUCCESS, or ERROR when the storage could not be allocated.
+ */
+static int _resize_vector(vt_Vector *vt, size_t capacity);
+
+/**
+ * @brief Append in concurrent mode. A full list is copied into a new
+ * buffer that is published before the size, and the old one is retired.
+ *
+ * @param vt     pointer to vector.
+ * @param elems  elements to append.
+ * @param n      the number of elements.
+ * @return SUCCESS, or ERROR if the new buffer could not be allocated.
+ */
+static int _concurrent_append(vt_Vector *vt, const vt_Vector_Element *elems, size_t n);
+
+/**
+ * @brief Release the vector storage.
+ *
+ * @param vt  pointer to vector.
+ */
+static void _free_storage(vt_Vector *vt);
+
+#ifdef __linux__
+/**
+ * @brief Create an anonymous mapping for the vector storage.
+ *
+ * @param bytes      size of the mapping.
+ * @param hugepages  align to VT_HUGEPAGE_SIZE and advise huge pages.
+ * @return the mapping, or MAP_FAILED.
+ */
+static void *_map_storage(size_t bytes, bool hugepages);
+#endif
+
+/**
+ * @brief Shared state of one vt_sort_parallel call.
+ */
+typedef struct {
+    vt_Vector_Element *list;
+    vt_Vector_Element *buffer;
+    size_t n;
+    size_t nthreads;
+    size_t *bounds;             /* chunk i is [bounds[i], bounds[i+1]) */
+    vt_ElemCompare comp;
+    pthread_mutex_t start;      /* held by the caller until the workers are set up */
+    pthread_barrier_t barrier;  /* between phases, nthreads workers */
+} ParallelSort;
+
+/**
+ * @brief Per thread argument of a parallel sort.
+ */
+typedef struct {
+    ParallelSort *ps;
+    size_t id;
+} SortWorker;
+
+/**
+ * @brief Body of one parallel sort worker: sort its chunk, then take
+ * part in every merge round and the final copy, waiting on the barrier
+ * between phases. The same threads run all phases.
+ *
+ * @param arg  pointer to a SortWorker.
+ */
+static void *_sort_worker(void *arg);
 
 /**
- * @brief Recursive sorting function.
+ * @brief Merge phase, produce output range id of one round.
+ *
+ * Each round merges neighbouring groups of width chunks from src into
+ * dst. The output is cut into nthreads equal ranges so every thread
+ * gets the same amount of work however the groups fall.
+ *
+ * @param ps     pointer to the parallel sort state.
+ * @param id     worker id.
+ * @param src    merge input of the round.
+ * @param dst    merge output of the round.
+ * @param width  chunks per merge input in this round.
+ */
+static void _merge_chunk(const ParallelSort *ps, size_t id, const vt_Vector_Element *src,
+                         vt_Vector_Element *dst, size_t width);
+
+/**
+ * @brief Find how many of the first k merged elements come from a.
+ *
+ * @param a     pointer to the first sorted run.
+ * @param na    length of a.
+ * @param b     pointer to the second sorted run.
+ * @param nb    length of b.
+ * @param k     number of merged elements.
+ * @param comp  pointer to compare function.
+ * @return the number of elements taken from a (ties go to a).
+ */
+static size_t _corank(const vt_Vector_Element *a, size_t na,
+                      const vt_Vector_Element *b, size_t nb,
+                      size_t k, vt_ElemCompare comp);
+
+/**
+ * @brief Stable natural merge sort.
+ *
+ * Ascending runs are kept, strictly descending runs are reversed and
+ * short runs are extended to VT_SORT_MINRUN with insertion sort. Runs
+ * are merged as they are found, through one scratch buffer of n/2
+ * elements.
  *
  * @param list  pointer to list elements.
- * @param low   the index to the beginning of the array.
- * @param high  the index to the end of the array.
+ * @param n     the number of elements.
  * @param comp  pointer to compare function.
- */ 
-static void _sort(vt_Vector_Element *list, size_t low, size_t high,
-                  vt_ElemCompare comp);
+ */
+static void _sort(vt_Vector_Element *list, size_t n, vt_ElemCompare comp);
 
 /**
- * @brief Merge two vectors.
+ * @brief Find the run starting at low and make it ascending.
  *
- * @param list  pointer to pointer of list elements.
- * @param low   the index to the beginning of the array.
- * @param mid   the index to the middle of the array.
- * @param high  the index to the end of the array.
+ * @param list  pointer to list elements.
+ * @param low   the index to the beginning of the run.
+ * @param high  the index past the end of the array.
  * @param comp  pointer to compare function.
+ * @return the index past the end of the run.
+ */
+static size_t _find_run(vt_Vector_Element *list, size_t low, size_t high,
+                        vt_ElemCompare comp);
+
+/**
+ * @brief Binary insertion sort list[low, high), list[low, sorted) is already sorted.
+ *
+ * @param list    pointer to list elements.
+ * @param low     the index to the beginning of the array.
+ * @param sorted  the index past the sorted prefix.
+ * @param high    the index past the end of the array.
+ * @param comp    pointer to compare function.
+ */
+static void _insertion_sort(vt_Vector_Element *list, size_t low, size_t sorted,
+                            size_t high, vt_ElemCompare comp);
+
+/**
+ * @brief Merge the sorted runs list[low, mid) and list[mid, high).
+ *
+ * @param list     pointer to list elements.
+ * @param low      the index to the beginning of the first run.
+ * @param mid      the index to the beginning of the second run.
+ * @param high     the index past the end of the second run.
+ * @param scratch  buffer of at least min(mid-low, high-mid) elements.
+ * @param comp     pointer to compare function.
  */ 
-static void _merge(vt_Vector_Element **list, size_t low, size_t mid,
-                   size_t high, vt_ElemCompare comp);
+static void _merge(vt_Vector_Element *list, size_t low, size_t mid,
+                   size_t high, vt_Vector_Element *scratch, vt_ElemCompare comp);
+
+/**
+ * @brief Stable LSD radix sort by key, one pass per VT_RADIX_BITS digit
+ * that differs between keys, ping-ponging between two buffers.
+ *
+ * @param list  pointer to list elements.
+ * @param n     the number of elements.
+ * @param key   pointer to key function.
+ */
+static void _radix_sort(vt_Vector_Element *list, size_t n, vt_ElemKey key);
+
+/**
+ * @brief Stable insertion sort of keyed elements, for short lists.
+ *
+ * @param list  pointer to keyed elements.
+ * @param n     the number of elements.
+ */
+static void _keyed_insertion_sort(KeyedElement *list, size_t n);
+
+/**
+ * @brief Search over a sorted list, returns a position in [0, n].
+ */
+typedef size_t (*BoundSearch)(const vt_Vector_Element *list, size_t n,
+                              const vt_Vector_Element key, vt_ElemCompare comp);
+
+/**
+ * @brief Run a bound search on the vector under its lock, or inside an
+ * epoch in concurrent mode.
+ *
+ * @param vt      pointer to vector.
+ * @param key     the element to look for.
+ * @param comp    pointer to compare function.
+ * @param search  the bound search to run.
+ * @param found   if not NULL, set to whether the element at the result
+ *                position is equal to key.
+ * @return the position returned by search.
+ */
+static size_t _search(vt_Vector *vt, const vt_Vector_Element key, vt_ElemCompare comp,
+                      BoundSearch search, bool *found);
+
+/**
+ * @brief First position in list whose element is not less than key.
+ *
+ * @param list  pointer to list elements, sorted by comp.
+ * @param n     the number of elements.
+ * @param key   the element to look for.
+ * @param comp  pointer to compare function.
+ * @return the position, n if there is none.
+ */
+static size_t _lower_bound(const vt_Vector_Element *list, size_t n,
+                           const vt_Vector_Element key, vt_ElemCompare comp);
+
+/**
+ * @brief First position in list whose element is greater than key.
+ *
+ * @param list  pointer to list elements, sorted by comp.
+ * @param n     the number of elements.
+ * @param key   the element to look for.
+ * @param comp  pointer to compare function.
+ * @return the position, n if there is none.
+ */
+static size_t _upper_bound(const vt_Vector_Element *list, size_t n,
+                           const vt_Vector_Element key, vt_ElemCompare comp);
+
+/**
+ * @brief _lower_bound with a conditional move instead of a branch and
+ * prefetching of the next probe.
+ *
+ * @param list  pointer to list elements, sorted by comp.
+ * @param n     the number of elements.
+ * @param key   the element to look for.
+ * @param comp  pointer to compare function.
+ * @return the position, n if there is none.
+ */
+static size_t _lower_bound_branchless(const vt_Vector_Element *list, size_t n,
+                                      const vt_Vector_Element key, vt_ElemCompare comp);
+
+#ifdef SYNC
+/**
+ * @brief Lock up to three vectors in address order, each one once.
+ */
+static void _lock_vectors(vt_Vector *a, vt_Vector *b, vt_Vector *c);
+
+/**
+ * @brief Unlock vectors locked by _lock_vectors.
+ */
+static void _unlock_vectors(vt_Vector *a, vt_Vector *b, vt_Vector *c);
+#endif
 
 vt_Vector *vt_init(void)
+{
+    return vt_init_with_capacity(vt_INITIAL_VECTOR_CAPACITY);
+}
+
+vt_Vector *vt_init_with_capacity(size_t capacity)
 {
     vt_Vector *vt = (vt_Vector*)calloc(1, sizeof *vt);
     assert(vt);
     vt->size = 0;
     vt->index = 0;
-    vt->capacity = vt_INITIAL_VECTOR_CAPACITY;
+    vt->capacity = (capacity > 0) ? capacity : 1;
+    vt->increment = vt_INITIAL_VECTOR_CAPACITY;
+    vt->growth = vt_GROW_DOUBLE;
+    vt->use_mremap = false;
+    vt->use_hugepages = false;
+    vt->mapped = false;
+    vt->concurrent = false;
     #ifdef SYNC
         if (pthread_mutex_init(&vt->mutex, NULL) != 0) {
             int errnum = errno;
@@ -65,16 +340,24 @@ vt_Vector *vt_init(void)
                 fprintf(stderr, "%s() error: unable to initialize mutex. errorcode: %d\n",
                         FUNC, errnum);
             #endif
+            (void)errnum;
             free(vt);
             return NULL;
         }
     #endif
-    vt->list = (vt_Vector_Element*)calloc(vt_INITIAL_VECTOR_CAPACITY,
-                sizeof *vt->list);
+    vt->list = (vt_Vector_Element*)calloc(vt->capacity, sizeof *vt->list);
     assert(vt->list);
     return vt;
 }
 
+vt_Vector *vt_init_concurrent(size_t capacity)
+{
+    vt_Vector *vt = vt_init_with_capacity(capacity);
+    if (vt)
+        vt->concurrent = true;
+    return vt;
+}
+
 void vt_destroy(vt_Vector *vt, vt_ElemDtor dtor)
 {
     assert(vt);
@@ -89,234 +372,1353 @@ void vt_destroy(vt_Vector *vt, vt_ElemDtor dtor)
                 fprintf(stderr, "%s() error: unable to destroy mutex. errorcode: %d\n",
                         FUNC, errnum);
             #endif
+            (void)errnum;
         }
     #endif
+    ep_destroy(&vt->ep);
+    _free_storage(vt);
     free(vt);
 }
 
-void vt_add(vt_Vector *vt, const vt_Vector_Element elem)
+void vt_set_growth(vt_Vector *vt, vt_GrowthPolicy growth, size_t increment)
 {
     assert(vt);
     #ifdef SYNC
-        ll_LOCK(&ll->mutex);
+        ll_LOCK(&vt->mutex);
     #endif
-
-    if (vt->size == vt->capacity)
-        _grow_vector(&vt);
-
-    vt->list[vt->index++] = CONST_CAST(vt_Vector_Element, elem);
-    vt->size++;
-
+    vt->growth = growth;
+    vt->increment = (increment > 0) ? increment : 1;
     #ifdef SYNC
-        ll_UNLOCK(&ll->mutex);
+        ll_UNLOCK(&vt->mutex);
     #endif
 }
 
-void vt_add_at(vt_Vector *vt, const vt_Vector_Element elem, size_t pos)
+int vt_set_mremap(vt_Vector *vt, bool enable)
 {
     assert(vt);
-    #ifdef SYNC
-        ll_LOCK(&ll->mutex);
-    #endif
 
-    if (pos <= vt->size) {
-        if (vt->size == vt->capacity)
-            _grow_vector(&vt);
-    
-        vt->list[pos] = CONST_CAST(vt_Vector_Element, elem);
-        vt->size++;
-    } else {
+    /* retired lists are freed, mapped storage would need munmap */
+    if (vt->concurrent) {
         #ifdef ALGOS_DEBUG
-            fprintf(stderr, "%s() error: pos is out-of-bounds\n", FUNC);
+            fprintf(stderr, "%s() error: vector is in concurrent mode\n", FUNC);
         #endif
+        return ERROR;
     }
 
     #ifdef SYNC
-        ll_UNLOCK(&ll->mutex);
+        ll_LOCK(&vt->mutex);
+    #endif
+    vt->use_mremap = enable;
+    #ifdef SYNC
+        ll_UNLOCK(&vt->mutex);
     #endif
+    return SUCCESS;
 }
 
-const vt_Vector_Element vt_get(vt_Vector *vt)
+int vt_set_hugepages(vt_Vector *vt, bool enable)
 {
     assert(vt);
 
-    if (vt_isempty(vt)) {
+    /* retired lists are freed, mapped storage would need munmap */
+    if (vt->concurrent) {
         #ifdef ALGOS_DEBUG
-            fprintf(stderr, "%s() error: vector is empty\n", FUNC);
+            fprintf(stderr, "%s() error: vector is in concurrent mode\n", FUNC);
         #endif
-        return NULL;
+        return ERROR;
     }
 
     #ifdef SYNC
-        ll_LOCK(&ll->mutex);
+        ll_LOCK(&vt->mutex);
     #endif
-    const vt_Vector_Element elem = vt->list[vt->index-1];
+    vt->use_hugepages = enable;
     #ifdef SYNC
-        ll_UNLOCK(&ll->mutex);
+        ll_UNLOCK(&vt->mutex);
     #endif
-    return elem;
+    return SUCCESS;
 }
 
-const vt_Vector_Element vt_get_at(vt_Vector *vt, size_t pos)
+int vt_reserve(vt_Vector *vt, size_t capacity)
 {
-    vt_Vector_Element elem = NULL;
-    assert(vt);
+    int ret = SUCCESS;
 
+    assert(vt);
     #ifdef SYNC
-        ll_LOCK(&ll->mutex);
+        ll_LOCK(&vt->mutex);
     #endif
 
-    if (pos >= 0 && pos < vt->size) {
-        elem = vt->list[pos];
-    } else {
-        #ifdef ALGOS_DEBUG
-            fprintf(stderr, "%s() error: pos is out-of-bounds\n", FUNC);
-        #endif
-    }
+    if (capacity > vt->capacity)
+        ret = _resize_vector(vt, capacity);
 
     #ifdef SYNC
-        ll_UNLOCK(&ll->mutex);
+        ll_UNLOCK(&vt->mutex);
     #endif
-    return elem;
+    return ret;
 }
 
-void vt_remove(vt_Vector *vt, vt_ElemDtor dtor)
+int vt_shrink_to_fit(vt_Vector *vt)
 {
+    int ret = SUCCESS;
+
     assert(vt);
     #ifdef SYNC
-        ll_LOCK(&ll->mutex);
+        ll_LOCK(&vt->mutex);
     #endif
 
-    if (dtor) {
-        dtor(vt->list[vt->index-1]);
-    } else {
-        free(vt->list[vt->index-1]);
-        vt->list[vt->index-1] = NULL;
-    }
+    if (vt->size < vt->capacity)
+        ret = _resize_vector(vt, vt->size);
 
     #ifdef SYNC
-        ll_UNLOCK(&ll->mutex);
+        ll_UNLOCK(&vt->mutex);
     #endif
+    return ret;
 }
 
-void vt_remote_at(vt_Vector *vt, size_t pos, vt_ElemDtor dtor)
+size_t vt_getcapacity(vt_Vector *vt)
 {
     assert(vt);
     #ifdef SYNC
-        ll_LOCK(&ll->mutex);
+        ll_LOCK(&vt->mutex);
     #endif
-
-    if (pos >= 0 && pos < vt->size) {
-        if (dtor) {
-            dtor(vt->list[pos]);
-        } else {
-            free(vt->list[pos]);
-            vt->list[pos] = NULL;
-        }
-    }
-
+    size_t capacity = vt->capacity;
     #ifdef SYNC
-        ll_UNLOCK(&ll->mutex);
+        ll_UNLOCK(&vt->mutex);
     #endif
+    return capacity;
 }
 
-void vt_sort(vt_Vector *vt, vt_ElemCompare comp)
+int vt_add(vt_Vector *vt, const vt_Vector_Element elem)
 {
     assert(vt);
-    assert(comp);
+
+    if (vt->concurrent) {
+        if (_concurrent_append(vt, &elem, 1) != SUCCESS) {
+            #ifdef ALGOS_DEBUG
+                fprintf(stderr, "%s() error: unable to grow the vector\n", FUNC);
+            #endif
+            return ERROR;
+        }
+        return SUCCESS;
+    }
+
     #ifdef SYNC
-        ll_LOCK(&ll->mutex);
+        ll_LOCK(&vt->mutex);
     #endif
-    _sort(vt->list, 0, vt->size, comp);
+
+    if (_grow_vector(vt, vt->size + 1) != SUCCESS) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: unable to grow the vector\n", FUNC);
+        #endif
+        #ifdef SYNC
+            ll_UNLOCK(&vt->mutex);
+        #endif
+        return ERROR;
+    }
+
+    vt->list[vt->index++] = CONST_CAST(vt_Vector_Element, elem);
+    vt->size++;
+
     #ifdef SYNC
-        ll_UNLOCK(&ll->mutex);
+        ll_UNLOCK(&vt->mutex);
     #endif
+    return SUCCESS;
 }
 
-void vt_print(vt_Vector *vt, vt_ElemPrint print)
+int vt_add_at(vt_Vector *vt, const vt_Vector_Element elem, size_t pos)
 {
+    int ret = SUCCESS;
+
     assert(vt);
-    assert(print);
     #ifdef SYNC
-        ll_LOCK(&ll->mutex);
+        ll_LOCK(&vt->mutex);
     #endif
-    for (size_t i = 0; i < vt->size; ++i) {
-        print(vt->list[i]);
+
+    if (pos > vt->size) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: pos is out-of-bounds\n", FUNC);
+        #endif
+        ret = ERROR;
+    } else if (_grow_vector(vt, vt->size + 1) != SUCCESS) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: unable to grow the vector\n", FUNC);
+        #endif
+        ret = ERROR;
+    } else {
+        memmove(vt->list + pos + 1, vt->list + pos, (vt->size - pos) * sizeof *vt->list);
+        vt->list[pos] = CONST_CAST(vt_Vector_Element, elem);
+        vt->size++;
+        vt->index++;
     }
+
     #ifdef SYNC
-        ll_UNLOCK(&ll->mutex);
+        ll_UNLOCK(&vt->mutex);
     #endif
+    return ret;
 }
 
-size_t vt_getsize(vt_Vector *vt)
+const vt_Vector_Element vt_get(vt_Vector *vt)
 {
+    vt_Vector_Element elem = NULL;
     assert(vt);
+
+    if (vt->concurrent) {
+        unsigned long epoch = ep_enter(&vt->ep);
+        size_t size = __atomic_load_n(&vt->size, __ATOMIC_ACQUIRE);
+        if (size > 0)
+            elem = __atomic_load_n(&vt->list, __ATOMIC_ACQUIRE)[size-1];
+        ep_exit(&vt->ep, epoch);
+        return elem;
+    }
+
     #ifdef SYNC
-        ll_LOCK(&ll->mutex);
+        ll_LOCK(&vt->mutex);
     #endif
-    size_t size = vt->size;
+    if (vt->size > 0) {
+        elem = vt->list[vt->index-1];
+    } else {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: vector is empty\n", FUNC);
+        #endif
+    }
     #ifdef SYNC
-        ll_UNLOCK(&ll->mutex);
+        ll_UNLOCK(&vt->mutex);
     #endif
-    return size;
+    return elem;
 }
 
-bool vt_isempty(vt_Vector *vt)
+const vt_Vector_Element vt_get_at(vt_Vector *vt, size_t pos)
 {
+    vt_Vector_Element elem = NULL;
     assert(vt);
+
+    if (vt->concurrent) {
+        /* size before list: any list published after the size holds it */
+        unsigned long epoch = ep_enter(&vt->ep);
+        if (pos < __atomic_load_n(&vt->size, __ATOMIC_ACQUIRE))
+            elem = __atomic_load_n(&vt->list, __ATOMIC_ACQUIRE)[pos];
+        ep_exit(&vt->ep, epoch);
+        return elem;
+    }
+
     #ifdef SYNC
-        ll_LOCK(&ll->mutex);
+        ll_LOCK(&vt->mutex);
     #endif
-    bool empty = (vt->size == 0) ? true : false;
+
+    if (pos < vt->size) {
+        elem = vt->list[pos];
+    } else {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: pos is out-of-bounds\n", FUNC);
+        #endif
+    }
+
     #ifdef SYNC
-        ll_UNLOCK(&ll->mutex);
+        ll_UNLOCK(&vt->mutex);
     #endif
-    return empty;
+    return elem;
 }
 
-static void _destroy_element(vt_Vector_Element *elem, vt_ElemDtor dtor)
+int vt_snapshot_begin(vt_Vector *vt, vt_Snapshot *snap)
 {
-    if (dtor)
-        dtor(elem);
-    else
-        free(elem);
+    assert(vt);
+    assert(snap);
+
+    if (!vt->concurrent) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: vector is not in concurrent mode\n", FUNC);
+        #endif
+        return ERROR;
+    }
+
+    snap->vt = vt;
+    snap->epoch = ep_enter(&vt->ep);
+    snap->size = __atomic_load_n(&vt->size, __ATOMIC_ACQUIRE);
+    snap->list = __atomic_load_n(&vt->list, __ATOMIC_ACQUIRE);
+    return SUCCESS;
 }
 
-static void _grow_vector(vt_Vector **vt)
+void vt_snapshot_end(vt_Snapshot *snap)
 {
-    (*vt)->list = realloc((*vt)->list, (*vt)->capacity*2 * sizeof *((*vt)->list));
-    assert((*vt)->list);
-    (*vt)->capacity *= 2;
+    assert(snap);
+    assert(snap->vt);
+    ep_exit(&snap->vt->ep, snap->epoch);
+    snap->vt = NULL;
+    snap->list = NULL;
+    snap->size = 0;
 }
 
-static void _sort(vt_Vector_Element *list, size_t low, size_t high,
-                  vt_ElemCompare comp)
+void vt_remove(vt_Vector *vt, vt_ElemDtor dtor)
 {
-    if (low < high) {
-        size_t mid = (high - low) / 2;
-        _sort(list, low, mid+1, comp);
-        _sort(list, mid+1, high, comp);
-        _merge(&list, low, mid+1, high, comp);
+    assert(vt);
+    #ifdef SYNC
+        ll_LOCK(&vt->mutex);
+    #endif
+
+    if (vt->size > 0) {
+        _destroy_element(vt->list[vt->index-1], dtor);
+        vt->list[vt->index-1] = NULL;
+        vt->index--;
+        vt->size--;
+    } else {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: vector is empty\n", FUNC);
+        #endif
     }
+
+    #ifdef SYNC
+        ll_UNLOCK(&vt->mutex);
+    #endif
 }
 
-static void _merge(vt_Vector_Element **list, size_t low, size_t mid,
-                   size_t high, vt_ElemCompare comp)
+void vt_remove_at(vt_Vector *vt, size_t pos, vt_ElemDtor dtor)
 {
-    size_t i, j, k;
-    vt_Vector_Element *l1 = (*list)[low];
-    vt_Vector_Element *l2 = (*list)[mid];
+    assert(vt);
+    #ifdef SYNC
+        ll_LOCK(&vt->mutex);
+    #endif
 
-    for (i = 0, j = 0, k = 0; i < mid && j < high; ++k) {
-        if (comp(l1[i], l2[j]) < 1)
-            (*list)[k] = l1[i++];
-        else
-            (*list)[k] = l2[j++];
+    if (pos < vt->size) {
+        _destroy_element(vt->list[pos], dtor);
+        memmove(vt->list + pos, vt->list + pos + 1, (vt->size - pos - 1) * sizeof *vt->list);
+        vt->index--;
+        vt->size--;
+        vt->list[vt->size] = NULL;
+    } else {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: pos is out-of-bounds\n", FUNC);
+        #endif
+    }
+
+    #ifdef SYNC
+        ll_UNLOCK(&vt->mutex);
+    #endif
+}
+
+int vt_add_range(vt_Vector *vt, const vt_Vector_Element *elems, size_t n)
+{
+    assert(vt);
+    assert(elems || n == 0);
+
+    if (vt->concurrent) {
+        if (_concurrent_append(vt, elems, n) != SUCCESS) {
+            #ifdef ALGOS_DEBUG
+                fprintf(stderr, "%s() error: unable to grow the vector\n", FUNC);
+            #endif
+            return ERROR;
+        }
+        return SUCCESS;
+    }
+
+    #ifdef SYNC
+        ll_LOCK(&vt->mutex);
+    #endif
+
+    if (_grow_vector(vt, vt->size + n) != SUCCESS) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: unable to grow the vector\n", FUNC);
+        #endif
+        #ifdef SYNC
+            ll_UNLOCK(&vt->mutex);
+        #endif
+        return ERROR;
     }
+    memcpy(vt->list + vt->size, elems, n * sizeof *vt->list);
+    vt->size += n;
+    vt->index += n;
+
+    #ifdef SYNC
+        ll_UNLOCK(&vt->mutex);
+    #endif
+    return SUCCESS;
+}
 
-    while (i < mid)
-        (*list)[k++] = l1[i++];
+int vt_insert_range(vt_Vector *vt, size_t pos, const vt_Vector_Element *elems, size_t n)
+{
+    assert(vt);
+    assert(elems || n == 0);
+    #ifdef SYNC
+        ll_LOCK(&vt->mutex);
+    #endif
+
+    if (pos > vt->size) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: pos is out-of-bounds\n", FUNC);
+        #endif
+        #ifdef SYNC
+            ll_UNLOCK(&vt->mutex);
+        #endif
+        return ERROR;
+    }
+
+    if (_grow_vector(vt, vt->size + n) != SUCCESS) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: unable to grow the vector\n", FUNC);
+        #endif
+        #ifdef SYNC
+            ll_UNLOCK(&vt->mutex);
+        #endif
+        return ERROR;
+    }
+    memmove(vt->list + pos + n, vt->list + pos, (vt->size - pos) * sizeof *vt->list);
+    memcpy(vt->list + pos, elems, n * sizeof *vt->list);
+    vt->size += n;
+    vt->index += n;
+
+    #ifdef SYNC
+        ll_UNLOCK(&vt->mutex);
+    #endif
+    return SUCCESS;
+}
+
+int vt_remove_range(vt_Vector *vt, size_t pos, size_t n, vt_ElemDtor dtor)
+{
+    size_t i;
+
+    assert(vt);
+    #ifdef SYNC
+        ll_LOCK(&vt->mutex);
+    #endif
+
+    if (pos > vt->size || n > vt->size - pos) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: range is out-of-bounds\n", FUNC);
+        #endif
+        #ifdef SYNC
+            ll_UNLOCK(&vt->mutex);
+        #endif
+        return ERROR;
+    }
+
+    for (i = pos; i < pos + n; ++i)
+        _destroy_element(vt->list[i], dtor);
+    memmove(vt->list + pos, vt->list + pos + n, (vt->size - pos - n) * sizeof *vt->list);
+    vt->size -= n;
+    vt->index -= n;
+
+    #ifdef SYNC
+        ll_UNLOCK(&vt->mutex);
+    #endif
+    return SUCCESS;
+}
+
+int vt_copy_out(vt_Vector *vt, size_t pos, size_t n, vt_Vector_Element *buf)
+{
+    assert(vt);
+    assert(buf || n == 0);
+    #ifdef SYNC
+        ll_LOCK(&vt->mutex);
+    #endif
+
+    if (pos > vt->size || n > vt->size - pos) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: range is out-of-bounds\n", FUNC);
+        #endif
+        #ifdef SYNC
+            ll_UNLOCK(&vt->mutex);
+        #endif
+        return ERROR;
+    }
+
+    memcpy(buf, vt->list + pos, n * sizeof *buf);
+
+    #ifdef SYNC
+        ll_UNLOCK(&vt->mutex);
+    #endif
+    return SUCCESS;
+}
+
+void vt_sort(vt_Vector *vt, vt_ElemCompare comp)
+{
+    assert(vt);
+    assert(comp);
+    #ifdef SYNC
+        ll_LOCK(&vt->mutex);
+    #endif
+    _sort(vt->list, vt->size, comp);
+    #ifdef SYNC
+        ll_UNLOCK(&vt->mutex);
+    #endif
+}
+
+void vt_sort_by_key(vt_Vector *vt, vt_ElemKey key)
+{
+    assert(vt);
+    assert(key);
+    #ifdef SYNC
+        ll_LOCK(&vt->mutex);
+    #endif
+    _radix_sort(vt->list, vt->size, key);
+    #ifdef SYNC
+        ll_UNLOCK(&vt->mutex);
+    #endif
+}
+
+void vt_sort_parallel(vt_Vector *vt, vt_ElemCompare comp, size_t nthreads)
+{
+    ParallelSort ps;
+    SortWorker *workers = NULL;
+    pthread_t *threads = NULL;
+    size_t started, i;
+    int errnum;
+
+    assert(vt);
+    assert(comp);
+
+    if (nthreads == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        nthreads = (online > 0) ? (size_t)online : 1;
+    }
+
+    #ifdef SYNC
+        ll_LOCK(&vt->mutex);
+    #endif
+
+    /* keep chunks large enough to pay for the threads */
+    if (nthreads > vt->size / VT_SORT_PARALLEL_MINCHUNK)
+        nthreads = vt->size / VT_SORT_PARALLEL_MINCHUNK;
+
+    if (nthreads < 2) {
+        _sort(vt->list, vt->size, comp);
+        #ifdef SYNC
+            ll_UNLOCK(&vt->mutex);
+        #endif
+        return;
+    }
+
+    ps.list = vt->list;
+    ps.n = vt->size;
+    ps.comp = comp;
+    ps.buffer = (vt_Vector_Element*)malloc(ps.n * sizeof *ps.buffer);
+    assert(ps.buffer);
+    ps.bounds = (size_t*)malloc((nthreads + 1) * sizeof *ps.bounds);
+    assert(ps.bounds);
+    workers = (SortWorker*)malloc(nthreads * sizeof *workers);
+    assert(workers);
+    threads = (pthread_t*)malloc(nthreads * sizeof *threads);
+    assert(threads);
+
+    /* start the threads once, they run every phase. the work is cut by
+     * the number that actually started */
+    if ((errnum = pthread_mutex_init(&ps.start, NULL)) != 0) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: unable to initialize mutex. errorcode: %d\n",
+                    FUNC, errnum);
+        #endif
+        (void)errnum;
+        free(threads);
+        free(workers);
+        free(ps.bounds);
+        free(ps.buffer);
+        _sort(vt->list, vt->size, comp);
+        #ifdef SYNC
+            ll_UNLOCK(&vt->mutex);
+        #endif
+        return;
+    }
+    pthread_mutex_lock(&ps.start);
+    for (started = 1; started < nthreads; ++started) {
+        workers[started].ps = &ps;
+        workers[started].id = started;
+        if (pthread_create(&threads[started], NULL, _sort_worker, &workers[started]) != 0)
+            break;
+    }
+    ps.nthreads = started;
+    for (i = 0; i <= started; ++i)
+        ps.bounds[i] = ps.n * i / started;
+    if ((errnum = pthread_barrier_init(&ps.barrier, NULL, (unsigned)started)) != 0) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: unable to initialize barrier. errorcode: %d\n",
+                    FUNC, errnum);
+        #endif
+        (void)errnum;
+        /* the started threads return as soon as they see this */
+        ps.nthreads = 0;
+    }
+    pthread_mutex_unlock(&ps.start);
+
+    if (ps.nthreads > 0) {
+        workers[0].ps = &ps;
+        workers[0].id = 0;
+        _sort_worker(&workers[0]);
+    }
+    for (i = 1; i < started; ++i)
+        pthread_join(threads[i], NULL);
+
+    if (ps.nthreads > 0)
+        pthread_barrier_destroy(&ps.barrier);
+    else
+        _sort(vt->list, vt->size, comp);
+    pthread_mutex_destroy(&ps.start);
+    free(threads);
+    free(workers);
+    free(ps.bounds);
+    free(ps.buffer);
+
+    #ifdef SYNC
+        ll_UNLOCK(&vt->mutex);
+    #endif
+}
+
+int vt_bsearch(vt_Vector *vt, const vt_Vector_Element key, vt_ElemCompare comp,
+               size_t *pos)
+{
+    bool found = false;
+
+    assert(vt);
+    assert(comp);
+    assert(pos);
+    *pos = _search(vt, key, comp, _lower_bound, &found);
+    return found ? SUCCESS : NOTFOUND;
+}
+
+size_t vt_lower_bound(vt_Vector *vt, const vt_Vector_Element key, vt_ElemCompare comp)
+{
+    assert(vt);
+    assert(comp);
+    return _search(vt, key, comp, _lower_bound, NULL);
+}
+
+size_t vt_upper_bound(vt_Vector *vt, const vt_Vector_Element key, vt_ElemCompare comp)
+{
+    assert(vt);
+    assert(comp);
+    return _search(vt, key, comp, _upper_bound, NULL);
+}
+
+size_t vt_lower_bound_branchless(vt_Vector *vt, const vt_Vector_Element key,
+                                 vt_ElemCompare comp)
+{
+    assert(vt);
+    assert(comp);
+    return _search(vt, key, comp, _lower_bound_branchless, NULL);
+}
+
+size_t vt_insert_sorted(vt_Vector *vt, const vt_Vector_Element elem, vt_ElemCompare comp)
+{
+    size_t pos;
+
+    assert(vt);
+    assert(comp);
+    #ifdef SYNC
+        ll_LOCK(&vt->mutex);
+    #endif
+
+    if (_grow_vector(vt, vt->size + 1) != SUCCESS) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: unable to grow the vector\n", FUNC);
+        #endif
+        #ifdef SYNC
+            ll_UNLOCK(&vt->mutex);
+        #endif
+        return (size_t)ERROR;
+    }
+    pos = _upper_bound(vt->list, vt->size, elem, comp);
+    memmove(vt->list + pos + 1, vt->list + pos, (vt->size - pos) * sizeof *vt->list);
+    vt->list[pos] = CONST_CAST(vt_Vector_Element, elem);
+    vt->size++;
+    vt->index++;
+
+    #ifdef SYNC
+        ll_UNLOCK(&vt->mutex);
+    #endif
+    return pos;
+}
+
+int vt_merge_sorted(vt_Vector *dst, vt_Vector *a, vt_Vector *b, vt_ElemCompare comp)
+{
+    vt_Vector_Element *out = NULL;
+    size_t i = 0;
+    size_t j = 0;
+
+    assert(dst);
+    assert(a);
+    assert(b);
+    assert(comp);
+
+    if (dst == a || dst == b) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: dst overlaps a source vector\n", FUNC);
+        #endif
+        return ERROR;
+    }
+
+    #ifdef SYNC
+        _lock_vectors(dst, a, b);
+    #endif
+
+    if (_grow_vector(dst, dst->size + a->size + b->size) != SUCCESS) {
+        #ifdef ALGOS_DEBUG
+            fprintf(stderr, "%s() error: unable to grow the vector\n", FUNC);
+        #endif
+        #ifdef SYNC
+            _unlock_vectors(dst, a, b);
+        #endif
+        return ERROR;
+    }
+    out = dst->list + dst->size;
+
+    /* nothing to interleave when b starts after a ends */
+    if (a->size > 0 && b->size > 0 && comp(b->list[0], a->list[a->size-1]) < 0) {
+        while (i < a->size && j < b->size) {
+            if (comp(b->list[j], a->list[i]) < 0)
+                *out++ = b->list[j++];
+            else
+                *out++ = a->list[i++];
+        }
+    }
+    memcpy(out, a->list + i, (a->size - i) * sizeof *out);
+    out += a->size - i;
+    memcpy(out, b->list + j, (b->size - j) * sizeof *out);
+    dst->size += a->size + b->size;
+    dst->index += a->size + b->size;
+
+    #ifdef SYNC
+        _unlock_vectors(dst, a, b);
+    #endif
+    return SUCCESS;
+}
+
+void vt_print(vt_Vector *vt, vt_ElemPrint print)
+{
+    assert(vt);
+    assert(print);
+    #ifdef SYNC
+        ll_LOCK(&vt->mutex);
+    #endif
+    for (size_t i = 0; i < vt->size; ++i) {
+        print(vt->list[i]);
+    }
+    #ifdef SYNC
+        ll_UNLOCK(&vt->mutex);
+    #endif
+}
+
+size_t vt_getsize(vt_Vector *vt)
+{
+    assert(vt);
+    if (vt->concurrent)
+        return __atomic_load_n(&vt->size, __ATOMIC_ACQUIRE);
+    #ifdef SYNC
+        ll_LOCK(&vt->mutex);
+    #endif
+    size_t size = vt->size;
+    #ifdef SYNC
+        ll_UNLOCK(&vt->mutex);
+    #endif
+    return size;
+}
+
+bool vt_isempty(vt_Vector *vt)
+{
+    return vt_getsize(vt) == 0;
+}
+
+static void _destroy_element(vt_Vector_Element *elem, vt_ElemDtor dtor)
+{
+    if (dtor)
+        dtor(elem);
+    else
+        free(elem);
+}
+
+static int _grow_vector(vt_Vector *vt, size_t needed)
+{
+    size_t capacity = vt->capacity;
+
+    if (needed <= capacity)
+        return SUCCESS;
+
+    switch (vt->growth) {
+        case vt_GROW_HALF:
+            capacity += capacity / 2 + 1;
+            break;
+        case vt_GROW_FIXED:
+            capacity += vt->increment;
+            break;
+        case vt_GROW_DOUBLE:
+        default:
+            capacity *= 2;
+            break;
+    }
+    if (capacity < needed)
+        capacity = needed;
+    return _resize_vector(vt, capacity);
+}
+
+static int _resize_vector(vt_Vector *vt, size_t capacity)
+{
+    size_t bytes = 0;
+    vt_Vector_Element *list = NULL;
+
+    if (capacity < vt->size)
+        capacity = vt->size;
+    if (capacity == 0)
+        capacity = 1;
+    bytes = capacity * sizeof *vt->list;
+
+    #ifdef __linux__
+    if ((vt->use_mremap || vt->use_hugepages) && !vt->concurrent && bytes >= vt_MREMAP_BYTES) {
+        size_t page = vt->use_hugepages ? VT_HUGEPAGE_SIZE : (size_t)sysconf(_SC_PAGESIZE);
+        size_t mapbytes = (bytes + page - 1) & ~(page - 1);
+        size_t oldbytes = vt->capacity * sizeof *vt->list;
+        void *addr = NULL;
+
+        if (vt->mapped && vt->use_hugepages && mapbytes < oldbytes) {
+            /* keep the (aligned) mapping, drop the pages past the new end */
+            size_t keep = (bytes + (size_t)sysconf(_SC_PAGESIZE) - 1) &
+                          ~((size_t)sysconf(_SC_PAGESIZE) - 1);
+            if (keep < oldbytes)
+                madvise((char*)vt->list + keep, oldbytes - keep, MADV_DONTNEED);
+            return SUCCESS;
+        }
+
+        if (vt->mapped) {
+            /* grow in place first so huge page alignment survives */
+            addr = mremap(vt->list, oldbytes, mapbytes, 0);
+            if (addr == MAP_FAILED)
+                addr = mremap(vt->list, oldbytes, mapbytes, MREMAP_MAYMOVE);
+            if (addr == MAP_FAILED)
+                return ERROR;
+            #ifdef MADV_HUGEPAGE
+            if (vt->use_hugepages)
+                madvise(addr, mapbytes, MADV_HUGEPAGE);
+            #endif
+        } else {
+            addr = _map_storage(mapbytes, vt->use_hugepages);
+            if (addr == MAP_FAILED)
+                return ERROR;
+            memcpy(addr, vt->list, vt->size * sizeof *vt->list);
+            free(vt->list);
+            vt->mapped = true;
+        }
+        vt->list = (vt_Vector_Element*)addr;
+        vt->capacity = mapbytes / sizeof *vt->list;
+        return SUCCESS;
+    }
+
+    if (vt->mapped) {
+        /* back under the threshold (or mremap turned off), return to the heap */
+        list = (vt_Vector_Element*)malloc(bytes);
+        if (list == NULL)
+            return ERROR;
+        memcpy(list, vt->list, vt->size * sizeof *vt->list);
+        munmap(vt->list, vt->capacity * sizeof *vt->list);
+        vt->mapped = false;
+        vt->list = list;
+        vt->capacity = capacity;
+        return SUCCESS;
+    }
+    #endif
+
+    list = (vt_Vector_Element*)realloc(vt->list, bytes);
+    if (list == NULL)
+        return ERROR;
+    vt->list = list;
+    vt->capacity = capacity;
+    return SUCCESS;
+}
+
+static void _free_storage(vt_Vector *vt)
+{
+    #ifdef __linux__
+    if (vt->mapped) {
+        munmap(vt->list, vt->capacity * sizeof *vt->list);
+        vt->list = NULL;
+        return;
+    }
+    #endif
+    free(vt->list);
+    vt->list = NULL;
+}
+
+static void _radix_sort(vt_Vector_Element *list, size_t n, vt_ElemKey key)
+{
+    KeyedElement *src = NULL;
+    KeyedElement *dst = NULL;
+    size_t (*counts)[VT_RADIX_BUCKETS] = NULL;
+    unsigned pass;
+    size_t i;
+
+    if (n < 2)
+        return;
+
+    src = (KeyedElement*)malloc(n * sizeof *src);
+    assert(src);
+    for (i = 0; i < n; ++i) {
+        src[i].key = key(list[i]);
+        src[i].elem = list[i];
+    }
+
+    if (n < VT_RADIX_MIN) {
+        _keyed_insertion_sort(src, n);
+    } else {
+        dst = (KeyedElement*)malloc(n * sizeof *dst);
+        assert(dst);
+        counts = calloc(VT_RADIX_PASSES, sizeof *counts);
+        assert(counts);
+
+        /* one read of the keys counts the digits of every pass */
+        for (i = 0; i < n; ++i) {
+            uint64_t k = src[i].key;
+            for (pass = 0; pass < VT_RADIX_PASSES; ++pass)
+                counts[pass][(k >> (pass * VT_RADIX_BITS)) & (VT_RADIX_BUCKETS - 1)]++;
+        }
+
+        for (pass = 0; pass < VT_RADIX_PASSES; ++pass) {
+            size_t *count = counts[pass];
+            unsigned shift = pass * VT_RADIX_BITS;
+            size_t b, offset = 0;
+            KeyedElement *tmp = NULL;
+
+            /* every key has the same digit, nothing would move */
+            if (count[(src[0].key >> shift) & (VT_RADIX_BUCKETS - 1)] == n)
+                continue;
+
+            for (b = 0; b < VT_RADIX_BUCKETS; ++b) {
+                size_t c = count[b];
+                count[b] = offset;
+                offset += c;
+            }
+            for (i = 0; i < n; ++i)
+                dst[count[(src[i].key >> shift) & (VT_RADIX_BUCKETS - 1)]++] = src[i];
+
+            tmp = src;
+            src = dst;
+            dst = tmp;
+        }
+        free(counts);
+        free(dst);
+    }
+
+    for (i = 0; i < n; ++i)
+        list[i] = src[i].elem;
+    free(src);
+}
+
+static void _keyed_insertion_sort(KeyedElement *list, size_t n)
+{
+    size_t i, j;
+
+    for (i = 1; i < n; ++i) {
+        KeyedElement elem = list[i];
+        for (j = i; j > 0 && list[j-1].key > elem.key; --j)
+            list[j] = list[j-1];
+        list[j] = elem;
+    }
+}
+
+static void _sort(vt_Vector_Element *list, size_t n, vt_ElemCompare comp)
+{
+    /* run stack, a run is list[base[i], base[i]+len[i]) */
+    size_t base[VT_SORT_MAXRUNS];
+    size_t len[VT_SORT_MAXRUNS];
+    size_t nruns = 0;
+    size_t low, high;
+    vt_Vector_Element *scratch = NULL;
+
+    if (n < 2)
+        return;
+
+    scratch = (vt_Vector_Element*)malloc((n / 2 + 1) * sizeof *scratch);
+    assert(scratch);
+
+    for (low = 0; low < n; low = high) {
+        high = _find_run(list, low, n, comp);
+        if (high - low < VT_SORT_MINRUN) {
+            size_t end = (n - low < VT_SORT_MINRUN) ? n : low + VT_SORT_MINRUN;
+            _insertion_sort(list, low, high, end, comp);
+            high = end;
+        }
+        base[nruns] = low;
+        len[nruns] = high - low;
+        nruns++;
+
+        /*
+         * merge eagerly while the run lengths on the stack do not shrink
+         * fast enough. this keeps merges balanced, bounds the stack depth
+         * and merges runs while they are still warm in cache.
+         */
+        while (nruns > 1) {
+            size_t i = nruns - 2;
+            if ((i > 0 && len[i-1] <= len[i] + len[i+1]) ||
+                (i > 1 && len[i-2] <= len[i-1] + len[i])) {
+                if (len[i-1] < len[i+1])
+                    i--;
+            } else if (len[i] > len[i+1]) {
+                break;
+            }
+            _merge(list, base[i], base[i+1], base[i+1] + len[i+1], scratch, comp);
+            len[i] += len[i+1];
+            if (i + 2 < nruns) {
+                base[i+1] = base[i+2];
+                len[i+1] = len[i+2];
+            }
+            nruns--;
+        }
+    }
+
+    while (nruns > 1) {
+        size_t i = nruns - 2;
+        _merge(list, base[i], base[i+1], base[i+1] + len[i+1], scratch, comp);
+        len[i] += len[i+1];
+        nruns--;
+    }
+
+    free(scratch);
+}
+
+static size_t _find_run(vt_Vector_Element *list, size_t low, size_t high,
+                        vt_ElemCompare comp)
+{
+    size_t end = low + 1;
+
+    if (end == high)
+        return end;
+
+    if (comp(list[end], list[low]) < 0) {
+        /* strictly descending, reversing it keeps the sort stable */
+        size_t i, j;
+        while (end + 1 < high && comp(list[end+1], list[end]) < 0)
+            end++;
+        for (i = low, j = end; i < j; ++i, --j) {
+            vt_Vector_Element tmp = list[i];
+            list[i] = list[j];
+            list[j] = tmp;
+        }
+    } else {
+        while (end + 1 < high && comp(list[end+1], list[end]) >= 0)
+            end++;
+    }
+    return end + 1;
+}
+
+static void _insertion_sort(vt_Vector_Element *list, size_t low, size_t sorted,
+                            size_t high, vt_ElemCompare comp)
+{
+    size_t i;
+
+    for (i = (sorted > low) ? sorted : low + 1; i < high; ++i) {
+        vt_Vector_Element elem = list[i];
+        size_t left = low;
+        size_t right = i;
+
+        /* binary search keeps comparisons (the expensive part) at log2 */
+        while (left < right) {
+            size_t mid = left + (right - left) / 2;
+            if (comp(elem, list[mid]) < 0)
+                right = mid;
+            else
+                left = mid + 1;
+        }
+        memmove(list + left + 1, list + left, (i - left) * sizeof *list);
+        list[left] = elem;
+    }
+}
+
+static void _merge(vt_Vector_Element *list, size_t low, size_t mid,
+                   size_t high, vt_Vector_Element *scratch, vt_ElemCompare comp)
+{
+    size_t i, j, k;
+
+    /* already in order, typical for partly sorted input */
+    if (comp(list[mid-1], list[mid]) <= 0)
+        return;
+
+    if (mid - low <= high - mid) {
+        /* copy the left run out and merge front to back */
+        memcpy(scratch, list + low, (mid - low) * sizeof *scratch);
+        i = 0;
+        j = mid;
+        k = low;
+        while (i < mid - low && j < high) {
+            if (comp(list[j], scratch[i]) < 0)
+                list[k++] = list[j++];
+            else
+                list[k++] = scratch[i++];
+        }
+        while (i < mid - low)
+            list[k++] = scratch[i++];
+    } else {
+        /* copy the right run out and merge back to front */
+        memcpy(scratch, list + mid, (high - mid) * sizeof *scratch);
+        i = mid;
+        j = high - mid;
+        k = high;
+        while (i > low && j > 0) {
+            if (comp(scratch[j-1], list[i-1]) < 0)
+                list[--k] = list[--i];
+            else
+                list[--k] = scratch[--j];
+        }
+        while (j > 0)
+            list[--k] = scratch[--j];
+    }
+}
+
+static size_t _search(vt_Vector *vt, const vt_Vector_Element key, vt_ElemCompare comp,
+                      BoundSearch search, bool *found)
+{
+    const vt_Vector_Element *list = NULL;
+    unsigned long epoch = 0;
+    size_t size, pos;
+
+    if (vt->concurrent) {
+        epoch = ep_enter(&vt->ep);
+        size = __atomic_load_n(&vt->size, __ATOMIC_ACQUIRE);
+        list = __atomic_load_n(&vt->list, __ATOMIC_ACQUIRE);
+    } else {
+        #ifdef SYNC
+            ll_LOCK(&vt->mutex);
+        #endif
+        size = vt->size;
+        list = vt->list;
+    }
+
+    pos = search(list, size, key, comp);
+    if (found)
+        *found = (pos < size && comp(list[pos], key) == 0);
+
+    if (vt->concurrent) {
+        ep_exit(&vt->ep, epoch);
+    } else {
+        #ifdef SYNC
+            ll_UNLOCK(&vt->mutex);
+        #endif
+    }
+    return pos;
+}
+
+static size_t _lower_bound(const vt_Vector_Element *list, size_t n,
+                           const vt_Vector_Element key, vt_ElemCompare comp)
+{
+    size_t low = 0;
+    size_t high = n;
+
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (comp(list[mid], key) < 0)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+static size_t _upper_bound(const vt_Vector_Element *list, size_t n,
+                           const vt_Vector_Element key, vt_ElemCompare comp)
+{
+    size_t low = 0;
+    size_t high = n;
+
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (comp(key, list[mid]) < 0)
+            high = mid;
+        else
+            low = mid + 1;
+    }
+    return low;
+}
+
+static size_t _lower_bound_branchless(const vt_Vector_Element *list, size_t n,
+                                      const vt_Vector_Element key, vt_ElemCompare comp)
+{
+    const vt_Vector_Element *base = list;
+
+    if (n == 0)
+        return 0;
+
+    /* the answer stays in [base, base + n], which halves every round */
+    while (n > 1) {
+        size_t half = n / 2;
+        /* both candidates for the next probe, the miss overlaps this compare */
+        __builtin_prefetch(base + (n - half) / 2);
+        __builtin_prefetch(base + half + (n - half) / 2);
+        base = (comp(base[half], key) < 0) ? base + half : base;
+        n -= half;
+    }
+    return (size_t)(base - list) + (comp(*base, key) < 0);
+}
+
+#ifdef SYNC
+static void _lock_vectors(vt_Vector *a, vt_Vector *b, vt_Vector *c)
+{
+    vt_Vector *tmp = NULL;
+
+    if (b < a) { tmp = a; a = b; b = tmp; }
+    if (c < b) { tmp = b; b = c; c = tmp; }
+    if (b < a) { tmp = a; a = b; b = tmp; }
+
+    ll_LOCK(&a->mutex);
+    if (b != a)
+        ll_LOCK(&b->mutex);
+    if (c != b)
+        ll_LOCK(&c->mutex);
+}
+
+static void _unlock_vectors(vt_Vector *a, vt_Vector *b, vt_Vector *c)
+{
+    ll_UNLOCK(&a->mutex);
+    if (b != a)
+        ll_UNLOCK(&b->mutex);
+    if (c != a && c != b)
+        ll_UNLOCK(&c->mutex);
+}
+#endif
+
+static void *_sort_worker(void *arg)
+{
+    SortWorker *worker = (SortWorker*)arg;
+    ParallelSort *ps = worker->ps;
+    vt_Vector_Element *src = ps->list;
+    vt_Vector_Element *dst = ps->buffer;
+    size_t low, high, width;
+
+    /* wait for the caller to fix nthreads, bounds and the barrier */
+    pthread_mutex_lock(&ps->start);
+    pthread_mutex_unlock(&ps->start);
+
+    /* no barrier, the caller sorts on its own */
+    if (ps->nthreads == 0)
+        return NULL;
+
+    low = ps->bounds[worker->id];
+    high = ps->bounds[worker->id + 1];
+    _sort(ps->list + low, high - low, ps->comp);
+
+    for (width = 1; width < ps->nthreads; width *= 2) {
+        vt_Vector_Element *tmp = NULL;
+        /* the previous phase wrote src */
+        pthread_barrier_wait(&ps->barrier);
+        _merge_chunk(ps, worker->id, src, dst, width);
+        tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+
+    if (src != ps->list) {
+        low = ps->n * worker->id / ps->nthreads;
+        high = ps->n * (worker->id + 1) / ps->nthreads;
+        pthread_barrier_wait(&ps->barrier);
+        memcpy(ps->list + low, src + low, (high - low) * sizeof *ps->list);
+    }
+    return NULL;
+}
+
+static void _merge_chunk(const ParallelSort *ps, size_t id, const vt_Vector_Element *src,
+                         vt_Vector_Element *dst, size_t width)
+{
+    size_t out_low = ps->n * id / ps->nthreads;
+    size_t out_high = ps->n * (id + 1) / ps->nthreads;
+    size_t c;
+
+    for (c = 0; c < ps->nthreads; c += 2 * width) {
+        size_t low = ps->bounds[c];
+        size_t mid = ps->bounds[(c + width < ps->nthreads) ? c + width : ps->nthreads];
+        size_t high = ps->bounds[(c + 2 * width < ps->nthreads) ? c + 2 * width
+                                                                    : ps->nthreads];
+        const vt_Vector_Element *a = src + low;
+        const vt_Vector_Element *b = src + mid;
+        vt_Vector_Element *out = NULL;
+        size_t from, to, i, j, iend, jend;
+
+        /* the part of this merge that falls into our output range */
+        from = (low > out_low) ? low : out_low;
+        to = (high < out_high) ? high : out_high;
+        if (from >= to)
+            continue;
+
+        i = _corank(a, mid - low, b, high - mid, from - low, ps->comp);
+        j = from - low - i;
+        iend = _corank(a, mid - low, b, high - mid, to - low, ps->comp);
+        jend = to - low - iend;
+
+        out = dst + from;
+        while (i < iend && j < jend) {
+            if (ps->comp(b[j], a[i]) < 0)
+                *out++ = b[j++];
+            else
+                *out++ = a[i++];
+        }
+        while (i < iend)
+            *out++ = a[i++];
+        while (j < jend)
+            *out++ = b[j++];
+    }
+}
+
+static size_t _corank(const vt_Vector_Element *a, size_t na,
+                      const vt_Vector_Element *b, size_t nb,
+                      size_t k, vt_ElemCompare comp)
+{
+    size_t low = (k > nb) ? k - nb : 0;
+    size_t high = (k < na) ? k : na;
+
+    /* take more from a while a[i] still merges ahead of b[k-i-1] */
+    while (low < high) {
+        size_t i = low + (high - low) / 2;
+        size_t j = k - i;
+        if (j > 0 && i < na && comp(b[j-1], a[i]) >= 0)
+            low = i + 1;
+        else
+            high = i;
+    }
+    return low;
+}
+
+#ifdef __linux__
+static void *_map_storage(size_t bytes, bool hugepages)
+{
+    void *addr = NULL;
+
+    if (!hugepages)
+        return mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    /* over-allocate and trim so the mapping starts on a huge page */
+    addr = mmap(NULL, bytes + VT_HUGEPAGE_SIZE, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (addr != MAP_FAILED) {
+        uintptr_t start = (uintptr_t)addr;
+        uintptr_t aligned = (start + VT_HUGEPAGE_SIZE - 1) & ~((uintptr_t)VT_HUGEPAGE_SIZE - 1);
+        if (aligned > start)
+            munmap(addr, aligned - start);
+        munmap((void*)(aligned + bytes), start + VT_HUGEPAGE_SIZE - aligned);
+        addr = (void*)aligned;
+        #ifdef MADV_HUGEPAGE
+        madvise(addr, bytes, MADV_HUGEPAGE);
+        #endif
+    }
+    return addr;
+}
+#endif
+
+static int _concurrent_append(vt_Vector *vt, const vt_Vector_Element *elems, size_t n)
+{
+    size_t size = vt->size;
+
+    if (size + n > vt->capacity) {
+        size_t capacity = vt->capacity;
+        vt_Vector_Element *list = NULL, *old = NULL;
+
+        while (capacity < size + n)
+            capacity = (vt->growth == vt_GROW_FIXED) ? capacity + vt->increment
+                     : (vt->growth == vt_GROW_HALF) ? capacity + capacity / 2 + 1
+                     : capacity * 2;
+        list = (vt_Vector_Element*)malloc(capacity * sizeof *list);
+        if (list == NULL)
+            return ERROR;
+        memcpy(list, vt->list, size * sizeof *list);
+
+        /* readers that already loaded the old list keep using it. seq_cst
+         * so the reclaim check in ep_retire cannot see the reader counts
+         * from before this store */
+        old = vt->list;
+        __atomic_store_n(&vt->list, list, __ATOMIC_SEQ_CST);
+        vt->capacity = capacity;
+        ep_retire(&vt->ep, old, NULL);
+    }
 
-    while (j < high)
-        (*list)[k++] = l2[j++];
+    memcpy(vt->list + size, elems, n * sizeof *elems);
+    vt->index = size + n;
+    __atomic_store_n(&vt->size, size + n, __ATOMIC_RELEASE);
+    return SUCCESS;
 }
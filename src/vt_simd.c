@@ -0,0 +1,651 @@
+#include <assert.h>
+#include <pthread.h>
+#include <stdint.h>
+
+#include "vt.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define VT_SIMD_X86
+#include <immintrin.h>
+#endif
+
+/*
+ * Every kernel comes in three versions, _<op>_<type>_<isa>, with isa one
+ * of scalar, sse2 and avx2. The vector versions are built from a few
+ * per type and isa helpers (_load_, _set1_, _eq_, ...) by the
+ * VT_SIMD_KERNELS macro, and the public functions pick one at runtime.
+ */
+
+/**
+ * @brief Detect the cpu and fill the compaction tables, run once.
+ */
+static void _simd_init(void);
+
+/**
+ * @brief Return the level in use, detecting it on first call.
+ */
+static vt_SimdLevel _simd_level(void);
+
+static pthread_once_t _simd_once = PTHREAD_ONCE_INIT;
+static vt_SimdLevel _simd_detected = vt_SIMD_SCALAR;
+static int _simd_current = vt_SIMD_SCALAR;
+
+
+/* scalar kernels, also used for the tails of the vector ones. sums
+ * add into A and return S */
+#define VT_SCALAR_KERNELS(sfx, T, S, A)                                       \
+static size_t _find_##sfx##_scalar(const T *list, size_t n, T value)          \
+{                                                                             \
+    size_t i;                                                                 \
+    for (i = 0; i < n; ++i)                                                   \
+        if (list[i] == value)                                                 \
+            return i;                                                         \
+    return n;                                                                 \
+}                                                                             \
+                                                                              \
+static size_t _count_##sfx##_scalar(const T *list, size_t n, T value)         \
+{                                                                             \
+    size_t i, count = 0;                                                      \
+    for (i = 0; i < n; ++i)                                                   \
+        count += (list[i] == value);                                          \
+    return count;                                                             \
+}                                                                             \
+                                                                              \
+static int _minmax_##sfx##_scalar(const T *list, size_t n, T *min, T *max)    \
+{                                                                             \
+    T lo, hi;                                                                 \
+    size_t i;                                                                 \
+    if (n == 0)                                                               \
+        return ERROR;                                                         \
+    lo = hi = list[0];                                                        \
+    for (i = 1; i < n; ++i) {                                                 \
+        lo = (list[i] < lo) ? list[i] : lo;                                   \
+        hi = (list[i] > hi) ? list[i] : hi;                                   \
+    }                                                                         \
+    *min = lo;                                                                \
+    *max = hi;                                                                \
+    return SUCCESS;                                                           \
+}                                                                             \
+                                                                              \
+static S _sum_##sfx##_scalar(const T *list, size_t n)                         \
+{                                                                             \
+    A sum = 0;                                                                \
+    size_t i;                                                                 \
+    for (i = 0; i < n; ++i)                                                   \
+        sum += (A)list[i];                                                    \
+    return (S)sum;                                                            \
+}                                                                             \
+                                                                              \
+static size_t _filter_##sfx##_scalar(const T *list, size_t n, T low, T high,  \
+                                     T *out)                                  \
+{                                                                             \
+    size_t i, count = 0;                                                      \
+    for (i = 0; i < n; ++i)                                                   \
+        if (list[i] >= low && list[i] <= high)                                \
+            out[count++] = list[i];                                           \
+    return count;                                                             \
+}
+
+VT_SCALAR_KERNELS(i32, int32_t, int64_t, int64_t)
+/* int64_t sums wrap, so add them unsigned */
+VT_SCALAR_KERNELS(i64, int64_t, int64_t, uint64_t)
+VT_SCALAR_KERNELS(f32, float, double, double)
+VT_SCALAR_KERNELS(f64, double, double, double)
+
+
+#ifdef VT_SIMD_X86
+
+#define TARGET_sse2 __attribute__((target("sse2")))
+#define TARGET_avx2 __attribute__((target("avx2,popcnt")))
+#define VT_HELPER(isa) static inline __attribute__((always_inline)) TARGET_##isa
+
+/* lane indices that move the lanes set in a mask to the front, 3 bits each */
+static uint32_t _compact32[256];    /* 8 x 32-bit lanes */
+static uint32_t _compact64[16];     /* 4 x 64-bit lanes as 8 x 32-bit */
+
+/*
+ * Vector kernels on top of the helpers for sfx and isa:
+ * vec_<sfx>_<isa>   vector type holding W elements
+ * _load_, _store_   unaligned load and store
+ * _set1_            broadcast a value
+ * _eq_              bit mask of the lanes equal between two vectors
+ * _range_           bit mask of the lanes in [low, high]
+ * _min_, _max_      lane wise min and max
+ * _compact_         store the lanes set in a mask to the front of out
+ * and _popcount_<isa> counting the bits of a lane mask.
+ */
+#define VT_SIMD_KERNELS(sfx, T, isa, W)                                       \
+    VT_SIMD_SEARCH(sfx, T, isa, W)                                            \
+    VT_SIMD_MINMAX(sfx, T, isa, W)                                            \
+    VT_SIMD_FILTER(sfx, T, isa, W)
+
+#define VT_SIMD_SEARCH(sfx, T, isa, W)                                        \
+static TARGET_##isa size_t _find_##sfx##_##isa(const T *list, size_t n,       \
+                                               T value)                       \
+{                                                                             \
+    vec_##sfx##_##isa v = _set1_##sfx##_##isa(value);                         \
+    size_t i = 0;                                                             \
+    for (; i + 2 * W <= n; i += 2 * W) {                                      \
+        unsigned lo = _eq_##sfx##_##isa(_load_##sfx##_##isa(list + i), v);    \
+        unsigned hi = _eq_##sfx##_##isa(_load_##sfx##_##isa(list + i + W), v);\
+        if (lo | hi)                                                          \
+            return i + __builtin_ctz(lo | (hi << W));                         \
+    }                                                                         \
+    return i + _find_##sfx##_scalar(list + i, n - i, value);                  \
+}                                                                             \
+                                                                              \
+static TARGET_##isa size_t _count_##sfx##_##isa(const T *list, size_t n,      \
+                                                T value)                      \
+{                                                                             \
+    vec_##sfx##_##isa v = _set1_##sfx##_##isa(value);                         \
+    size_t i = 0, count = 0;                                                  \
+    for (; i + W <= n; i += W)                                                \
+        count += _popcount_##isa(                                             \
+                     _eq_##sfx##_##isa(_load_##sfx##_##isa(list + i), v));    \
+    return count + _count_##sfx##_scalar(list + i, n - i, value);             \
+}
+
+#define VT_SIMD_MINMAX(sfx, T, isa, W)                                        \
+static TARGET_##isa int _minmax_##sfx##_##isa(const T *list, size_t n,        \
+                                              T *min, T *max)                 \
+{                                                                             \
+    vec_##sfx##_##isa vmin, vmax;                                             \
+    T lanes_min[W], lanes_max[W], lo, hi;                                     \
+    size_t i;                                                                 \
+    if (n < W)                                                                \
+        return _minmax_##sfx##_scalar(list, n, min, max);                     \
+    vmin = vmax = _load_##sfx##_##isa(list);                                  \
+    for (i = W; i + W <= n; i += W) {                                         \
+        vec_##sfx##_##isa x = _load_##sfx##_##isa(list + i);                  \
+        vmin = _min_##sfx##_##isa(vmin, x);                                   \
+        vmax = _max_##sfx##_##isa(vmax, x);                                   \
+    }                                                                         \
+    _store_##sfx##_##isa(lanes_min, vmin);                                    \
+    _store_##sfx##_##isa(lanes_max, vmax);                                    \
+    _minmax_##sfx##_scalar(lanes_min, W, &lo, &hi);                           \
+    *min = lo;                                                                \
+    _minmax_##sfx##_scalar(lanes_max, W, &lo, &hi);                           \
+    *max = hi;                                                                \
+    if (i < n) {                                                              \
+        _minmax_##sfx##_scalar(list + i, n - i, &lo, &hi);                    \
+        *min = (lo < *min) ? lo : *min;                                       \
+        *max = (hi > *max) ? hi : *max;                                       \
+    }                                                                         \
+    return SUCCESS;                                                           \
+}
+
+#define VT_SIMD_FILTER(sfx, T, isa, W)                                        \
+static TARGET_##isa size_t _filter_##sfx##_##isa(const T *list, size_t n,     \
+                                                 T low, T high, T *out)       \
+{                                                                             \
+    vec_##sfx##_##isa vlow = _set1_##sfx##_##isa(low);                        \
+    vec_##sfx##_##isa vhigh = _set1_##sfx##_##isa(high);                      \
+    size_t i = 0, count = 0;                                                  \
+    for (; i + W <= n; i += W) {                                              \
+        vec_##sfx##_##isa x = _load_##sfx##_##isa(list + i);                  \
+        unsigned mask = _range_##sfx##_##isa(x, vlow, vhigh);                 \
+        count += _compact_##sfx##_##isa(out + count, list + i, x, mask);      \
+    }                                                                         \
+    return count + _filter_##sfx##_scalar(list + i, n - i, low, high,         \
+                                          out + count);                       \
+}
+
+
+/* SSE2 has no popcnt, masks are 4 bits at most: look them up by nibble */
+VT_HELPER(sse2) unsigned _popcount_sse2(unsigned mask)
+{
+    return (0x4332322132212110ULL >> (4 * mask)) & 0xf;
+}
+
+/* SSE2 has no variable shuffle, store the kept lanes one by one */
+#define VT_SSE2_COMPACT(sfx, T)                                               \
+VT_HELPER(sse2) size_t _compact_##sfx##_sse2(T *out, const T *in,             \
+                                             vec_##sfx##_sse2 x,              \
+                                             unsigned mask)                   \
+{                                                                             \
+    size_t count = 0;                                                         \
+    (void)x;                                                                  \
+    while (mask) {                                                            \
+        out[count++] = in[__builtin_ctz(mask)];                               \
+        mask &= mask - 1;                                                     \
+    }                                                                         \
+    return count;                                                             \
+}
+
+VT_HELPER(sse2) __m128i _blend_sse2(__m128i mask, __m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+/* int32_t, SSE2 */
+typedef __m128i vec_i32_sse2;
+VT_HELPER(sse2) __m128i _load_i32_sse2(const int32_t *p) { return _mm_loadu_si128((const __m128i*)p); }
+VT_HELPER(sse2) void _store_i32_sse2(int32_t *p, __m128i x) { _mm_storeu_si128((__m128i*)p, x); }
+VT_HELPER(sse2) __m128i _set1_i32_sse2(int32_t v) { return _mm_set1_epi32(v); }
+VT_HELPER(sse2) unsigned _eq_i32_sse2(__m128i a, __m128i b)
+{
+    return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(a, b)));
+}
+VT_HELPER(sse2) unsigned _range_i32_sse2(__m128i x, __m128i low, __m128i high)
+{
+    __m128i out = _mm_or_si128(_mm_cmpgt_epi32(low, x), _mm_cmpgt_epi32(x, high));
+    return ~_mm_movemask_ps(_mm_castsi128_ps(out)) & 0xf;
+}
+VT_HELPER(sse2) __m128i _min_i32_sse2(__m128i a, __m128i b) { return _blend_sse2(_mm_cmpgt_epi32(a, b), b, a); }
+VT_HELPER(sse2) __m128i _max_i32_sse2(__m128i a, __m128i b) { return _blend_sse2(_mm_cmpgt_epi32(a, b), a, b); }
+VT_SSE2_COMPACT(i32, int32_t)
+VT_SIMD_KERNELS(i32, int32_t, sse2, 4)
+
+/* int64_t, SSE2 */
+typedef __m128i vec_i64_sse2;
+VT_HELPER(sse2) __m128i _load_i64_sse2(const int64_t *p) { return _mm_loadu_si128((const __m128i*)p); }
+VT_HELPER(sse2) __m128i _set1_i64_sse2(int64_t v) { return _mm_set1_epi64x(v); }
+VT_HELPER(sse2) unsigned _eq_i64_sse2(__m128i a, __m128i b)
+{
+    __m128i eq = _mm_cmpeq_epi32(a, b);
+    eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_movemask_pd(_mm_castsi128_pd(eq));
+}
+VT_SIMD_SEARCH(i64, int64_t, sse2, 2)
+
+/* no signed 64-bit compare before SSE4.2, emulating it is slower than the loop */
+static int _minmax_i64_sse2(const int64_t *list, size_t n, int64_t *min, int64_t *max)
+{
+    return _minmax_i64_scalar(list, n, min, max);
+}
+
+static size_t _filter_i64_sse2(const int64_t *list, size_t n, int64_t low,
+                               int64_t high, int64_t *out)
+{
+    return _filter_i64_scalar(list, n, low, high, out);
+}
+
+/* float, SSE2 */
+typedef __m128 vec_f32_sse2;
+VT_HELPER(sse2) __m128 _load_f32_sse2(const float *p) { return _mm_loadu_ps(p); }
+VT_HELPER(sse2) void _store_f32_sse2(float *p, __m128 x) { _mm_storeu_ps(p, x); }
+VT_HELPER(sse2) __m128 _set1_f32_sse2(float v) { return _mm_set1_ps(v); }
+VT_HELPER(sse2) unsigned _eq_f32_sse2(__m128 a, __m128 b) { return _mm_movemask_ps(_mm_cmpeq_ps(a, b)); }
+VT_HELPER(sse2) unsigned _range_f32_sse2(__m128 x, __m128 low, __m128 high)
+{
+    return _mm_movemask_ps(_mm_and_ps(_mm_cmpge_ps(x, low), _mm_cmple_ps(x, high)));
+}
+VT_HELPER(sse2) __m128 _min_f32_sse2(__m128 a, __m128 b) { return _mm_min_ps(a, b); }
+VT_HELPER(sse2) __m128 _max_f32_sse2(__m128 a, __m128 b) { return _mm_max_ps(a, b); }
+VT_SSE2_COMPACT(f32, float)
+VT_SIMD_KERNELS(f32, float, sse2, 4)
+
+/* double, SSE2 */
+typedef __m128d vec_f64_sse2;
+VT_HELPER(sse2) __m128d _load_f64_sse2(const double *p) { return _mm_loadu_pd(p); }
+VT_HELPER(sse2) void _store_f64_sse2(double *p, __m128d x) { _mm_storeu_pd(p, x); }
+VT_HELPER(sse2) __m128d _set1_f64_sse2(double v) { return _mm_set1_pd(v); }
+VT_HELPER(sse2) unsigned _eq_f64_sse2(__m128d a, __m128d b) { return _mm_movemask_pd(_mm_cmpeq_pd(a, b)); }
+VT_HELPER(sse2) unsigned _range_f64_sse2(__m128d x, __m128d low, __m128d high)
+{
+    return _mm_movemask_pd(_mm_and_pd(_mm_cmpge_pd(x, low), _mm_cmple_pd(x, high)));
+}
+VT_HELPER(sse2) __m128d _min_f64_sse2(__m128d a, __m128d b) { return _mm_min_pd(a, b); }
+VT_HELPER(sse2) __m128d _max_f64_sse2(__m128d a, __m128d b) { return _mm_max_pd(a, b); }
+VT_SSE2_COMPACT(f64, double)
+VT_SIMD_KERNELS(f64, double, sse2, 2)
+
+/* sums need wider accumulators for some types, written out per type */
+static TARGET_sse2 int64_t _sum_i32_sse2(const int32_t *list, size_t n)
+{
+    __m128i acc = _mm_setzero_si128();
+    int64_t lanes[2];
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        __m128i x = _load_i32_sse2(list + i);
+        __m128i sign = _mm_srai_epi32(x, 31);
+        acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(x, sign));
+        acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(x, sign));
+    }
+    _mm_storeu_si128((__m128i*)lanes, acc);
+    return lanes[0] + lanes[1] + _sum_i32_scalar(list + i, n - i);
+}
+
+static TARGET_sse2 int64_t _sum_i64_sse2(const int64_t *list, size_t n)
+{
+    __m128i acc = _mm_setzero_si128();
+    uint64_t lanes[2];
+    size_t i = 0;
+
+    for (; i + 2 <= n; i += 2)
+        acc = _mm_add_epi64(acc, _load_i64_sse2(list + i));
+    _mm_storeu_si128((__m128i*)lanes, acc);
+    return (int64_t)(lanes[0] + lanes[1] + (uint64_t)_sum_i64_scalar(list + i, n - i));
+}
+
+static TARGET_sse2 double _sum_f32_sse2(const float *list, size_t n)
+{
+    __m128d acc = _mm_setzero_pd();
+    double lanes[2];
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        __m128 x = _load_f32_sse2(list + i);
+        acc = _mm_add_pd(acc, _mm_cvtps_pd(x));
+        acc = _mm_add_pd(acc, _mm_cvtps_pd(_mm_movehl_ps(x, x)));
+    }
+    _mm_storeu_pd(lanes, acc);
+    return lanes[0] + lanes[1] + _sum_f32_scalar(list + i, n - i);
+}
+
+static TARGET_sse2 double _sum_f64_sse2(const double *list, size_t n)
+{
+    __m128d acc0 = _mm_setzero_pd();
+    __m128d acc1 = _mm_setzero_pd();
+    double lanes[2];
+    size_t i = 0;
+
+    /* two chains hide the add latency */
+    for (; i + 4 <= n; i += 4) {
+        acc0 = _mm_add_pd(acc0, _load_f64_sse2(list + i));
+        acc1 = _mm_add_pd(acc1, _load_f64_sse2(list + i + 2));
+    }
+    _mm_storeu_pd(lanes, _mm_add_pd(acc0, acc1));
+    return lanes[0] + lanes[1] + _sum_f64_scalar(list + i, n - i);
+}
+
+
+VT_HELPER(avx2) unsigned _popcount_avx2(unsigned mask)
+{
+    return __builtin_popcount(mask);
+}
+
+/* AVX2 compaction, permute the kept lanes to the front and store all 8 */
+VT_HELPER(avx2) __m256i _compact_index_avx2(uint32_t packed)
+{
+    const __m256i shifts = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+    return _mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(packed), shifts),
+                            _mm256_set1_epi32(7));
+}
+
+/* int32_t, AVX2 */
+typedef __m256i vec_i32_avx2;
+VT_HELPER(avx2) __m256i _load_i32_avx2(const int32_t *p) { return _mm256_loadu_si256((const __m256i*)p); }
+VT_HELPER(avx2) void _store_i32_avx2(int32_t *p, __m256i x) { _mm256_storeu_si256((__m256i*)p, x); }
+VT_HELPER(avx2) __m256i _set1_i32_avx2(int32_t v) { return _mm256_set1_epi32(v); }
+VT_HELPER(avx2) unsigned _eq_i32_avx2(__m256i a, __m256i b)
+{
+    return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b)));
+}
+VT_HELPER(avx2) unsigned _range_i32_avx2(__m256i x, __m256i low, __m256i high)
+{
+    __m256i out = _mm256_or_si256(_mm256_cmpgt_epi32(low, x), _mm256_cmpgt_epi32(x, high));
+    return ~_mm256_movemask_ps(_mm256_castsi256_ps(out)) & 0xff;
+}
+VT_HELPER(avx2) __m256i _min_i32_avx2(__m256i a, __m256i b) { return _mm256_min_epi32(a, b); }
+VT_HELPER(avx2) __m256i _max_i32_avx2(__m256i a, __m256i b) { return _mm256_max_epi32(a, b); }
+VT_HELPER(avx2) size_t _compact_i32_avx2(int32_t *out, const int32_t *in, __m256i x,
+                                         unsigned mask)
+{
+    (void)in;
+    x = _mm256_permutevar8x32_epi32(x, _compact_index_avx2(_compact32[mask]));
+    _mm256_storeu_si256((__m256i*)out, x);
+    return __builtin_popcount(mask);
+}
+VT_SIMD_KERNELS(i32, int32_t, avx2, 8)
+
+/* int64_t, AVX2 */
+typedef __m256i vec_i64_avx2;
+VT_HELPER(avx2) __m256i _load_i64_avx2(const int64_t *p) { return _mm256_loadu_si256((const __m256i*)p); }
+VT_HELPER(avx2) void _store_i64_avx2(int64_t *p, __m256i x) { _mm256_storeu_si256((__m256i*)p, x); }
+VT_HELPER(avx2) __m256i _set1_i64_avx2(int64_t v) { return _mm256_set1_epi64x(v); }
+VT_HELPER(avx2) unsigned _eq_i64_avx2(__m256i a, __m256i b)
+{
+    return _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(a, b)));
+}
+VT_HELPER(avx2) unsigned _range_i64_avx2(__m256i x, __m256i low, __m256i high)
+{
+    __m256i out = _mm256_or_si256(_mm256_cmpgt_epi64(low, x), _mm256_cmpgt_epi64(x, high));
+    return ~_mm256_movemask_pd(_mm256_castsi256_pd(out)) & 0xf;
+}
+VT_HELPER(avx2) __m256i _min_i64_avx2(__m256i a, __m256i b)
+{
+    return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b));
+}
+VT_HELPER(avx2) __m256i _max_i64_avx2(__m256i a, __m256i b)
+{
+    return _mm256_blendv_epi8(b, a, _mm256_cmpgt_epi64(a, b));
+}
+VT_HELPER(avx2) size_t _compact_i64_avx2(int64_t *out, const int64_t *in, __m256i x,
+                                         unsigned mask)
+{
+    (void)in;
+    x = _mm256_permutevar8x32_epi32(x, _compact_index_avx2(_compact64[mask]));
+    _mm256_storeu_si256((__m256i*)out, x);
+    return __builtin_popcount(mask);
+}
+VT_SIMD_KERNELS(i64, int64_t, avx2, 4)
+
+/* float, AVX2 */
+typedef __m256 vec_f32_avx2;
+VT_HELPER(avx2) __m256 _load_f32_avx2(const float *p) { return _mm256_loadu_ps(p); }
+VT_HELPER(avx2) void _store_f32_avx2(float *p, __m256 x) { _mm256_storeu_ps(p, x); }
+VT_HELPER(avx2) __m256 _set1_f32_avx2(float v) { return _mm256_set1_ps(v); }
+VT_HELPER(avx2) unsigned _eq_f32_avx2(__m256 a, __m256 b)
+{
+    return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_EQ_OQ));
+}
+VT_HELPER(avx2) unsigned _range_f32_avx2(__m256 x, __m256 low, __m256 high)
+{
+    return _mm256_movemask_ps(_mm256_and_ps(_mm256_cmp_ps(x, low, _CMP_GE_OQ),
+                                            _mm256_cmp_ps(x, high, _CMP_LE_OQ)));
+}
+VT_HELPER(avx2) __m256 _min_f32_avx2(__m256 a, __m256 b) { return _mm256_min_ps(a, b); }
+VT_HELPER(avx2) __m256 _max_f32_avx2(__m256 a, __m256 b) { return _mm256_max_ps(a, b); }
+VT_HELPER(avx2) size_t _compact_f32_avx2(float *out, const float *in, __m256 x,
+                                         unsigned mask)
+{
+    (void)in;
+    x = _mm256_permutevar8x32_ps(x, _compact_index_avx2(_compact32[mask]));
+    _mm256_storeu_ps(out, x);
+    return __builtin_popcount(mask);
+}
+VT_SIMD_KERNELS(f32, float, avx2, 8)
+
+/* double, AVX2 */
+typedef __m256d vec_f64_avx2;
+VT_HELPER(avx2) __m256d _load_f64_avx2(const double *p) { return _mm256_loadu_pd(p); }
+VT_HELPER(avx2) void _store_f64_avx2(double *p, __m256d x) { _mm256_storeu_pd(p, x); }
+VT_HELPER(avx2) __m256d _set1_f64_avx2(double v) { return _mm256_set1_pd(v); }
+VT_HELPER(avx2) unsigned _eq_f64_avx2(__m256d a, __m256d b)
+{
+    return _mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_EQ_OQ));
+}
+VT_HELPER(avx2) unsigned _range_f64_avx2(__m256d x, __m256d low, __m256d high)
+{
+    return _mm256_movemask_pd(_mm256_and_pd(_mm256_cmp_pd(x, low, _CMP_GE_OQ),
+                                            _mm256_cmp_pd(x, high, _CMP_LE_OQ)));
+}
+VT_HELPER(avx2) __m256d _min_f64_avx2(__m256d a, __m256d b) { return _mm256_min_pd(a, b); }
+VT_HELPER(avx2) __m256d _max_f64_avx2(__m256d a, __m256d b) { return _mm256_max_pd(a, b); }
+VT_HELPER(avx2) size_t _compact_f64_avx2(double *out, const double *in, __m256d x,
+                                         unsigned mask)
+{
+    __m256 perm = _mm256_permutevar8x32_ps(_mm256_castpd_ps(x),
+                                           _compact_index_avx2(_compact64[mask]));
+    (void)in;
+    _mm256_storeu_pd(out, _mm256_castps_pd(perm));
+    return __builtin_popcount(mask);
+}
+VT_SIMD_KERNELS(f64, double, avx2, 4)
+
+static TARGET_avx2 int64_t _sum_i32_avx2(const int32_t *list, size_t n)
+{
+    __m256i acc = _mm256_setzero_si256();
+    int64_t lanes[4];
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _load_i32_avx2(list + i);
+        acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(x)));
+        acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(x, 1)));
+    }
+    _mm256_storeu_si256((__m256i*)lanes, acc);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + _sum_i32_scalar(list + i, n - i);
+}
+
+static TARGET_avx2 int64_t _sum_i64_avx2(const int64_t *list, size_t n)
+{
+    __m256i acc = _mm256_setzero_si256();
+    uint64_t lanes[4];
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+        acc = _mm256_add_epi64(acc, _load_i64_avx2(list + i));
+    _mm256_storeu_si256((__m256i*)lanes, acc);
+    return (int64_t)(lanes[0] + lanes[1] + lanes[2] + lanes[3]
+                     + (uint64_t)_sum_i64_scalar(list + i, n - i));
+}
+
+static TARGET_avx2 double _sum_f32_avx2(const float *list, size_t n)
+{
+    __m256d acc = _mm256_setzero_pd();
+    double lanes[4];
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m256 x = _load_f32_avx2(list + i);
+        acc = _mm256_add_pd(acc, _mm256_cvtps_pd(_mm256_castps256_ps128(x)));
+        acc = _mm256_add_pd(acc, _mm256_cvtps_pd(_mm256_extractf128_ps(x, 1)));
+    }
+    _mm256_storeu_pd(lanes, acc);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + _sum_f32_scalar(list + i, n - i);
+}
+
+static TARGET_avx2 double _sum_f64_avx2(const double *list, size_t n)
+{
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    double lanes[4];
+    size_t i = 0;
+
+    /* two chains hide the add latency */
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_add_pd(acc0, _load_f64_avx2(list + i));
+        acc1 = _mm256_add_pd(acc1, _load_f64_avx2(list + i + 4));
+    }
+    _mm256_storeu_pd(lanes, _mm256_add_pd(acc0, acc1));
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + _sum_f64_scalar(list + i, n - i);
+}
+
+#endif /* VT_SIMD_X86 */
+
+
+#ifdef VT_SIMD_X86
+#define VT_DISPATCH(op, sfx, args)                                            \
+    switch (_simd_level()) {                                                  \
+        case vt_SIMD_AVX2:                                                    \
+            return _##op##_##sfx##_avx2 args;                                 \
+        case vt_SIMD_SSE2:                                                    \
+            return _##op##_##sfx##_sse2 args;                                 \
+        default:                                                              \
+            return _##op##_##sfx##_scalar args;                               \
+    }
+#else
+#define VT_DISPATCH(op, sfx, args) return _##op##_##sfx##_scalar args;
+#endif
+
+#define VT_PUBLIC_KERNELS(sfx, T, S)                                          \
+size_t vt_find_##sfx(const T *list, size_t n, T value)                        \
+{                                                                             \
+    assert(list || n == 0);                                                   \
+    VT_DISPATCH(find, sfx, (list, n, value))                                  \
+}                                                                             \
+                                                                              \
+size_t vt_count_##sfx(const T *list, size_t n, T value)                       \
+{                                                                             \
+    assert(list || n == 0);                                                   \
+    VT_DISPATCH(count, sfx, (list, n, value))                                 \
+}                                                                             \
+                                                                              \
+int vt_minmax_##sfx(const T *list, size_t n, T *min, T *max)                  \
+{                                                                             \
+    assert(list || n == 0);                                                   \
+    assert(min);                                                              \
+    assert(max);                                                              \
+    if (n == 0) {                                                             \
+        VT_DEBUG_EMPTY();                                                     \
+        return ERROR;                                                         \
+    }                                                                         \
+    VT_DISPATCH(minmax, sfx, (list, n, min, max))                             \
+}                                                                             \
+                                                                              \
+S vt_sum_##sfx(const T *list, size_t n)                                       \
+{                                                                             \
+    assert(list || n == 0);                                                   \
+    VT_DISPATCH(sum, sfx, (list, n))                                          \
+}                                                                             \
+                                                                              \
+size_t vt_filter_##sfx(const T *list, size_t n, T low, T high, T *out)        \
+{                                                                             \
+    assert(list || n == 0);                                                   \
+    assert(out || n == 0);                                                    \
+    VT_DISPATCH(filter, sfx, (list, n, low, high, out))                       \
+}
+
+#ifdef ALGOS_DEBUG
+#define VT_DEBUG_EMPTY() fprintf(stderr, "%s() error: list is empty\n", FUNC)
+#else
+#define VT_DEBUG_EMPTY() do { } while (0)
+#endif
+
+VT_PUBLIC_KERNELS(i32, int32_t, int64_t)
+VT_PUBLIC_KERNELS(i64, int64_t, int64_t)
+VT_PUBLIC_KERNELS(f32, float, double)
+VT_PUBLIC_KERNELS(f64, double, double)
+
+vt_SimdLevel vt_simd_level(void)
+{
+    return _simd_level();
+}
+
+vt_SimdLevel vt_simd_set_level(vt_SimdLevel max)
+{
+    vt_SimdLevel level;
+
+    pthread_once(&_simd_once, _simd_init);
+    level = (max < _simd_detected) ? max : _simd_detected;
+    __atomic_store_n(&_simd_current, (int)level, __ATOMIC_RELAXED);
+    return level;
+}
+
+static vt_SimdLevel _simd_level(void)
+{
+    pthread_once(&_simd_once, _simd_init);
+    return (vt_SimdLevel)__atomic_load_n(&_simd_current, __ATOMIC_RELAXED);
+}
+
+static void _simd_init(void)
+{
+    #ifdef VT_SIMD_X86
+        unsigned mask, lane, count;
+
+        for (mask = 0; mask < 256; ++mask) {
+            for (lane = count = 0; lane < 8; ++lane)
+                if (mask & (1u << lane))
+                    _compact32[mask] |= lane << (3 * count++);
+        }
+        /* 64-bit lane i is 32-bit lanes 2i and 2i+1 */
+        for (mask = 0; mask < 16; ++mask) {
+            for (lane = count = 0; lane < 4; ++lane) {
+                if (mask & (1u << lane)) {
+                    _compact64[mask] |= (2 * lane) << (3 * count++);
+                    _compact64[mask] |= (2 * lane + 1) << (3 * count++);
+                }
+            }
+        }
+
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt"))
+            _simd_detected = vt_SIMD_AVX2;
+        else if (__builtin_cpu_supports("sse2"))
+            _simd_detected = vt_SIMD_SSE2;
+    #endif
+    _simd_current = _simd_detected;
+}